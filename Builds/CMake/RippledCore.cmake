@@ -117,6 +117,7 @@ target_sources (xrpl_core PRIVATE
   src/ripple/protocol/impl/TxMeta.cpp
   src/ripple/protocol/impl/UintTypes.cpp
   src/ripple/protocol/impl/digest.cpp
+  src/ripple/protocol/impl/sha512_batch.cpp
   src/ripple/protocol/impl/tokens.cpp
   #[===============================[
     main sources:
@@ -371,6 +372,7 @@ target_sources (rippled PRIVATE
   src/ripple/app/ledger/impl/LedgerToJson.cpp
   src/ripple/app/ledger/impl/LocalTxs.cpp
   src/ripple/app/ledger/impl/OpenLedger.cpp
+  src/ripple/app/ledger/impl/ParallelApply.cpp
   src/ripple/app/ledger/impl/SkipListAcquire.cpp
   src/ripple/app/ledger/impl/TimeoutCounter.cpp
   src/ripple/app/ledger/impl/TransactionAcquire.cpp
@@ -397,6 +399,7 @@ target_sources (rippled PRIVATE
   src/ripple/app/misc/impl/AmendmentTable.cpp
   src/ripple/app/misc/impl/LoadFeeTrack.cpp
   src/ripple/app/misc/impl/Manifest.cpp
+  src/ripple/app/misc/impl/SigVerifier.cpp
   src/ripple/app/misc/impl/Transaction.cpp
   src/ripple/app/misc/impl/TxQ.cpp
   src/ripple/app/misc/impl/ValidatorKeys.cpp
@@ -465,6 +468,13 @@ target_sources (rippled PRIVATE
   src/ripple/app/tx/impl/apply.cpp
   src/ripple/app/tx/impl/applySteps.cpp
   src/ripple/app/hook/impl/applyHook.cpp
+  src/ripple/app/hook/impl/HookGuardCache.cpp
+  src/ripple/app/hook/impl/HookInstancePool.cpp
+  src/ripple/app/hook/impl/HookModuleCache.cpp
+  src/ripple/app/hook/impl/HookProfiler.cpp
+  src/ripple/app/hook/impl/HookSlotView.cpp
+  src/ripple/app/hook/impl/HookStatePrefetch.cpp
+  src/ripple/app/hook/impl/HookStateMap.cpp
   src/ripple/app/tx/impl/details/NFTokenUtils.cpp
   #[===============================[
      main sources:
@@ -473,6 +483,7 @@ target_sources (rippled PRIVATE
   src/ripple/basics/impl/Archive.cpp
   src/ripple/basics/impl/BasicConfig.cpp
   src/ripple/basics/impl/ResolverAsio.cpp
+  src/ripple/basics/impl/SnapshotFile.cpp
   src/ripple/basics/impl/UptimeClock.cpp
   src/ripple/basics/impl/make_SSLContext.cpp
   src/ripple/basics/impl/mulDiv.cpp
@@ -539,11 +550,13 @@ target_sources (rippled PRIVATE
   #]===============================]
   src/ripple/nodestore/backend/CassandraFactory.cpp
   src/ripple/nodestore/backend/RWDBFactory.cpp
+  src/ripple/nodestore/backend/SlabFactory.cpp
   src/ripple/nodestore/backend/MemoryFactory.cpp
   src/ripple/nodestore/backend/FlatmapFactory.cpp
   src/ripple/nodestore/backend/NuDBFactory.cpp
   src/ripple/nodestore/backend/NullFactory.cpp
   src/ripple/nodestore/backend/RocksDBFactory.cpp
+  src/ripple/nodestore/backend/TieredFactory.cpp
   src/ripple/nodestore/impl/BatchWriter.cpp
   src/ripple/nodestore/impl/Database.cpp
   src/ripple/nodestore/impl/DatabaseNodeImp.cpp
@@ -552,11 +565,16 @@ target_sources (rippled PRIVATE
   src/ripple/nodestore/impl/DeterministicShard.cpp
   src/ripple/nodestore/impl/DecodedBlob.cpp
   src/ripple/nodestore/impl/DummyScheduler.cpp
+  src/ripple/nodestore/impl/IoUring.cpp
+  src/ripple/nodestore/impl/LookupFilter.cpp
   src/ripple/nodestore/impl/ManagerImp.cpp
   src/ripple/nodestore/impl/NodeObject.cpp
+  src/ripple/nodestore/impl/NuDBReader.cpp
   src/ripple/nodestore/impl/Shard.cpp
   src/ripple/nodestore/impl/ShardInfo.cpp
+  src/ripple/nodestore/impl/StoredObject.cpp
   src/ripple/nodestore/impl/TaskQueue.cpp
+  src/ripple/nodestore/impl/ZstdDictionary.cpp
   #[===============================[
      main sources:
        subdir: overlay
@@ -615,6 +633,7 @@ target_sources (rippled PRIVATE
   src/ripple/rpc/handlers/FetchInfo.cpp
   src/ripple/rpc/handlers/GatewayBalances.cpp
   src/ripple/rpc/handlers/GetCounts.cpp
+  src/ripple/rpc/handlers/HookProfile.cpp
   src/ripple/rpc/handlers/LedgerAccept.cpp
   src/ripple/rpc/handlers/LedgerCleanerHandler.cpp
   src/ripple/rpc/handlers/LedgerClosed.cpp
@@ -723,6 +742,14 @@ if (tests)
     src/test/app/Freeze_test.cpp
     src/test/app/GenesisMint_test.cpp
     src/test/app/HashRouter_test.cpp
+    src/test/app/HookExecutor_test.cpp
+    src/test/app/HookGuardCache_test.cpp
+    src/test/app/HookInstancePool_test.cpp
+    src/test/app/HookModuleCache_test.cpp
+    src/test/app/HookProfiler_test.cpp
+    src/test/app/HookSlotView_test.cpp
+    src/test/app/HookStateMap_test.cpp
+    src/test/app/HookStatePrefetch_test.cpp
     src/test/app/Import_test.cpp
     src/test/app/Invoke_test.cpp
     src/test/app/LedgerHistory_test.cpp
@@ -739,18 +766,21 @@ if (tests)
     src/test/app/OfferStream_test.cpp
     src/test/app/Offer_test.cpp
     src/test/app/OversizeMeta_test.cpp
+    src/test/app/ParallelApply_test.cpp
     src/test/app/Path_test.cpp
     src/test/app/PayChan_test.cpp
     src/test/app/PayStrand_test.cpp
     src/test/app/PseudoTx_test.cpp
     src/test/app/RCLCensorshipDetector_test.cpp
     src/test/app/RCLValidations_test.cpp
+    src/test/app/RWDBDatabase_test.cpp
     src/test/app/Regression_test.cpp
     src/test/app/Remit_test.cpp
     src/test/app/SHAMapStore_test.cpp
     src/test/app/SetAuth_test.cpp
     src/test/app/SetRegularKey_test.cpp
     src/test/app/SetTrust_test.cpp
+    src/test/app/SigVerifier_test.cpp
     src/test/app/Taker_test.cpp
     src/test/app/TheoreticalQuality_test.cpp
     src/test/app/Ticket_test.cpp
@@ -765,6 +795,7 @@ if (tests)
     src/test/app/SetHookTSH_test.cpp
     src/test/app/Wildcard_test.cpp
     src/test/app/XahauGenesis_test.cpp
+    src/test/app/XFL_test.cpp
     src/test/app/tx/apply_test.cpp
     #[===============================[
        test sources:
@@ -780,7 +811,9 @@ if (tests)
     src/test/basics/PerfLog_test.cpp
     src/test/basics/RangeSet_test.cpp
     src/test/basics/scope_test.cpp
+    src/test/basics/ShardedCache_test.cpp
     src/test/basics/Slice_test.cpp
+    src/test/basics/SnapshotFile_test.cpp
     src/test/basics/StringUtilities_test.cpp
     src/test/basics/TaggedCache_test.cpp
     src/test/basics/XRPAmount_test.cpp
@@ -931,9 +964,13 @@ if (tests)
     #]===============================]
     src/test/nodestore/Backend_test.cpp
     src/test/nodestore/Basics_test.cpp
+    src/test/nodestore/Benchmark_test.cpp
     src/test/nodestore/DatabaseShard_test.cpp
     src/test/nodestore/Database_test.cpp
+    src/test/nodestore/LookupFilter_test.cpp
+    src/test/nodestore/NuDBReader_test.cpp
     src/test/nodestore/Timing_test.cpp
+    src/test/nodestore/ZstdDictionary_test.cpp
     src/test/nodestore/import_test.cpp
     src/test/nodestore/varint_test.cpp
     #[===============================[
@@ -973,6 +1010,7 @@ if (tests)
     src/test/protocol/Seed_test.cpp
     src/test/protocol/SeqProxy_test.cpp
     src/test/protocol/TER_test.cpp
+    src/test/protocol/digest_test.cpp
     src/test/protocol/types_test.cpp
     #[===============================[
        test sources:
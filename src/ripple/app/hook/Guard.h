@@ -1,12 +1,16 @@
 #include "Enum.h"
+#include <algorithm>
 #include <functional>
+#include <future>
 #include <iostream>
 #include <map>
 #include <memory>
+#include <optional>
 #include <ostream>
 #include <stack>
 #include <string>
 #include <string_view>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -796,6 +800,68 @@ check_guard(
     return wce;
 }
 
+// code sections at least this large have their functions checked in
+// parallel when no guard log is requested, see validateGuards
+#ifndef GUARD_PARALLEL_MIN_BYTES
+#define GUARD_PARALLEL_MIN_BYTES 16384
+#endif
+#ifndef GUARD_PARALLEL_MAX_THREADS
+#define GUARD_PARALLEL_MAX_THREADS 4
+#endif
+
+struct GuardCheckJob
+{
+    int codesec;
+    int start_offset;
+    int end_offset;
+};
+
+// runs check_guard over each job, spreading the jobs over up to
+// GUARD_PARALLEL_MAX_THREADS threads. results are in the order of jobs.
+// may throw as check_guard does, once every thread has finished
+inline std::vector<std::optional<uint64_t>>
+check_guards_parallel(
+    std::vector<uint8_t> const& wasm,
+    std::vector<GuardCheckJob> const& jobs,
+    int guard_func_idx,
+    int last_import_idx)
+{
+    std::vector<std::optional<uint64_t>> results(jobs.size());
+
+    size_t const threads = std::min<size_t>(
+        {jobs.size(),
+         std::max(1U, std::thread::hardware_concurrency()),
+         GUARD_PARALLEL_MAX_THREADS});
+
+    // jobs are interleaved over the threads as large functions tend to be
+    // next to each other
+    auto run = [&](size_t first) {
+        for (size_t k = first; k < jobs.size(); k += threads)
+            results[k] = check_guard(
+                wasm,
+                jobs[k].codesec,
+                jobs[k].start_offset,
+                jobs[k].end_offset,
+                guard_func_idx,
+                last_import_idx,
+                {},
+                "");
+    };
+
+    // the futures of std::async wait for their thread when destroyed, so
+    // an exception thrown here can't outlive the threads using `results`
+    std::vector<std::future<void>> workers;
+    for (size_t t = 1; t < threads; ++t)
+        workers.push_back(std::async(std::launch::async, run, t));
+
+    run(0);
+
+    for (auto& worker : workers)
+        worker.get();
+
+    return results;
+}
+
 // RH TODO: reprogram this function to use REQUIRE/ADVANCE
 // may throw overflow_error
 inline std::optional<  // unpopulated means invalid
@@ -1437,6 +1503,31 @@ validateGuards(
             int func_count = parseLeb128(wasm, i, &i);
             CHECK_SHORT_HOOK();
 
+            auto assign_count = [&](int j, uint64_t count) {
+                if (hook_func_idx && *hook_func_idx == j)
+                    maxInstrCountHook = count;
+                else if (cbak_func_idx && *cbak_func_idx == j)
+                    maxInstrCountCbak = count;
+                else
+                {
+                    if (DEBUG_GUARD)
+                        printf(
+                            "code section: %d not hook_func_idx: %d or "
+                            "cbak_func_idx: %d\n",
+                            j,
+                            *hook_func_idx,
+                            (cbak_func_idx ? *cbak_func_idx : -1));
+                    //   assert(false);
+                }
+            };
+
+            // without a log to keep in order the functions of a large code
+            // section are all parsed first and then checked in parallel
+            bool const parallel = !guardLog &&
+                section_length >= GUARD_PARALLEL_MIN_BYTES &&
+                std::thread::hardware_concurrency() > 1;
+            std::vector<GuardCheckJob> jobs;
+
             for (int j = 0; j < func_count; ++j)
             {
                 // parse locals
@@ -1469,6 +1560,13 @@ validateGuards(
                 // execution to here means we are up to the actual expr for the
                 // codesec/function
 
+                if (parallel)
+                {
+                    jobs.push_back({j, i, code_end});
+                    i = code_end;
+                    continue;
+                }
+
                 auto valid = check_guard(
                     wasm,
                     j,
@@ -1482,22 +1580,21 @@ validateGuards(
                 if (!valid)
                     return {};
 
-                if (hook_func_idx && *hook_func_idx == j)
-                    maxInstrCountHook = *valid;
-                else if (cbak_func_idx && *cbak_func_idx == j)
-                    maxInstrCountCbak = *valid;
-                else
+                assign_count(j, *valid);
+                i = code_end;
+            }
+
+            if (parallel)
+            {
+                auto const results = check_guards_parallel(
+                    wasm, jobs, guard_import_number, last_import_number);
+
+                for (size_t k = 0; k < jobs.size(); ++k)
                 {
-                    if (DEBUG_GUARD)
-                        printf(
-                            "code section: %d not hook_func_idx: %d or "
-                            "cbak_func_idx: %d\n",
-                            j,
-                            *hook_func_idx,
-                            (cbak_func_idx ? *cbak_func_idx : -1));
-                    //   assert(false);
+                    if (!results[k])
+                        return {};
+                    assign_count(jobs[k].codesec, *results[k]);
                 }
-                i = code_end;
             }
         }
         i = next_section;
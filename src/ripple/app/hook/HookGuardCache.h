@@ -0,0 +1,109 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_HOOK_HOOKGUARDCACHE_H_INCLUDED
+#define RIPPLE_APP_HOOK_HOOKGUARDCACHE_H_INCLUDED
+
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/json/json_value.h>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <optional>
+#include <utility>
+
+namespace hook {
+
+/**
+ * Node-local cache of CreateCode validation results keyed by HookHash.
+ *
+ * Validating CreateCode (the guard check and worst case execution analysis
+ * of validateGuards followed by a WasmEdge load) is a pure function of the
+ * code and the guard rules version, yet a SetHook is validated in preflight
+ * every time it is applied and again when its definition is created, and
+ * hook factories install identical code on many accounts. Both valid and
+ * invalid outcomes are remembered, bounded by a number of entries with the
+ * least recently used entry evicted first.
+ */
+class HookGuardCache
+{
+public:
+    // unpopulated means invalid, otherwise the maximum instruction counts
+    // of hook() and cbak() as returned by validateGuards
+    using Result = std::optional<std::pair<std::uint64_t, std::uint64_t>>;
+
+    static constexpr std::size_t defaultCapacity = 4096;
+
+private:
+    struct Entry
+    {
+        ripple::uint256 hookHash;
+        std::uint64_t rulesVersion;
+        Result result;
+    };
+
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;  // most recently used at the front
+    ripple::hash_map<ripple::uint256, std::list<Entry>::iterator> index_;
+    std::size_t capacity_;
+    std::uint64_t hits_ = 0;
+    std::uint64_t misses_ = 0;
+
+    // Must be called with mutex_ held
+    void
+    evict();
+
+public:
+    explicit HookGuardCache(std::size_t capacity = defaultCapacity);
+
+    /** The process-wide cache used by SetHook. */
+    static HookGuardCache&
+    instance();
+
+    /**
+     * The validation result for `hookHash` under `rulesVersion`, or nothing
+     * if it has not been validated.
+     */
+    std::optional<Result>
+    fetch(ripple::uint256 const& hookHash, std::uint64_t rulesVersion);
+
+    void
+    insert(
+        ripple::uint256 const& hookHash,
+        std::uint64_t rulesVersion,
+        Result const& result);
+
+    /** Change the number of entries kept, evicting entries as required. */
+    void
+    setCapacity(std::size_t capacity);
+
+    void
+    clear();
+
+    std::size_t
+    size() const;
+
+    Json::Value
+    getJson() const;
+};
+
+}  // namespace hook
+
+#endif
@@ -0,0 +1,239 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_HOOK_HOOKINSTANCEPOOL_H_INCLUDED
+#define RIPPLE_APP_HOOK_HOOKINSTANCEPOOL_H_INCLUDED
+
+#include <ripple/app/hook/HookModuleCache.h>
+#include <ripple/basics/Blob.h>
+#include <ripple/basics/Slice.h>
+#include <ripple/basics/base_uint.h>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+#include <wasmedge/wasmedge.h>
+
+namespace hook {
+
+/**
+ * A hook module rebuilt so that its instances can be returned to the state
+ * they had immediately after instantiation.
+ *
+ * WasmEdge only gives access to exported globals and memories, so every
+ * mutable global and the linear memory are additionally exported under
+ * reserved names. Exports cannot be observed from inside the module, so
+ * executing the rebuilt module is indistinguishable from executing the
+ * original.
+ *
+ * Modules with state that cannot be restored this way (tables, element or
+ * data count sections, a start function, more than one memory or imports
+ * other than functions) are not rebuilt and always run on a fresh instance.
+ */
+class ResettableModule
+{
+public:
+    struct Layout
+    {
+        ripple::Blob wasm;
+        std::vector<std::string> globals;  // exported mutable globals
+        std::optional<std::string> memory;
+    };
+
+    static constexpr char const* globalPrefix = "__hook_reset_global_";
+    static constexpr char const* memoryName = "__hook_reset_memory";
+
+private:
+    HookModuleCache::ModulePtr module_;
+    Layout layout_;
+
+public:
+    ResettableModule(HookModuleCache::ModulePtr module, Layout layout)
+        : module_(std::move(module)), layout_(std::move(layout))
+    {
+    }
+
+    /**
+     * Add the exports needed to reset an instance of `wasm`.
+     * Returns nothing if instances of the module cannot be reset.
+     */
+    static std::optional<Layout>
+    rewrite(ripple::Slice const& wasm);
+
+    /** Rewrite and compile `wasm`, or nullptr if it is not resettable. */
+    static std::shared_ptr<ResettableModule const>
+    make(ripple::Slice const& wasm);
+
+    WasmEdge_ASTModuleContext const*
+    ast() const
+    {
+        return module_->ast();
+    }
+
+    Layout const&
+    layout() const
+    {
+        return layout_;
+    }
+
+    /** Approximate number of bytes this module keeps resident. */
+    std::size_t
+    size() const
+    {
+        return module_->size();
+    }
+};
+
+/**
+ * An instantiated hook which can be executed repeatedly.
+ *
+ * The instance records its globals and memory once instantiation completes
+ * and reset() restores them, so every execution starts from exactly the
+ * state a newly instantiated module would have.
+ */
+class HookInstance
+{
+private:
+    std::shared_ptr<ResettableModule const> const module_;
+    HookModuleInstance instance_;
+
+    std::vector<WasmEdge_GlobalInstanceContext*> globals_;
+    std::vector<WasmEdge_Value> initialGlobals_;
+    WasmEdge_MemoryInstanceContext* memory_ = NULL;
+    std::vector<std::uint8_t> initialMemory_;
+
+    // instructions counted while instantiating, see execute()
+    std::uint64_t instantiationCount_ = 0;
+
+    explicit HookInstance(std::shared_ptr<ResettableModule const> module);
+
+    bool
+    instantiate();
+
+public:
+    HookInstance(HookInstance const&) = delete;
+    HookInstance&
+    operator=(HookInstance const&) = delete;
+
+    /** Instantiate `module`, or nullptr if that fails. */
+    static std::unique_ptr<HookInstance>
+    create(std::shared_ptr<ResettableModule const> const& module);
+
+    /**
+     * Run the exported function `name`.
+     *
+     * `instructions` receives the number of instructions a fresh instance
+     * would have reported, that is including those counted while the module
+     * was instantiated, so fees are the same whether or not an instance is
+     * reused.
+     */
+    WasmEdge_Result
+    execute(
+        WasmEdge_String name,
+        WasmEdge_Value const* params,
+        std::uint32_t paramCount,
+        WasmEdge_Value* returns,
+        std::uint32_t returnCount,
+        std::uint64_t& instructions);
+
+    /**
+     * Restore the state captured after instantiation.
+     * Returns false if the instance cannot be reused, for example because
+     * the hook grew its memory.
+     */
+    bool
+    reset();
+};
+
+/**
+ * Per-thread pools of HookInstances keyed by HookHash.
+ *
+ * Each thread keeps up to size() instances, reusing the least recently
+ * executed slot once full. An instance is checked out for the duration of
+ * an execution and only returned to the pool after a successful reset().
+ * As a HookHash identifies the code, any pooled instance with the right
+ * hash can be used whichever HookModule it was built from.
+ *
+ * Disabled (a size of zero) unless set via [hooks] instance_pool.
+ */
+class HookInstancePool
+{
+private:
+    struct ThreadPool;
+
+    std::atomic<std::size_t> size_{0};
+
+    ThreadPool&
+    local();
+
+public:
+    /** The process-wide pool used by hook::apply. */
+    static HookInstancePool&
+    instance();
+
+    /** Maximum number of instances kept by each thread. */
+    void
+    setSize(std::size_t size)
+    {
+        size_ = size;
+    }
+
+    std::size_t
+    size() const
+    {
+        return size_;
+    }
+
+    /**
+     * Take a ready to run instance of `module` from the calling thread's
+     * pool, instantiating one if none is pooled. The resettable module
+     * built for the first instance is charged to HookModuleCache::instance()
+     * alongside `module`. Returns nullptr when
+     * pooling is disabled or the module's instances cannot be reset, in
+     * which case the caller should instantiate the module itself.
+     */
+    std::unique_ptr<HookInstance>
+    acquire(
+        ripple::uint256 const& hookHash,
+        HookModuleCache::ModulePtr const& module,
+        ripple::Slice const& wasm);
+
+    /**
+     * Return an instance obtained from acquire() after it has been used.
+     * The instance is reset and pooled, or destroyed if it cannot be reset.
+     */
+    void
+    release(
+        ripple::uint256 const& hookHash,
+        std::unique_ptr<HookInstance> instance);
+
+    /** Number of instances pooled by the calling thread. */
+    std::size_t
+    pooled();
+
+    /** Drop the calling thread's pooled instances. */
+    void
+    clear();
+};
+
+}  // namespace hook
+
+#endif
@@ -0,0 +1,264 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_HOOK_HOOKMODULECACHE_H_INCLUDED
+#define RIPPLE_APP_HOOK_HOOKMODULECACHE_H_INCLUDED
+
+#include <ripple/basics/Slice.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/json/json_value.h>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <wasmedge/wasmedge.h>
+
+namespace hook {
+
+class ResettableModule;
+
+/**
+ * A hook's CreateCode after it has been parsed and validated by WasmEdge.
+ *
+ * Parsing and validation are the expensive, execution-independent part of
+ * running a hook. A HookModule holds the resulting AST so that it can be
+ * instantiated directly on every subsequent execution, see
+ * HookModuleInstance. The AST is never modified after construction and may
+ * be shared between threads.
+ */
+class HookModule
+{
+private:
+    WasmEdge_ASTModuleContext* ast_;
+    std::size_t const size_;
+
+    // built on first use by HookInstancePool
+    mutable std::once_flag resettableOnce_;
+    mutable std::shared_ptr<ResettableModule const> resettable_;
+    mutable std::atomic<std::size_t> resettableSize_{0};
+
+public:
+    HookModule(WasmEdge_ASTModuleContext* ast, std::size_t size)
+        : ast_(ast), size_(size)
+    {
+    }
+
+    HookModule(HookModule const&) = delete;
+    HookModule&
+    operator=(HookModule const&) = delete;
+
+    ~HookModule()
+    {
+        if (ast_)
+            WasmEdge_ASTModuleDelete(ast_);
+    }
+
+    WasmEdge_ASTModuleContext const*
+    ast() const
+    {
+        return ast_;
+    }
+
+    /**
+     * Approximate number of bytes this module keeps resident, including its
+     * resettable module once that has been built.
+     */
+    std::size_t
+    size() const
+    {
+        return size_ + resettableSize_.load();
+    }
+
+    /**
+     * This module rebuilt so that its instances can be reused, or nullptr if
+     * that is not possible. `wasm` must be the code the module was compiled
+     * from, it is only read on the first call.
+     */
+    std::shared_ptr<ResettableModule const>
+    resettable(ripple::Slice const& wasm) const;
+};
+
+/**
+ * An instance of a HookModule, ready to run its exports.
+ *
+ * A VM validates every module it is given and validation writes to the AST,
+ * so a shared AST must never be passed to a VM. The executor used here only
+ * reads the AST, which HookModuleCache::compile has already validated, so
+ * any number of threads can instantiate the same module concurrently.
+ * Instructions are counted from the start of instantiation, exactly as a VM
+ * running the module from scratch would count them.
+ */
+class HookModuleInstance
+{
+private:
+    WasmEdge_ConfigureContext* conf_ = NULL;
+    WasmEdge_StatisticsContext* stats_ = NULL;
+    WasmEdge_StoreContext* store_ = NULL;
+    WasmEdge_ExecutorContext* executor_ = NULL;
+    WasmEdge_ModuleInstanceContext* module_ = NULL;
+
+public:
+    HookModuleInstance();
+    ~HookModuleInstance();
+
+    HookModuleInstance(HookModuleInstance const&) = delete;
+    HookModuleInstance&
+    operator=(HookModuleInstance const&) = delete;
+
+    bool
+    sane() const
+    {
+        return conf_ && stats_ && store_ && executor_;
+    }
+
+    /** Link `imports` and instantiate the validated module `ast`. */
+    WasmEdge_Result
+    instantiate(
+        WasmEdge_ASTModuleContext const* ast,
+        WasmEdge_ModuleInstanceContext const* imports);
+
+    /** Run the exported function `name` of the instantiated module. */
+    WasmEdge_Result
+    execute(
+        WasmEdge_String name,
+        WasmEdge_Value const* params,
+        std::uint32_t paramCount,
+        WasmEdge_Value* returns,
+        std::uint32_t returnCount);
+
+    /** Instructions counted since instantiate() was called. */
+    std::uint64_t
+    instructionCount() const;
+
+    WasmEdge_ModuleInstanceContext const*
+    module() const
+    {
+        return module_;
+    }
+};
+
+/**
+ * Node-local cache of HookModules keyed by HookHash.
+ *
+ * A HookHash is the sha512h of the CreateCode so an entry can never go stale
+ * and a single cache serves every ledger (and every Application in the
+ * process). The cache is bounded by an approximate memory budget and evicts
+ * the least recently used module once the budget is exceeded. A budget of
+ * zero disables caching: modules are still compiled but never retained.
+ *
+ * Execution through a cached module is identical to execution from the raw
+ * byte code: the module is run by the same interpreter with the same
+ * statistics configuration, so instruction counts (and therefore fees) are
+ * unaffected.
+ */
+class HookModuleCache
+{
+public:
+    using ModulePtr = std::shared_ptr<HookModule const>;
+
+    // The parsed AST is considerably larger than the byte code it was parsed
+    // from. This factor is used to estimate a module's resident size.
+    static constexpr std::size_t astOverheadFactor = 8;
+
+    static constexpr std::size_t defaultBudget = 64 * 1024 * 1024;
+
+private:
+    struct Entry
+    {
+        ripple::uint256 hookHash;
+        ModulePtr module;
+        std::size_t charged;  // bytes counted in bytes_
+    };
+
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;  // most recently used at the front
+    ripple::hash_map<ripple::uint256, std::list<Entry>::iterator> index_;
+    std::size_t budget_;
+    std::size_t bytes_ = 0;
+    std::uint64_t hits_ = 0;
+    std::uint64_t misses_ = 0;
+
+    // Must be called with mutex_ held
+    void
+    evict();
+
+public:
+    explicit HookModuleCache(std::size_t budget = defaultBudget);
+
+    /** The process-wide cache used by hook::apply and SetHook. */
+    static HookModuleCache&
+    instance();
+
+    /**
+     * Parse and validate `wasm`.
+     * On failure nullptr is returned and `error` describes the problem.
+     */
+    static ModulePtr
+    compile(ripple::Slice const& wasm, std::string& error);
+
+    /** Return the cached module for `hookHash` or nullptr. */
+    ModulePtr
+    fetch(ripple::uint256 const& hookHash);
+
+    /**
+     * Return the cached module for `hookHash`, compiling `wasm` and
+     * inserting the result if it is not already present.
+     * On failure nullptr is returned and `error` describes the problem.
+     */
+    ModulePtr
+    fetchOrCompile(
+        ripple::uint256 const& hookHash,
+        ripple::Slice const& wasm,
+        std::string& error);
+
+    /** Insert a module, returning whichever module is cached afterwards. */
+    ModulePtr
+    insert(ripple::uint256 const& hookHash, ModulePtr const& module);
+
+    /**
+     * Re-account the cached module for `hookHash` after its size changed,
+     * evicting entries as required. Does nothing unless `module` is the
+     * module cached for the hash.
+     */
+    void
+    recharge(ripple::uint256 const& hookHash, ModulePtr const& module);
+
+    /** Change the memory budget, evicting entries as required. */
+    void
+    setBudget(std::size_t bytes);
+
+    void
+    clear();
+
+    std::size_t
+    size() const;
+
+    std::size_t
+    bytes() const;
+
+    Json::Value
+    getJson() const;
+};
+
+}  // namespace hook
+
+#endif
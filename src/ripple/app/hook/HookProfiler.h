@@ -0,0 +1,247 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_HOOK_HOOKPROFILER_H_INCLUDED
+#define RIPPLE_APP_HOOK_HOOKPROFILER_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <ripple/beast/insight/Collector.h>
+#include <ripple/json/json_value.h>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace hook {
+
+/**
+ * Opt-in profiler for hook execution.
+ *
+ * While enabled every Hook API host function call records its wall time, the
+ * bytes the hook handed to it (its *read_len arguments) and the bytes it
+ * wrote back into wasm memory, and every hook execution records its wall
+ * time, instruction count and number of host calls under its HookHash.
+ *
+ * Counters are kept per thread. Host function counters are only ever written
+ * by their own thread, so recording a call is a few relaxed stores with no
+ * locking and no shared cache lines. Per hook totals are updated once per
+ * execution under a per-thread mutex which is only contended while a
+ * snapshot is taken. Readers sum over all threads.
+ *
+ * Per hook totals are bounded: each thread tracks at most maxHooks distinct
+ * hooks and adds executions of any further hook to a single "other" bucket.
+ * Totals kept for exited threads and returned by snapshot() are trimmed to
+ * the maxHooks hooks with the most instructions, the rest being folded into
+ * the same bucket. clear() discards the per hook totals of every thread.
+ *
+ * Disabled unless turned on via [hooks] profile or the hook_profile command.
+ */
+class HookProfiler
+{
+public:
+    using clock_type = std::chrono::steady_clock;
+
+    // upper bound on the number of host functions that can be registered
+    static constexpr std::size_t maxFunctions = 128;
+
+    // upper bound on the number of hooks tracked individually
+    static constexpr std::size_t maxHooks = 256;
+
+    struct FunctionStats
+    {
+        std::string name;
+        std::uint64_t calls = 0;
+        std::uint64_t nanoseconds = 0;
+        std::uint64_t bytesIn = 0;
+        std::uint64_t bytesOut = 0;
+    };
+
+    struct HookStats
+    {
+        std::uint64_t executions = 0;
+        std::uint64_t nanoseconds = 0;
+        std::uint64_t instructions = 0;
+        std::uint64_t hostCalls = 0;
+    };
+
+    struct Snapshot
+    {
+        // one entry per registered host function, in registration order
+        std::vector<FunctionStats> functions;
+        std::map<ripple::uint256, HookStats> hooks;
+        // hooks beyond the maxHooks tracked individually
+        HookStats otherHooks;
+    };
+
+    /** Kept in each HookContext, see WRITE_WASM_MEMORY. */
+    struct Execution
+    {
+        std::uint64_t bytesWritten = 0;
+        std::uint64_t hostCalls = 0;
+    };
+
+    /** Measures a single host function call, see DEFINE_HOOK_FUNCTION. */
+    class Call
+    {
+        std::size_t const function_;
+        Execution& execution_;
+        bool const active_;
+        std::uint64_t bytesIn_ = 0;
+        std::uint64_t bytesWritten_ = 0;
+        clock_type::time_point start_;
+
+        void
+        begin();
+
+        void
+        end();
+
+    public:
+        Call(std::size_t function, Execution& execution, std::uint64_t bytesIn)
+            : function_(function)
+            , execution_(execution)
+            , active_(HookProfiler::active())
+        {
+            if (active_)
+            {
+                bytesIn_ = bytesIn;
+                begin();
+            }
+        }
+
+        ~Call()
+        {
+            if (active_)
+                end();
+        }
+
+        Call(Call const&) = delete;
+        Call&
+        operator=(Call const&) = delete;
+    };
+
+private:
+    struct ThreadCounters;
+    struct Metrics;
+
+    static inline std::atomic<bool> enabled_{false};
+
+    mutable std::mutex mutex_;
+    std::vector<ThreadCounters*> threads_;
+    Snapshot retired_;   // totals of threads which have exited
+    std::vector<FunctionStats> baseline_;  // totals at the last clear()
+
+    std::mutex metricsMutex_;
+    std::unique_ptr<Metrics> metrics_;
+
+    HookProfiler();
+
+    static ThreadCounters&
+    local();
+
+    Snapshot
+    totals() const;
+
+    // fold all but the maxHooks hooks with the most instructions into
+    // otherHooks
+    static void
+    trimHooks(Snapshot& snapshot);
+
+    void
+    collectMetrics();
+
+public:
+    ~HookProfiler();
+
+    HookProfiler(HookProfiler const&) = delete;
+    HookProfiler&
+    operator=(HookProfiler const&) = delete;
+
+    /** The process-wide profiler. */
+    static HookProfiler&
+    instance();
+
+    /** Cheap check used on every host call. */
+    static bool
+    active()
+    {
+        return enabled_.load(std::memory_order_relaxed);
+    }
+
+    void
+    setEnabled(bool enabled)
+    {
+        enabled_ = enabled;
+    }
+
+    bool
+    enabled() const
+    {
+        return active();
+    }
+
+    /**
+     * Assign an index to a host function. Called once per function during
+     * static initialization.
+     */
+    static std::size_t
+    registerFunction(char const* name);
+
+    /** True for the names of arguments giving the length of hook input. */
+    static constexpr bool
+    isReadLength(std::string_view name)
+    {
+        return name.ends_with("read_len");
+    }
+
+    /** Record a completed hook execution on the calling thread. */
+    void
+    recordHook(
+        ripple::uint256 const& hookHash,
+        clock_type::duration elapsed,
+        std::uint64_t instructions,
+        std::uint64_t hostCalls);
+
+    /** Everything recorded since the last clear(), summed over threads. */
+    Snapshot
+    snapshot() const;
+
+    void
+    clear();
+
+    /** Publish aggregate and per host function totals as insight gauges. */
+    void
+    attach(beast::insight::Collector::ptr const& collector);
+
+    /** Stop publishing to the collector passed to attach(). */
+    void
+    detach();
+
+    Json::Value
+    getJson() const;
+};
+
+}  // namespace hook
+
+#endif
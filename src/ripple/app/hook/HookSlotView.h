@@ -0,0 +1,89 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_HOOK_HOOKSLOTVIEW_H_INCLUDED
+#define RIPPLE_APP_HOOK_HOOKSLOTVIEW_H_INCLUDED
+
+#include <ripple/basics/Slice.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/protocol/STObject.h>
+#include <ripple/protocol/Serializer.h>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <utility>
+
+namespace hook {
+
+/**
+ * The serialized form of an object loaded into a hook slot, shared by every
+ * slot that points into that object.
+ *
+ * Reading a slot into guest memory used to serialize the slotted field each
+ * time. Instead the whole object is serialized once, on the first read of
+ * any slot pointing into it, and the position of every field within those
+ * bytes is recorded. The bytes a field's add() would produce are then a
+ * contiguous range of them, so every subsequent read of the object or any
+ * field or array element within it is a lookup and a copy.
+ *
+ * Slotted objects are never modified, so the bytes stay valid for as long
+ * as the slot.
+ */
+class SlotView
+{
+private:
+    std::shared_ptr<ripple::STObject const> const root_;
+
+    ripple::Serializer bytes_;
+    ripple::hash_map<
+        ripple::STBase const*,
+        std::pair<std::uint32_t, std::uint32_t>>
+        index_;  // field -> [begin, end) in bytes_
+    bool built_ = false;
+
+    void
+    build();
+
+    // Append `field` to bytes_ exactly as field.add() would, recording where
+    // it and everything within it were written.
+    void
+    index(ripple::STBase const& field);
+
+public:
+    explicit SlotView(std::shared_ptr<ripple::STObject const> root)
+        : root_(std::move(root))
+    {
+    }
+
+    SlotView(SlotView const&) = delete;
+    SlotView&
+    operator=(SlotView const&) = delete;
+
+    /**
+     * The bytes field.add() would produce. `field` is expected to be the
+     * root object or something within it, anything else is serialized and
+     * kept in addition. The slice is valid until the next call.
+     */
+    std::optional<ripple::Slice>
+    serialized(ripple::STBase const* field);
+};
+
+}  // namespace hook
+
+#endif
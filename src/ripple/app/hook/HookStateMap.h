@@ -0,0 +1,289 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_HOOK_HOOKSTATEMAP_H_INCLUDED
+#define RIPPLE_APP_HOOK_HOOKSTATEMAP_H_INCLUDED
+
+#include <ripple/basics/ByteUtilities.h>
+#include <ripple/basics/Slice.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/protocol/AccountID.h>
+
+#include <boost/container/pmr/monotonic_buffer_resource.hpp>
+#include <boost/container/pmr/polymorphic_allocator.hpp>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace hook {
+
+namespace detail {
+
+/**
+ * Open addressing index over records stored in a separate vector.
+ *
+ * Only the (truncated) hash and the position of each record are kept, so
+ * probing touches a single cache line in the common case and the caller
+ * compares the full key only when the hashes match.
+ */
+class FlatIndex
+{
+public:
+    using allocator_type = boost::container::pmr::polymorphic_allocator<
+        std::pair<std::uint32_t, std::uint32_t>>;
+
+private:
+    // first = hash, second = record index + 1 (0 marks an empty slot)
+    std::vector<std::pair<std::uint32_t, std::uint32_t>, allocator_type>
+        slots_;
+    std::size_t size_ = 0;
+
+    void
+    grow();
+
+public:
+    explicit FlatIndex(allocator_type const& alloc) : slots_(alloc)
+    {
+    }
+
+    /** Return the index of the record matching `equal`, or -1. */
+    template <class Equal>
+    std::int64_t
+    find(std::uint32_t hash, Equal&& equal) const
+    {
+        if (slots_.empty())
+            return -1;
+
+        std::size_t const mask = slots_.size() - 1;
+        for (std::size_t i = hash & mask;; i = (i + 1) & mask)
+        {
+            auto const& [h, idx] = slots_[i];
+            if (idx == 0)
+                return -1;
+            if (h == hash && equal(idx - 1))
+                return idx - 1;
+        }
+    }
+
+    /** Add a record which is known not to be present yet. */
+    void
+    insert(std::uint32_t hash, std::uint32_t index);
+};
+
+}  // namespace detail
+
+/**
+ * This map acts as both a read and write cache for hook execution and is
+ * preserved across the execution of the set of hook chains being executed
+ * in the current transaction. It is committed to the ledger only upon
+ * tesSUCCESS for the otxn (see finalizeHookState).
+ *
+ * State entries are keyed by (account, namespace, key) and live in a flat,
+ * open addressed hash table. Entries, index slots and any values too large
+ * to be stored inline are carved out of a single monotonic arena, which is
+ * released in one go when the map is destroyed at the end of the
+ * transaction. Iteration for commit is always in (account, namespace, key)
+ * order, so the order of ledger writes does not depend on hashing.
+ */
+class HookStateMap
+{
+public:
+    // Values up to this size are stored inside the entry itself
+    static constexpr std::size_t inlineValueSize = 32;
+
+    // The arena only allocates this once the first entry is inserted, so
+    // transactions that never touch hook state pay nothing for it.
+    static constexpr std::size_t initialBufferSize = ripple::kilobytes(16);
+
+    /** Reserve accounting for an account whose state has been touched. */
+    struct Account
+    {
+        ripple::AccountID id;
+        std::int64_t availableForReserves;  // remaining available ownercount
+        std::int64_t namespaceCount;        // total namespace count
+    };
+
+private:
+    // Every (account, namespace) pair is stored once; entries refer to it.
+    // These are allocated individually so their addresses never change.
+    struct Namespace
+    {
+        ripple::AccountID account;
+        ripple::uint256 ns;
+        std::uint32_t index;
+    };
+
+public:
+    class Entry
+    {
+    private:
+        friend class HookStateMap;
+
+        Namespace const* ns_;
+        ripple::uint256 key_;
+        std::uint8_t* external_ = nullptr;
+        std::uint32_t size_ = 0;
+        std::uint32_t capacity_ = inlineValueSize;
+        std::array<std::uint8_t, inlineValueSize> inline_;
+
+    public:
+        bool modified = false;  // is modified from ledger value
+
+        Entry(Namespace const* ns, ripple::uint256 const& key)
+            : ns_(ns), key_(key)
+        {
+        }
+
+        ripple::AccountID const&
+        account() const
+        {
+            return ns_->account;
+        }
+
+        ripple::uint256 const&
+        ns() const
+        {
+            return ns_->ns;
+        }
+
+        ripple::uint256 const&
+        key() const
+        {
+            return key_;
+        }
+
+        ripple::Slice
+        value() const
+        {
+            return {external_ ? external_ : inline_.data(), size_};
+        }
+    };
+
+private:
+    template <class T>
+    using arena_vector =
+        std::vector<T, boost::container::pmr::polymorphic_allocator<T>>;
+
+    // must outlive everything allocated from it, so it is declared first
+    boost::container::pmr::monotonic_buffer_resource arena_;
+
+    arena_vector<Account> accounts_;
+    arena_vector<Namespace*> namespaces_;
+    arena_vector<Entry> entries_;
+    detail::FlatIndex accountIndex_;
+    detail::FlatIndex namespaceIndex_;
+    detail::FlatIndex entryIndex_;
+
+    // Hooks overwhelmingly work within a single namespace, remembering the
+    // last one found saves hashing the account and namespace on every call.
+    mutable Namespace const* lastNamespace_ = nullptr;
+
+    Namespace const*
+    findNamespace(ripple::AccountID const& acc, ripple::uint256 const& ns)
+        const;
+
+public:
+    uint32_t modified_entry_count = 0;  // track the number of total modified
+
+    HookStateMap();
+
+    HookStateMap(HookStateMap const&) = delete;
+    HookStateMap&
+    operator=(HookStateMap const&) = delete;
+
+    /** Return the reserve accounting for `acc`, or nullptr. */
+    Account*
+    findAccount(ripple::AccountID const& acc);
+
+    /** Start reserve accounting for an account not yet in the map. */
+    Account&
+    insertAccount(
+        ripple::AccountID const& acc,
+        std::int64_t availableForReserves,
+        std::int64_t namespaceCount);
+
+    /** True if any entry under (acc, ns) has been cached. */
+    bool
+    hasNamespace(ripple::AccountID const& acc, ripple::uint256 const& ns)
+        const;
+
+    /**
+     * Return the cached entry, or nullptr.
+     * The pointer is invalidated by the next call to insert().
+     */
+    Entry const*
+    find(
+        ripple::AccountID const& acc,
+        ripple::uint256 const& ns,
+        ripple::uint256 const& key) const;
+
+    Entry*
+    find(
+        ripple::AccountID const& acc,
+        ripple::uint256 const& ns,
+        ripple::uint256 const& key);
+
+    /**
+     * Add an entry which is not in the map yet.
+     * The namespace is recorded too, if it had not been seen before.
+     */
+    Entry&
+    insert(
+        ripple::AccountID const& acc,
+        ripple::uint256 const& ns,
+        ripple::uint256 const& key,
+        ripple::Slice const& value,
+        bool modified);
+
+    /** Replace the value of an entry, reusing its storage where possible. */
+    void
+    assign(Entry& entry, ripple::Slice const& value);
+
+    /** Number of cached entries, modified or not. */
+    std::size_t
+    size() const
+    {
+        return entries_.size();
+    }
+
+    /** All cached entries, in no particular order. */
+    auto
+    begin() const
+    {
+        return entries_.begin();
+    }
+
+    auto
+    end() const
+    {
+        return entries_.end();
+    }
+
+    /**
+     * The modified entries ordered by (account, namespace, key).
+     * This is the order in which they are written to the ledger.
+     */
+    std::vector<Entry const*>
+    modified() const;
+};
+
+}  // namespace hook
+
+#endif
@@ -0,0 +1,123 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_HOOK_HOOKSTATEPREFETCH_H_INCLUDED
+#define RIPPLE_APP_HOOK_HOOKSTATEPREFETCH_H_INCLUDED
+
+#include <ripple/app/hook/HookStateMap.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/basics/base_uint.h>
+#include <ripple/protocol/AccountID.h>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace ripple {
+class Ledger;
+}
+
+namespace hook {
+
+/**
+ * Warms the node store caches for hook state before a hook chain runs.
+ *
+ * A hook reading state that is not yet in the HookStateMap reads the ledger
+ * one entry at a time, and each read can block on the node store. The
+ * prefetcher remembers which state keys were touched under each (account,
+ * namespace) and, before that account's hooks execute again, requests the
+ * SHAMap nodes leading to those keys and to the namespace's directory root
+ * asynchronously. The reads complete on the node store's read threads while
+ * the transaction is being prepared; nothing is read into the view, so the
+ * outcome of hook execution is unaffected.
+ *
+ * Disabled unless turned on via [hooks] state_prefetch.
+ */
+class HookStatePrefetcher
+{
+public:
+    // recently touched keys remembered per account and namespace
+    static constexpr std::size_t keysPerNamespace = 32;
+
+    // number of (account, namespace) pairs remembered
+    static constexpr std::size_t maxNamespaces = 4096;
+
+private:
+    using Keys = std::vector<ripple::uint256>;  // most recent first
+    using Entry = std::pair<ripple::uint256, Keys>;
+
+    std::atomic<bool> enabled_{false};
+
+    mutable std::mutex mutex_;
+    std::list<Entry> lru_;  // most recently used at the front
+    ripple::hash_map<ripple::uint256, std::list<Entry>::iterator> index_;
+
+    std::atomic<std::uint64_t> requested_{0};
+
+public:
+    /** The process-wide prefetcher used by Transactor. */
+    static HookStatePrefetcher&
+    instance();
+
+    void
+    setEnabled(bool enabled)
+    {
+        enabled_ = enabled;
+    }
+
+    bool
+    enabled() const
+    {
+        return enabled_;
+    }
+
+    /** Remember the state keys touched while applying a transaction. */
+    void
+    record(HookStateMap const& stateMap);
+
+    /** The keys remembered for (acc, ns), most recently touched first. */
+    std::vector<ripple::uint256>
+    recent(ripple::AccountID const& acc, ripple::uint256 const& ns) const;
+
+    /**
+     * Start loading the directory root and the remembered state entries of
+     * (acc, ns) from `ledger`. Returns immediately.
+     */
+    void
+    prefetch(
+        std::shared_ptr<ripple::Ledger const> const& ledger,
+        ripple::AccountID const& acc,
+        ripple::uint256 const& ns);
+
+    /** Number of ledger entries prefetching has been requested for. */
+    std::uint64_t
+    requested() const
+    {
+        return requested_;
+    }
+
+    void
+    clear();
+};
+
+}  // namespace hook
+
+#endif
@@ -33,6 +33,7 @@
 #define DELIM_0 ,
 #define DELIM_1
 #define DELIM_2 ;
+#define DELIM_3 +
 #define DELIM(S) DELIM_##S
 
 #define FOR_VAR_1(T, S, D) SEP(T, D)
@@ -88,6 +89,13 @@
 
 #define WASM_VAL_TYPE(T, b) CAT2(TYP_, T)
 
+// the *read_len arguments of a host function, summed for the profiler
+#define PROFILE_READ_LEN(T, V)                                             \
+    (std::integral_constant<bool, hook::HookProfiler::isReadLength(#V)>:: \
+             value                                                         \
+         ? static_cast<uint64_t>(V)                                        \
+         : uint64_t{0})
+
 #define DECLARE_HOOK_FUNCTION(R, F, ...)                      \
     R F(hook::HookContext& hookCtx,                           \
         WasmEdge_CallingFrameContext const& frameCtx,         \
@@ -115,6 +123,8 @@
     extern WasmEdge_String WasmFunctionName##F;
 
 #define DEFINE_HOOK_FUNCTION(R, F, ...)                             \
+    static std::size_t const WasmFunctionProfileId##F =             \
+        hook::HookProfiler::registerFunction(#F);                   \
     WasmEdge_Result hook_api::WasmFunction##F(                      \
         void* data_ptr,                                             \
         const WasmEdge_CallingFrameContext* frameCtx,               \
@@ -123,8 +133,13 @@
     {                                                               \
         int _stack = 0;                                             \
         FOR_VARS(VAR_ASSIGN, 2, __VA_ARGS__);                       \
-        hook::HookContext* hookCtx =                                \
-            reinterpret_cast<hook::HookContext*>(data_ptr);         \
+        hook::HookContext* hookCtx = hook::currentHookContext;      \
+        if (!hookCtx)                                               \
+            return WasmEdge_Result_Fail;                            \
+        hook::HookProfiler::Call profileCall(                       \
+            WasmFunctionProfileId##F,                               \
+            hookCtx->profile,                                       \
+            (FOR_VARS(PROFILE_READ_LEN, 3, __VA_ARGS__)));          \
         R return_code = hook_api::F(                                \
             *hookCtx,                                               \
             *const_cast<WasmEdge_CallingFrameContext*>(frameCtx),   \
@@ -152,14 +167,19 @@
         __VA_ARGS__)
 
 #define DEFINE_HOOK_FUNCNARG(R, F)                                           \
+    static std::size_t const WasmFunctionProfileId##F =                      \
+        hook::HookProfiler::registerFunction(#F);                            \
     WasmEdge_Result hook_api::WasmFunction##F(                               \
         void* data_ptr,                                                      \
         const WasmEdge_CallingFrameContext* frameCtx,                        \
         const WasmEdge_Value* in,                                            \
         WasmEdge_Value* out)                                                 \
     {                                                                        \
-        hook::HookContext* hookCtx =                                         \
-            reinterpret_cast<hook::HookContext*>(data_ptr);                  \
+        hook::HookContext* hookCtx = hook::currentHookContext;               \
+        if (!hookCtx)                                                        \
+            return WasmEdge_Result_Fail;                                     \
+        hook::HookProfiler::Call profileCall(                                \
+            WasmFunctionProfileId##F, hookCtx->profile, 0);                  \
         R return_code = hook_api::F(                                         \
             *hookCtx, *const_cast<WasmEdge_CallingFrameContext*>(frameCtx)); \
         if (return_code == RC_ROLLBACK || return_code == RC_ACCEPT)          \
@@ -229,6 +249,7 @@
                 bytes_to_write)))                                           \
             return INTERNAL_ERROR;                                          \
         bytes_written += bytes_to_write;                                    \
+        hookCtx.profile.bytesWritten += bytes_to_write;                     \
     }
 
 #define WRITE_WASM_MEMORY_AND_RETURN( \
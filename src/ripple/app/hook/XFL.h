@@ -0,0 +1,654 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_HOOK_XFL_H_INCLUDED
+#define RIPPLE_APP_HOOK_XFL_H_INCLUDED
+
+#include <ripple/app/hook/Enum.h>
+#include <ripple/basics/IOUAmount.h>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+
+#ifndef __SIZEOF_INT128__
+#include <boost/multiprecision/cpp_int.hpp>
+#endif
+
+/**
+ * XFL, the packed floating point format of the hook float_* API, and the
+ * arithmetic kernels behind those functions.
+ *
+ * The results of every kernel are part of consensus. Where a kernel avoids
+ * work the original implementation did (a libm call, multiprecision
+ * arithmetic or a loop) it reproduces that implementation's result exactly,
+ * including its rounding quirks; src/test/app/XFL_test.cpp checks this
+ * against a copy of the original code.
+ */
+namespace hook_float {
+
+#ifdef __SIZEOF_INT128__
+using uint128_t = unsigned __int128;
+#else
+using uint128_t = boost::multiprecision::uint128_t;
+#endif
+
+// power of 10 LUT for fast integer math
+static constexpr int64_t power_of_ten[19] = {
+    1LL,
+    10LL,
+    100LL,
+    1000LL,
+    10000LL,
+    100000LL,
+    1000000LL,
+    10000000LL,
+    100000000LL,
+    1000000000LL,
+    10000000000LL,
+    100000000000LL,
+    1000000000000LL,
+    10000000000000LL,
+    100000000000000LL,
+    1000000000000000LL,  // 15
+    10000000000000000LL,
+    100000000000000000LL,
+    1000000000000000000LL,
+};
+
+using namespace hook_api;
+static int64_t const minMantissa = 1000000000000000ull;
+static int64_t const maxMantissa = 9999999999999999ull;
+static int32_t const minExponent = -96;
+static int32_t const maxExponent = 80;
+inline int32_t
+get_exponent(int64_t float1)
+{
+    if (float1 < 0)
+        return INVALID_FLOAT;
+    if (float1 == 0)
+        return 0;
+    uint64_t float_in = (uint64_t)float1;
+    float_in >>= 54U;
+    float_in &= 0xFFU;
+    return ((int32_t)float_in) - 97;
+}
+
+inline int64_t
+get_mantissa(int64_t float1)
+{
+    if (float1 < 0)
+        return INVALID_FLOAT;
+    if (float1 == 0)
+        return 0;
+    float1 -= ((((uint64_t)float1) >> 54U) << 54U);
+    return float1;
+}
+
+inline bool
+is_negative(int64_t float1)
+{
+    return ((float1 >> 62U) & 1ULL) == 0;
+}
+
+inline int64_t
+invert_sign(int64_t float1)
+{
+    int64_t r = (int64_t)(((uint64_t)float1) ^ (1ULL << 62U));
+    return r;
+}
+
+inline int64_t
+set_sign(int64_t float1, bool set_negative)
+{
+    bool neg = is_negative(float1);
+    if ((neg && set_negative) || (!neg && !set_negative))
+        return float1;
+
+    return invert_sign(float1);
+}
+
+inline int64_t
+set_mantissa(int64_t float1, uint64_t mantissa)
+{
+    if (mantissa > maxMantissa)
+        return MANTISSA_OVERSIZED;
+    if (mantissa < minMantissa)
+        return MANTISSA_UNDERSIZED;
+    return float1 - get_mantissa(float1) + mantissa;
+}
+
+inline int64_t
+set_exponent(int64_t float1, int32_t exponent)
+{
+    if (exponent > maxExponent)
+        return EXPONENT_OVERSIZED;
+    if (exponent < minExponent)
+        return EXPONENT_UNDERSIZED;
+
+    uint64_t exp = (exponent + 97);
+    exp <<= 54U;
+    float1 &= ~(0xFFLL << 54);
+    float1 += (int64_t)exp;
+    return float1;
+}
+
+inline int64_t
+make_float(ripple::IOUAmount& amt)
+{
+    int64_t man_out = amt.mantissa();
+    int64_t float_out = 0;
+    bool neg = man_out < 0;
+    if (neg)
+        man_out *= -1;
+
+    float_out = set_sign(float_out, neg);
+    float_out = set_mantissa(float_out, (uint64_t)man_out);
+    float_out = set_exponent(float_out, amt.exponent());
+    return float_out;
+}
+
+inline int64_t
+make_float(uint64_t mantissa, int32_t exponent, bool neg)
+{
+    if (mantissa == 0)
+        return 0;
+    if (mantissa > maxMantissa)
+        return MANTISSA_OVERSIZED;
+    if (mantissa < minMantissa)
+        return MANTISSA_UNDERSIZED;
+    if (exponent > maxExponent)
+        return EXPONENT_OVERSIZED;
+    if (exponent < minExponent)
+        return EXPONENT_UNDERSIZED;
+    int64_t out = 0;
+    out = set_mantissa(out, mantissa);
+    out = set_exponent(out, exponent);
+    out = set_sign(out, neg);
+    return out;
+}
+inline bool
+is_invalid_float(int64_t float1)
+{
+    if (float1 < 0)
+        return true;
+    if (float1 == 0)
+        return false;
+    uint64_t mantissa = get_mantissa(float1);
+    int32_t exponent = get_exponent(float1);
+    return mantissa < minMantissa || mantissa > maxMantissa ||
+        exponent > maxExponent || exponent < minExponent;
+}
+
+inline int64_t const float_one_internal =
+    make_float(1000000000000000ull, -15, false);
+
+/**
+ * Hide `v` from the optimizer.
+ *
+ * The tables below must hold what libm's log10 and pow return, as that is
+ * what the results of the float API have always been computed with. Given
+ * constant arguments the compiler evaluates those calls itself, and as its
+ * results are correctly rounded they differ from libm's for a few inputs.
+ */
+template <typename T>
+inline T
+opaque(T v)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    __asm__ __volatile__("" : "+m"(v));
+    return v;
+#else
+    T volatile r = v;
+    return r;
+#endif
+}
+
+/**
+ * The smallest m for which (int32_t)log10(m) is at least the index.
+ *
+ * log10 of an integer above 2^53 is taken after rounding it to a double, and
+ * even below that log10 may round up to the next integer, so these sit
+ * slightly below the powers of ten. They are found with the same log10 that
+ * normalization originally called, which keeps mantissa_order() in exact
+ * agreement with it.
+ */
+inline std::array<uint64_t, 20> const&
+mantissa_order_thresholds()
+{
+    static std::array<uint64_t, 20> const thresholds = [] {
+        auto order = [](uint64_t m) {
+            return (int32_t)log10(opaque((double)m));
+        };
+
+        std::array<uint64_t, 20> t{};
+        t[0] = 1;
+        for (int32_t k = 1; k < 20; ++k)
+        {
+            uint64_t lo = t[k - 1];
+            uint64_t hi = std::numeric_limits<uint64_t>::max();
+            while (lo < hi)
+            {
+                uint64_t const mid = lo + (hi - lo) / 2;
+                if (order(mid) >= k)
+                    hi = mid;
+                else
+                    lo = mid + 1;
+            }
+            t[k] = lo;
+        }
+        return t;
+    }();
+    return thresholds;
+}
+
+/**
+ * (int32_t)log10(man) for a non-zero man, without the libm call.
+ *
+ * The bit width of man puts its order at t or t - 1, one comparison against
+ * the thresholds decides which.
+ */
+inline int32_t
+mantissa_order(uint64_t man)
+{
+    int32_t width = 64;
+#if defined(__GNUC__) || defined(__clang__)
+    width -= __builtin_clzll(man);
+#else
+    while (width > 1 && !(man >> (width - 1)))
+        --width;
+#endif
+    int32_t const t = (width * 1233) >> 12;
+    return t - (man < mantissa_order_thresholds()[t]);
+}
+
+/**
+ * This function normalizes the mantissa and exponent passed, if it can.
+ * It returns the XFL and mutates the supplied manitssa and exponent.
+ * If a negative mantissa is provided then the returned XFL has the negative
+ * flag set. If there is an overflow error return XFL_OVERFLOW. On underflow
+ * returns canonical 0
+ */
+template <typename T>
+inline int64_t
+normalize_xfl(T& man, int32_t& exp, bool neg = false)
+{
+    if (man == 0)
+        return 0;
+
+    if (man == std::numeric_limits<int64_t>::min())
+        man++;
+
+    constexpr bool sman = std::is_same<T, int64_t>::value;
+    static_assert(sman || std::is_same<T, uint64_t>());
+
+    if constexpr (sman)
+    {
+        if (man < 0)
+        {
+            man *= -1LL;
+            neg = true;
+        }
+    }
+
+    // mantissa order
+    int32_t mo = mantissa_order((uint64_t)man);
+
+    int32_t adjust = 15 - mo;
+
+    if (adjust > 0)
+    {
+        // defensive check
+        if (adjust > 18)
+            return 0;
+        man *= power_of_ten[adjust];
+        exp -= adjust;
+    }
+    else if (adjust < 0)
+    {
+        // defensive check
+        if (-adjust > 18)
+            return XFL_OVERFLOW;
+        man /= power_of_ten[-adjust];
+        exp -= adjust;
+    }
+
+    if (man == 0)
+    {
+        exp = 0;
+        return 0;
+    }
+
+    // even after adjustment the mantissa can be outside the range by one place
+    // improving the math above would probably alleviate the need for these
+    // branches
+    if (man < minMantissa)
+    {
+        if (man == minMantissa - 1LL)
+            man += 1LL;
+        else
+        {
+            man *= 10LL;
+            exp--;
+        }
+    }
+
+    if (man > maxMantissa)
+    {
+        if (man == maxMantissa + 1LL)
+            man -= 1LL;
+        else
+        {
+            man /= 10LL;
+            exp++;
+        }
+    }
+
+    if (exp < minExponent)
+    {
+        man = 0;
+        exp = 0;
+        return 0;
+    }
+
+    if (man == 0)
+    {
+        exp = 0;
+        return 0;
+    }
+
+    if (exp > maxExponent)
+        return XFL_OVERFLOW;
+
+    int64_t ret = make_float((uint64_t)man, exp, neg);
+    if constexpr (sman)
+    {
+        if (neg)
+            man *= -1LL;
+    }
+
+    return ret;
+}
+
+inline int64_t
+float_multiply_internal_parts(
+    uint64_t man1,
+    int32_t exp1,
+    bool neg1,
+    uint64_t man2,
+    int32_t exp2,
+    bool neg2)
+{
+    uint128_t const mult = uint128_t(man1) * man2 / power_of_ten[15];
+    if (mult > std::numeric_limits<uint64_t>::max())
+        return XFL_OVERFLOW;
+    uint64_t man_out = static_cast<uint64_t>(mult);
+
+    int32_t exp_out = exp1 + exp2 + 15;
+    bool neg_out = (neg1 && !neg2) || (!neg1 && neg2);
+    int64_t ret = normalize_xfl(man_out, exp_out, neg_out);
+
+    if (ret == EXPONENT_UNDERSIZED)
+        return 0;
+    if (ret == EXPONENT_OVERSIZED)
+        return XFL_OVERFLOW;
+    return ret;
+}
+
+inline int64_t
+float_divide_internal(int64_t float1, int64_t float2, bool hasFix)
+{
+    if (is_invalid_float(float1) || is_invalid_float(float2))
+        return INVALID_FLOAT;
+    if (float2 == 0)
+        return DIVISION_BY_ZERO;
+    if (float1 == 0)
+        return 0;
+
+    // special case: division by 1
+    // RH TODO: add more special cases (division by power of 10)
+    if (float2 == float_one_internal)
+        return float1;
+
+    uint64_t man1 = get_mantissa(float1);
+    int32_t exp1 = get_exponent(float1);
+    bool neg1 = is_negative(float1);
+    uint64_t man2 = get_mantissa(float2);
+    int32_t exp2 = get_exponent(float2);
+    bool neg2 = is_negative(float2);
+
+    int64_t tmp1 = normalize_xfl(man1, exp1);
+    int64_t tmp2 = normalize_xfl(man2, exp2);
+
+    if (tmp1 < 0 || tmp2 < 0)
+        return INVALID_FLOAT;
+
+    if (tmp1 == 0)
+        return 0;
+
+    while (man2 > man1)
+    {
+        man2 /= 10;
+        exp2++;
+    }
+
+    if (man2 == 0)
+        return DIVISION_BY_ZERO;
+
+    while (man2 < man1)
+    {
+        if (man2 * 10 > man1)
+            break;
+        man2 *= 10;
+        exp2--;
+    }
+
+    uint64_t man3 = 0;
+    int32_t exp3 = exp1 - exp2;
+
+    // each digit is the number of times the divisor can be subtracted from
+    // what remains of the dividend. Without fixFloatDivide a remainder equal
+    // to the divisor was not subtracted, so that digit comes out one short.
+    while (man2 > 0)
+    {
+        uint64_t i = 0;
+        if (hasFix)
+            i = man1 / man2;
+        else if (man1 > man2)
+            i = (man1 - 1) / man2;
+        man1 -= i * man2;
+
+        man3 *= 10;
+        man3 += i;
+        man2 /= 10;
+        if (man2 == 0)
+            break;
+        exp3--;
+    }
+
+    bool neg3 = !((neg1 && neg2) || (!neg1 && !neg2));
+
+    return normalize_xfl(man3, exp3, neg3);
+}
+
+inline int64_t
+float_sum_internal(int64_t float1, int64_t float2)
+{
+    if (is_invalid_float(float1) || is_invalid_float(float2))
+        return INVALID_FLOAT;
+
+    if (float1 == 0)
+        return float2;
+    if (float2 == 0)
+        return float1;
+
+    int32_t exp1 = get_exponent(float1);
+    int32_t exp2 = get_exponent(float2);
+
+    // with the same sign and exponent and no carry into another digit the
+    // sum is exact, so IOUAmount (whichever of its implementations is in use
+    // and whatever the rounding mode) produces exactly this
+    if (exp1 == exp2 && is_negative(float1) == is_negative(float2))
+    {
+        uint64_t const man = get_mantissa(float1) + get_mantissa(float2);
+        if (man <= maxMantissa)
+            return make_float(man, exp1, is_negative(float1));
+    }
+
+    int64_t man1 =
+        (int64_t)(get_mantissa(float1)) * (is_negative(float1) ? -1LL : 1LL);
+    int64_t man2 =
+        (int64_t)(get_mantissa(float2)) * (is_negative(float2) ? -1LL : 1LL);
+
+    try
+    {
+        ripple::IOUAmount amt1{man1, exp1};
+        ripple::IOUAmount amt2{man2, exp2};
+        amt1 += amt2;
+        int64_t result = make_float(amt1);
+        if (result == EXPONENT_UNDERSIZED)
+        {
+            // this is an underflow e.g. as a result of subtracting an xfl from
+            // itself and thus not an error, just return canonical 0
+            return 0;
+        }
+        return result;
+    }
+    catch (std::overflow_error& e)
+    {
+        return XFL_OVERFLOW;
+    }
+}
+
+/**
+ * pow(10, n), looked up for the exponents XFL arithmetic produces.
+ * The table is filled by libm's pow (see opaque) so the values are the ones
+ * it returns.
+ */
+inline double
+power_of_ten_double(int32_t n)
+{
+    static std::array<double, 257> const table = [] {
+        std::array<double, 257> t{};
+        for (int32_t i = 0; i < 257; ++i)
+            t[i] = pow(10, opaque(i - 128));
+        return t;
+    }();
+
+    if (n < -128 || n > 128)
+        return pow(10, n);
+    return table[n + 128];
+}
+
+inline int64_t
+double_to_xfl(double x)
+{
+    if ((x) == 0)
+        return 0;
+    bool neg = x < 0;
+    double absresult = neg ? -x : x;
+
+    // first compute the base 10 order of the float
+    int32_t exp_out = (int32_t)log10(absresult);
+
+    // next adjust it into the valid mantissa range (this means dividing by its
+    // order and multiplying by 10**15)
+    absresult *= power_of_ten_double(-exp_out + 15);
+
+    // after adjustment the value may still fall below the minMantissa
+    int64_t result = (int64_t)absresult;
+    if (result < minMantissa)
+    {
+        if (result == minMantissa - 1LL)
+            result += 1LL;
+        else
+        {
+            result *= 10LL;
+            exp_out--;
+        }
+    }
+
+    // likewise the value can fall above the maxMantissa
+    if (result > maxMantissa)
+    {
+        if (result == maxMantissa + 1LL)
+            result -= 1LL;
+        else
+        {
+            result /= 10LL;
+            exp_out++;
+        }
+    }
+
+    exp_out -= 15;
+    int64_t ret = make_float(result, exp_out, neg);
+
+    if (ret == EXPONENT_UNDERSIZED)
+        return 0;
+
+    return ret;
+}
+
+inline int64_t
+float_log_internal(int64_t float1)
+{
+    if (is_invalid_float(float1))
+        return INVALID_FLOAT;
+
+    if (float1 == 0)
+        return INVALID_ARGUMENT;
+
+    uint64_t man1 = get_mantissa(float1);
+    int32_t exp1 = get_exponent(float1);
+    if (is_negative(float1))
+        return COMPLEX_NOT_SUPPORTED;
+
+    double inp = (double)(man1);
+    double result = log10(inp) + exp1;
+
+    return double_to_xfl(result);
+}
+
+inline int64_t
+float_root_internal(int64_t float1, uint32_t n)
+{
+    if (is_invalid_float(float1))
+        return INVALID_FLOAT;
+    if (float1 == 0)
+        return 0;
+
+    if (n < 2)
+        return INVALID_ARGUMENT;
+
+    uint64_t man1 = get_mantissa(float1);
+    int32_t exp1 = get_exponent(float1);
+    if (is_negative(float1))
+        return COMPLEX_NOT_SUPPORTED;
+
+    double inp = (double)(man1)*power_of_ten_double(exp1);
+    double result = pow(inp, ((double)1.0f) / ((double)(n)));
+
+    return double_to_xfl(result);
+}
+
+}  // namespace hook_float
+
+#endif
@@ -1,6 +1,11 @@
 #ifndef APPLY_HOOK_INCLUDED
 #define APPLY_HOOK_INCLUDED 1
 #include <ripple/app/hook/Enum.h>
+#include <ripple/app/hook/HookInstancePool.h>
+#include <ripple/app/hook/HookModuleCache.h>
+#include <ripple/app/hook/HookProfiler.h>
+#include <ripple/app/hook/HookSlotView.h>
+#include <ripple/app/hook/HookStateMap.h>
 #include <ripple/app/hook/Macro.h>
 #include <ripple/app/hook/Misc.h>
 #include <ripple/app/misc/Transaction.h>
@@ -23,27 +28,6 @@ struct HookResult;
 bool
 isEmittedTxn(ripple::STTx const& tx);
 
-// This map type acts as both a read and write cache for hook execution
-// and is preserved across the execution of the set of hook chains
-// being executed in the current transaction. It is committed to lgr
-// only upon tesSuccess for the otxn.
-class HookStateMap : public std::map<
-                         ripple::AccountID,  // account that owns the state
-                         std::tuple<
-                             int64_t,  // remaining available ownercount
-                             int64_t,  // total namespace count
-                             std::map<
-                                 ripple::uint256,  // namespace
-                                 std::map<
-                                     ripple::uint256,  // key
-                                     std::pair<
-                                         bool,  // is modified from ledger value
-                                         ripple::Blob>>>>>  // the value
-{
-public:
-    uint32_t modified_entry_count = 0;  // track the number of total modified
-};
-
 using namespace ripple;
 std::vector<std::pair<AccountID, bool>>
 getTransactionalStakeHolders(STTx const& tx, ReadView const& rv);
@@ -518,6 +502,8 @@ struct SlotEntry
     std::shared_ptr<const ripple::STObject> storage;
     const ripple::STBase* entry;  // raw pointer into the storage, that can be
                                   // freely pointed around inside
+    std::shared_ptr<SlotView> view{};  // serialized storage, created on first
+                                       // use and shared by slots into storage
 };
 
 struct HookContext
@@ -550,8 +536,14 @@ struct HookContext
                       // emitted txn then this optional becomes
                       // populated with the SLE
     const HookExecutor* module = 0;
+    HookProfiler::Execution profile{};  // see HookProfiler
 };
 
+// The Hook API host functions are registered once, without a data pointer, in
+// a module shared by every execution. While a hook is running this points at
+// its HookContext so the host functions can find it.
+extern thread_local HookContext* currentHookContext;
+
 bool
 addHookNamespaceEntry(ripple::SLE& sleAccount, ripple::uint256 ns);
 
@@ -592,14 +584,13 @@ gatherHookParameters(
     std::map<std::vector<uint8_t>, std::vector<uint8_t>>& parameters,
     beast::Journal const& j_);
 
-// RH TODO: call destruct for these on rippled shutdown
-#define ADD_HOOK_FUNCTION(F, ctx)                          \
+#define ADD_HOOK_FUNCTION(F, importObj)                    \
     {                                                      \
         WasmEdge_FunctionInstanceContext* hf =             \
             WasmEdge_FunctionInstanceCreate(               \
                 hook_api::WasmFunctionType##F,             \
                 hook_api::WasmFunction##F,                 \
-                (void*)(&ctx),                             \
+                NULL,                                      \
                 0);                                        \
         WasmEdge_ModuleInstanceAddFunction(                \
             importObj, hook_api::WasmFunctionName##F, hf); \
@@ -626,11 +617,11 @@ static WasmEdge_String hookFunctionName =
 #define WasmEdge_kPageSize 65536ULL
 
 /**
- * HookExecutor is effectively a two-part function:
- * The first part sets up the Hook Api inside the wasm import, ready for use
- * (this is done during object construction.)
- * The second part is actually executing webassembly instructions
- * this is done during execteWasm function.
+ * HookExecutor executes a single hook against its HookContext.
+ * The Hook Api is provided by an import module that is built once and shared
+ * (read-only) by every execution, see importModule(). The executor binds its
+ * HookContext to the executing thread for the duration of executeWasm so the
+ * host functions can reach it.
  * The instance is single use.
  */
 class HookExecutor
@@ -640,7 +631,6 @@ private:
 
 public:
     HookContext& hookCtx;
-    WasmEdge_ModuleInstanceContext* importObj;
 
     class WasmEdgeVM
     {
@@ -710,15 +700,17 @@ public:
     }
 
     /**
-     * Execute web assembly byte code against the constructed Hook Context
+     * Execute a compiled hook module against the constructed Hook Context
      * Once execution has occured the exector is spent and cannot be used again
      * and should be destructed Information about the execution is populated
      * into hookCtx
+     * When HookInstancePool is enabled a pooled instance of the module is
+     * used where possible, `wasm` is the code the module was compiled from.
      */
     void
     executeWasm(
-        const void* wasm,
-        size_t len,
+        HookModuleCache::ModulePtr const& module,
+        ripple::Slice const& wasm,
         bool callback,
         uint32_t wasmParam,
         beast::Journal const& j)
@@ -728,44 +720,73 @@ public:
 
         spent = true;
 
-        JLOG(j.trace()) << "HookInfo[" << HC_ACC()
-                        << "]: creating wasm instance";
-
         WasmEdge_LogOff();
 
-        WasmEdgeVM vm;
+        auto& pool = HookInstancePool::instance();
+        auto instance = pool.acquire(hookCtx.result.hookHash, module, wasm);
 
-        if (!vm.sane())
+        std::optional<HookModuleInstance> fresh;
+        if (!instance)
         {
-            JLOG(j.warn()) << "HookError[" << HC_ACC()
-                           << "]: Could not create WASMEDGE instance.";
+            JLOG(j.trace()) << "HookInfo[" << HC_ACC()
+                            << "]: creating wasm instance";
 
-            hookCtx.result.exitType = hook_api::ExitType::WASM_ERROR;
-            return;
-        }
+            fresh.emplace();
 
-        WasmEdge_Result res =
-            WasmEdge_VMRegisterModuleFromImport(vm.ctx, this->importObj);
+            if (!fresh->sane())
+            {
+                JLOG(j.warn()) << "HookError[" << HC_ACC()
+                               << "]: Could not create WASMEDGE instance.";
 
-        if (auto err = getWasmError("Import phase failed", res); err)
-        {
-            hookCtx.result.exitType = hook_api::ExitType::WASM_ERROR;
-            JLOG(j.trace()) << "HookError[" << HC_ACC() << "]: " << *err;
-            return;
+                hookCtx.result.exitType = hook_api::ExitType::WASM_ERROR;
+                return;
+            }
         }
 
+        // bind this execution's context to the thread for the host functions
+        HookContext* const previousHookContext = currentHookContext;
+        currentHookContext = &hookCtx;
+
         WasmEdge_Value params[1] = {WasmEdge_ValueGenI32((int64_t)wasmParam)};
         WasmEdge_Value returns[1];
+        WasmEdge_String const function =
+            callback ? cbakFunctionName : hookFunctionName;
 
-        res = WasmEdge_VMRunWasmFromBuffer(
-            vm.ctx,
-            reinterpret_cast<const uint8_t*>(wasm),
-            len,
-            callback ? cbakFunctionName : hookFunctionName,
-            params,
-            1,
-            returns,
-            1);
+        bool const profile = HookProfiler::active();
+        auto const start = profile ? HookProfiler::clock_type::now()
+                                   : HookProfiler::clock_type::time_point{};
+
+        WasmEdge_Result res;
+        uint64_t instructionCount = 0;
+
+        if (instance)
+        {
+            res = instance->execute(
+                function, params, 1, returns, 1, instructionCount);
+        }
+        else
+        {
+            // the module was validated when it was compiled, instantiating
+            // it through a VM would validate it again and write to the
+            // shared AST
+            res = fresh->instantiate(module->ast(), importModule());
+            if (WasmEdge_ResultOK(res))
+                res = fresh->execute(function, params, 1, returns, 1);
+            instructionCount = fresh->instructionCount();
+        }
+
+        currentHookContext = previousHookContext;
+
+        if (profile)
+            HookProfiler::instance().recordHook(
+                hookCtx.result.hookHash,
+                HookProfiler::clock_type::now() - start,
+                instructionCount,
+                hookCtx.profile.hostCalls);
+
+        // instances which trapped are never reused
+        if (instance && WasmEdge_ResultOK(res))
+            pool.release(hookCtx.result.hookHash, std::move(instance));
 
         if (auto err = getWasmError("WASM VM error", res); err)
         {
@@ -774,124 +795,32 @@ public:
             return;
         }
 
-        auto* statsCtx = WasmEdge_VMGetStatisticsContext(vm.ctx);
-        hookCtx.result.instructionCount =
-            WasmEdge_StatisticsGetInstrCount(statsCtx);
+        hookCtx.result.instructionCount = instructionCount;
 
-        // RH NOTE: stack unwind will clean up WasmEdgeVM
+        // RH NOTE: stack unwind will clean up the module instance
     }
 
-    HookExecutor(HookContext& ctx)
-        : hookCtx(ctx), importObj(WasmEdge_ModuleInstanceCreate(exportName))
+    /**
+     * Build a module instance exporting the whole Hook Api under "env".
+     * The host functions carry no data pointer, see currentHookContext.
+     * The caller owns the returned module.
+     */
+    static WasmEdge_ModuleInstanceContext*
+    createImportModule();
+
+    /**
+     * The import module shared by every hook execution. It is created on
+     * first use and lives for the remainder of the process.
+     */
+    static WasmEdge_ModuleInstanceContext const*
+    importModule();
+
+    HookExecutor(HookContext& ctx) : hookCtx(ctx)
     {
         ctx.module = this;
 
         WasmEdge_LogSetDebugLevel();
-
-        ADD_HOOK_FUNCTION(_g, ctx);
-        ADD_HOOK_FUNCTION(accept, ctx);
-        ADD_HOOK_FUNCTION(rollback, ctx);
-        ADD_HOOK_FUNCTION(util_raddr, ctx);
-        ADD_HOOK_FUNCTION(util_accid, ctx);
-        ADD_HOOK_FUNCTION(util_verify, ctx);
-        ADD_HOOK_FUNCTION(util_sha512h, ctx);
-        ADD_HOOK_FUNCTION(sto_validate, ctx);
-        ADD_HOOK_FUNCTION(sto_subfield, ctx);
-        ADD_HOOK_FUNCTION(sto_subarray, ctx);
-        ADD_HOOK_FUNCTION(sto_emplace, ctx);
-        ADD_HOOK_FUNCTION(sto_erase, ctx);
-        ADD_HOOK_FUNCTION(util_keylet, ctx);
-
-        ADD_HOOK_FUNCTION(emit, ctx);
-        ADD_HOOK_FUNCTION(etxn_burden, ctx);
-        ADD_HOOK_FUNCTION(etxn_fee_base, ctx);
-        ADD_HOOK_FUNCTION(etxn_details, ctx);
-        ADD_HOOK_FUNCTION(etxn_reserve, ctx);
-        ADD_HOOK_FUNCTION(etxn_generation, ctx);
-        ADD_HOOK_FUNCTION(etxn_nonce, ctx);
-
-        ADD_HOOK_FUNCTION(float_set, ctx);
-        ADD_HOOK_FUNCTION(float_multiply, ctx);
-        ADD_HOOK_FUNCTION(float_mulratio, ctx);
-        ADD_HOOK_FUNCTION(float_negate, ctx);
-        ADD_HOOK_FUNCTION(float_compare, ctx);
-        ADD_HOOK_FUNCTION(float_sum, ctx);
-        ADD_HOOK_FUNCTION(float_sto, ctx);
-        ADD_HOOK_FUNCTION(float_sto_set, ctx);
-        ADD_HOOK_FUNCTION(float_invert, ctx);
-
-        ADD_HOOK_FUNCTION(float_divide, ctx);
-        ADD_HOOK_FUNCTION(float_one, ctx);
-        ADD_HOOK_FUNCTION(float_mantissa, ctx);
-        ADD_HOOK_FUNCTION(float_sign, ctx);
-        ADD_HOOK_FUNCTION(float_int, ctx);
-        ADD_HOOK_FUNCTION(float_log, ctx);
-        ADD_HOOK_FUNCTION(float_root, ctx);
-
-        ADD_HOOK_FUNCTION(otxn_burden, ctx);
-        ADD_HOOK_FUNCTION(otxn_generation, ctx);
-        ADD_HOOK_FUNCTION(otxn_field, ctx);
-        ADD_HOOK_FUNCTION(otxn_id, ctx);
-        ADD_HOOK_FUNCTION(otxn_type, ctx);
-        ADD_HOOK_FUNCTION(otxn_slot, ctx);
-        ADD_HOOK_FUNCTION(otxn_param, ctx);
-
-        ADD_HOOK_FUNCTION(hook_account, ctx);
-        ADD_HOOK_FUNCTION(hook_hash, ctx);
-        ADD_HOOK_FUNCTION(hook_again, ctx);
-        ADD_HOOK_FUNCTION(fee_base, ctx);
-        ADD_HOOK_FUNCTION(ledger_seq, ctx);
-        ADD_HOOK_FUNCTION(ledger_last_hash, ctx);
-        ADD_HOOK_FUNCTION(ledger_last_time, ctx);
-        ADD_HOOK_FUNCTION(ledger_nonce, ctx);
-        ADD_HOOK_FUNCTION(ledger_keylet, ctx);
-
-        ADD_HOOK_FUNCTION(hook_param, ctx);
-        ADD_HOOK_FUNCTION(hook_param_set, ctx);
-        ADD_HOOK_FUNCTION(hook_skip, ctx);
-        ADD_HOOK_FUNCTION(hook_pos, ctx);
-
-        ADD_HOOK_FUNCTION(state, ctx);
-        ADD_HOOK_FUNCTION(state_foreign, ctx);
-        ADD_HOOK_FUNCTION(state_set, ctx);
-        ADD_HOOK_FUNCTION(state_foreign_set, ctx);
-
-        ADD_HOOK_FUNCTION(slot, ctx);
-        ADD_HOOK_FUNCTION(slot_clear, ctx);
-        ADD_HOOK_FUNCTION(slot_count, ctx);
-        ADD_HOOK_FUNCTION(slot_set, ctx);
-        ADD_HOOK_FUNCTION(slot_size, ctx);
-        ADD_HOOK_FUNCTION(slot_subarray, ctx);
-        ADD_HOOK_FUNCTION(slot_subfield, ctx);
-        ADD_HOOK_FUNCTION(slot_type, ctx);
-        ADD_HOOK_FUNCTION(slot_float, ctx);
-
-        ADD_HOOK_FUNCTION(trace, ctx);
-        ADD_HOOK_FUNCTION(trace_num, ctx);
-        ADD_HOOK_FUNCTION(trace_float, ctx);
-
-        ADD_HOOK_FUNCTION(meta_slot, ctx);
-        ADD_HOOK_FUNCTION(xpop_slot, ctx);
-
-        /*
-        ADD_HOOK_FUNCTION(str_find, ctx);
-        ADD_HOOK_FUNCTION(str_replace, ctx);
-        ADD_HOOK_FUNCTION(str_compare, ctx);
-        ADD_HOOK_FUNCTION(str_concat, ctx);
-        */
-
-        WasmEdge_TableInstanceContext* hostTable =
-            WasmEdge_TableInstanceCreate(tableType);
-        WasmEdge_ModuleInstanceAddTable(importObj, tableName, hostTable);
-        WasmEdge_MemoryInstanceContext* hostMem =
-            WasmEdge_MemoryInstanceCreate(memType);
-        WasmEdge_ModuleInstanceAddMemory(importObj, memName, hostMem);
     }
-
-    ~HookExecutor()
-    {
-        WasmEdge_ModuleInstanceDelete(importObj);
-    };
 };
 
 }  // namespace hook
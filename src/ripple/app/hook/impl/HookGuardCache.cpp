@@ -0,0 +1,126 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/HookGuardCache.h>
+
+namespace hook {
+
+HookGuardCache::HookGuardCache(std::size_t capacity) : capacity_(capacity)
+{
+}
+
+HookGuardCache&
+HookGuardCache::instance()
+{
+    static HookGuardCache cache;
+    return cache;
+}
+
+std::optional<HookGuardCache::Result>
+HookGuardCache::fetch(
+    ripple::uint256 const& hookHash,
+    std::uint64_t rulesVersion)
+{
+    std::lock_guard lock(mutex_);
+
+    auto const it = index_.find(hookHash);
+    if (it == index_.end() || it->second->rulesVersion != rulesVersion)
+    {
+        ++misses_;
+        return std::nullopt;
+    }
+
+    ++hits_;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->result;
+}
+
+void
+HookGuardCache::insert(
+    ripple::uint256 const& hookHash,
+    std::uint64_t rulesVersion,
+    Result const& result)
+{
+    std::lock_guard lock(mutex_);
+
+    // a result for another rules version is replaced
+    if (auto const it = index_.find(hookHash); it != index_.end())
+    {
+        it->second->rulesVersion = rulesVersion;
+        it->second->result = result;
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return;
+    }
+
+    if (capacity_ == 0)
+        return;
+
+    lru_.push_front({hookHash, rulesVersion, result});
+    index_.emplace(hookHash, lru_.begin());
+
+    evict();
+}
+
+void
+HookGuardCache::evict()
+{
+    while (lru_.size() > capacity_)
+    {
+        index_.erase(lru_.back().hookHash);
+        lru_.pop_back();
+    }
+}
+
+void
+HookGuardCache::setCapacity(std::size_t capacity)
+{
+    std::lock_guard lock(mutex_);
+    capacity_ = capacity;
+    evict();
+}
+
+void
+HookGuardCache::clear()
+{
+    std::lock_guard lock(mutex_);
+    index_.clear();
+    lru_.clear();
+}
+
+std::size_t
+HookGuardCache::size() const
+{
+    std::lock_guard lock(mutex_);
+    return lru_.size();
+}
+
+Json::Value
+HookGuardCache::getJson() const
+{
+    std::lock_guard lock(mutex_);
+
+    Json::Value ret(Json::objectValue);
+    ret["entries"] = static_cast<Json::UInt>(lru_.size());
+    ret["capacity"] = static_cast<Json::UInt>(capacity_);
+    ret["hits"] = std::to_string(hits_);
+    ret["misses"] = std::to_string(misses_);
+    return ret;
+}
+
+}  // namespace hook
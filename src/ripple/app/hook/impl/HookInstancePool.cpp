@@ -0,0 +1,598 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/HookInstancePool.h>
+#include <ripple/app/hook/applyHook.h>
+#include <algorithm>
+#include <cstring>
+#include <list>
+#include <map>
+#include <set>
+
+namespace hook {
+
+namespace {
+
+constexpr std::uint8_t wasmHeader[] = {
+    0x00U, 0x61U, 0x73U, 0x6DU, 0x01U, 0x00U, 0x00U, 0x00U};
+
+constexpr std::uint8_t exportSection = 7;
+constexpr std::uint8_t exportGlobal = 3;
+constexpr std::uint8_t exportMemory = 2;
+
+constexpr std::size_t pageSize = 65536;
+
+// Bounds checked reader over a wasm binary. Any out of range read marks the
+// reader as failed rather than throwing.
+class Reader
+{
+    std::uint8_t const* data_;
+    std::size_t size_;
+    std::size_t pos_ = 0;
+    bool ok_ = true;
+
+public:
+    explicit Reader(ripple::Slice const& s) : data_(s.data()), size_(s.size())
+    {
+    }
+
+    bool
+    ok() const
+    {
+        return ok_;
+    }
+
+    bool
+    done() const
+    {
+        return !ok_ || pos_ == size_;
+    }
+
+    std::size_t
+    pos() const
+    {
+        return pos_;
+    }
+
+    std::uint8_t
+    byte()
+    {
+        if (pos_ >= size_)
+        {
+            ok_ = false;
+            return 0;
+        }
+        return data_[pos_++];
+    }
+
+    // unsigned LEB128, signed values are consumed the same way
+    std::uint64_t
+    leb()
+    {
+        std::uint64_t ret = 0;
+        for (int shift = 0; shift < 64; shift += 7)
+        {
+            auto const b = byte();
+            ret |= static_cast<std::uint64_t>(b & 0x7FU) << shift;
+            if (!(b & 0x80U))
+                return ret;
+        }
+        ok_ = false;
+        return 0;
+    }
+
+    ripple::Slice
+    slice(std::uint64_t n)
+    {
+        if (!ok_ || n > size_ - pos_)
+        {
+            ok_ = false;
+            return {};
+        }
+        ripple::Slice const ret(data_ + pos_, n);
+        pos_ += n;
+        return ret;
+    }
+
+    std::string
+    name()
+    {
+        auto const s = slice(leb());
+        return std::string(reinterpret_cast<char const*>(s.data()), s.size());
+    }
+};
+
+void
+appendLeb(ripple::Blob& out, std::uint64_t value)
+{
+    do
+    {
+        std::uint8_t b = value & 0x7FU;
+        value >>= 7;
+        if (value)
+            b |= 0x80U;
+        out.push_back(b);
+    } while (value);
+}
+
+void
+appendSlice(ripple::Blob& out, ripple::Slice const& s)
+{
+    out.insert(out.end(), s.data(), s.data() + s.size());
+}
+
+// Skip a global's constant initializer expression
+bool
+skipConstExpr(Reader& r)
+{
+    while (r.ok())
+    {
+        switch (r.byte())
+        {
+            case 0x0BU:  // end
+                return true;
+            case 0x41U:  // i32.const
+            case 0x42U:  // i64.const
+            case 0x23U:  // global.get
+            case 0xD2U:  // ref.func
+                r.leb();
+                break;
+            case 0x43U:  // f32.const
+                r.slice(4);
+                break;
+            case 0x44U:  // f64.const
+                r.slice(8);
+                break;
+            case 0xD0U:  // ref.null
+                r.byte();
+                break;
+            default:
+                return false;
+        }
+    }
+    return false;
+}
+
+}  // namespace
+
+//------------------------------------------------------------------------------
+
+std::optional<ResettableModule::Layout>
+ResettableModule::rewrite(ripple::Slice const& wasm)
+{
+    if (wasm.size() < sizeof(wasmHeader) ||
+        !std::equal(std::begin(wasmHeader), std::end(wasmHeader), wasm.data()))
+        return std::nullopt;
+
+    struct Section
+    {
+        std::uint8_t id;
+        ripple::Slice payload;
+    };
+
+    std::vector<Section> sections;
+    Reader r(wasm);
+    r.slice(sizeof(wasmHeader));
+    while (!r.done())
+    {
+        auto const id = r.byte();
+        auto const payload = r.slice(r.leb());
+        sections.push_back({id, payload});
+    }
+    if (!r.ok())
+        return std::nullopt;
+
+    std::vector<std::uint64_t> mutableGlobals;
+    bool hasMemory = false;
+
+    std::set<std::string> exportNames;
+    std::map<std::uint64_t, std::string> exportedGlobals;
+    std::optional<std::string> exportedMemory;
+    ripple::Slice exportEntries;
+    std::uint64_t exportCount = 0;
+
+    for (auto const& section : sections)
+    {
+        Reader p(section.payload);
+        switch (section.id)
+        {
+            case 1:   // type
+            case 3:   // function
+            case 10:  // code
+            case 11:  // data
+                // these hold no instance state beyond the memory
+                continue;
+
+            case 2: {  // import, only functions can be restored as is
+                auto const count = p.leb();
+                for (std::uint64_t i = 0; i < count && p.ok(); ++i)
+                {
+                    p.name();
+                    p.name();
+                    if (p.byte() != 0)
+                        return std::nullopt;
+                    p.leb();
+                }
+                break;
+            }
+
+            case 5: {  // memory
+                auto const count = p.leb();
+                if (count > 1)
+                    return std::nullopt;
+                hasMemory = count == 1;
+                if (hasMemory)
+                {
+                    // limits: flags, minimum and, if flagged, maximum
+                    auto const flags = p.byte();
+                    p.leb();
+                    if (flags & 0x01U)
+                        p.leb();
+                }
+                break;
+            }
+
+            case 6: {  // global
+                auto const count = p.leb();
+                for (std::uint64_t i = 0; i < count && p.ok(); ++i)
+                {
+                    p.byte();  // value type
+                    if (p.byte())
+                        mutableGlobals.push_back(i);
+                    if (!skipConstExpr(p))
+                        return std::nullopt;
+                }
+                break;
+            }
+
+            case exportSection: {
+                exportCount = p.leb();
+                auto const start = p.pos();
+                for (std::uint64_t i = 0; i < exportCount && p.ok(); ++i)
+                {
+                    auto name = p.name();
+                    auto const kind = p.byte();
+                    auto const index = p.leb();
+                    if (kind == exportGlobal)
+                        exportedGlobals.emplace(index, name);
+                    else if (kind == exportMemory && index == 0)
+                        exportedMemory = name;
+                    exportNames.insert(std::move(name));
+                }
+                exportEntries = ripple::Slice(
+                    section.payload.data() + start,
+                    section.payload.size() - start);
+                break;
+            }
+
+            default:
+                // custom, table, start, element, data count or unknown
+                return std::nullopt;
+        }
+
+        if (!p.ok() || !p.done())
+            return std::nullopt;
+    }
+
+    Layout layout;
+    ripple::Blob added;
+    std::uint64_t addedCount = 0;
+
+    auto addExport = [&](std::string const& name,
+                         std::uint8_t kind,
+                         std::uint64_t index) {
+        if (exportNames.count(name))
+            return false;
+        appendLeb(added, name.size());
+        added.insert(added.end(), name.begin(), name.end());
+        added.push_back(kind);
+        appendLeb(added, index);
+        ++addedCount;
+        return true;
+    };
+
+    for (auto const index : mutableGlobals)
+    {
+        if (auto const it = exportedGlobals.find(index);
+            it != exportedGlobals.end())
+        {
+            layout.globals.push_back(it->second);
+            continue;
+        }
+
+        auto name = globalPrefix + std::to_string(index);
+        if (!addExport(name, exportGlobal, index))
+            return std::nullopt;
+        layout.globals.push_back(std::move(name));
+    }
+
+    if (hasMemory)
+    {
+        if (exportedMemory)
+            layout.memory = exportedMemory;
+        else if (addExport(memoryName, exportMemory, 0))
+            layout.memory = memoryName;
+        else
+            return std::nullopt;
+    }
+
+    // Copy the module, replacing (or inserting) the export section
+    layout.wasm.assign(std::begin(wasmHeader), std::end(wasmHeader));
+
+    bool exportsWritten = false;
+    auto writeExports = [&]() {
+        ripple::Blob payload;
+        appendLeb(payload, exportCount + addedCount);
+        appendSlice(payload, exportEntries);
+        payload.insert(payload.end(), added.begin(), added.end());
+
+        layout.wasm.push_back(exportSection);
+        appendLeb(layout.wasm, payload.size());
+        layout.wasm.insert(layout.wasm.end(), payload.begin(), payload.end());
+        exportsWritten = true;
+    };
+
+    for (auto const& section : sections)
+    {
+        if (section.id == exportSection)
+        {
+            writeExports();
+            continue;
+        }
+
+        if (!exportsWritten && section.id > exportSection)
+            writeExports();
+
+        layout.wasm.push_back(section.id);
+        appendLeb(layout.wasm, section.payload.size());
+        appendSlice(layout.wasm, section.payload);
+    }
+
+    if (!exportsWritten)
+        writeExports();
+
+    return layout;
+}
+
+std::shared_ptr<ResettableModule const>
+ResettableModule::make(ripple::Slice const& wasm)
+{
+    auto layout = rewrite(wasm);
+    if (!layout)
+        return {};
+
+    std::string error;
+    auto module = HookModuleCache::compile(
+        ripple::Slice(layout->wasm.data(), layout->wasm.size()), error);
+    if (!module)
+        return {};
+
+    // the rewritten code is only needed to compile the module
+    layout->wasm = ripple::Blob{};
+
+    return std::make_shared<ResettableModule const>(
+        std::move(module), std::move(*layout));
+}
+
+//------------------------------------------------------------------------------
+
+HookInstance::HookInstance(std::shared_ptr<ResettableModule const> module)
+    : module_(std::move(module))
+{
+}
+
+std::unique_ptr<HookInstance>
+HookInstance::create(std::shared_ptr<ResettableModule const> const& module)
+{
+    std::unique_ptr<HookInstance> ret(new HookInstance(module));
+    if (!ret->instantiate())
+        return {};
+    return ret;
+}
+
+bool
+HookInstance::instantiate()
+{
+    // the module was validated when it was compiled, see HookModuleInstance
+    if (!WasmEdge_ResultOK(instance_.instantiate(
+            module_->ast(), HookExecutor::importModule())))
+        return false;
+
+    instantiationCount_ = instance_.instructionCount();
+
+    auto const* active = instance_.module();
+    if (!active)
+        return false;
+
+    auto const& layout = module_->layout();
+
+    for (auto const& name : layout.globals)
+    {
+        auto* global = WasmEdge_ModuleInstanceFindGlobal(
+            active, WasmEdge_StringWrap(name.data(), name.size()));
+        if (!global)
+            return false;
+
+        globals_.push_back(global);
+        initialGlobals_.push_back(WasmEdge_GlobalInstanceGetValue(global));
+    }
+
+    if (layout.memory)
+    {
+        memory_ = WasmEdge_ModuleInstanceFindMemory(
+            active,
+            WasmEdge_StringWrap(
+                layout.memory->data(), layout.memory->size()));
+        if (!memory_)
+            return false;
+
+        initialMemory_.resize(
+            WasmEdge_MemoryInstanceGetPageSize(memory_) * pageSize);
+        if (!WasmEdge_ResultOK(WasmEdge_MemoryInstanceGetData(
+                memory_,
+                initialMemory_.data(),
+                0,
+                initialMemory_.size())))
+            return false;
+    }
+
+    return true;
+}
+
+WasmEdge_Result
+HookInstance::execute(
+    WasmEdge_String name,
+    WasmEdge_Value const* params,
+    std::uint32_t paramCount,
+    WasmEdge_Value* returns,
+    std::uint32_t returnCount,
+    std::uint64_t& instructions)
+{
+    // The statistics accumulate over instantiation and every execution, so
+    // the count for this run is taken as a difference.
+    auto const before = instance_.instructionCount();
+
+    auto const res =
+        instance_.execute(name, params, paramCount, returns, returnCount);
+
+    instructions =
+        instantiationCount_ + (instance_.instructionCount() - before);
+
+    return res;
+}
+
+bool
+HookInstance::reset()
+{
+    if (memory_)
+    {
+        // memory can grow but never shrink
+        auto const size = WasmEdge_MemoryInstanceGetPageSize(memory_) * pageSize;
+        if (size != initialMemory_.size())
+            return false;
+
+        auto* data = WasmEdge_MemoryInstanceGetPointer(memory_, 0, size);
+        if (!data)
+            return false;
+        std::memcpy(data, initialMemory_.data(), size);
+    }
+
+    for (std::size_t i = 0; i < globals_.size(); ++i)
+        WasmEdge_GlobalInstanceSetValue(globals_[i], initialGlobals_[i]);
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+
+struct HookInstancePool::ThreadPool
+{
+    struct Entry
+    {
+        ripple::uint256 hookHash;
+        std::unique_ptr<HookInstance> instance;
+    };
+
+    // most recently used at the front, the pool is small enough that a
+    // linear search beats maintaining an index
+    std::list<Entry> entries;
+
+    std::list<Entry>::iterator
+    find(ripple::uint256 const& hookHash)
+    {
+        return std::find_if(
+            entries.begin(), entries.end(), [&](Entry const& e) {
+                return e.hookHash == hookHash;
+            });
+    }
+};
+
+HookInstancePool&
+HookInstancePool::instance()
+{
+    static HookInstancePool pool;
+    return pool;
+}
+
+HookInstancePool::ThreadPool&
+HookInstancePool::local()
+{
+    thread_local ThreadPool pool;
+    return pool;
+}
+
+std::unique_ptr<HookInstance>
+HookInstancePool::acquire(
+    ripple::uint256 const& hookHash,
+    HookModuleCache::ModulePtr const& module,
+    ripple::Slice const& wasm)
+{
+    if (size_ == 0 || !module)
+        return {};
+
+    auto& pool = local();
+    if (auto it = pool.find(hookHash); it != pool.entries.end())
+    {
+        auto instance = std::move(it->instance);
+        pool.entries.erase(it);
+        return instance;
+    }
+
+    auto const resettable = module->resettable(wasm);
+    if (!resettable)
+        return {};
+
+    // the resettable module lives as long as `module`, so it counts towards
+    // the cache's budget
+    HookModuleCache::instance().recharge(hookHash, module);
+
+    return HookInstance::create(resettable);
+}
+
+void
+HookInstancePool::release(
+    ripple::uint256 const& hookHash,
+    std::unique_ptr<HookInstance> instance)
+{
+    auto const size = size_.load();
+    if (size == 0 || !instance || !instance->reset())
+        return;
+
+    auto& pool = local();
+    if (auto it = pool.find(hookHash); it != pool.entries.end())
+        pool.entries.erase(it);
+
+    pool.entries.push_front({hookHash, std::move(instance)});
+    while (pool.entries.size() > size)
+        pool.entries.pop_back();
+}
+
+std::size_t
+HookInstancePool::pooled()
+{
+    return local().entries.size();
+}
+
+void
+HookInstancePool::clear()
+{
+    local().entries.clear();
+}
+
+}  // namespace hook
@@ -0,0 +1,307 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/HookInstancePool.h>
+#include <ripple/app/hook/HookModuleCache.h>
+
+namespace hook {
+
+std::shared_ptr<ResettableModule const>
+HookModule::resettable(ripple::Slice const& wasm) const
+{
+    std::call_once(resettableOnce_, [&]() {
+        resettable_ = ResettableModule::make(wasm);
+        if (resettable_)
+            resettableSize_ = resettable_->size();
+    });
+    return resettable_;
+}
+
+HookModuleInstance::HookModuleInstance()
+{
+    // configured exactly as HookExecutor::WasmEdgeVM
+    conf_ = WasmEdge_ConfigureCreate();
+    if (!conf_)
+        return;
+    WasmEdge_ConfigureStatisticsSetInstructionCounting(conf_, true);
+
+    stats_ = WasmEdge_StatisticsCreate();
+    store_ = WasmEdge_StoreCreate();
+    if (stats_)
+        executor_ = WasmEdge_ExecutorCreate(conf_, stats_);
+}
+
+HookModuleInstance::~HookModuleInstance()
+{
+    if (module_)
+        WasmEdge_ModuleInstanceDelete(module_);
+    if (executor_)
+        WasmEdge_ExecutorDelete(executor_);
+    if (store_)
+        WasmEdge_StoreDelete(store_);
+    if (stats_)
+        WasmEdge_StatisticsDelete(stats_);
+    if (conf_)
+        WasmEdge_ConfigureDelete(conf_);
+}
+
+WasmEdge_Result
+HookModuleInstance::instantiate(
+    WasmEdge_ASTModuleContext const* ast,
+    WasmEdge_ModuleInstanceContext const* imports)
+{
+    if (!sane() || module_)
+        return WasmEdge_Result_Fail;
+
+    auto res = WasmEdge_ExecutorRegisterImport(executor_, store_, imports);
+    if (!WasmEdge_ResultOK(res))
+        return res;
+
+    return WasmEdge_ExecutorInstantiate(executor_, &module_, store_, ast);
+}
+
+WasmEdge_Result
+HookModuleInstance::execute(
+    WasmEdge_String name,
+    WasmEdge_Value const* params,
+    std::uint32_t paramCount,
+    WasmEdge_Value* returns,
+    std::uint32_t returnCount)
+{
+    if (!module_)
+        return WasmEdge_Result_Fail;
+
+    auto const* function = WasmEdge_ModuleInstanceFindFunction(module_, name);
+    if (!function)
+        return WasmEdge_Result_Fail;
+
+    return WasmEdge_ExecutorInvoke(
+        executor_, function, params, paramCount, returns, returnCount);
+}
+
+std::uint64_t
+HookModuleInstance::instructionCount() const
+{
+    return stats_ ? WasmEdge_StatisticsGetInstrCount(stats_) : 0;
+}
+
+//------------------------------------------------------------------------------
+
+HookModuleCache::HookModuleCache(std::size_t budget) : budget_(budget)
+{
+}
+
+HookModuleCache&
+HookModuleCache::instance()
+{
+    static HookModuleCache cache;
+    return cache;
+}
+
+HookModuleCache::ModulePtr
+HookModuleCache::compile(ripple::Slice const& wasm, std::string& error)
+{
+    WasmEdge_ConfigureContext* conf = WasmEdge_ConfigureCreate();
+    if (!conf)
+    {
+        error = "Could not create WASMEDGE configuration";
+        return {};
+    }
+
+    WasmEdge_LoaderContext* loader = WasmEdge_LoaderCreate(conf);
+    WasmEdge_ValidatorContext* validator = WasmEdge_ValidatorCreate(conf);
+    WasmEdge_ASTModuleContext* ast = NULL;
+
+    auto const cleanup = [&]() {
+        if (validator)
+            WasmEdge_ValidatorDelete(validator);
+        if (loader)
+            WasmEdge_LoaderDelete(loader);
+        WasmEdge_ConfigureDelete(conf);
+    };
+
+    if (!loader || !validator)
+    {
+        cleanup();
+        error = "Could not create WASMEDGE loader";
+        return {};
+    }
+
+    WasmEdge_Result res =
+        WasmEdge_LoaderParseFromBuffer(loader, &ast, wasm.data(), wasm.size());
+
+    if (WasmEdge_ResultOK(res))
+        res = WasmEdge_ValidatorValidate(validator, ast);
+
+    cleanup();
+
+    if (!WasmEdge_ResultOK(res))
+    {
+        if (ast)
+            WasmEdge_ASTModuleDelete(ast);
+
+        const char* msg = WasmEdge_ResultGetMessage(res);
+        error = std::string("Module compilation failed: ") +
+            (msg ? msg : "unknown error");
+        return {};
+    }
+
+    return std::make_shared<HookModule const>(
+        ast, wasm.size() * astOverheadFactor);
+}
+
+HookModuleCache::ModulePtr
+HookModuleCache::fetch(ripple::uint256 const& hookHash)
+{
+    std::lock_guard lock(mutex_);
+
+    auto const it = index_.find(hookHash);
+    if (it == index_.end())
+    {
+        ++misses_;
+        return {};
+    }
+
+    ++hits_;
+    lru_.splice(lru_.begin(), lru_, it->second);
+    return it->second->module;
+}
+
+HookModuleCache::ModulePtr
+HookModuleCache::fetchOrCompile(
+    ripple::uint256 const& hookHash,
+    ripple::Slice const& wasm,
+    std::string& error)
+{
+    if (auto module = fetch(hookHash))
+        return module;
+
+    // Compile outside of the lock, if two threads race here the first
+    // insertion wins and the other module is simply discarded.
+    auto module = compile(wasm, error);
+    if (!module)
+        return {};
+
+    return insert(hookHash, module);
+}
+
+HookModuleCache::ModulePtr
+HookModuleCache::insert(
+    ripple::uint256 const& hookHash,
+    ModulePtr const& module)
+{
+    std::lock_guard lock(mutex_);
+
+    if (auto const it = index_.find(hookHash); it != index_.end())
+    {
+        lru_.splice(lru_.begin(), lru_, it->second);
+        return it->second->module;
+    }
+
+    auto const size = module->size();
+    if (size > budget_)
+        return module;
+
+    lru_.push_front({hookHash, module, size});
+    index_.emplace(hookHash, lru_.begin());
+    bytes_ += size;
+
+    evict();
+    return module;
+}
+
+void
+HookModuleCache::recharge(
+    ripple::uint256 const& hookHash,
+    ModulePtr const& module)
+{
+    std::lock_guard lock(mutex_);
+
+    auto const it = index_.find(hookHash);
+    if (it == index_.end() || it->second->module != module)
+        return;
+
+    auto& entry = *it->second;
+    auto const size = module->size();
+    if (size == entry.charged)
+        return;
+
+    bytes_ = bytes_ - entry.charged + size;
+    entry.charged = size;
+    evict();
+}
+
+void
+HookModuleCache::evict()
+{
+    while (bytes_ > budget_ && !lru_.empty())
+    {
+        auto const& entry = lru_.back();
+        bytes_ -= entry.charged;
+        index_.erase(entry.hookHash);
+        lru_.pop_back();
+    }
+}
+
+void
+HookModuleCache::setBudget(std::size_t bytes)
+{
+    std::lock_guard lock(mutex_);
+    budget_ = bytes;
+    evict();
+}
+
+void
+HookModuleCache::clear()
+{
+    std::lock_guard lock(mutex_);
+    index_.clear();
+    lru_.clear();
+    bytes_ = 0;
+}
+
+std::size_t
+HookModuleCache::size() const
+{
+    std::lock_guard lock(mutex_);
+    return lru_.size();
+}
+
+std::size_t
+HookModuleCache::bytes() const
+{
+    std::lock_guard lock(mutex_);
+    return bytes_;
+}
+
+Json::Value
+HookModuleCache::getJson() const
+{
+    std::lock_guard lock(mutex_);
+
+    Json::Value ret(Json::objectValue);
+    ret["entries"] = static_cast<Json::UInt>(lru_.size());
+    ret["bytes"] = std::to_string(bytes_);
+    ret["budget"] = std::to_string(budget_);
+    ret["hits"] = std::to_string(hits_);
+    ret["misses"] = std::to_string(misses_);
+    return ret;
+}
+
+}  // namespace hook
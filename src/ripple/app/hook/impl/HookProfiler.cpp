@@ -0,0 +1,447 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/HookProfiler.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/basics/contract.h>
+#include <ripple/beast/insight/Gauge.h>
+#include <ripple/beast/insight/Hook.h>
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+
+namespace hook {
+
+namespace {
+
+struct FunctionNames
+{
+    std::mutex mutex;
+    std::vector<std::string> names;
+};
+
+FunctionNames&
+functionNames()
+{
+    static FunctionNames names;
+    return names;
+}
+
+std::vector<std::string>
+registeredFunctions()
+{
+    auto& registry = functionNames();
+    std::lock_guard lock(registry.mutex);
+    return registry.names;
+}
+
+// Counters of a thread are only written by that thread, a load and a store
+// avoids the locked read-modify-write of fetch_add.
+inline void
+bump(std::atomic<std::uint64_t>& counter, std::uint64_t value)
+{
+    counter.store(
+        counter.load(std::memory_order_relaxed) + value,
+        std::memory_order_relaxed);
+}
+
+std::uint64_t
+toMicroseconds(std::uint64_t nanoseconds)
+{
+    return nanoseconds / 1000;
+}
+
+void
+addStats(HookProfiler::HookStats& to, HookProfiler::HookStats const& from)
+{
+    to.executions += from.executions;
+    to.nanoseconds += from.nanoseconds;
+    to.instructions += from.instructions;
+    to.hostCalls += from.hostCalls;
+}
+
+}  // namespace
+
+struct HookProfiler::ThreadCounters
+{
+    struct Function
+    {
+        std::atomic<std::uint64_t> calls{0};
+        std::atomic<std::uint64_t> nanoseconds{0};
+        std::atomic<std::uint64_t> bytesIn{0};
+        std::atomic<std::uint64_t> bytesOut{0};
+    };
+
+    std::array<Function, maxFunctions> functions;
+
+    std::mutex hooksMutex;
+    ripple::hash_map<ripple::uint256, HookStats> hooks;
+    HookStats otherHooks;
+
+    ThreadCounters()
+    {
+        auto& profiler = HookProfiler::instance();
+        std::lock_guard lock(profiler.mutex_);
+        profiler.threads_.push_back(this);
+    }
+
+    // fold this thread's counters into the retired totals as it exits
+    ~ThreadCounters()
+    {
+        auto& profiler = HookProfiler::instance();
+        std::lock_guard lock(profiler.mutex_);
+        addTo(profiler.retired_);
+        trimHooks(profiler.retired_);
+        profiler.threads_.erase(std::find(
+            profiler.threads_.begin(), profiler.threads_.end(), this));
+    }
+
+    void
+    addTo(Snapshot& snapshot)
+    {
+        auto const n = std::min(snapshot.functions.size(), functions.size());
+        for (std::size_t i = 0; i < n; ++i)
+        {
+            auto& to = snapshot.functions[i];
+            auto const& from = functions[i];
+            to.calls += from.calls.load(std::memory_order_relaxed);
+            to.nanoseconds += from.nanoseconds.load(std::memory_order_relaxed);
+            to.bytesIn += from.bytesIn.load(std::memory_order_relaxed);
+            to.bytesOut += from.bytesOut.load(std::memory_order_relaxed);
+        }
+
+        std::lock_guard lock(hooksMutex);
+        for (auto const& [hash, from] : hooks)
+            addStats(snapshot.hooks[hash], from);
+        addStats(snapshot.otherHooks, otherHooks);
+    }
+
+    void
+    clearHooks()
+    {
+        std::lock_guard lock(hooksMutex);
+        hooks.clear();
+        otherHooks = {};
+    }
+};
+
+struct HookProfiler::Metrics
+{
+    struct Function
+    {
+        beast::insight::Gauge calls;
+        beast::insight::Gauge time;
+        beast::insight::Gauge bytesIn;
+        beast::insight::Gauge bytesOut;
+    };
+
+    beast::insight::Hook hook;
+    beast::insight::Gauge executions;
+    beast::insight::Gauge time;
+    beast::insight::Gauge instructions;
+    beast::insight::Gauge hostCalls;
+    std::vector<Function> functions;
+};
+
+void
+HookProfiler::Call::begin()
+{
+    bytesWritten_ = execution_.bytesWritten;
+    ++execution_.hostCalls;
+    start_ = clock_type::now();
+}
+
+void
+HookProfiler::Call::end()
+{
+    auto const elapsed = clock_type::now() - start_;
+
+    auto& counters = local().functions[function_];
+    bump(counters.calls, 1);
+    bump(
+        counters.nanoseconds,
+        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+    bump(counters.bytesIn, bytesIn_);
+    bump(counters.bytesOut, execution_.bytesWritten - bytesWritten_);
+}
+
+HookProfiler::HookProfiler()
+{
+    retired_.functions.resize(maxFunctions);
+}
+
+HookProfiler::~HookProfiler() = default;
+
+HookProfiler&
+HookProfiler::instance()
+{
+    static HookProfiler profiler;
+    return profiler;
+}
+
+HookProfiler::ThreadCounters&
+HookProfiler::local()
+{
+    thread_local auto counters = std::make_unique<ThreadCounters>();
+    return *counters;
+}
+
+std::size_t
+HookProfiler::registerFunction(char const* name)
+{
+    auto& registry = functionNames();
+    std::lock_guard lock(registry.mutex);
+
+    if (registry.names.size() == maxFunctions)
+        ripple::Throw<std::logic_error>(
+            "HookProfiler: too many host functions, raise maxFunctions");
+
+    registry.names.emplace_back(name);
+    return registry.names.size() - 1;
+}
+
+void
+HookProfiler::recordHook(
+    ripple::uint256 const& hookHash,
+    clock_type::duration elapsed,
+    std::uint64_t instructions,
+    std::uint64_t hostCalls)
+{
+    auto& counters = local();
+
+    HookStats const stats{
+        1,
+        static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed)
+                .count()),
+        instructions,
+        hostCalls};
+
+    std::lock_guard lock(counters.hooksMutex);
+    if (auto it = counters.hooks.find(hookHash); it != counters.hooks.end())
+        addStats(it->second, stats);
+    else if (counters.hooks.size() < maxHooks)
+        counters.hooks.emplace(hookHash, stats);
+    else
+        addStats(counters.otherHooks, stats);
+}
+
+void
+HookProfiler::trimHooks(Snapshot& snapshot)
+{
+    if (snapshot.hooks.size() <= maxHooks)
+        return;
+
+    std::vector<std::pair<ripple::uint256, HookStats>> hooks(
+        snapshot.hooks.begin(), snapshot.hooks.end());
+    std::nth_element(
+        hooks.begin(),
+        hooks.begin() + maxHooks,
+        hooks.end(),
+        [](auto const& a, auto const& b) {
+            return a.second.instructions > b.second.instructions;
+        });
+
+    for (auto it = hooks.begin() + maxHooks; it != hooks.end(); ++it)
+        addStats(snapshot.otherHooks, it->second);
+    hooks.resize(maxHooks);
+
+    snapshot.hooks.clear();
+    snapshot.hooks.insert(hooks.begin(), hooks.end());
+}
+
+// Caller must hold mutex_
+HookProfiler::Snapshot
+HookProfiler::totals() const
+{
+    Snapshot ret;
+    for (auto const& name : registeredFunctions())
+        ret.functions.push_back({name});
+
+    auto const n = std::min(ret.functions.size(), retired_.functions.size());
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        auto& to = ret.functions[i];
+        auto const& from = retired_.functions[i];
+        to.calls = from.calls;
+        to.nanoseconds = from.nanoseconds;
+        to.bytesIn = from.bytesIn;
+        to.bytesOut = from.bytesOut;
+    }
+    ret.hooks = retired_.hooks;
+    ret.otherHooks = retired_.otherHooks;
+
+    for (auto* thread : threads_)
+        thread->addTo(ret);
+
+    trimHooks(ret);
+    return ret;
+}
+
+HookProfiler::Snapshot
+HookProfiler::snapshot() const
+{
+    std::lock_guard lock(mutex_);
+    auto ret = totals();
+
+    auto const n = std::min(ret.functions.size(), baseline_.size());
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        auto& to = ret.functions[i];
+        auto const& from = baseline_[i];
+        to.calls -= from.calls;
+        to.nanoseconds -= from.nanoseconds;
+        to.bytesIn -= from.bytesIn;
+        to.bytesOut -= from.bytesOut;
+    }
+
+    return ret;
+}
+
+// The host function counters are owned by the threads writing them, so rather
+// than zeroing them the current totals are remembered and subtracted from
+// later snapshots. Per hook totals are guarded by a mutex and simply dropped,
+// which also releases the memory of hooks that no longer run.
+void
+HookProfiler::clear()
+{
+    std::lock_guard lock(mutex_);
+    baseline_ = totals().functions;
+
+    retired_.hooks.clear();
+    retired_.otherHooks = {};
+    for (auto* thread : threads_)
+        thread->clearHooks();
+}
+
+void
+HookProfiler::attach(beast::insight::Collector::ptr const& collector)
+{
+    auto metrics = std::make_unique<Metrics>();
+    metrics->executions = collector->make_gauge("hook_profile", "executions");
+    metrics->time = collector->make_gauge("hook_profile", "time_us");
+    metrics->instructions =
+        collector->make_gauge("hook_profile", "instructions");
+    metrics->hostCalls = collector->make_gauge("hook_profile", "host_calls");
+
+    for (auto const& name : registeredFunctions())
+    {
+        auto const prefix = "hook_profile." + name;
+        metrics->functions.push_back(
+            {collector->make_gauge(prefix, "calls"),
+             collector->make_gauge(prefix, "time_us"),
+             collector->make_gauge(prefix, "bytes_in"),
+             collector->make_gauge(prefix, "bytes_out")});
+    }
+
+    metrics->hook = collector->make_hook([this]() { collectMetrics(); });
+
+    // The collector calls the hook while holding its own lock, so metrics are
+    // never created or destroyed while metricsMutex_ is held.
+    {
+        std::lock_guard lock(metricsMutex_);
+        metrics_.swap(metrics);
+    }
+}
+
+void
+HookProfiler::detach()
+{
+    std::unique_ptr<Metrics> metrics;
+    {
+        std::lock_guard lock(metricsMutex_);
+        metrics_.swap(metrics);
+    }
+}
+
+void
+HookProfiler::collectMetrics()
+{
+    std::lock_guard lock(metricsMutex_);
+    if (!metrics_ || !active())
+        return;
+
+    auto const s = snapshot();
+
+    HookStats total = s.otherHooks;
+    for (auto const& [hash, stats] : s.hooks)
+        addStats(total, stats);
+
+    metrics_->executions = total.executions;
+    metrics_->time = toMicroseconds(total.nanoseconds);
+    metrics_->instructions = total.instructions;
+    metrics_->hostCalls = total.hostCalls;
+
+    auto const n = std::min(s.functions.size(), metrics_->functions.size());
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        auto const& from = s.functions[i];
+        auto& to = metrics_->functions[i];
+        to.calls = from.calls;
+        to.time = toMicroseconds(from.nanoseconds);
+        to.bytesIn = from.bytesIn;
+        to.bytesOut = from.bytesOut;
+    }
+}
+
+Json::Value
+HookProfiler::getJson() const
+{
+    auto const s = snapshot();
+
+    Json::Value ret(Json::objectValue);
+    ret["enabled"] = enabled();
+
+    Json::Value& functions = (ret["host_functions"] = Json::objectValue);
+    for (auto const& f : s.functions)
+    {
+        if (f.calls == 0)
+            continue;
+
+        Json::Value& entry = functions[f.name];
+        entry["calls"] = std::to_string(f.calls);
+        entry["time_us"] = std::to_string(toMicroseconds(f.nanoseconds));
+        entry["bytes_in"] = std::to_string(f.bytesIn);
+        entry["bytes_out"] = std::to_string(f.bytesOut);
+    }
+
+    Json::Value& hooks = (ret["hooks"] = Json::objectValue);
+    for (auto const& [hash, stats] : s.hooks)
+    {
+        Json::Value& entry = hooks[to_string(hash)];
+        entry["executions"] = std::to_string(stats.executions);
+        entry["time_us"] = std::to_string(toMicroseconds(stats.nanoseconds));
+        entry["instructions"] = std::to_string(stats.instructions);
+        entry["host_calls"] = std::to_string(stats.hostCalls);
+    }
+
+    if (s.otherHooks.executions != 0)
+    {
+        Json::Value& entry = (ret["other_hooks"] = Json::objectValue);
+        entry["executions"] = std::to_string(s.otherHooks.executions);
+        entry["time_us"] =
+            std::to_string(toMicroseconds(s.otherHooks.nanoseconds));
+        entry["instructions"] = std::to_string(s.otherHooks.instructions);
+        entry["host_calls"] = std::to_string(s.otherHooks.hostCalls);
+    }
+
+    return ret;
+}
+
+}  // namespace hook
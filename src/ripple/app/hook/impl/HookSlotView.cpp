@@ -0,0 +1,110 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/HookSlotView.h>
+#include <ripple/protocol/STArray.h>
+#include <algorithm>
+#include <vector>
+
+namespace hook {
+
+using namespace ripple;
+
+void
+SlotView::build()
+{
+    built_ = true;
+    if (root_)
+        index(*root_);
+}
+
+void
+SlotView::index(STBase const& field)
+{
+    auto const begin = static_cast<std::uint32_t>(bytes_.size());
+
+    if (auto const* obj = dynamic_cast<STObject const*>(&field))
+    {
+        // as STObject::add: the fields present, sorted by field code, with
+        // objects and arrays terminated by an end marker
+        std::vector<STBase const*> fields;
+        fields.reserve(obj->getCount());
+        for (STBase const& f : *obj)
+        {
+            if (f.getSType() != STI_NOTPRESENT &&
+                f.getFName().shouldInclude(true))
+                fields.push_back(&f);
+        }
+        std::sort(
+            fields.begin(), fields.end(), [](auto const* lhs, auto const* rhs) {
+                return lhs->getFName().fieldCode < rhs->getFName().fieldCode;
+            });
+
+        for (STBase const* f : fields)
+        {
+            SerializedTypeID const sType{f->getSType()};
+            f->addFieldID(bytes_);
+            index(*f);
+            if (sType == STI_ARRAY || sType == STI_OBJECT)
+                bytes_.addFieldID(sType, 1);
+        }
+    }
+    else if (auto const* arr = dynamic_cast<STArray const*>(&field))
+    {
+        // as STArray::add
+        for (STObject const& obj : *arr)
+        {
+            obj.addFieldID(bytes_);
+            index(obj);
+            bytes_.addFieldID(STI_OBJECT, 1);
+        }
+    }
+    else
+        field.add(bytes_);
+
+    index_.emplace(
+        &field,
+        std::make_pair(begin, static_cast<std::uint32_t>(bytes_.size())));
+}
+
+std::optional<Slice>
+SlotView::serialized(STBase const* field)
+{
+    if (!built_)
+        build();
+
+    if (!field)
+        return std::nullopt;
+
+    auto it = index_.find(field);
+    if (it == index_.end())
+    {
+        // not part of the root's serialization, such as a field which is
+        // never serialized, so it is serialized on its own
+        index(*field);
+        it = index_.find(field);
+    }
+
+    auto const [begin, end] = it->second;
+    return Slice(
+        static_cast<std::uint8_t const*>(bytes_.getDataPtr()) + begin,
+        end - begin);
+}
+
+}  // namespace hook
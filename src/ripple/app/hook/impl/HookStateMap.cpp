@@ -0,0 +1,269 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/HookStateMap.h>
+#include <ripple/basics/hardened_hash.h>
+#include <boost/multiprecision/cpp_int.hpp>
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <new>
+#include <tuple>
+
+namespace hook {
+
+namespace {
+
+// Folded 64x64->128 bit multiply, the mixing step used by wyhash.
+inline std::uint64_t
+mix(std::uint64_t a, std::uint64_t b)
+{
+    boost::multiprecision::uint128_t const r =
+        boost::multiprecision::uint128_t(a) * b;
+    return static_cast<std::uint64_t>(r) ^ static_cast<std::uint64_t>(r >> 64);
+}
+
+// Keys and namespaces are chosen by hook authors, so the hash is seeded per
+// process to keep collisions from being engineered. The fields are packed
+// into whole words and mixed in a single pass: hashing dominates the cost of
+// a lookup and this is several times cheaper than the streaming xxhasher.
+template <class... Args>
+std::uint32_t
+hashOf(std::uint64_t salt, Args const&... args)
+{
+    static auto const seed = ripple::detail::make_seed_pair<>();
+
+    constexpr std::size_t bytes = (Args::bytes + ...);
+    std::array<std::uint64_t, (bytes + 7) / 8> words{};
+    auto out = reinterpret_cast<std::uint8_t*>(words.data());
+    ((std::memcpy(out, args.data(), Args::bytes), out += Args::bytes), ...);
+
+    std::uint64_t h = seed.first ^ salt;
+    std::size_t i = 0;
+    for (; i + 1 < words.size(); i += 2)
+        h = mix(words[i] ^ seed.second, words[i + 1] ^ h);
+    if (i < words.size())
+        h = mix(words[i] ^ seed.second, 0xa0761d6478bd642fULL ^ h);
+
+    return static_cast<std::uint32_t>(mix(h, bytes ^ 0xe7037ed1a0b428dbULL));
+}
+
+// base_uint's comparison operators are built for ordering, plain equality
+// is considerably cheaper.
+template <class T>
+inline bool
+same(T const& a, T const& b)
+{
+    return std::memcmp(a.data(), b.data(), T::bytes) == 0;
+}
+
+}  // namespace
+
+namespace detail {
+
+void
+FlatIndex::insert(std::uint32_t hash, std::uint32_t index)
+{
+    // keep the load factor at or below one half
+    if ((size_ + 1) * 2 > slots_.size())
+        grow();
+
+    std::size_t const mask = slots_.size() - 1;
+    std::size_t i = hash & mask;
+    while (slots_[i].second != 0)
+        i = (i + 1) & mask;
+
+    slots_[i] = {hash, index + 1};
+    ++size_;
+}
+
+void
+FlatIndex::grow()
+{
+    decltype(slots_) old(
+        std::max<std::size_t>(16, slots_.size() * 2),
+        {0, 0},
+        slots_.get_allocator());
+    old.swap(slots_);
+
+    std::size_t const mask = slots_.size() - 1;
+    for (auto const& slot : old)
+    {
+        if (slot.second == 0)
+            continue;
+
+        std::size_t i = slot.first & mask;
+        while (slots_[i].second != 0)
+            i = (i + 1) & mask;
+        slots_[i] = slot;
+    }
+}
+
+}  // namespace detail
+
+HookStateMap::HookStateMap()
+    : arena_(initialBufferSize)
+    , accounts_(&arena_)
+    , namespaces_(&arena_)
+    , entries_(&arena_)
+    , accountIndex_(&arena_)
+    , namespaceIndex_(&arena_)
+    , entryIndex_(&arena_)
+{
+}
+
+HookStateMap::Account*
+HookStateMap::findAccount(ripple::AccountID const& acc)
+{
+    auto const i = accountIndex_.find(hashOf(0, acc), [&](std::uint32_t i) {
+        return same(accounts_[i].id, acc);
+    });
+    return i < 0 ? nullptr : &accounts_[i];
+}
+
+HookStateMap::Account&
+HookStateMap::insertAccount(
+    ripple::AccountID const& acc,
+    std::int64_t availableForReserves,
+    std::int64_t namespaceCount)
+{
+    accountIndex_.insert(hashOf(0, acc), accounts_.size());
+    return accounts_.emplace_back(
+        Account{acc, availableForReserves, namespaceCount});
+}
+
+HookStateMap::Namespace const*
+HookStateMap::findNamespace(
+    ripple::AccountID const& acc,
+    ripple::uint256 const& ns) const
+{
+    if (lastNamespace_ && same(lastNamespace_->ns, ns) &&
+        same(lastNamespace_->account, acc))
+        return lastNamespace_;
+
+    auto const i = namespaceIndex_.find(hashOf(0, acc, ns), [&](auto i) {
+        return same(namespaces_[i]->ns, ns) &&
+            same(namespaces_[i]->account, acc);
+    });
+    if (i < 0)
+        return nullptr;
+
+    return lastNamespace_ = namespaces_[i];
+}
+
+bool
+HookStateMap::hasNamespace(
+    ripple::AccountID const& acc,
+    ripple::uint256 const& ns) const
+{
+    return findNamespace(acc, ns) != nullptr;
+}
+
+HookStateMap::Entry const*
+HookStateMap::find(
+    ripple::AccountID const& acc,
+    ripple::uint256 const& ns,
+    ripple::uint256 const& key) const
+{
+    auto const nsp = findNamespace(acc, ns);
+    if (!nsp)
+        return nullptr;
+
+    auto const i =
+        entryIndex_.find(hashOf(nsp->index, key), [&](std::uint32_t i) {
+            auto const& e = entries_[i];
+            return e.ns_ == nsp && same(e.key_, key);
+        });
+    return i < 0 ? nullptr : &entries_[i];
+}
+
+HookStateMap::Entry*
+HookStateMap::find(
+    ripple::AccountID const& acc,
+    ripple::uint256 const& ns,
+    ripple::uint256 const& key)
+{
+    return const_cast<Entry*>(
+        static_cast<HookStateMap const*>(this)->find(acc, ns, key));
+}
+
+HookStateMap::Entry&
+HookStateMap::insert(
+    ripple::AccountID const& acc,
+    ripple::uint256 const& ns,
+    ripple::uint256 const& key,
+    ripple::Slice const& value,
+    bool modified)
+{
+    auto nsp = findNamespace(acc, ns);
+    if (!nsp)
+    {
+        auto const index = static_cast<std::uint32_t>(namespaces_.size());
+        auto p = new (arena_.allocate(sizeof(Namespace), alignof(Namespace)))
+            Namespace{acc, ns, index};
+
+        namespaceIndex_.insert(hashOf(0, acc, ns), index);
+        namespaces_.push_back(p);
+        nsp = lastNamespace_ = p;
+    }
+
+    entryIndex_.insert(hashOf(nsp->index, key), entries_.size());
+    auto& entry = entries_.emplace_back(nsp, key);
+    entry.modified = modified;
+    assign(entry, value);
+    return entry;
+}
+
+void
+HookStateMap::assign(Entry& entry, ripple::Slice const& value)
+{
+    if (value.size() > entry.capacity_)
+    {
+        // Grow geometrically so a value rewritten with increasing sizes
+        // wastes at most as much arena space as its final capacity.
+        auto const capacity = std::bit_ceil(value.size());
+        entry.external_ =
+            static_cast<std::uint8_t*>(arena_.allocate(capacity, 1));
+        entry.capacity_ = capacity;
+    }
+
+    if (!value.empty())
+        std::memcpy(
+            entry.external_ ? entry.external_ : entry.inline_.data(),
+            value.data(),
+            value.size());
+    entry.size_ = value.size();
+}
+
+std::vector<HookStateMap::Entry const*>
+HookStateMap::modified() const
+{
+    std::vector<Entry const*> ret;
+    for (auto const& entry : entries_)
+        if (entry.modified)
+            ret.push_back(&entry);
+
+    std::sort(ret.begin(), ret.end(), [](Entry const* a, Entry const* b) {
+        return std::tie(a->account(), a->ns(), a->key_) <
+            std::tie(b->account(), b->ns(), b->key_);
+    });
+    return ret;
+}
+
+}  // namespace hook
@@ -0,0 +1,115 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/HookStatePrefetch.h>
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/protocol/Indexes.h>
+#include <algorithm>
+
+namespace hook {
+
+HookStatePrefetcher&
+HookStatePrefetcher::instance()
+{
+    static HookStatePrefetcher prefetcher;
+    return prefetcher;
+}
+
+void
+HookStatePrefetcher::record(HookStateMap const& stateMap)
+{
+    if (!enabled_ || stateMap.size() == 0)
+        return;
+
+    std::lock_guard lock(mutex_);
+
+    for (auto const& entry : stateMap)
+    {
+        // the directory key uniquely identifies the (account, namespace)
+        auto const dir =
+            ripple::keylet::hookStateDir(entry.account(), entry.ns()).key;
+
+        auto it = index_.find(dir);
+        if (it == index_.end())
+        {
+            lru_.emplace_front(dir, Keys{});
+            it = index_.emplace(dir, lru_.begin()).first;
+        }
+        else
+            lru_.splice(lru_.begin(), lru_, it->second);
+
+        auto& keys = it->second->second;
+        if (auto const k = std::find(keys.begin(), keys.end(), entry.key());
+            k != keys.end())
+            keys.erase(k);
+        else if (keys.size() == keysPerNamespace)
+            keys.pop_back();
+        keys.insert(keys.begin(), entry.key());
+    }
+
+    while (lru_.size() > maxNamespaces)
+    {
+        index_.erase(lru_.back().first);
+        lru_.pop_back();
+    }
+}
+
+std::vector<ripple::uint256>
+HookStatePrefetcher::recent(
+    ripple::AccountID const& acc,
+    ripple::uint256 const& ns) const
+{
+    auto const dir = ripple::keylet::hookStateDir(acc, ns).key;
+
+    std::lock_guard lock(mutex_);
+    if (auto const it = index_.find(dir); it != index_.end())
+        return it->second->second;
+    return {};
+}
+
+void
+HookStatePrefetcher::prefetch(
+    std::shared_ptr<ripple::Ledger const> const& ledger,
+    ripple::AccountID const& acc,
+    ripple::uint256 const& ns)
+{
+    if (!enabled_ || !ledger)
+        return;
+
+    auto const keys = recent(acc, ns);
+    auto const& stateMap = ledger->stateMap();
+
+    // the directory root is read whenever state is created or deleted
+    stateMap.prefetch(ripple::keylet::hookStateDir(acc, ns).key, ledger);
+
+    for (auto const& key : keys)
+        stateMap.prefetch(ripple::keylet::hookState(acc, key, ns).key, ledger);
+
+    requested_ += keys.size() + 1;
+}
+
+void
+HookStatePrefetcher::clear()
+{
+    std::lock_guard lock(mutex_);
+    index_.clear();
+    lru_.clear();
+}
+
+}  // namespace hook
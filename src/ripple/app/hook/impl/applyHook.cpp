@@ -1,3 +1,4 @@
+#include <ripple/app/hook/XFL.h>
 #include <ripple/app/hook/applyHook.h>
 #include <ripple/app/ledger/OpenLedger.h>
 #include <ripple/app/ledger/TransactionMaster.h>
@@ -13,9 +14,7 @@
 #include <ripple/protocol/TxFlags.h>
 #include <ripple/protocol/st.h>
 #include <ripple/protocol/tokens.h>
-#include <boost/multiprecision/cpp_dec_float.hpp>
 #include <any>
-#include <cfenv>
 #include <memory>
 #include <optional>
 #include <string>
@@ -509,257 +508,6 @@ getTransactionalStakeHolders(STTx const& tx, ReadView const& rv)
 
 }  // namespace hook
 
-namespace hook_float {
-
-// power of 10 LUT for fast integer math
-static int64_t power_of_ten[19] = {
-    1LL,
-    10LL,
-    100LL,
-    1000LL,
-    10000LL,
-    100000LL,
-    1000000LL,
-    10000000LL,
-    100000000LL,
-    1000000000LL,
-    10000000000LL,
-    100000000000LL,
-    1000000000000LL,
-    10000000000000LL,
-    100000000000000LL,
-    1000000000000000LL,  // 15
-    10000000000000000LL,
-    100000000000000000LL,
-    1000000000000000000LL,
-};
-
-using namespace hook_api;
-static int64_t const minMantissa = 1000000000000000ull;
-static int64_t const maxMantissa = 9999999999999999ull;
-static int32_t const minExponent = -96;
-static int32_t const maxExponent = 80;
-inline int32_t
-get_exponent(int64_t float1)
-{
-    if (float1 < 0)
-        return INVALID_FLOAT;
-    if (float1 == 0)
-        return 0;
-    uint64_t float_in = (uint64_t)float1;
-    float_in >>= 54U;
-    float_in &= 0xFFU;
-    return ((int32_t)float_in) - 97;
-}
-
-inline int64_t
-get_mantissa(int64_t float1)
-{
-    if (float1 < 0)
-        return INVALID_FLOAT;
-    if (float1 == 0)
-        return 0;
-    float1 -= ((((uint64_t)float1) >> 54U) << 54U);
-    return float1;
-}
-
-inline bool
-is_negative(int64_t float1)
-{
-    return ((float1 >> 62U) & 1ULL) == 0;
-}
-
-inline int64_t
-invert_sign(int64_t float1)
-{
-    int64_t r = (int64_t)(((uint64_t)float1) ^ (1ULL << 62U));
-    return r;
-}
-
-inline int64_t
-set_sign(int64_t float1, bool set_negative)
-{
-    bool neg = is_negative(float1);
-    if ((neg && set_negative) || (!neg && !set_negative))
-        return float1;
-
-    return invert_sign(float1);
-}
-
-inline int64_t
-set_mantissa(int64_t float1, uint64_t mantissa)
-{
-    if (mantissa > maxMantissa)
-        return MANTISSA_OVERSIZED;
-    if (mantissa < minMantissa)
-        return MANTISSA_UNDERSIZED;
-    return float1 - get_mantissa(float1) + mantissa;
-}
-
-inline int64_t
-set_exponent(int64_t float1, int32_t exponent)
-{
-    if (exponent > maxExponent)
-        return EXPONENT_OVERSIZED;
-    if (exponent < minExponent)
-        return EXPONENT_UNDERSIZED;
-
-    uint64_t exp = (exponent + 97);
-    exp <<= 54U;
-    float1 &= ~(0xFFLL << 54);
-    float1 += (int64_t)exp;
-    return float1;
-}
-
-inline int64_t
-make_float(ripple::IOUAmount& amt)
-{
-    int64_t man_out = amt.mantissa();
-    int64_t float_out = 0;
-    bool neg = man_out < 0;
-    if (neg)
-        man_out *= -1;
-
-    float_out = set_sign(float_out, neg);
-    float_out = set_mantissa(float_out, (uint64_t)man_out);
-    float_out = set_exponent(float_out, amt.exponent());
-    return float_out;
-}
-
-inline int64_t
-make_float(uint64_t mantissa, int32_t exponent, bool neg)
-{
-    if (mantissa == 0)
-        return 0;
-    if (mantissa > maxMantissa)
-        return MANTISSA_OVERSIZED;
-    if (mantissa < minMantissa)
-        return MANTISSA_UNDERSIZED;
-    if (exponent > maxExponent)
-        return EXPONENT_OVERSIZED;
-    if (exponent < minExponent)
-        return EXPONENT_UNDERSIZED;
-    int64_t out = 0;
-    out = set_mantissa(out, mantissa);
-    out = set_exponent(out, exponent);
-    out = set_sign(out, neg);
-    return out;
-}
-
-/**
- * This function normalizes the mantissa and exponent passed, if it can.
- * It returns the XFL and mutates the supplied manitssa and exponent.
- * If a negative mantissa is provided then the returned XFL has the negative
- * flag set. If there is an overflow error return XFL_OVERFLOW. On underflow
- * returns canonical 0
- */
-template <typename T>
-inline int64_t
-normalize_xfl(T& man, int32_t& exp, bool neg = false)
-{
-    if (man == 0)
-        return 0;
-
-    if (man == std::numeric_limits<int64_t>::min())
-        man++;
-
-    constexpr bool sman = std::is_same<T, int64_t>::value;
-    static_assert(sman || std::is_same<T, uint64_t>());
-
-    if constexpr (sman)
-    {
-        if (man < 0)
-        {
-            man *= -1LL;
-            neg = true;
-        }
-    }
-
-    // mantissa order
-    std::feclearexcept(FE_ALL_EXCEPT);
-    int32_t mo = log10(man);
-    // defensively ensure log10 produces a sane result; we'll borrow the
-    // overflow error code if it didn't
-    if (std::fetestexcept(FE_INVALID))
-        return XFL_OVERFLOW;
-
-    int32_t adjust = 15 - mo;
-
-    if (adjust > 0)
-    {
-        // defensive check
-        if (adjust > 18)
-            return 0;
-        man *= power_of_ten[adjust];
-        exp -= adjust;
-    }
-    else if (adjust < 0)
-    {
-        // defensive check
-        if (-adjust > 18)
-            return XFL_OVERFLOW;
-        man /= power_of_ten[-adjust];
-        exp -= adjust;
-    }
-
-    if (man == 0)
-    {
-        exp = 0;
-        return 0;
-    }
-
-    // even after adjustment the mantissa can be outside the range by one place
-    // improving the math above would probably alleviate the need for these
-    // branches
-    if (man < minMantissa)
-    {
-        if (man == minMantissa - 1LL)
-            man += 1LL;
-        else
-        {
-            man *= 10LL;
-            exp--;
-        }
-    }
-
-    if (man > maxMantissa)
-    {
-        if (man == maxMantissa + 1LL)
-            man -= 1LL;
-        else
-        {
-            man /= 10LL;
-            exp++;
-        }
-    }
-
-    if (exp < minExponent)
-    {
-        man = 0;
-        exp = 0;
-        return 0;
-    }
-
-    if (man == 0)
-    {
-        exp = 0;
-        return 0;
-    }
-
-    if (exp > maxExponent)
-        return XFL_OVERFLOW;
-
-    int64_t ret = make_float((uint64_t)man, exp, neg);
-    if constexpr (sman)
-    {
-        if (neg)
-            man *= -1LL;
-    }
-
-    return ret;
-}
-
-}  // namespace hook_float
 using namespace hook_float;
 inline int32_t
 no_free_slots(hook::HookContext& hookCtx)
@@ -797,6 +545,14 @@ get_free_slot(hook::HookContext& hookCtx)
     return slot_into;
 }
 
+inline hook::SlotView&
+get_slot_view(hook::SlotEntry& slot)
+{
+    if (!slot.view)
+        slot.view = std::make_shared<hook::SlotView>(slot.storage);
+    return *slot.view;
+}
+
 // cu_ptr is a pointer into memory, bounds check is assumed to have already
 // happened
 inline std::optional<Currency>
@@ -1238,10 +994,25 @@ hook::apply(
 
     auto const& j = applyCtx.app.journal("View");
 
+    std::string error;
+    auto const module = HookModuleCache::instance().fetchOrCompile(
+        hookHash, ripple::Slice(wasm.data(), wasm.size()), error);
+
+    if (!module)
+    {
+        JLOG(j.warn()) << "HookError[" << HC_ACC() << "]: " << error;
+        hookCtx.result.exitType = hook_api::ExitType::WASM_ERROR;
+        return hookCtx.result;
+    }
+
     HookExecutor executor{hookCtx};
 
     executor.executeWasm(
-        wasm.data(), (size_t)wasm.size(), isCallback, wasmParam, j);
+        module,
+        ripple::Slice(wasm.data(), wasm.size()),
+        isCallback,
+        wasmParam,
+        j);
 
     JLOG(j.trace()) << "HookInfo[" << HC_ACC() << "]: "
                     << (hookCtx.result.exitType == hook_api::ExitType::ROLLBACK
@@ -1253,6 +1024,126 @@ hook::apply(
     return hookCtx.result;
 }
 
+thread_local hook::HookContext* hook::currentHookContext = nullptr;
+
+WasmEdge_ModuleInstanceContext*
+hook::HookExecutor::createImportModule()
+{
+    WasmEdge_ModuleInstanceContext* importObj =
+        WasmEdge_ModuleInstanceCreate(exportName);
+
+    ADD_HOOK_FUNCTION(_g, importObj);
+    ADD_HOOK_FUNCTION(accept, importObj);
+    ADD_HOOK_FUNCTION(rollback, importObj);
+    ADD_HOOK_FUNCTION(util_raddr, importObj);
+    ADD_HOOK_FUNCTION(util_accid, importObj);
+    ADD_HOOK_FUNCTION(util_verify, importObj);
+    ADD_HOOK_FUNCTION(util_sha512h, importObj);
+    ADD_HOOK_FUNCTION(sto_validate, importObj);
+    ADD_HOOK_FUNCTION(sto_subfield, importObj);
+    ADD_HOOK_FUNCTION(sto_subarray, importObj);
+    ADD_HOOK_FUNCTION(sto_emplace, importObj);
+    ADD_HOOK_FUNCTION(sto_erase, importObj);
+    ADD_HOOK_FUNCTION(util_keylet, importObj);
+
+    ADD_HOOK_FUNCTION(emit, importObj);
+    ADD_HOOK_FUNCTION(etxn_burden, importObj);
+    ADD_HOOK_FUNCTION(etxn_fee_base, importObj);
+    ADD_HOOK_FUNCTION(etxn_details, importObj);
+    ADD_HOOK_FUNCTION(etxn_reserve, importObj);
+    ADD_HOOK_FUNCTION(etxn_generation, importObj);
+    ADD_HOOK_FUNCTION(etxn_nonce, importObj);
+
+    ADD_HOOK_FUNCTION(float_set, importObj);
+    ADD_HOOK_FUNCTION(float_multiply, importObj);
+    ADD_HOOK_FUNCTION(float_mulratio, importObj);
+    ADD_HOOK_FUNCTION(float_negate, importObj);
+    ADD_HOOK_FUNCTION(float_compare, importObj);
+    ADD_HOOK_FUNCTION(float_sum, importObj);
+    ADD_HOOK_FUNCTION(float_sto, importObj);
+    ADD_HOOK_FUNCTION(float_sto_set, importObj);
+    ADD_HOOK_FUNCTION(float_invert, importObj);
+
+    ADD_HOOK_FUNCTION(float_divide, importObj);
+    ADD_HOOK_FUNCTION(float_one, importObj);
+    ADD_HOOK_FUNCTION(float_mantissa, importObj);
+    ADD_HOOK_FUNCTION(float_sign, importObj);
+    ADD_HOOK_FUNCTION(float_int, importObj);
+    ADD_HOOK_FUNCTION(float_log, importObj);
+    ADD_HOOK_FUNCTION(float_root, importObj);
+
+    ADD_HOOK_FUNCTION(otxn_burden, importObj);
+    ADD_HOOK_FUNCTION(otxn_generation, importObj);
+    ADD_HOOK_FUNCTION(otxn_field, importObj);
+    ADD_HOOK_FUNCTION(otxn_id, importObj);
+    ADD_HOOK_FUNCTION(otxn_type, importObj);
+    ADD_HOOK_FUNCTION(otxn_slot, importObj);
+    ADD_HOOK_FUNCTION(otxn_param, importObj);
+
+    ADD_HOOK_FUNCTION(hook_account, importObj);
+    ADD_HOOK_FUNCTION(hook_hash, importObj);
+    ADD_HOOK_FUNCTION(hook_again, importObj);
+    ADD_HOOK_FUNCTION(fee_base, importObj);
+    ADD_HOOK_FUNCTION(ledger_seq, importObj);
+    ADD_HOOK_FUNCTION(ledger_last_hash, importObj);
+    ADD_HOOK_FUNCTION(ledger_last_time, importObj);
+    ADD_HOOK_FUNCTION(ledger_nonce, importObj);
+    ADD_HOOK_FUNCTION(ledger_keylet, importObj);
+
+    ADD_HOOK_FUNCTION(hook_param, importObj);
+    ADD_HOOK_FUNCTION(hook_param_set, importObj);
+    ADD_HOOK_FUNCTION(hook_skip, importObj);
+    ADD_HOOK_FUNCTION(hook_pos, importObj);
+
+    ADD_HOOK_FUNCTION(state, importObj);
+    ADD_HOOK_FUNCTION(state_foreign, importObj);
+    ADD_HOOK_FUNCTION(state_set, importObj);
+    ADD_HOOK_FUNCTION(state_foreign_set, importObj);
+
+    ADD_HOOK_FUNCTION(slot, importObj);
+    ADD_HOOK_FUNCTION(slot_clear, importObj);
+    ADD_HOOK_FUNCTION(slot_count, importObj);
+    ADD_HOOK_FUNCTION(slot_set, importObj);
+    ADD_HOOK_FUNCTION(slot_size, importObj);
+    ADD_HOOK_FUNCTION(slot_subarray, importObj);
+    ADD_HOOK_FUNCTION(slot_subfield, importObj);
+    ADD_HOOK_FUNCTION(slot_type, importObj);
+    ADD_HOOK_FUNCTION(slot_float, importObj);
+
+    ADD_HOOK_FUNCTION(trace, importObj);
+    ADD_HOOK_FUNCTION(trace_num, importObj);
+    ADD_HOOK_FUNCTION(trace_float, importObj);
+
+    ADD_HOOK_FUNCTION(meta_slot, importObj);
+    ADD_HOOK_FUNCTION(xpop_slot, importObj);
+
+    /*
+    ADD_HOOK_FUNCTION(str_find, importObj);
+    ADD_HOOK_FUNCTION(str_replace, importObj);
+    ADD_HOOK_FUNCTION(str_compare, importObj);
+    ADD_HOOK_FUNCTION(str_concat, importObj);
+    */
+
+    // Guard validation only permits function imports so the table and
+    // memory are never linked to (or written by) a hook.
+    WasmEdge_TableInstanceContext* hostTable =
+        WasmEdge_TableInstanceCreate(tableType);
+    WasmEdge_ModuleInstanceAddTable(importObj, tableName, hostTable);
+    WasmEdge_MemoryInstanceContext* hostMem =
+        WasmEdge_MemoryInstanceCreate(memType);
+    WasmEdge_ModuleInstanceAddMemory(importObj, memName, hostMem);
+
+    return importObj;
+}
+
+WasmEdge_ModuleInstanceContext const*
+hook::HookExecutor::importModule()
+{
+    static WasmEdge_ModuleInstanceContext const* const importObj =
+        createImportModule();
+    return importObj;
+}
+
 /* If XRPLD is running with trace log level hooks may produce debugging output
  * to the trace log specifying both a string and an integer to output */
 DEFINE_HOOK_FUNCTION(
@@ -1403,30 +1294,14 @@ std::optional<ripple::uint256> inline make_state_key(std::string_view source)
 }
 
 // check the state cache
-inline std::optional<
-    std::reference_wrapper<std::pair<bool, ripple::Blob> const>>
+inline hook::HookStateMap::Entry const*
 lookup_state_cache(
     hook::HookContext& hookCtx,
     ripple::AccountID const& acc,
     ripple::uint256 const& ns,
     ripple::uint256 const& key)
 {
-    auto& stateMap = hookCtx.result.stateMap;
-    if (stateMap.find(acc) == stateMap.end())
-        return std::nullopt;
-
-    auto& stateMapAcc = std::get<2>(stateMap[acc]);
-    if (stateMapAcc.find(ns) == stateMapAcc.end())
-        return std::nullopt;
-
-    auto& stateMapNs = stateMapAcc[ns];
-
-    auto const& ret = stateMapNs.find(key);
-
-    if (ret == stateMapNs.end())
-        return std::nullopt;
-
-    return std::cref(ret->second);
+    return hookCtx.result.stateMap.find(acc, ns, key);
 }
 
 // update the state cache
@@ -1436,7 +1311,7 @@ set_state_cache(
     ripple::AccountID const& acc,
     ripple::uint256 const& ns,
     ripple::uint256 const& key,
-    ripple::Blob& data,
+    ripple::Slice const& data,
     bool modified)
 {
     auto& stateMap = hookCtx.result.stateMap;
@@ -1448,7 +1323,8 @@ set_state_cache(
     bool const createNamespace = view.rules().enabled(fixXahauV1) &&
         !view.exists(keylet::hookStateDir(acc, ns));
 
-    if (stateMap.find(acc) == stateMap.end())
+    auto* accountState = stateMap.findAccount(acc);
+    if (!accountState)
     {
         // if this is the first time this account has been interacted with
         // we will compute how many available reserve positions there are
@@ -1490,19 +1366,16 @@ set_state_cache(
 
         stateMap.modified_entry_count++;
 
-        stateMap[acc] = {
-            availableForReserves - 1,
-            namespaceCount,
-            {{ns, {{key, {modified, data}}}}}};
+        stateMap.insertAccount(acc, availableForReserves - 1, namespaceCount);
+        stateMap.insert(acc, ns, key, data, modified);
         return 1;
     }
 
-    auto& availableForReserves = std::get<0>(stateMap[acc]);
-    auto& namespaceCount = std::get<1>(stateMap[acc]);
-    auto& stateMapAcc = std::get<2>(stateMap[acc]);
+    auto& availableForReserves = accountState->availableForReserves;
+    auto& namespaceCount = accountState->namespaceCount;
     bool const canReserveNew = availableForReserves > 0;
 
-    if (stateMapAcc.find(ns) == stateMapAcc.end())
+    if (!stateMap.hasNamespace(acc, ns))
     {
         if (modified)
         {
@@ -1525,13 +1398,13 @@ set_state_cache(
             stateMap.modified_entry_count++;
         }
 
-        stateMapAcc[ns] = {{key, {modified, data}}};
+        stateMap.insert(acc, ns, key, data, modified);
 
         return 1;
     }
 
-    auto& stateMapNs = stateMapAcc[ns];
-    if (stateMapNs.find(key) == stateMapNs.end())
+    auto* entry = stateMap.find(acc, ns, key);
+    if (!entry)
     {
         if (modified)
         {
@@ -1541,21 +1414,21 @@ set_state_cache(
             stateMap.modified_entry_count++;
         }
 
-        stateMapNs[key] = {modified, data};
+        stateMap.insert(acc, ns, key, data, modified);
         hookCtx.result.changedStateCount++;
         return 1;
     }
 
     if (modified)
     {
-        if (!stateMapNs[key].first)
+        if (!entry->modified)
             hookCtx.result.changedStateCount++;
 
         stateMap.modified_entry_count++;
-        stateMapNs[key].first = true;
+        entry->modified = true;
     }
 
-    stateMapNs[key].second = data;
+    stateMap.assign(*entry, data);
     return 1;
 }
 
@@ -1659,7 +1532,7 @@ DEFINE_HOOK_FUNCTION(
     if (!key)
         return INTERNAL_ERROR;
 
-    ripple::Blob data{memory + read_ptr, memory + read_ptr + read_len};
+    ripple::Slice const data{memory + read_ptr, read_len};
 
     // local modifications are always allowed
     if (aread_len == 0 || acc == hookCtx.result.account)
@@ -1677,7 +1550,7 @@ DEFINE_HOOK_FUNCTION(
 
     // first check if we've already modified this state
     auto cacheEntry = lookup_state_cache(hookCtx, acc, ns, *key);
-    if (cacheEntry && cacheEntry->get().first)
+    if (cacheEntry && cacheEntry->modified)
     {
         // if a cache entry already exists and it has already been modified
         // don't check grants again
@@ -1775,46 +1648,32 @@ hook::finalizeHookState(
     uint16_t changeCount = 0;
 
     // write all changes to state, if in "apply" mode
-    for (const auto& accEntry : stateMap)
+    for (auto const* entry : stateMap.modified())
     {
-        const auto& acc = accEntry.first;
-        for (const auto& nsEntry : std::get<2>(accEntry.second))
+        changeCount++;
+        if (changeCount > max_state_modifications + 1)
         {
-            const auto& ns = nsEntry.first;
-            for (const auto& cacheEntry : nsEntry.second)
-            {
-                bool is_modified = cacheEntry.second.first;
-                const auto& key = cacheEntry.first;
-                const auto& blob = cacheEntry.second.second;
-                if (is_modified)
-                {
-                    changeCount++;
-                    if (changeCount > max_state_modifications + 1)
-                    {
-                        // overflow
-                        JLOG(j.warn())
-                            << "HooKError[TX:" << txnID
-                            << "]: SetHooKState failed: Too many state changes";
-                        return tecHOOK_REJECTED;
-                    }
+            // overflow
+            JLOG(j.warn()) << "HooKError[TX:" << txnID
+                           << "]: SetHooKState failed: Too many state changes";
+            return tecHOOK_REJECTED;
+        }
 
-                    // this entry isn't just cached, it was actually modified
-                    auto slice = Slice(blob.data(), blob.size());
+        // this entry isn't just cached, it was actually modified
+        auto const& key = entry->key();
+        auto slice = entry->value();
 
-                    TER result = setHookState(applyCtx, acc, ns, key, slice);
+        TER result =
+            setHookState(applyCtx, entry->account(), entry->ns(), key, slice);
 
-                    if (!isTesSuccess(result))
-                    {
-                        JLOG(j.warn())
-                            << "HookError[TX:" << txnID
-                            << "]: SetHookState failed: " << result
-                            << " Key: " << key << " Value: " << slice;
-                        return result;
-                    }
-                    // ^ should not fail... checks were done before map insert
-                }
-            }
+        if (!isTesSuccess(result))
+        {
+            JLOG(j.warn()) << "HookError[TX:" << txnID
+                           << "]: SetHookState failed: " << result
+                           << " Key: " << key << " Value: " << slice;
+            return result;
         }
+        // ^ should not fail... checks were done before map insert
     }
     return tesSUCCESS;
 }
@@ -2117,14 +1976,10 @@ DEFINE_HOOK_FUNCTION(
     auto cacheEntryLookup = lookup_state_cache(hookCtx, acc, ns, *key);
     if (cacheEntryLookup)
     {
-        auto const& cacheEntry = cacheEntryLookup->get();
+        auto const cacheEntry = cacheEntryLookup->value();
 
         WRITE_WASM_MEMORY_OR_RETURN_AS_INT64(
-            write_ptr,
-            write_len,
-            cacheEntry.second.data(),
-            cacheEntry.second.size(),
-            false);
+            write_ptr, write_len, cacheEntry.data(), cacheEntry.size(), false);
     }
 
     auto hsSLE = view.peek(keylet::hookState(acc, *key, ns));
@@ -2135,7 +1990,7 @@ DEFINE_HOOK_FUNCTION(
     Blob b = hsSLE->getFieldVL(sfHookStateData);
 
     // it exists add it to cache and return it
-    if (set_state_cache(hookCtx, acc, ns, *key, b, false) < 0)
+    if (set_state_cache(hookCtx, acc, ns, *key, makeSlice(b), false) < 0)
         return INTERNAL_ERROR;  // should never happen
 
     WRITE_WASM_MEMORY_OR_RETURN_AS_INT64(
@@ -2448,18 +2303,20 @@ DEFINE_HOOK_FUNCTION(
     if (hookCtx.slot.find(slot_no) == hookCtx.slot.end())
         return DOESNT_EXIST;
 
-    if (hookCtx.slot[slot_no].entry == 0)
+    auto& slot = hookCtx.slot[slot_no];
+    if (slot.entry == 0)
         return INTERNAL_ERROR;
 
-    Serializer s;
-    hookCtx.slot[slot_no].entry->add(s);
+    auto const data = get_slot_view(slot).serialized(slot.entry);
+    if (!data)
+        return INTERNAL_ERROR;
 
     WRITE_WASM_MEMORY_OR_RETURN_AS_INT64(
         write_ptr,
         write_len,
-        s.getDataPtr(),
-        s.getDataLength(),
-        hookCtx.slot[slot_no].entry->getSType() == STI_ACCOUNT);
+        data->data(),
+        data->size(),
+        slot.entry->getSType() == STI_ACCOUNT);
 
     HOOK_TEARDOWN();
 }
@@ -2586,13 +2443,15 @@ DEFINE_HOOK_FUNCTION(int64_t, slot_size, uint32_t slot_no)
     if (hookCtx.slot.find(slot_no) == hookCtx.slot.end())
         return DOESNT_EXIST;
 
-    if (hookCtx.slot[slot_no].entry == 0)
+    auto& slot = hookCtx.slot[slot_no];
+    if (slot.entry == 0)
         return INTERNAL_ERROR;
 
-    // RH TODO: this is a very expensive way of computing size, cache it
-    Serializer s;
-    hookCtx.slot[slot_no].entry->add(s);
-    return s.getDataLength();
+    auto const data = get_slot_view(slot).serialized(slot.entry);
+    if (!data)
+        return INTERNAL_ERROR;
+
+    return data->size();
 
     HOOK_TEARDOWN();
 }
@@ -2640,10 +2499,11 @@ DEFINE_HOOK_FUNCTION(
                 return NO_FREE_SLOTS;
         }
 
-        // copy
+        // copy, sharing the parent's serialization
         if (new_slot != parent_slot)
         {
             copied = true;
+            get_slot_view(hookCtx.slot[parent_slot]);
             hookCtx.slot[new_slot] = hookCtx.slot[parent_slot];
         }
         hookCtx.slot[new_slot].entry = &(parent_obj[array_id]);
@@ -2708,10 +2568,11 @@ DEFINE_HOOK_FUNCTION(
                 return NO_FREE_SLOTS;
         }
 
-        // copy
+        // copy, sharing the parent's serialization
         if (new_slot != parent_slot)
         {
             copied = true;
+            get_slot_view(hookCtx.slot[parent_slot]);
             hookCtx.slot[new_slot] = hookCtx.slot[parent_slot];
         }
 
@@ -4867,33 +4728,6 @@ mulratio_internal(
     }
 }
 
-inline int64_t
-float_multiply_internal_parts(
-    uint64_t man1,
-    int32_t exp1,
-    bool neg1,
-    uint64_t man2,
-    int32_t exp2,
-    bool neg2)
-{
-    using namespace boost::multiprecision;
-    cpp_int mult = cpp_int(man1) * cpp_int(man2);
-    mult /= power_of_ten[15];
-    uint64_t man_out = static_cast<uint64_t>(mult);
-    if (mult > man_out)
-        return XFL_OVERFLOW;
-
-    int32_t exp_out = exp1 + exp2 + 15;
-    bool neg_out = (neg1 && !neg2) || (!neg1 && neg2);
-    int64_t ret = normalize_xfl(man_out, exp_out, neg_out);
-
-    if (ret == EXPONENT_UNDERSIZED)
-        return 0;
-    if (ret == EXPONENT_OVERSIZED)
-        return XFL_OVERFLOW;
-    return ret;
-}
-
 DEFINE_HOOK_FUNCTION(
     int64_t,
     float_int,
@@ -5066,39 +4900,7 @@ DEFINE_HOOK_FUNCTION(int64_t, float_sum, int64_t float1, int64_t float2)
     HOOK_SETUP();  // populates memory_ctx, memory, memory_length, applyCtx,
                    // hookCtx on current stack
 
-    RETURN_IF_INVALID_FLOAT(float1);
-    RETURN_IF_INVALID_FLOAT(float2);
-
-    if (float1 == 0)
-        return float2;
-    if (float2 == 0)
-        return float1;
-
-    int64_t man1 =
-        (int64_t)(get_mantissa(float1)) * (is_negative(float1) ? -1LL : 1LL);
-    int32_t exp1 = get_exponent(float1);
-    int64_t man2 =
-        (int64_t)(get_mantissa(float2)) * (is_negative(float2) ? -1LL : 1LL);
-    int32_t exp2 = get_exponent(float2);
-
-    try
-    {
-        ripple::IOUAmount amt1{man1, exp1};
-        ripple::IOUAmount amt2{man2, exp2};
-        amt1 += amt2;
-        int64_t result = make_float(amt1);
-        if (result == EXPONENT_UNDERSIZED)
-        {
-            // this is an underflow e.g. as a result of subtracting an xfl from
-            // itself and thus not an error, just return canonical 0
-            return 0;
-        }
-        return result;
-    }
-    catch (std::overflow_error& e)
-    {
-        return XFL_OVERFLOW;
-    }
+    return float_sum_internal(float1, float2);
 
     HOOK_TEARDOWN();
 }
@@ -5401,86 +5203,6 @@ DEFINE_HOOK_FUNCTION(
     HOOK_TEARDOWN();
 }
 
-const int64_t float_one_internal = make_float(1000000000000000ull, -15, false);
-
-inline int64_t
-float_divide_internal(int64_t float1, int64_t float2, bool hasFix)
-{
-    RETURN_IF_INVALID_FLOAT(float1);
-    RETURN_IF_INVALID_FLOAT(float2);
-    if (float2 == 0)
-        return DIVISION_BY_ZERO;
-    if (float1 == 0)
-        return 0;
-
-    // special case: division by 1
-    // RH TODO: add more special cases (division by power of 10)
-    if (float2 == float_one_internal)
-        return float1;
-
-    uint64_t man1 = get_mantissa(float1);
-    int32_t exp1 = get_exponent(float1);
-    bool neg1 = is_negative(float1);
-    uint64_t man2 = get_mantissa(float2);
-    int32_t exp2 = get_exponent(float2);
-    bool neg2 = is_negative(float2);
-
-    int64_t tmp1 = normalize_xfl(man1, exp1);
-    int64_t tmp2 = normalize_xfl(man2, exp2);
-
-    if (tmp1 < 0 || tmp2 < 0)
-        return INVALID_FLOAT;
-
-    if (tmp1 == 0)
-        return 0;
-
-    while (man2 > man1)
-    {
-        man2 /= 10;
-        exp2++;
-    }
-
-    if (man2 == 0)
-        return DIVISION_BY_ZERO;
-
-    while (man2 < man1)
-    {
-        if (man2 * 10 > man1)
-            break;
-        man2 *= 10;
-        exp2--;
-    }
-
-    uint64_t man3 = 0;
-    int32_t exp3 = exp1 - exp2;
-
-    while (man2 > 0)
-    {
-        int i = 0;
-        if (hasFix)
-        {
-            for (; man1 >= man2; man1 -= man2, ++i)
-                ;
-        }
-        else
-        {
-            for (; man1 > man2; man1 -= man2, ++i)
-                ;
-        }
-
-        man3 *= 10;
-        man3 += i;
-        man2 /= 10;
-        if (man2 == 0)
-            break;
-        exp3--;
-    }
-
-    bool neg3 = !((neg1 && neg2) || (!neg1 && !neg2));
-
-    return normalize_xfl(man3, exp3, neg3);
-}
-
 DEFINE_HOOK_FUNCTION(int64_t, float_divide, int64_t float1, int64_t float2)
 {
     HOOK_SETUP();  // populates memory_ctx, memory, memory_length, applyCtx,
@@ -5539,74 +5261,12 @@ DEFINE_HOOK_FUNCTION(int64_t, float_sign, int64_t float1)
     HOOK_TEARDOWN();
 }
 
-inline int64_t
-double_to_xfl(double x)
-{
-    if ((x) == 0)
-        return 0;
-    bool neg = x < 0;
-    double absresult = neg ? -x : x;
-
-    // first compute the base 10 order of the float
-    int32_t exp_out = (int32_t)log10(absresult);
-
-    // next adjust it into the valid mantissa range (this means dividing by its
-    // order and multiplying by 10**15)
-    absresult *= pow(10, -exp_out + 15);
-
-    // after adjustment the value may still fall below the minMantissa
-    int64_t result = (int64_t)absresult;
-    if (result < minMantissa)
-    {
-        if (result == minMantissa - 1LL)
-            result += 1LL;
-        else
-        {
-            result *= 10LL;
-            exp_out--;
-        }
-    }
-
-    // likewise the value can fall above the maxMantissa
-    if (result > maxMantissa)
-    {
-        if (result == maxMantissa + 1LL)
-            result -= 1LL;
-        else
-        {
-            result /= 10LL;
-            exp_out++;
-        }
-    }
-
-    exp_out -= 15;
-    int64_t ret = make_float(result, exp_out, neg);
-
-    if (ret == EXPONENT_UNDERSIZED)
-        return 0;
-
-    return ret;
-}
-
 DEFINE_HOOK_FUNCTION(int64_t, float_log, int64_t float1)
 {
     HOOK_SETUP();  // populates memory_ctx, memory, memory_length, applyCtx,
                    // hookCtx on current stack
 
-    RETURN_IF_INVALID_FLOAT(float1);
-
-    if (float1 == 0)
-        return INVALID_ARGUMENT;
-
-    uint64_t man1 = get_mantissa(float1);
-    int32_t exp1 = get_exponent(float1);
-    if (is_negative(float1))
-        return COMPLEX_NOT_SUPPORTED;
-
-    double inp = (double)(man1);
-    double result = log10(inp) + exp1;
-
-    return double_to_xfl(result);
+    return float_log_internal(float1);
 
     HOOK_TEARDOWN();
 }
@@ -5616,22 +5276,7 @@ DEFINE_HOOK_FUNCTION(int64_t, float_root, int64_t float1, uint32_t n)
     HOOK_SETUP();  // populates memory_ctx, memory, memory_length, applyCtx,
                    // hookCtx on current stack
 
-    RETURN_IF_INVALID_FLOAT(float1);
-    if (float1 == 0)
-        return 0;
-
-    if (n < 2)
-        return INVALID_ARGUMENT;
-
-    uint64_t man1 = get_mantissa(float1);
-    int32_t exp1 = get_exponent(float1);
-    if (is_negative(float1))
-        return COMPLEX_NOT_SUPPORTED;
-
-    double inp = (double)(man1)*pow(10, exp1);
-    double result = pow(inp, ((double)1.0f) / ((double)(n)));
-
-    return double_to_xfl(result);
+    return float_root_internal(float1, n);
 
     HOOK_TEARDOWN();
 }
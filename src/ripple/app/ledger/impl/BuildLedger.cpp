@@ -21,6 +21,7 @@
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/app/ledger/LedgerReplay.h>
 #include <ripple/app/ledger/OpenLedger.h>
+#include <ripple/app/ledger/impl/ParallelApply.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/CanonicalTXSet.h>
 #include <ripple/app/tx/apply.h>
@@ -67,8 +68,8 @@ buildLedgerImpl(
         // Write the final version of all modified SHAMap
         // nodes to the node store to preserve the new LCL
 
-        int const asf = built->stateMap().flushDirty(hotACCOUNT_NODE);
-        int const tmf = built->txMap().flushDirty(hotTRANSACTION_NODE);
+        int const asf = built->stateMap().flushDirty(hotACCOUNT_NODE, true);
+        int const tmf = built->txMap().flushDirty(hotTRANSACTION_NODE, true);
         JLOG(j.debug()) << "Flushed " << asf << " accounts and " << tmf
                         << " transaction nodes";
     }
@@ -103,6 +104,8 @@ applyTransactions(
     bool certainRetry = true;
     std::size_t count = 0;
 
+    auto const parallel = app.getParallelApply();
+
     // Attempt to apply all of the retriable transactions
     for (int pass = 0; pass < LEDGER_TOTAL_PASSES; ++pass)
     {
@@ -110,48 +113,56 @@ applyTransactions(
                         << " begins (" << txns.size() << " transactions)";
         int changes = 0;
 
-        auto it = txns.begin();
-
-        while (it != txns.end())
+        if (parallel)
+        {
+            changes = parallel->pass(
+                built, txns, failed, view, pass == 0, certainRetry);
+        }
+        else
         {
-            auto const txid = it->first.getTXID();
+            auto it = txns.begin();
 
-#ifndef DEBUG
-            try
+            while (it != txns.end())
             {
-#endif
-                if (pass == 0 && built->txExists(txid))
-                {
-                    it = txns.erase(it);
-                    continue;
-                }
+                auto const txid = it->first.getTXID();
 
-                switch (applyTransaction(
-                    app, view, *it->second, certainRetry, tapNONE, j))
+#ifndef DEBUG
+                try
                 {
-                    case ApplyResult::Success:
-                        it = txns.erase(it);
-                        ++changes;
-                        break;
-
-                    case ApplyResult::Fail:
-                        failed.insert(txid);
+#endif
+                    if (pass == 0 && built->txExists(txid))
+                    {
                         it = txns.erase(it);
-                        break;
-
-                    case ApplyResult::Retry:
-                        ++it;
-                }
+                        continue;
+                    }
+
+                    switch (applyTransaction(
+                        app, view, *it->second, certainRetry, tapNONE, j))
+                    {
+                        case ApplyResult::Success:
+                            it = txns.erase(it);
+                            ++changes;
+                            break;
+
+                        case ApplyResult::Fail:
+                            failed.insert(txid);
+                            it = txns.erase(it);
+                            break;
+
+                        case ApplyResult::Retry:
+                            ++it;
+                    }
 #ifndef DEBUG
-            }
-            catch (std::exception const& ex)
-            {
-                JLOG(j.warn())
-                    << "Transaction " << txid << " throws: " << ex.what();
-                failed.insert(txid);
-                it = txns.erase(it);
-            }
+                }
+                catch (std::exception const& ex)
+                {
+                    JLOG(j.warn())
+                        << "Transaction " << txid << " throws: " << ex.what();
+                    failed.insert(txid);
+                    it = txns.erase(it);
+                }
 #endif
+            }
         }
 
         JLOG(j.debug()) << (certainRetry ? "Pass: " : "Final pass: ") << pass
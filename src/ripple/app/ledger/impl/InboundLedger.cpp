@@ -37,6 +37,7 @@
 
 #include <algorithm>
 #include <random>
+#include <vector>
 
 namespace ripple {
 
@@ -960,27 +961,54 @@ InboundLedger::receiveNode(protocol::TMLedgerData& packet, SHAMapAddNode& san)
     {
         auto const f = filter.get();
 
+        // Runs of non-root nodes are added together, so that their inner
+        // nodes are hashed as a batch
+        std::vector<std::pair<SHAMapNodeID, Slice>> known;
+        auto addKnown = [&]() {
+            if (!known.empty())
+            {
+                san += map.addKnownNodes(known, f);
+                known.clear();
+            }
+            return san.isGood();
+        };
+
         for (auto const& node : packet.nodes())
         {
             auto const nodeID = deserializeSHAMapNodeID(node.nodeid());
 
+            if (!nodeID || nodeID->isRoot())
+            {
+                if (!addKnown())
+                {
+                    JLOG(journal_.warn()) << "Received bad node data";
+                    return;
+                }
+            }
+
             if (!nodeID)
                 throw std::runtime_error("data does not properly deserialize");
 
             if (nodeID->isRoot())
             {
                 san += map.addRootNode(rootHash, makeSlice(node.nodedata()), f);
+
+                if (!san.isGood())
+                {
+                    JLOG(journal_.warn()) << "Received bad node data";
+                    return;
+                }
             }
             else
             {
-                san += map.addKnownNode(*nodeID, makeSlice(node.nodedata()), f);
+                known.emplace_back(*nodeID, makeSlice(node.nodedata()));
             }
+        }
 
-            if (!san.isGood())
-            {
-                JLOG(journal_.warn()) << "Received bad node data";
-                return;
-            }
+        if (!addKnown())
+        {
+            JLOG(journal_.warn()) << "Received bad node data";
+            return;
         }
     }
     catch (std::exception const& e)
@@ -0,0 +1,492 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/Ledger.h>
+#include <ripple/app/ledger/impl/ParallelApply.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/app/tx/apply.h>
+#include <ripple/basics/Log.h>
+#include <ripple/beast/core/CurrentThreadName.h>
+#include <ripple/ledger/OpenView.h>
+#include <ripple/protocol/STObject.h>
+#include <atomic>
+#include <exception>
+#include <optional>
+#include <string>
+#include <utility>
+
+namespace ripple {
+
+namespace {
+
+// Forwards reads to a view, noting the state they depend on
+class RecordingView : public ReadView
+{
+public:
+    explicit RecordingView(ReadView const& base) : base_(base)
+    {
+    }
+
+    // Keys read, whether or not they were found
+    std::vector<uint256> const&
+    keys() const
+    {
+        return keys_;
+    }
+
+    // Ranges searched by succ, as (key, last)
+    std::vector<std::pair<uint256, std::optional<uint256>>> const&
+    ranges() const
+    {
+        return ranges_;
+    }
+
+    // True if the state was iterated, which depends on all of it
+    bool
+    readAll() const
+    {
+        return readAll_;
+    }
+
+    LedgerInfo const&
+    info() const override
+    {
+        return base_.info();
+    }
+
+    bool
+    open() const override
+    {
+        return base_.open();
+    }
+
+    Fees const&
+    fees() const override
+    {
+        return base_.fees();
+    }
+
+    Rules const&
+    rules() const override
+    {
+        return base_.rules();
+    }
+
+    bool
+    exists(Keylet const& k) const override
+    {
+        keys_.push_back(k.key);
+        return base_.exists(k);
+    }
+
+    std::optional<key_type>
+    succ(key_type const& key, std::optional<key_type> const& last)
+        const override
+    {
+        ranges_.emplace_back(key, last);
+        return base_.succ(key, last);
+    }
+
+    std::shared_ptr<SLE const>
+    read(Keylet const& k) const override
+    {
+        keys_.push_back(k.key);
+        return base_.read(k);
+    }
+
+    STAmount
+    balanceHook(
+        AccountID const& account,
+        AccountID const& issuer,
+        STAmount const& amount) const override
+    {
+        return base_.balanceHook(account, issuer, amount);
+    }
+
+    std::uint32_t
+    ownerCountHook(AccountID const& account, std::uint32_t count)
+        const override
+    {
+        return base_.ownerCountHook(account, count);
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesBegin() const override
+    {
+        readAll_ = true;
+        return base_.slesBegin();
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesEnd() const override
+    {
+        readAll_ = true;
+        return base_.slesEnd();
+    }
+
+    std::unique_ptr<sles_type::iter_base>
+    slesUpperBound(key_type const& key) const override
+    {
+        readAll_ = true;
+        return base_.slesUpperBound(key);
+    }
+
+    // An OpenView only reads its own transactions
+    std::unique_ptr<txs_type::iter_base>
+    txsBegin() const override
+    {
+        return base_.txsBegin();
+    }
+
+    std::unique_ptr<txs_type::iter_base>
+    txsEnd() const override
+    {
+        return base_.txsEnd();
+    }
+
+    bool
+    txExists(key_type const& key) const override
+    {
+        return base_.txExists(key);
+    }
+
+    tx_type
+    txRead(key_type const& key) const override
+    {
+        return base_.txRead(key);
+    }
+
+private:
+    ReadView const& base_;
+    mutable std::vector<uint256> keys_;
+    mutable std::vector<std::pair<uint256, std::optional<uint256>>> ranges_;
+    mutable bool readAll_ = false;
+};
+
+// Receives a speculative view's changes, noting the keys changed. If given
+// a view, passes the changes on to it with the transaction numbered as the
+// view's next.
+class ChangeSink : public TxsRawView
+{
+public:
+    ChangeSink(OpenView* to, std::vector<uint256>& keys) : to_(to), keys_(keys)
+    {
+    }
+
+    void
+    rawErase(std::shared_ptr<SLE> const& sle) override
+    {
+        keys_.push_back(sle->key());
+        if (to_)
+            to_->rawErase(sle);
+    }
+
+    void
+    rawInsert(std::shared_ptr<SLE> const& sle) override
+    {
+        keys_.push_back(sle->key());
+        if (to_)
+            to_->rawInsert(sle);
+    }
+
+    void
+    rawReplace(std::shared_ptr<SLE> const& sle) override
+    {
+        keys_.push_back(sle->key());
+        if (to_)
+            to_->rawReplace(sle);
+    }
+
+    void
+    rawDestroyXRP(XRPAmount const& fee) override
+    {
+        if (to_)
+            to_->rawDestroyXRP(fee);
+    }
+
+    void
+    rawTxInsert(
+        ReadView::key_type const& key,
+        std::shared_ptr<Serializer const> const& txn,
+        std::shared_ptr<Serializer const> const& metaData) override
+    {
+        if (!to_)
+            return;
+
+        // The metadata was made with the transaction first in its view
+        auto const index = to_->txCount();
+        if (!metaData || index == 0)
+            return to_->rawTxInsert(key, txn, metaData);
+
+        STObject meta(SerialIter{metaData->slice()}, sfMetadata);
+        meta.setFieldU32(sfTransactionIndex, index);
+        auto s = std::make_shared<Serializer>();
+        meta.add(*s);
+        to_->rawTxInsert(key, txn, s);
+    }
+
+private:
+    OpenView* const to_;
+    std::vector<uint256>& keys_;
+};
+
+}  // namespace
+
+struct ParallelApply::Speculation
+{
+    CanonicalTXSet::const_iterator it;
+
+    std::unique_ptr<RecordingView> reads;
+    std::unique_ptr<OpenView> view;
+    std::vector<uint256> writes;
+    ApplyResult result = ApplyResult::Retry;
+    std::exception_ptr error;
+
+    // Whether the state this depends on was changed by a transaction
+    // committed since it was applied
+    bool
+    stale(std::set<uint256> const& changed) const
+    {
+        if (changed.empty())
+            return false;
+
+        if (reads->readAll())
+            return true;
+
+        for (auto const& key : reads->keys())
+        {
+            if (changed.count(key))
+                return true;
+        }
+
+        for (auto const& [key, last] : reads->ranges())
+        {
+            auto const next = changed.upper_bound(key);
+            if (next != changed.end() && (!last || *next < *last))
+                return true;
+        }
+
+        for (auto const& key : writes)
+        {
+            if (changed.count(key))
+                return true;
+        }
+
+        return false;
+    }
+};
+
+ParallelApply::ParallelApply(
+    Application& app,
+    std::size_t threads,
+    beast::Journal j)
+    : app_(app), j_(j), window_(std::max<std::size_t>(threads, 1) * 16)
+{
+    for (std::size_t i = 1; i < threads; ++i)
+        workers_.emplace_back([this, i] { work(i); });
+}
+
+ParallelApply::~ParallelApply()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_)
+        worker.join();
+}
+
+int
+ParallelApply::pass(
+    std::shared_ptr<Ledger const> const& built,
+    CanonicalTXSet& txns,
+    std::set<TxID>& failed,
+    OpenView& view,
+    bool first,
+    bool certainRetry)
+{
+    std::lock_guard passLock(passMutex_);
+
+    int changes = 0;
+    std::size_t speculated = 0;
+    std::size_t reapplied = 0;
+
+    std::vector<Speculation> window;
+    window.reserve(window_);
+
+    auto it = txns.begin();
+    while (it != txns.end())
+    {
+        window.clear();
+        while (it != txns.end() && window.size() < window_)
+        {
+            if (first && built->txExists(it->first.getTXID()))
+            {
+                it = txns.erase(it);
+                continue;
+            }
+
+            window.emplace_back().it = it++;
+        }
+
+        std::atomic<std::size_t> next{0};
+        runOnAll([&] {
+            for (auto i = next++; i < window.size(); i = next++)
+                speculate(window[i], view, certainRetry);
+        });
+        speculated += window.size();
+
+        // Commit in canonical order
+        std::set<uint256> changed;
+        for (auto& s : window)
+        {
+            auto const txid = s.it->first.getTXID();
+
+            if (s.stale(changed))
+            {
+                speculate(s, view, certainRetry);
+                ++reapplied;
+            }
+
+            if (s.error)
+            {
+#ifdef DEBUG
+                std::rethrow_exception(s.error);
+#else
+                try
+                {
+                    std::rethrow_exception(s.error);
+                }
+                catch (std::exception const& ex)
+                {
+                    JLOG(j_.warn())
+                        << "Transaction " << txid << " throws: " << ex.what();
+                }
+                failed.insert(txid);
+                txns.erase(s.it);
+                continue;
+#endif
+            }
+
+            switch (s.result)
+            {
+                case ApplyResult::Success: {
+                    std::vector<uint256> keys;
+                    ChangeSink sink(&view, keys);
+                    s.view->apply(sink);
+                    changed.insert(keys.begin(), keys.end());
+                    txns.erase(s.it);
+                    ++changes;
+                    break;
+                }
+
+                case ApplyResult::Fail:
+                    failed.insert(txid);
+                    txns.erase(s.it);
+                    break;
+
+                case ApplyResult::Retry:
+                    break;
+            }
+
+            s.view.reset();
+            s.reads.reset();
+        }
+    }
+
+    JLOG(j_.debug()) << "Parallel pass: " << speculated << " transactions, "
+                     << reapplied << " applied again";
+
+    return changes;
+}
+
+void
+ParallelApply::speculate(
+    Speculation& s,
+    OpenView const& view,
+    bool certainRetry)
+{
+    s.view.reset();
+    s.reads = std::make_unique<RecordingView>(view);
+    s.view = std::make_unique<OpenView>(s.reads.get());
+    s.writes.clear();
+    s.error = nullptr;
+
+    try
+    {
+        s.result = applyTransaction(
+            app_, *s.view, *s.it->second, certainRetry, tapNONE, j_);
+
+        ChangeSink sink(nullptr, s.writes);
+        s.view->apply(sink);
+    }
+    catch (...)
+    {
+        // Whatever is thrown, the thread must go on to report the task
+        // done, so it is rethrown when the transaction is committed
+        s.error = std::current_exception();
+    }
+}
+
+void
+ParallelApply::runOnAll(std::function<void()> const& task)
+{
+    {
+        std::lock_guard lock(mutex_);
+        task_ = &task;
+        running_ = workers_.size();
+        ++generation_;
+    }
+    wake_.notify_all();
+
+    task();
+
+    std::unique_lock lock(mutex_);
+    done_.wait(lock, [this] { return running_ == 0; });
+}
+
+void
+ParallelApply::work(std::size_t index)
+{
+    beast::setCurrentThreadName("apply #" + std::to_string(index));
+
+    std::uint64_t seen = 0;
+    while (true)
+    {
+        std::function<void()> const* task;
+        {
+            std::unique_lock lock(mutex_);
+            wake_.wait(
+                lock, [&] { return stopping_ || generation_ != seen; });
+            if (stopping_)
+                return;
+            seen = generation_;
+            task = task_;
+        }
+
+        (*task)();
+
+        std::lock_guard lock(mutex_);
+        if (--running_ == 0)
+            done_.notify_all();
+    }
+}
+
+}  // namespace ripple
@@ -0,0 +1,125 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_LEDGER_PARALLELAPPLY_H_INCLUDED
+#define RIPPLE_APP_LEDGER_PARALLELAPPLY_H_INCLUDED
+
+#include <ripple/app/misc/CanonicalTXSet.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/protocol/Protocol.h>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+class Application;
+class Ledger;
+class OpenView;
+
+/** Applies consensus transactions speculatively on several threads.
+
+    A pass takes the transactions a window at a time. Each transaction in
+    the window is applied on its own thread to a view of its own over the
+    ledger being built, which notes the state it reads. The results are
+    then committed in canonical order. A transaction which read or changed
+    state that an earlier one in the window changed is applied again, now
+    that the earlier changes are in place.
+
+    Every transaction committed thus saw the same state it would have seen
+    had the transactions been applied one at a time, so the ledger built is
+    the same.
+
+    The Application keeps one engine, and its threads, for as long as it
+    runs. Passes are made one at a time.
+
+    Applying a transaction only changes the view it's applied to, with one
+    exception: speculatively applied transactions whose result is discarded
+    may still have set flags in the HashRouter, such as those noting a
+    valid signature or a transaction emitted by a hook.
+*/
+class ParallelApply
+{
+public:
+    /** Create an engine using a number of threads, the caller included. */
+    ParallelApply(Application& app, std::size_t threads, beast::Journal j);
+
+    ~ParallelApply();
+
+    ParallelApply(ParallelApply const&) = delete;
+    ParallelApply&
+    operator=(ParallelApply const&) = delete;
+
+    /** Make one pass over the transactions, as applyTransactions does.
+
+        @param built The ledger being built
+        @param txns The transactions to apply; those to retry are left
+        @param failed Populated with the transactions that failed
+        @param view The view accumulating the ledger's changes
+        @param first Whether this is the first pass
+        @param certainRetry Whether transactions will be retried
+        @return The number of transactions applied
+    */
+    int
+    pass(
+        std::shared_ptr<Ledger const> const& built,
+        CanonicalTXSet& txns,
+        std::set<TxID>& failed,
+        OpenView& view,
+        bool first,
+        bool certainRetry);
+
+private:
+    struct Speculation;
+
+    void
+    speculate(Speculation& s, OpenView const& view, bool certainRetry);
+
+    // Runs a task on every thread, returning once all have finished it
+    void
+    runOnAll(std::function<void()> const& task);
+
+    void
+    work(std::size_t index);
+
+    Application& app_;
+    beast::Journal const j_;
+    std::size_t const window_;
+
+    // Held for a whole pass
+    std::mutex passMutex_;
+
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::condition_variable done_;
+    std::function<void()> const* task_ = nullptr;
+    std::uint64_t generation_ = 0;
+    std::size_t running_ = 0;
+    bool stopping_ = false;
+    std::vector<std::thread> workers_;
+};
+
+}  // namespace ripple
+
+#endif
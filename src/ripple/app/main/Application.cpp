@@ -18,6 +18,10 @@
 //==============================================================================
 
 #include <ripple/app/consensus/RCLValidations.h>
+#include <ripple/app/hook/HookInstancePool.h>
+#include <ripple/app/hook/HookProfiler.h>
+#include <ripple/app/hook/HookStatePrefetch.h>
+#include <ripple/app/hook/applyHook.h>
 #include <ripple/app/ledger/InboundLedgers.h>
 #include <ripple/app/ledger/InboundTransactions.h>
 #include <ripple/app/ledger/LedgerCleaner.h>
@@ -27,6 +31,7 @@
 #include <ripple/app/ledger/OpenLedger.h>
 #include <ripple/app/ledger/OrderBookDB.h>
 #include <ripple/app/ledger/PendingSaves.h>
+#include <ripple/app/ledger/impl/ParallelApply.h>
 #include <ripple/app/ledger/TransactionMaster.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/main/BasicApp.h>
@@ -41,6 +46,7 @@
 #include <ripple/app/misc/LoadFeeTrack.h>
 #include <ripple/app/misc/NetworkOPs.h>
 #include <ripple/app/misc/SHAMapStore.h>
+#include <ripple/app/misc/SigVerifier.h>
 #include <ripple/app/misc/TxQ.h>
 #include <ripple/app/misc/ValidatorKeys.h>
 #include <ripple/app/misc/ValidatorSite.h>
@@ -215,6 +221,8 @@ public:
     std::unique_ptr<AmendmentTable> m_amendmentTable;
     std::unique_ptr<LoadFeeTrack> mFeeTrack;
     std::unique_ptr<HashRouter> hashRouter_;
+    std::unique_ptr<SigVerifier> sigVerifier_;
+    std::unique_ptr<ParallelApply> parallelApply_;
     RCLValidations mValidations;
     std::unique_ptr<LoadManager> m_loadManager;
     std::unique_ptr<TxQ> txQ_;
@@ -801,6 +809,22 @@ public:
         return *hashRouter_;
     }
 
+    // Signatures are checked in batches only if the server is configured
+    // with threads to do it. Otherwise this returns a nullptr.
+    SigVerifier*
+    getSigVerifier() override
+    {
+        return sigVerifier_.get();
+    }
+
+    // Consensus transactions are applied on several threads only if the
+    // server is configured with them. Otherwise this returns a nullptr.
+    ParallelApply*
+    getParallelApply() override
+    {
+        return parallelApply_.get();
+    }
+
     RCLValidations&
     getValidations() override
     {
@@ -1181,6 +1205,19 @@ ApplicationImp::setup(boost::program_options::variables_map const& cmdline)
     if (!initRelationalDatabase() || !initNodeStore())
         return false;
 
+    hook::HookModuleCache::instance().setBudget(
+        config_->HOOK_MODULE_CACHE_SIZE);
+    hook::HookInstancePool::instance().setSize(
+        config_->HOOK_INSTANCE_POOL_SIZE);
+    hook::HookStatePrefetcher::instance().setEnabled(
+        config_->HOOK_STATE_PREFETCH);
+    hook::HookProfiler::instance().setEnabled(config_->HOOK_PROFILE);
+    hook::HookProfiler::instance().attach(m_collectorManager->collector());
+
+    // build the shared Hook API import module now rather than on the first
+    // hook execution
+    hook::HookExecutor::importModule();
+
     if (shardStore_)
     {
         shardFamily_ =
@@ -1542,6 +1579,16 @@ ApplicationImp::start(bool withTimers)
     m_resolver->start();
     m_loadManager->start();
     m_shaMapStore->start();
+    if (config_->SIG_VERIFY_WORKERS > 0)
+        sigVerifier_ = std::make_unique<SigVerifier>(
+            *this,
+            config_->SIG_VERIFY_WORKERS,
+            logs_->journal("SigVerifier"));
+    if (config_->PARALLEL_APPLY_THREADS > 1)
+        parallelApply_ = std::make_unique<ParallelApply>(
+            *this,
+            config_->PARALLEL_APPLY_THREADS,
+            logs_->journal("ParallelApply"));
     if (overlay_)
         overlay_->start();
     grpcServer_->start();
@@ -1628,6 +1675,8 @@ ApplicationImp::run()
     // Re-ordering them risks undefined behavior.
     m_loadManager->stop();
     m_shaMapStore->stop();
+    if (sigVerifier_)
+        sigVerifier_->stop();
     m_jobQueue->stop();
     if (shardArchiveHandler_)
         shardArchiveHandler_->stop();
@@ -1648,6 +1697,7 @@ ApplicationImp::run()
         pg->stop();
     m_nodeStore->stop();
     perfLog_->stop();
+    hook::HookProfiler::instance().detach();
 
     JLOG(m_journal.info()) << "Done.";
 }
@@ -85,10 +85,12 @@ class NetworkOPs;
 class OpenLedger;
 class OrderBookDB;
 class Overlay;
+class ParallelApply;
 class PathRequests;
 class PendingSaves;
 class PublicKey;
 class SecretKey;
+class SigVerifier;
 class STLedgerEntry;
 class TimeKeeper;
 class TransactionMaster;
@@ -184,6 +186,10 @@ public:
     getAmendmentTable() = 0;
     virtual HashRouter&
     getHashRouter() = 0;
+    virtual SigVerifier*
+    getSigVerifier() = 0;
+    virtual ParallelApply*
+    getParallelApply() = 0;
     virtual LoadFeeTrack&
     getFeeTrack() = 0;
     virtual LoadManager&
@@ -29,7 +29,13 @@
 #include <ripple/core/TimeKeeper.h>
 #include <ripple/json/to_string.h>
 #include <ripple/net/RPCCall.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/nodestore/impl/ZstdDictionary.h>
+#include <ripple/nodestore/impl/codec.h>
 #include <ripple/protocol/BuildInfo.h>
+#include <ripple/protocol/Serializer.h>
 #include <ripple/resource/Fees.h>
 #include <ripple/rpc/RPCHandler.h>
 
@@ -340,6 +346,88 @@ runUnitTests(
 }
 
 #endif  // ENABLE_TESTS
+
+/** Train a zstd dictionary on the objects in [node_db] and add it to the
+    zstd_dictionaries directory. Backends compress with it once restarted.
+*/
+static int
+trainDictionary(Config const& config)
+{
+    using namespace NodeStore;
+
+    // About a hundred times the dictionary size is what zstd recommends
+    static constexpr std::size_t sampleBytes =
+        100 * ZstdDictionary::defaultBytes;
+
+    auto const& section = config.section(ConfigSection::nodeDatabase());
+    std::string dir;
+    if (!get_if_exists(section, "zstd_dictionaries", dir) || dir.empty())
+    {
+        std::cerr << "train-dictionary: zstd_dictionaries must be set in ["
+                  << ConfigSection::nodeDatabase() << "]\n";
+        return -1;
+    }
+
+    DummyScheduler scheduler;
+    auto backend = Manager::instance().make_Backend(
+        section,
+        megabytes(config.getValueFor(SizedItem::burstSize, std::nullopt)),
+        scheduler,
+        beast::Journal{beast::Journal::getNullSink()});
+    backend->open(false);
+
+    // Inner nodes have their own encodings, so only leaves and ledger
+    // headers are worth sampling.
+    struct Enough
+    {
+    };
+    std::vector<Blob> samples;
+    std::size_t total = 0;
+    try
+    {
+        backend->for_each([&](std::shared_ptr<NodeObject> object) {
+            auto const& data = object->getData();
+            if (data.size() >= 4 &&
+                SerialIter(data.data(), 4).get32() ==
+                    safe_cast<std::uint32_t>(HashPrefix::innerNode))
+                return;
+
+            EncodedBlob const e(object);
+            auto const p = reinterpret_cast<std::uint8_t const*>(e.getData());
+            samples.emplace_back(p, p + e.getSize());
+            total += e.getSize();
+            if (total >= sampleBytes)
+                throw Enough{};
+        });
+    }
+    catch (Enough const&)
+    {
+    }
+    backend->close();
+
+    auto dictionary = std::make_unique<ZstdDictionary>(
+        ZstdDictionary::train(samples));
+
+    std::size_t lz4 = 0;
+    std::size_t zstd = 0;
+    nudb::detail::buffer bf;
+    for (auto const& sample : samples)
+    {
+        lz4 += nodeobject_compress(sample.data(), sample.size(), bf).second;
+        zstd += nodeobject_compress(
+                    sample.data(), sample.size(), bf, dictionary.get())
+                    .second;
+    }
+
+    dictionary->save(dir);
+    std::cout << "Dictionary " << dictionary->id() << " ("
+              << dictionary->content().size() << " bytes) trained on "
+              << samples.size() << " objects, " << total
+              << " bytes. Compressed size: lz4 " << lz4 << ", zstd " << zstd
+              << "." << std::endl;
+    return 0;
+}
+
 //------------------------------------------------------------------------------
 
 int
@@ -397,6 +485,8 @@ run(int argc, char** argv)
         "startReporting",
         po::value<std::string>(),
         "Start reporting from a fresh Ledger.")(
+        "train-dictionary",
+        "Train a compression dictionary on the node store.")(
         "vacuum", "VACUUM the transaction db.")(
         "valid", "Consider the initial ledger a valid network ledger.");
 
@@ -602,6 +692,20 @@ run(int argc, char** argv)
         return 0;
     }
 
+    if (vm.count("train-dictionary"))
+    {
+        try
+        {
+            return trainDictionary(*config);
+        }
+        catch (std::exception const& e)
+        {
+            std::cerr << "exception " << e.what() << " in function " << __func__
+                      << std::endl;
+            return -1;
+        }
+    }
+
     if (vm.count("start"))
     {
         config->START_UP = Config::FRESH;
@@ -64,4 +64,13 @@ NodeStoreScheduler::onBatchWrite(NodeStore::BatchWriteReport const& report)
     jobQueue_.addLoadEvents(jtNS_WRITE, report.writeCount, report.elapsed);
 }
 
+void
+NodeStoreScheduler::scheduleCompletions(std::function<void()> f)
+{
+    // The callbacks must run, so run them here if the queue won't
+    if (jobQueue_.isStopped() ||
+        !jobQueue_.addJob(jtFETCH_DONE, "NodeObject::fetched", f))
+        f();
+}
+
 }  // namespace ripple
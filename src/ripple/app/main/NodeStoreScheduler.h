@@ -38,6 +38,8 @@ public:
     onFetch(NodeStore::FetchReport const& report) override;
     void
     onBatchWrite(NodeStore::BatchWriteReport const& report) override;
+    void
+    scheduleCompletions(std::function<void()> f) override;
 
 private:
     JobQueue& jobQueue_;
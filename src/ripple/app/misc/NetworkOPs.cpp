@@ -33,6 +33,7 @@
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/app/misc/SigVerifier.h>
 #include <ripple/app/misc/Transaction.h>
 #include <ripple/app/misc/TxQ.h>
 #include <ripple/app/misc/ValidatorKeys.h>
@@ -280,6 +281,10 @@ public:
     void
     submitTransaction(std::shared_ptr<STTx const> const&) override;
 
+    // Finishes submitTransaction, once the signature may have been checked
+    void
+    submitChecked(std::shared_ptr<STTx const> const& trans);
+
     void
     processTransaction(
         std::shared_ptr<Transaction>& transaction,
@@ -1172,6 +1177,18 @@ NetworkOPsImp::submitTransaction(std::shared_ptr<STTx const> const& iTrans)
         return;
     }
 
+    // Have the signature checked in a batch first if we can
+    auto const verifier = app_.getSigVerifier();
+    if (!verifier ||
+        !verifier->verify(trans, [this, trans]() { submitChecked(trans); }))
+        submitChecked(trans);
+}
+
+void
+NetworkOPsImp::submitChecked(std::shared_ptr<STTx const> const& trans)
+{
+    auto const txid = trans->getTransactionID();
+
     try
     {
         auto const [validity, reason] = checkValidity(
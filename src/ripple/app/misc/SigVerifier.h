@@ -0,0 +1,107 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_APP_MISC_SIGVERIFIER_H_INCLUDED
+#define RIPPLE_APP_MISC_SIGVERIFIER_H_INCLUDED
+
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/protocol/STTx.h>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+class Application;
+
+/** Checks transaction signatures in batches on threads of its own.
+
+    Transactions arriving from peers, or submitted, each had their
+    signature checked in a job before anything else was done with them.
+    When many arrive together, that work crowds out the rest of the job
+    queue. Instead, they can be queued here. Each thread takes up to
+    `batchSize` of those waiting at a time and checks their signatures with
+    `checkSignatures`, which caches the results in the HashRouter. It then
+    calls the callback given with each transaction, which typically queues
+    the job that goes on to call `checkValidity`.
+
+    Signatures are verified one by one, not with Ed25519 batch verification.
+    A batch can pass although a signature in it, with a small-order
+    component, fails on its own. Since the cached result is used when
+    building ledgers, relying on it could make this server disagree with
+    the rest of the network.
+*/
+class SigVerifier
+{
+public:
+    /** The most transactions a thread checks at a time. */
+    static constexpr std::size_t batchSize = 64;
+
+    /** The most transactions waiting to be checked. */
+    static constexpr std::size_t maxQueued = 8192;
+
+    SigVerifier(Application& app, std::size_t threads, beast::Journal j);
+
+    ~SigVerifier();
+
+    SigVerifier(SigVerifier const&) = delete;
+    SigVerifier&
+    operator=(SigVerifier const&) = delete;
+
+    /** Queue a transaction to have its signature checked.
+
+        Once checked, the callback is called on one of the verifier's
+        threads. It should do little more than queue the work that needs
+        the result.
+
+        @return false, without calling the callback, if too many
+                transactions are waiting or the verifier has stopped.
+    */
+    bool
+    verify(
+        std::shared_ptr<STTx const> const& tx,
+        std::function<void()> callback);
+
+    /** Stop the threads. Transactions still waiting are dropped. */
+    void
+    stop();
+
+private:
+    void
+    run(std::size_t index);
+
+    Application& app_;
+    beast::Journal const j_;
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<std::pair<std::shared_ptr<STTx const>, std::function<void()>>>
+        queue_;
+    bool stopping_ = false;
+
+    std::vector<std::thread> threads_;
+};
+
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,122 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/main/Application.h>
+#include <ripple/app/misc/SigVerifier.h>
+#include <ripple/app/tx/apply.h>
+#include <ripple/basics/Log.h>
+#include <ripple/beast/core/CurrentThreadName.h>
+#include <string>
+
+namespace ripple {
+
+SigVerifier::SigVerifier(
+    Application& app,
+    std::size_t threads,
+    beast::Journal j)
+    : app_(app), j_(j)
+{
+    for (std::size_t i = 0; i < threads; ++i)
+        threads_.emplace_back([this, i] { run(i); });
+}
+
+SigVerifier::~SigVerifier()
+{
+    stop();
+}
+
+bool
+SigVerifier::verify(
+    std::shared_ptr<STTx const> const& tx,
+    std::function<void()> callback)
+{
+    {
+        std::lock_guard lock(mutex_);
+        if (stopping_ || queue_.size() >= maxQueued)
+            return false;
+        queue_.emplace_back(tx, std::move(callback));
+    }
+    cond_.notify_one();
+    return true;
+}
+
+void
+SigVerifier::stop()
+{
+    {
+        std::lock_guard lock(mutex_);
+        if (stopping_)
+            return;
+        stopping_ = true;
+        queue_.clear();
+    }
+    cond_.notify_all();
+    for (auto& thread : threads_)
+        thread.join();
+}
+
+void
+SigVerifier::run(std::size_t index)
+{
+    beast::setCurrentThreadName("sigverify #" + std::to_string(index));
+
+    std::vector<std::shared_ptr<STTx const>> txs;
+    std::vector<std::function<void()>> callbacks;
+    txs.reserve(batchSize);
+    callbacks.reserve(batchSize);
+
+    while (true)
+    {
+        {
+            std::unique_lock lock(mutex_);
+            cond_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (stopping_)
+                return;
+
+            while (!queue_.empty() && txs.size() < batchSize)
+            {
+                txs.push_back(std::move(queue_.front().first));
+                callbacks.push_back(std::move(queue_.front().second));
+                queue_.pop_front();
+            }
+        }
+
+        try
+        {
+            checkSignatures(
+                app_.getHashRouter(),
+                txs,
+                app_.getLedgerMaster().getValidatedRules());
+        }
+        catch (std::exception const& ex)
+        {
+            // checkValidity will check the signatures left unknown
+            JLOG(j_.warn()) << "Exception checking signatures: " << ex.what();
+        }
+
+        for (auto& callback : callbacks)
+            callback();
+
+        txs.clear();
+        callbacks.clear();
+    }
+}
+
+}  // namespace ripple
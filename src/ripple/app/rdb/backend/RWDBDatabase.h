@@ -2,57 +2,131 @@
 #define RIPPLE_APP_RDB_BACKEND_MEMORYDATABASE_H_INCLUDED
 
 #include <ripple/app/ledger/AcceptedLedger.h>
+#include <ripple/app/ledger/InboundLedger.h>
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/ledger/LedgerToJson.h>
 #include <ripple/app/ledger/PendingSaves.h>
 #include <ripple/app/ledger/TransactionMaster.h>
 #include <ripple/app/misc/impl/AccountTxPaging.h>
 #include <ripple/app/rdb/backend/SQLiteDatabase.h>
+#include <ripple/basics/SnapshotFile.h>
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/beast/core/CurrentThreadName.h>
 #include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
 #include <map>
 #include <mutex>
 #include <optional>
 #include <shared_mutex>
+#include <thread>
+#include <tuple>
 #include <vector>
 
 namespace ripple {
 
+/** The relational database kept entirely in memory.
+
+    The ledgers, the transactions by hash and the transactions by account
+    each have their own locks, and the last two are split into shards by
+    hash and by account, so saving a validated ledger only ever holds one
+    small lock at a time. RPC readers of account_tx and tx carry on while a
+    ledger is saved, except for the brief moment it touches their shard.
+*/
 class RWDBDatabase : public SQLiteDatabase
 {
 private:
     struct LedgerData
     {
         LedgerInfo info;
-        std::map<uint256, AccountTx> transactions;
+        // in transaction index order
+        std::vector<AccountTx> transactions;
+    };
+
+    // A transaction that affected an account
+    struct AccountTxEntry
+    {
+        std::uint32_t ledgerSeq;
+        std::uint32_t txSeq;
+        AccountTx tx;
+    };
+
+    // Ordered by ledger then transaction index. Ledgers mostly arrive in
+    // order, so entries are nearly always added at the back and removed from
+    // the front.
+    using AccountTxEntries = std::vector<AccountTxEntry>;
+
+    static constexpr std::size_t shardCount = 16;
+
+    struct TxShard
+    {
+        mutable std::shared_mutex mutex;
+        hash_map<uint256, AccountTx> transactions;
     };
 
-    struct AccountTxData
+    struct AccountShard
     {
-        AccountTxs transactions;
-        std::map<uint32_t, std::map<uint32_t, size_t>>
-            ledgerTxMap;  // ledgerSeq -> txSeq -> index in transactions
+        mutable std::shared_mutex mutex;
+        hash_map<AccountID, AccountTxEntries> accounts;
     };
 
     Application& app_;
     bool const useTxTables_;
 
-    mutable std::shared_mutex mutex_;
-
+    // Lock order: ledgerMutex_ before any shard mutex, and never more than
+    // one shard at a time.
+    mutable std::shared_mutex ledgerMutex_;
     std::map<LedgerIndex, LedgerData> ledgers_;
-    std::map<uint256, LedgerIndex> ledgerHashToSeq_;
-    std::map<uint256, AccountTx> transactionMap_;
-    std::map<AccountID, AccountTxData> accountTxMap_;
+    hash_map<uint256, LedgerIndex> ledgerHashToSeq_;
+
+    std::array<TxShard, shardCount> txShards_;
+    std::array<AccountShard, shardCount> accountShards_;
+
+    // Optional on disk copy of the tables, reloaded on construction. It is
+    // rewritten in full, as ledgers are also deleted from the tables, by a
+    // background thread every snapshotInterval_ and on destruction.
+    static constexpr std::uint32_t snapshotTag = 0x4244474c;  // "LGDB"
+    enum SnapshotRecord : std::uint8_t { ledgerRecord = 1, txRecord = 2 };
+
+    boost::filesystem::path snapshotPath_;
+    std::chrono::seconds snapshotInterval_{0};
+
+    std::thread snapshotThread_;
+    std::mutex snapshotMutex_;
+    std::condition_variable snapshotCond_;
+    bool stopSnapshots_{false};
 
 public:
     RWDBDatabase(Application& app, Config const& config, JobQueue& jobQueue)
         : app_(app), useTxTables_(config.useTxTables())
     {
+        auto const& section = config.section(SECTION_RELATIONAL_DB);
+        bool snapshot = false;
+        get_if_exists(section, "snapshot", snapshot);
+        if (!snapshot)
+            return;
+
+        auto const dbPath = config.legacy("database_path");
+        if (dbPath.empty())
+            Throw<std::runtime_error>(
+                "RWDB snapshot requires a database_path");
+
+        boost::filesystem::create_directories(dbPath);
+        snapshotPath_ =
+            boost::filesystem::path(dbPath) / "rwdb_ledger.snapshot";
+        snapshotInterval_ = std::chrono::seconds(
+            get<std::uint32_t>(section, "snapshot_interval", 0));
+        loadSnapshot();
+
+        if (snapshotInterval_.count() > 0)
+            snapshotThread_ = std::thread(&RWDBDatabase::runSnapshots, this);
     }
 
     std::optional<LedgerIndex>
     getMinLedgerSeq() override
     {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::shared_lock<std::shared_mutex> lock(ledgerMutex_);
         if (ledgers_.empty())
             return std::nullopt;
         return ledgers_.begin()->first;
@@ -64,10 +138,13 @@ public:
         if (!useTxTables_)
             return {};
 
-        std::shared_lock<std::shared_mutex> lock(mutex_);
-        if (transactionMap_.empty())
-            return std::nullopt;
-        return transactionMap_.begin()->second.second->getLgrSeq();
+        std::shared_lock<std::shared_mutex> lock(ledgerMutex_);
+        for (auto const& [seq, ledgerData] : ledgers_)
+        {
+            if (!ledgerData.transactions.empty())
+                return seq;
+        }
+        return std::nullopt;
     }
 
     std::optional<LedgerIndex>
@@ -76,25 +153,24 @@ public:
         if (!useTxTables_)
             return {};
 
-        std::shared_lock<std::shared_mutex> lock(mutex_);
-        if (accountTxMap_.empty())
-            return std::nullopt;
-        LedgerIndex minSeq = std::numeric_limits<LedgerIndex>::max();
-        for (const auto& [_, accountData] : accountTxMap_)
+        std::optional<LedgerIndex> minSeq;
+        for (auto const& shard : accountShards_)
         {
-            if (!accountData.ledgerTxMap.empty())
-                minSeq =
-                    std::min(minSeq, accountData.ledgerTxMap.begin()->first);
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            for (auto const& [_, entries] : shard.accounts)
+            {
+                if (!entries.empty() &&
+                    (!minSeq || entries.front().ledgerSeq < *minSeq))
+                    minSeq = entries.front().ledgerSeq;
+            }
         }
-        return minSeq == std::numeric_limits<LedgerIndex>::max()
-            ? std::nullopt
-            : std::optional<LedgerIndex>(minSeq);
+        return minSeq;
     }
 
     std::optional<LedgerIndex>
     getMaxLedgerSeq() override
     {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::shared_lock<std::shared_mutex> lock(ledgerMutex_);
         if (ledgers_.empty())
             return std::nullopt;
         return ledgers_.rbegin()->first;
@@ -105,22 +181,21 @@ public:
         if (!useTxTables_)
             return;
 
-        std::unique_lock<std::shared_mutex> lock(mutex_);
-        auto it = ledgers_.find(ledgerSeq);
-        if (it != ledgers_.end())
+        std::vector<AccountTx> transactions;
         {
-            for (const auto& [txHash, _] : it->second.transactions)
-            {
-                transactionMap_.erase(txHash);
-            }
-            it->second.transactions.clear();
+            std::unique_lock<std::shared_mutex> lock(ledgerMutex_);
+            auto it = ledgers_.find(ledgerSeq);
+            if (it == ledgers_.end())
+                return;
+            transactions.swap(it->second.transactions);
         }
+        unindexTransactions(transactions);
     }
 
     void
     deleteBeforeLedgerSeq(LedgerIndex ledgerSeq) override
     {
-        std::unique_lock<std::shared_mutex> lock(mutex_);
+        std::unique_lock<std::shared_mutex> lock(ledgerMutex_);
         auto it = ledgers_.begin();
         while (it != ledgers_.end() && it->first < ledgerSeq)
         {
@@ -135,17 +210,23 @@ public:
         if (!useTxTables_)
             return;
 
-        std::unique_lock<std::shared_mutex> lock(mutex_);
-        auto it = ledgers_.begin();
-        while (it != ledgers_.end() && it->first < ledgerSeq)
+        std::vector<AccountTx> transactions;
         {
-            for (const auto& [txHash, _] : it->second.transactions)
+            std::unique_lock<std::shared_mutex> lock(ledgerMutex_);
+            auto it = ledgers_.begin();
+            while (it != ledgers_.end() && it->first < ledgerSeq)
             {
-                transactionMap_.erase(txHash);
+                auto& ledgerTxs = it->second.transactions;
+                transactions.insert(
+                    transactions.end(),
+                    std::make_move_iterator(ledgerTxs.begin()),
+                    std::make_move_iterator(ledgerTxs.end()));
+                ledgerTxs.clear();
+                ledgerTxs.shrink_to_fit();
+                ++it;
             }
-            it->second.transactions.clear();
-            ++it;
         }
+        unindexTransactions(transactions);
     }
 
     void
@@ -154,23 +235,27 @@ public:
         if (!useTxTables_)
             return;
 
-        std::unique_lock<std::shared_mutex> lock(mutex_);
-        for (auto& [_, accountData] : accountTxMap_)
+        for (auto& shard : accountShards_)
         {
-            auto txIt = accountData.ledgerTxMap.begin();
-            while (txIt != accountData.ledgerTxMap.end() &&
-                   txIt->first < ledgerSeq)
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.accounts.begin();
+            while (it != shard.accounts.end())
             {
-                txIt = accountData.ledgerTxMap.erase(txIt);
+                auto& entries = it->second;
+                entries.erase(
+                    entries.begin(),
+                    std::lower_bound(
+                        entries.begin(),
+                        entries.end(),
+                        ledgerSeq,
+                        [](AccountTxEntry const& entry, std::uint32_t seq) {
+                            return entry.ledgerSeq < seq;
+                        }));
+                if (entries.empty())
+                    it = shard.accounts.erase(it);
+                else
+                    ++it;
             }
-            accountData.transactions.erase(
-                std::remove_if(
-                    accountData.transactions.begin(),
-                    accountData.transactions.end(),
-                    [ledgerSeq](const AccountTx& tx) {
-                        return tx.second->getLgrSeq() < ledgerSeq;
-                    }),
-                accountData.transactions.end());
         }
     }
     std::size_t
@@ -179,8 +264,13 @@ public:
         if (!useTxTables_)
             return 0;
 
-        std::shared_lock<std::shared_mutex> lock(mutex_);
-        return transactionMap_.size();
+        std::size_t count = 0;
+        for (auto const& shard : txShards_)
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            count += shard.transactions.size();
+        }
+        return count;
     }
 
     std::size_t
@@ -189,11 +279,12 @@ public:
         if (!useTxTables_)
             return 0;
 
-        std::shared_lock<std::shared_mutex> lock(mutex_);
         std::size_t count = 0;
-        for (const auto& [_, accountData] : accountTxMap_)
+        for (auto const& shard : accountShards_)
         {
-            count += accountData.transactions.size();
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            for (auto const& [_, entries] : shard.accounts)
+                count += entries.size();
         }
         return count;
     }
@@ -201,7 +292,7 @@ public:
     CountMinMax
     getLedgerCountMinMax() override
     {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::shared_lock<std::shared_mutex> lock(ledgerMutex_);
         if (ledgers_.empty())
             return {0, 0, 0};
         return {
@@ -213,7 +304,6 @@ public:
         std::shared_ptr<Ledger const> const& ledger,
         bool current) override
     {
-        std::unique_lock<std::shared_mutex> lock(mutex_);
         LedgerData ledgerData;
         ledgerData.info = ledger->info();
         auto j = app_.journal("Ledger");
@@ -273,50 +363,49 @@ public:
         // Overwrite Current Ledger Transactions
         if (useTxTables_)
         {
+            ledgerData.transactions.reserve(aLedger->size());
             for (auto const& acceptedLedgerTx : *aLedger)
             {
-                auto const& txn = acceptedLedgerTx->getTxn();
-                auto const& meta = acceptedLedgerTx->getMeta();
-                auto const& id = txn->getTransactionID();
                 std::string reason;
+                ledgerData.transactions.emplace_back(
+                    std::make_shared<ripple::Transaction>(
+                        acceptedLedgerTx->getTxn(), reason, app_),
+                    std::make_shared<ripple::TxMeta>(
+                        acceptedLedgerTx->getMeta()));
+            }
+        }
 
-                auto accTx = std::make_pair(
-                    std::make_shared<ripple::Transaction>(txn, reason, app_),
-                    std::make_shared<ripple::TxMeta>(meta));
-
-                ledgerData.transactions.emplace(id, accTx);
-                transactionMap_.emplace(id, accTx);
+        // Overwrite Current Ledger. This happens before its transactions
+        // are indexed, so that tx and account_tx never return a transaction
+        // whose ledger can't be found yet.
+        auto const transactions = ledgerData.transactions;
+        {
+            std::unique_lock<std::shared_mutex> lock(ledgerMutex_);
+            insertLedger(std::move(ledgerData));
+        }
 
-                for (auto const& account : meta.getAffectedAccounts())
-                {
-                    if (accountTxMap_.find(account) == accountTxMap_.end())
-                        accountTxMap_[account] = AccountTxData();
-
-                    auto& accountData = accountTxMap_[account];
-                    accountData.transactions.push_back(accTx);
-                    accountData
-                        .ledgerTxMap[seq][acceptedLedgerTx->getTxnSeq()] =
-                        accountData.transactions.size() - 1;
-                }
+        if (useTxTables_)
+        {
+            for (auto const& accTx : transactions)
+                indexTransaction(seq, accTx);
 
+            for (auto const& acceptedLedgerTx : *aLedger)
+            {
                 app_.getMasterTransaction().inLedger(
-                    id,
+                    acceptedLedgerTx->getTxn()->getTransactionID(),
                     seq,
                     acceptedLedgerTx->getTxnSeq(),
                     app_.config().NETWORK_ID);
             }
         }
 
-        // Overwrite Current Ledger
-        ledgers_[seq] = std::move(ledgerData);
-        ledgerHashToSeq_[ledger->info().hash] = seq;
         return true;
     }
 
     std::optional<LedgerInfo>
     getLedgerInfoByIndex(LedgerIndex ledgerSeq) override
     {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::shared_lock<std::shared_mutex> lock(ledgerMutex_);
         auto it = ledgers_.find(ledgerSeq);
         if (it != ledgers_.end())
             return it->second.info;
@@ -326,7 +415,7 @@ public:
     std::optional<LedgerInfo>
     getNewestLedgerInfo() override
     {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::shared_lock<std::shared_mutex> lock(ledgerMutex_);
         if (ledgers_.empty())
             return std::nullopt;
         return ledgers_.rbegin()->second.info;
@@ -335,7 +424,7 @@ public:
     std::optional<LedgerInfo>
     getLimitedOldestLedgerInfo(LedgerIndex ledgerFirstIndex) override
     {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::shared_lock<std::shared_mutex> lock(ledgerMutex_);
         auto it = ledgers_.lower_bound(ledgerFirstIndex);
         if (it != ledgers_.end())
             return it->second.info;
@@ -345,7 +434,7 @@ public:
     std::optional<LedgerInfo>
     getLimitedNewestLedgerInfo(LedgerIndex ledgerFirstIndex) override
     {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::shared_lock<std::shared_mutex> lock(ledgerMutex_);
         auto it = ledgers_.lower_bound(ledgerFirstIndex);
         if (it == ledgers_.end())
             return std::nullopt;
@@ -355,7 +444,7 @@ public:
     std::optional<LedgerInfo>
     getLedgerInfoByHash(uint256 const& ledgerHash) override
     {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::shared_lock<std::shared_mutex> lock(ledgerMutex_);
         auto it = ledgerHashToSeq_.find(ledgerHash);
         if (it != ledgerHashToSeq_.end())
             return ledgers_.at(it->second).info;
@@ -364,7 +453,7 @@ public:
     uint256
     getHashByIndex(LedgerIndex ledgerIndex) override
     {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::shared_lock<std::shared_mutex> lock(ledgerMutex_);
         auto it = ledgers_.find(ledgerIndex);
         if (it != ledgers_.end())
             return it->second.info.hash;
@@ -374,7 +463,7 @@ public:
     std::optional<LedgerHashPair>
     getHashesByIndex(LedgerIndex ledgerIndex) override
     {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::shared_lock<std::shared_mutex> lock(ledgerMutex_);
         auto it = ledgers_.find(ledgerIndex);
         if (it != ledgers_.end())
         {
@@ -387,7 +476,7 @@ public:
     std::map<LedgerIndex, LedgerHashPair>
     getHashesByIndex(LedgerIndex minSeq, LedgerIndex maxSeq) override
     {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
+        std::shared_lock<std::shared_mutex> lock(ledgerMutex_);
         std::map<LedgerIndex, LedgerHashPair> result;
         auto it = ledgers_.lower_bound(minSeq);
         auto end = ledgers_.upper_bound(maxSeq);
@@ -408,28 +497,35 @@ public:
         if (!useTxTables_)
             return TxSearched::unknown;
 
-        std::shared_lock<std::shared_mutex> lock(mutex_);
-        auto it = transactionMap_.find(id);
-        if (it != transactionMap_.end())
+        std::optional<AccountTx> found;
         {
-            const auto& [txn, txMeta] = it->second;
+            auto const& shard = txShards_[shardOf(id)];
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.transactions.find(id);
+            if (it != shard.transactions.end())
+                found = it->second;
+        }
+
+        if (found)
+        {
+            const auto& [txn, txMeta] = *found;
             std::uint32_t inLedger =
                 rangeCheckedCast<std::uint32_t>(txMeta->getLgrSeq());
-            it->second.first->setStatus(COMMITTED);
-            it->second.first->setLedger(inLedger);
-            return it->second;
+            txn->setStatus(COMMITTED);
+            txn->setLedger(inLedger);
+            return *found;
         }
 
         if (range)
         {
+            std::shared_lock<std::shared_mutex> lock(ledgerMutex_);
             std::size_t count = 0;
-            for (LedgerIndex seq = range->first(); seq <= range->last(); ++seq)
+            auto it = ledgers_.lower_bound(range->first());
+            auto end = ledgers_.upper_bound(range->last());
+            for (; it != end; ++it)
             {
-                if (ledgers_.find(seq) != ledgers_.end())
-                {
-                    if (ledgers_[seq].transactions.size() > 0)
-                        ++count;
-                }
+                if (!it->second.transactions.empty())
+                    ++count;
             }
             return (count == (range->last() - range->first() + 1))
                 ? TxSearched::all
@@ -454,34 +550,13 @@ public:
     std::uint32_t
     getKBUsedAll() override
     {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
-        std::uint32_t size = sizeof(*this);
-        size += ledgers_.size() * (sizeof(LedgerIndex) + sizeof(LedgerData));
-        size +=
-            ledgerHashToSeq_.size() * (sizeof(uint256) + sizeof(LedgerIndex));
-        size += transactionMap_.size() * (sizeof(uint256) + sizeof(AccountTx));
-        for (const auto& [_, accountData] : accountTxMap_)
-        {
-            size += sizeof(AccountID) + sizeof(AccountTxData);
-            size += accountData.transactions.size() * sizeof(AccountTx);
-            for (const auto& [_, innerMap] : accountData.ledgerTxMap)
-            {
-                size += sizeof(uint32_t) +
-                    innerMap.size() * (sizeof(uint32_t) + sizeof(size_t));
-            }
-        }
-        return size / 1024;
+        return (sizeof(*this) + ledgerBytes() + transactionBytes()) / 1024;
     }
 
     std::uint32_t
     getKBUsedLedger() override
     {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
-        std::uint32_t size = 0;
-        size += ledgers_.size() * (sizeof(LedgerIndex) + sizeof(LedgerData));
-        size +=
-            ledgerHashToSeq_.size() * (sizeof(uint256) + sizeof(LedgerIndex));
-        return size / 1024;
+        return ledgerBytes() / 1024;
     }
 
     std::uint32_t
@@ -490,20 +565,7 @@ public:
         if (!useTxTables_)
             return 0;
 
-        std::shared_lock<std::shared_mutex> lock(mutex_);
-        std::uint32_t size = 0;
-        size += transactionMap_.size() * (sizeof(uint256) + sizeof(AccountTx));
-        for (const auto& [_, accountData] : accountTxMap_)
-        {
-            size += sizeof(AccountID) + sizeof(AccountTxData);
-            size += accountData.transactions.size() * sizeof(AccountTx);
-            for (const auto& [_, innerMap] : accountData.ledgerTxMap)
-            {
-                size += sizeof(uint32_t) +
-                    innerMap.size() * (sizeof(uint32_t) + sizeof(size_t));
-            }
-        }
-        return size / 1024;
+        return transactionBytes() / 1024;
     }
 
     void
@@ -520,13 +582,33 @@ public:
 
     ~RWDBDatabase()
     {
-        // Regular maps can use standard clear
-        accountTxMap_.clear();
-        transactionMap_.clear();
-        for (auto& ledger : ledgers_)
+        if (snapshotThread_.joinable())
         {
-            ledger.second.transactions.clear();
+            {
+                std::lock_guard lock(snapshotMutex_);
+                stopSnapshots_ = true;
+            }
+            snapshotCond_.notify_all();
+            snapshotThread_.join();
         }
+
+        if (!snapshotPath_.empty())
+        {
+            try
+            {
+                saveSnapshot();
+            }
+            catch (std::exception const& e)
+            {
+                JLOG(app_.journal("Ledger").error())
+                    << "RWDB snapshot: " << e.what();
+            }
+        }
+
+        for (auto& shard : accountShards_)
+            shard.accounts.clear();
+        for (auto& shard : txShards_)
+            shard.transactions.clear();
         ledgers_.clear();
         ledgerHashToSeq_.clear();
     }
@@ -537,51 +619,41 @@ public:
         if (!useTxTables_)
             return {};
 
-        std::shared_lock<std::shared_mutex> lock(mutex_);
-        std::vector<std::shared_ptr<Transaction>> result;
-
-        int skipped = 0;
-        int collected = 0;
-
-        for (auto it = ledgers_.rbegin(); it != ledgers_.rend(); ++it)
+        std::vector<AccountTx> found;
         {
-            const auto& transactions = it->second.transactions;
-            for (const auto& [txHash, accountTx] : transactions)
+            std::shared_lock<std::shared_mutex> lock(ledgerMutex_);
+
+            std::size_t skipped = 0;
+            for (auto it = ledgers_.rbegin();
+                 it != ledgers_.rend() && found.size() < 20;
+                 ++it)
             {
-                if (skipped < startIndex)
+                for (auto const& accountTx : it->second.transactions)
                 {
-                    ++skipped;
-                    continue;
-                }
+                    if (skipped < startIndex)
+                    {
+                        ++skipped;
+                        continue;
+                    }
 
-                if (collected >= 20)
-                {
-                    break;
+                    found.push_back(accountTx);
+                    if (found.size() >= 20)
+                        break;
                 }
-
-                std::uint32_t const inLedger = rangeCheckedCast<std::uint32_t>(
-                    accountTx.second->getLgrSeq());
-                accountTx.first->setStatus(COMMITTED);
-                accountTx.first->setLedger(inLedger);
-                result.push_back(accountTx.first);
-                ++collected;
             }
-
-            if (collected >= 20)
-                break;
         }
-        return result;
-    }
 
-    // Helper function to handle limits
-    template <typename Container>
-    void
-    applyLimit(Container& container, std::size_t limit, bool bUnlimited)
-    {
-        if (!bUnlimited && limit > 0 && container.size() > limit)
+        std::vector<std::shared_ptr<Transaction>> result;
+        result.reserve(found.size());
+        for (auto const& [txn, txMeta] : found)
         {
-            container.resize(limit);
+            std::uint32_t const inLedger =
+                rangeCheckedCast<std::uint32_t>(txMeta->getLgrSeq());
+            txn->setStatus(COMMITTED);
+            txn->setLedger(inLedger);
+            result.push_back(txn);
         }
+        return result;
     }
 
     AccountTxs
@@ -590,39 +662,15 @@ public:
         if (!useTxTables_)
             return {};
 
-        std::shared_lock<std::shared_mutex> lock(mutex_);
-        auto it = accountTxMap_.find(options.account);
-        if (it == accountTxMap_.end())
-            return {};
-
         AccountTxs result;
-        const auto& accountData = it->second;
-        auto txIt = accountData.ledgerTxMap.lower_bound(options.minLedger);
-        auto txEnd = accountData.ledgerTxMap.upper_bound(options.maxLedger);
-
-        std::size_t skipped = 0;
-        for (; txIt != txEnd &&
-             (options.bUnlimited || result.size() < options.limit);
-             ++txIt)
+        for (auto& entry : findAccountTxs(options, true))
         {
-            for (const auto& [txSeq, txIndex] : txIt->second)
-            {
-                if (skipped < options.offset)
-                {
-                    ++skipped;
-                    continue;
-                }
-                AccountTx const accountTx = accountData.transactions[txIndex];
-                std::uint32_t const inLedger = rangeCheckedCast<std::uint32_t>(
-                    accountTx.second->getLgrSeq());
-                accountTx.first->setStatus(COMMITTED);
-                accountTx.first->setLedger(inLedger);
-                result.push_back(accountTx);
-                if (!options.bUnlimited && result.size() >= options.limit)
-                    break;
-            }
+            std::uint32_t const inLedger = rangeCheckedCast<std::uint32_t>(
+                entry.tx.second->getLgrSeq());
+            entry.tx.first->setStatus(COMMITTED);
+            entry.tx.first->setLedger(inLedger);
+            result.push_back(std::move(entry.tx));
         }
-
         return result;
     }
 
@@ -632,42 +680,15 @@ public:
         if (!useTxTables_)
             return {};
 
-        std::shared_lock<std::shared_mutex> lock(mutex_);
-        auto it = accountTxMap_.find(options.account);
-        if (it == accountTxMap_.end())
-            return {};
-
         AccountTxs result;
-        const auto& accountData = it->second;
-        auto txIt = accountData.ledgerTxMap.lower_bound(options.minLedger);
-        auto txEnd = accountData.ledgerTxMap.upper_bound(options.maxLedger);
-
-        std::size_t skipped = 0;
-        for (auto rIt = std::make_reverse_iterator(txEnd);
-             rIt != std::make_reverse_iterator(txIt) &&
-             (options.bUnlimited || result.size() < options.limit);
-             ++rIt)
+        for (auto& entry : findAccountTxs(options, false))
         {
-            for (auto innerRIt = rIt->second.rbegin();
-                 innerRIt != rIt->second.rend();
-                 ++innerRIt)
-            {
-                if (skipped < options.offset)
-                {
-                    ++skipped;
-                    continue;
-                }
-                AccountTx const accountTx =
-                    accountData.transactions[innerRIt->second];
-                std::uint32_t const inLedger = rangeCheckedCast<std::uint32_t>(
-                    accountTx.second->getLgrSeq());
-                accountTx.first->setLedger(inLedger);
-                result.push_back(accountTx);
-                if (!options.bUnlimited && result.size() >= options.limit)
-                    break;
-            }
+            std::uint32_t const inLedger = rangeCheckedCast<std::uint32_t>(
+                entry.tx.second->getLgrSeq());
+            entry.tx.first->setStatus(COMMITTED);
+            entry.tx.first->setLedger(inLedger);
+            result.push_back(std::move(entry.tx));
         }
-
         return result;
     }
 
@@ -677,38 +698,15 @@ public:
         if (!useTxTables_)
             return {};
 
-        std::shared_lock<std::shared_mutex> lock(mutex_);
-        auto it = accountTxMap_.find(options.account);
-        if (it == accountTxMap_.end())
-            return {};
-
         MetaTxsList result;
-        const auto& accountData = it->second;
-        auto txIt = accountData.ledgerTxMap.lower_bound(options.minLedger);
-        auto txEnd = accountData.ledgerTxMap.upper_bound(options.maxLedger);
-
-        std::size_t skipped = 0;
-        for (; txIt != txEnd &&
-             (options.bUnlimited || result.size() < options.limit);
-             ++txIt)
+        for (auto const& entry : findAccountTxs(options, true))
         {
-            for (const auto& [txSeq, txIndex] : txIt->second)
-            {
-                if (skipped < options.offset)
-                {
-                    ++skipped;
-                    continue;
-                }
-                const auto& [txn, txMeta] = accountData.transactions[txIndex];
-                result.emplace_back(
-                    txn->getSTransaction()->getSerializer().peekData(),
-                    txMeta->getAsObject().getSerializer().peekData(),
-                    txIt->first);
-                if (!options.bUnlimited && result.size() >= options.limit)
-                    break;
-            }
+            auto const& [txn, txMeta] = entry.tx;
+            result.emplace_back(
+                txn->getSTransaction()->getSerializer().peekData(),
+                txMeta->getAsObject().getSerializer().peekData(),
+                entry.ledgerSeq);
         }
-
         return result;
     }
 
@@ -718,42 +716,15 @@ public:
         if (!useTxTables_)
             return {};
 
-        std::shared_lock<std::shared_mutex> lock(mutex_);
-        auto it = accountTxMap_.find(options.account);
-        if (it == accountTxMap_.end())
-            return {};
-
         MetaTxsList result;
-        const auto& accountData = it->second;
-        auto txIt = accountData.ledgerTxMap.lower_bound(options.minLedger);
-        auto txEnd = accountData.ledgerTxMap.upper_bound(options.maxLedger);
-
-        std::size_t skipped = 0;
-        for (auto rIt = std::make_reverse_iterator(txEnd);
-             rIt != std::make_reverse_iterator(txIt) &&
-             (options.bUnlimited || result.size() < options.limit);
-             ++rIt)
+        for (auto const& entry : findAccountTxs(options, false))
         {
-            for (auto innerRIt = rIt->second.rbegin();
-                 innerRIt != rIt->second.rend();
-                 ++innerRIt)
-            {
-                if (skipped < options.offset)
-                {
-                    ++skipped;
-                    continue;
-                }
-                const auto& [txn, txMeta] =
-                    accountData.transactions[innerRIt->second];
-                result.emplace_back(
-                    txn->getSTransaction()->getSerializer().peekData(),
-                    txMeta->getAsObject().getSerializer().peekData(),
-                    rIt->first);
-                if (!options.bUnlimited && result.size() >= options.limit)
-                    break;
-            }
+            auto const& [txn, txMeta] = entry.tx;
+            result.emplace_back(
+                txn->getSTransaction()->getSerializer().peekData(),
+                txMeta->getAsObject().getSerializer().peekData(),
+                entry.ledgerSeq);
         }
-
         return result;
     }
 
@@ -768,13 +739,6 @@ public:
         std::uint32_t page_length,
         bool forward)
     {
-        std::shared_lock<std::shared_mutex> lock(mutex_);
-        auto it = accountTxMap_.find(options.account);
-        if (it == accountTxMap_.end())
-            return {std::nullopt, 0};
-
-        int total = 0;
-
         bool lookingForMarker = options.marker.has_value();
 
         std::uint32_t numberOfResults;
@@ -803,117 +767,81 @@ public:
             findSeq = options.marker->txnSeq;
         }
 
-        std::optional<RelationalDatabase::AccountTxMarker> newmarker;
-        if (limit_used > 0)
-            newmarker = options.marker;
-
-        if (forward)
+        // Pick out the page under the shard lock, and serialize it after
+        std::vector<AccountTxEntry> page;
         {
-            // Oldest (forward = true)
-            const auto& accountData = it->second;
-            auto txIt = accountData.ledgerTxMap.lower_bound(
-                findLedger == 0 ? options.minLedger : findLedger);
-            auto txEnd = accountData.ledgerTxMap.upper_bound(options.maxLedger);
-            for (; txIt != txEnd; ++txIt)
-            {
-                std::uint32_t const ledgerSeq = txIt->first;
-                for (auto seqIt = txIt->second.begin();
-                     seqIt != txIt->second.end();
-                     ++seqIt)
+            auto const& shard = accountShards_[shardOf(options.account)];
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.accounts.find(options.account);
+            if (it == shard.accounts.end())
+                return {std::nullopt, 0};
+
+            auto const take = [&](AccountTxEntry const& entry) {
+                if (lookingForMarker)
                 {
-                    const auto& [txnSeq, index] = *seqIt;
-                    if (lookingForMarker)
-                    {
-                        if (findLedger == ledgerSeq && findSeq == txnSeq)
-                        {
-                            lookingForMarker = false;
-                        }
-                        else
-                            continue;
-                    }
-                    else if (numberOfResults == 0)
-                    {
-                        newmarker = {
-                            rangeCheckedCast<std::uint32_t>(ledgerSeq), txnSeq};
-                        return {newmarker, total};
-                    }
-
-                    Blob rawTxn = accountData.transactions[index]
-                                      .first->getSTransaction()
-                                      ->getSerializer()
-                                      .peekData();
-                    Blob rawMeta = accountData.transactions[index]
-                                       .second->getAsObject()
-                                       .getSerializer()
-                                       .peekData();
-
-                    if (rawMeta.size() == 0)
-                        onUnsavedLedger(ledgerSeq);
-
-                    onTransaction(
-                        rangeCheckedCast<std::uint32_t>(ledgerSeq),
-                        "COMMITTED",
-                        std::move(rawTxn),
-                        std::move(rawMeta));
-                    --numberOfResults;
-                    ++total;
+                    if (findLedger != entry.ledgerSeq ||
+                        findSeq != entry.txSeq)
+                        return true;
+                    lookingForMarker = false;
                 }
+                page.push_back(entry);
+                return page.size() < queryLimit;
+            };
+
+            if (forward)
+            {
+                // Oldest (forward = true)
+                auto const [first, last] = ledgerRange(
+                    it->second,
+                    findLedger == 0 ? options.minLedger : findLedger,
+                    options.maxLedger);
+                for (auto entry = first; entry != last && take(*entry);
+                     ++entry)
+                    ;
+            }
+            else
+            {
+                // Newest (forward = false)
+                auto const [first, last] = ledgerRange(
+                    it->second,
+                    options.minLedger,
+                    findLedger == 0 ? options.maxLedger : findLedger);
+                for (auto entry = std::make_reverse_iterator(last);
+                     entry != std::make_reverse_iterator(first) &&
+                     take(*entry);
+                     ++entry)
+                    ;
             }
         }
-        else
+
+        std::optional<RelationalDatabase::AccountTxMarker> newmarker;
+        if (limit_used > 0)
+            newmarker = options.marker;
+
+        int total = 0;
+        for (auto const& entry : page)
         {
-            // Newest (forward = false)
-            const auto& accountData = it->second;
-            auto txIt = accountData.ledgerTxMap.lower_bound(options.minLedger);
-            auto txEnd = accountData.ledgerTxMap.upper_bound(
-                findLedger == 0 ? options.maxLedger : findLedger);
-            auto rtxIt = std::make_reverse_iterator(txEnd);
-            auto rtxEnd = std::make_reverse_iterator(txIt);
-            for (; rtxIt != rtxEnd; ++rtxIt)
+            if (numberOfResults == 0)
             {
-                std::uint32_t const ledgerSeq = rtxIt->first;
-                for (auto innerRIt = rtxIt->second.rbegin();
-                     innerRIt != rtxIt->second.rend();
-                     ++innerRIt)
-                {
-                    const auto& [txnSeq, index] = *innerRIt;
-                    if (lookingForMarker)
-                    {
-                        if (findLedger == ledgerSeq && findSeq == txnSeq)
-                        {
-                            lookingForMarker = false;
-                        }
-                        else
-                            continue;
-                    }
-                    else if (numberOfResults == 0)
-                    {
-                        newmarker = {
-                            rangeCheckedCast<std::uint32_t>(ledgerSeq), txnSeq};
-                        return {newmarker, total};
-                    }
-
-                    Blob rawTxn = accountData.transactions[index]
-                                      .first->getSTransaction()
-                                      ->getSerializer()
-                                      .peekData();
-                    Blob rawMeta = accountData.transactions[index]
-                                       .second->getAsObject()
-                                       .getSerializer()
-                                       .peekData();
-
-                    if (rawMeta.size() == 0)
-                        onUnsavedLedger(ledgerSeq);
-
-                    onTransaction(
-                        rangeCheckedCast<std::uint32_t>(ledgerSeq),
-                        "COMMITTED",
-                        std::move(rawTxn),
-                        std::move(rawMeta));
-                    --numberOfResults;
-                    ++total;
-                }
+                newmarker = {entry.ledgerSeq, entry.txSeq};
+                break;
             }
+
+            Blob rawTxn =
+                entry.tx.first->getSTransaction()->getSerializer().peekData();
+            Blob rawMeta =
+                entry.tx.second->getAsObject().getSerializer().peekData();
+
+            if (rawMeta.size() == 0)
+                onUnsavedLedger(entry.ledgerSeq);
+
+            onTransaction(
+                entry.ledgerSeq,
+                "COMMITTED",
+                std::move(rawTxn),
+                std::move(rawMeta));
+            --numberOfResults;
+            ++total;
         }
         return {newmarker, total};
     }
@@ -1021,6 +949,307 @@ public:
                 .first;
         return {ret, newmarker};
     }
+
+private:
+    // Transaction ids and account ids are hashes, their first byte is as
+    // good a shard key as any.
+    template <std::size_t Bits, class Tag>
+    static std::size_t
+    shardOf(base_uint<Bits, Tag> const& key)
+    {
+        return key.data()[0] % shardCount;
+    }
+
+    static bool
+    entryLess(AccountTxEntry const& lhs, AccountTxEntry const& rhs)
+    {
+        return std::tie(lhs.ledgerSeq, lhs.txSeq) <
+            std::tie(rhs.ledgerSeq, rhs.txSeq);
+    }
+
+    // The entries of ledgers minLedger to maxLedger inclusive
+    static std::pair<
+        AccountTxEntries::const_iterator,
+        AccountTxEntries::const_iterator>
+    ledgerRange(
+        AccountTxEntries const& entries,
+        std::uint32_t minLedger,
+        std::uint32_t maxLedger)
+    {
+        auto const first = std::lower_bound(
+            entries.begin(),
+            entries.end(),
+            minLedger,
+            [](AccountTxEntry const& entry, std::uint32_t seq) {
+                return entry.ledgerSeq < seq;
+            });
+        auto const last = std::upper_bound(
+            first,
+            entries.end(),
+            maxLedger,
+            [](std::uint32_t seq, AccountTxEntry const& entry) {
+                return seq < entry.ledgerSeq;
+            });
+        return {first, last};
+    }
+
+    // The account's transactions in the options' ledger range, oldest or
+    // newest first, after skipping the offset and up to the limit.
+    std::vector<AccountTxEntry>
+    findAccountTxs(AccountTxOptions const& options, bool oldestFirst) const
+    {
+        std::vector<AccountTxEntry> result;
+
+        auto const& shard = accountShards_[shardOf(options.account)];
+        std::shared_lock<std::shared_mutex> lock(shard.mutex);
+        auto it = shard.accounts.find(options.account);
+        if (it == shard.accounts.end())
+            return result;
+
+        auto const [first, last] =
+            ledgerRange(it->second, options.minLedger, options.maxLedger);
+        std::size_t const available = last - first;
+        if (options.offset >= available)
+            return result;
+
+        std::size_t count = available - options.offset;
+        if (!options.bUnlimited)
+            count = std::min<std::size_t>(count, options.limit);
+
+        if (oldestFirst)
+        {
+            auto const begin = first + options.offset;
+            result.assign(begin, begin + count);
+        }
+        else
+        {
+            auto const begin =
+                std::make_reverse_iterator(last) + options.offset;
+            result.assign(begin, begin + count);
+        }
+        return result;
+    }
+
+    // Add a transaction of ledger seq to the transaction and account
+    // indexes, replacing any earlier copy of it.
+    void
+    indexTransaction(LedgerIndex seq, AccountTx const& accTx)
+    {
+        auto const& [txn, meta] = accTx;
+        auto const& id = txn->getID();
+        {
+            auto& shard = txShards_[shardOf(id)];
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            shard.transactions.insert_or_assign(id, accTx);
+        }
+
+        AccountTxEntry const entry{seq, meta->getIndex(), accTx};
+        for (auto const& account : meta->getAffectedAccounts())
+        {
+            auto& shard = accountShards_[shardOf(account)];
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            auto& entries = shard.accounts[account];
+            if (entries.empty() || entryLess(entries.back(), entry))
+            {
+                entries.push_back(entry);
+                continue;
+            }
+
+            auto const pos = std::lower_bound(
+                entries.begin(), entries.end(), entry, entryLess);
+            if (pos != entries.end() && !entryLess(entry, *pos))
+                *pos = entry;
+            else
+                entries.insert(pos, entry);
+        }
+    }
+
+    void
+    unindexTransactions(std::vector<AccountTx> const& transactions)
+    {
+        for (auto const& [txn, _] : transactions)
+        {
+            auto const& id = txn->getID();
+            auto& shard = txShards_[shardOf(id)];
+            std::unique_lock<std::shared_mutex> lock(shard.mutex);
+            shard.transactions.erase(id);
+        }
+    }
+
+    // The caller holds ledgerMutex_ exclusively.
+    void
+    insertLedger(LedgerData&& ledgerData)
+    {
+        auto const seq = ledgerData.info.seq;
+        auto const hash = ledgerData.info.hash;
+
+        auto [it, inserted] = ledgers_.try_emplace(seq);
+        if (!inserted && it->second.info.hash != hash)
+            ledgerHashToSeq_.erase(it->second.info.hash);
+        it->second = std::move(ledgerData);
+        ledgerHashToSeq_[hash] = seq;
+    }
+
+    std::size_t
+    ledgerBytes() const
+    {
+        std::shared_lock<std::shared_mutex> lock(ledgerMutex_);
+        std::size_t size = 0;
+        size += ledgers_.size() * (sizeof(LedgerIndex) + sizeof(LedgerData));
+        for (auto const& [_, ledgerData] : ledgers_)
+            size += ledgerData.transactions.capacity() * sizeof(AccountTx);
+        size +=
+            ledgerHashToSeq_.size() * (sizeof(uint256) + sizeof(LedgerIndex));
+        return size;
+    }
+
+    std::size_t
+    transactionBytes() const
+    {
+        std::size_t size = 0;
+        for (auto const& shard : txShards_)
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            size += shard.transactions.size() *
+                (sizeof(uint256) + sizeof(AccountTx));
+        }
+        for (auto const& shard : accountShards_)
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            for (auto const& [_, entries] : shard.accounts)
+            {
+                size += sizeof(AccountID) + sizeof(AccountTxEntries);
+                size += entries.capacity() * sizeof(AccountTxEntry);
+            }
+        }
+        return size;
+    }
+
+    void
+    runSnapshots()
+    {
+        beast::setCurrentThreadName("RWDB ledgers");
+
+        std::unique_lock lock(snapshotMutex_);
+        while (!snapshotCond_.wait_for(
+            lock, snapshotInterval_, [this] { return stopSnapshots_; }))
+        {
+            lock.unlock();
+            try
+            {
+                saveSnapshot();
+            }
+            catch (std::exception const& e)
+            {
+                JLOG(app_.journal("Ledger").error())
+                    << "RWDB snapshot: " << e.what();
+            }
+            lock.lock();
+        }
+    }
+
+    // Write the tables to a new file and swap it in for the old snapshot.
+    // Only one ledger is copied under ledgerMutex_ at a time, so saving a
+    // ledger is never held up for more than that copy. Ledgers added or
+    // deleted meanwhile may or may not make it into this snapshot.
+    void
+    saveSnapshot()
+    {
+        auto tmpPath = snapshotPath_;
+        tmpPath += ".tmp";
+        SnapshotFile file(tmpPath, snapshotTag);
+        file.remove();
+
+        std::optional<LedgerIndex> last;
+        while (true)
+        {
+            LedgerInfo info;
+            std::vector<AccountTx> transactions;
+            {
+                std::shared_lock<std::shared_mutex> lock(ledgerMutex_);
+                auto const it =
+                    last ? ledgers_.upper_bound(*last) : ledgers_.begin();
+                if (it == ledgers_.end())
+                    break;
+                last = it->first;
+                info = it->second.info;
+                transactions = it->second.transactions;
+            }
+
+            Serializer s(128);
+            s.add8(ledgerRecord);
+            addRaw(info, s, true);
+            file.append(s.slice());
+
+            for (auto const& [txn, meta] : transactions)
+            {
+                Serializer t;
+                t.add8(txRecord);
+                t.add32(info.seq);
+                t.addVL(txn->getSTransaction()->getSerializer().slice());
+                t.addVL(meta->getAsObject().getSerializer().slice());
+                file.append(t.slice());
+            }
+        }
+
+        file.close();
+        boost::filesystem::rename(tmpPath, snapshotPath_);
+    }
+
+    void
+    loadSnapshot()
+    {
+        auto const start = std::chrono::steady_clock::now();
+        SnapshotFile file(snapshotPath_, snapshotTag);
+
+        std::size_t transactions = 0;
+        std::unique_lock<std::shared_mutex> lock(ledgerMutex_);
+        file.load([this, &transactions](Slice record) {
+            SerialIter sit(record);
+            switch (sit.get8())
+            {
+                case ledgerRecord: {
+                    auto const info = deserializeHeader(
+                        sit.getSlice(sit.getBytesLeft()), true);
+                    ledgers_[info.seq].info = info;
+                    ledgerHashToSeq_[info.hash] = info.seq;
+                    break;
+                }
+                case txRecord: {
+                    LedgerIndex const seq = sit.get32();
+                    auto const it = ledgers_.find(seq);
+                    if (!useTxTables_ || it == ledgers_.end())
+                        break;
+
+                    auto const rawTxn = sit.getVL();
+                    auto const rawMeta = sit.getVL();
+                    SerialIter txnIter(makeSlice(rawTxn));
+                    auto const txn = std::make_shared<STTx const>(txnIter);
+                    std::string reason;
+                    auto& ledgerTxs = it->second.transactions;
+                    ledgerTxs.emplace_back(
+                        std::make_shared<ripple::Transaction>(
+                            txn, reason, app_),
+                        std::make_shared<ripple::TxMeta>(
+                            txn->getTransactionID(), seq, rawMeta));
+                    indexTransaction(seq, ledgerTxs.back());
+                    ++transactions;
+                    break;
+                }
+                default:
+                    break;
+            }
+        });
+
+        JLOG(app_.journal("Ledger").info())
+            << "RWDB loaded " << ledgers_.size() << " ledgers and "
+            << transactions << " transactions from " << snapshotPath_.string()
+            << " in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - start)
+                   .count()
+            << "ms";
+    }
 };
 
 // Factory function
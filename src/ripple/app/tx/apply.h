@@ -27,12 +27,20 @@
 #include <ripple/protocol/TER.h>
 #include <memory>
 #include <utility>
+#include <vector>
 
 namespace ripple {
 
 class Application;
 class HashRouter;
 
+// The HashRouter flags checkValidity caches its results in. These are the
+// same flags defined as SF_PRIVATE1-4 in HashRouter.h
+#define SF_SIGBAD SF_PRIVATE1     // Signature is bad
+#define SF_SIGGOOD SF_PRIVATE2    // Signature is good
+#define SF_LOCALBAD SF_PRIVATE3   // Local checks failed
+#define SF_LOCALGOOD SF_PRIVATE4  // Local checks passed
+
 /** Describes the pre-processing validity of a transaction.
 
     @see checkValidity, forceValidity
@@ -67,6 +75,24 @@ checkValidity(
     Config const& config,
     ApplyFlags const flags = tapNONE);
 
+/** Checks the signatures of several transactions.
+
+    The results are cached as `checkValidity` caches them, so a later call
+    to `checkValidity` for any of these transactions doesn't check the
+    signature again. Transactions whose signature is already known good or
+    bad, and emitted transactions, are skipped.
+
+    Each signature is verified exactly as `checkValidity` verifies it, so
+    this only moves the work.
+
+    @see checkValidity
+*/
+void
+checkSignatures(
+    HashRouter& router,
+    std::vector<std::shared_ptr<STTx const>> const& txs,
+    Rules const& rules);
+
 /** Sets the validity of a given transaction in the cache.
 
     @warning Use with extreme care.
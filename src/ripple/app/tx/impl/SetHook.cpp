@@ -21,6 +21,7 @@
 
 #include <ripple/app/hook/Enum.h>
 #include <ripple/app/hook/Guard.h>
+#include <ripple/app/hook/HookGuardCache.h>
 #include <ripple/app/hook/applyHook.h>
 #include <ripple/app/ledger/Ledger.h>
 #include <ripple/app/ledger/LedgerMaster.h>
@@ -459,6 +460,26 @@ SetHook::validateHookSetEntry(SetHookCtx& ctx, STObject const& hookSetObj)
 
                 Blob hook = hookSetObj.getFieldVL(sfCreateCode);
 
+                auto const hookHash = ripple::sha512Half_s(
+                    ripple::Slice(hook.data(), hook.size()));
+                uint64_t const rulesVersion =
+                    ctx.rules.enabled(featureHooksUpdate1) ? 1 : 0;
+
+                auto& guardCache = hook::HookGuardCache::instance();
+
+                // A cached result comes without the guard checker's log, so
+                // the code is validated in full whenever the log is wanted.
+                if (!ctx.j.trace())
+                {
+                    if (auto const cached =
+                            guardCache.fetch(hookHash, rulesVersion))
+                    {
+                        if (!*cached)
+                            return false;
+                        return **cached;
+                    }
+                }
+
                 // RH NOTE: validateGuards has a generic non-rippled specific
                 // interface so it can be used in other projects (i.e. tooling).
                 // As such the calling here is a bit convoluted.
@@ -479,7 +500,7 @@ SetHook::validateHookSetEntry(SetHookCtx& ctx, STObject const& hookSetObj)
                     hook,  // wasm to verify
                     logger,
                     hsacc,
-                    ctx.rules.enabled(featureHooksUpdate1) ? 1 : 0);
+                    rulesVersion);
 
                 if (ctx.j.trace())
                 {
@@ -513,7 +534,10 @@ SetHook::validateHookSetEntry(SetHookCtx& ctx, STObject const& hookSetObj)
                 }
 
                 if (!result)
+                {
+                    guardCache.insert(hookHash, rulesVersion, std::nullopt);
                     return false;
+                }
 
                 JLOG(ctx.j.trace())
                     << "HookSet(" << hook::log::WASM_SMOKE_TEST << ")["
@@ -521,20 +545,23 @@ SetHook::validateHookSetEntry(SetHookCtx& ctx, STObject const& hookSetObj)
                     << "]: Trying to wasm instantiate proposed hook "
                     << "size = " << hook.size();
 
-                std::optional<std::string> result2 =
-                    hook::HookExecutor::validateWasm(
-                        hook.data(), (size_t)hook.size());
-
-                if (result2)
+                // compile into a throwaway module: preflight must not touch
+                // the shared module cache, it is warmed when the hook is
+                // actually installed
+                std::string error;
+                if (!hook::HookModuleCache::compile(
+                        ripple::Slice(hook.data(), hook.size()), error))
                 {
                     JLOG(ctx.j.trace())
                         << "HookSet(" << hook::log::WASM_TEST_FAILURE << ")["
                         << HS_ACC()
                         << "Tried to set a hook with invalid code. VM error: "
-                        << *result2;
+                        << error;
+                    guardCache.insert(hookHash, rulesVersion, std::nullopt);
                     return false;
                 }
 
+                guardCache.insert(hookHash, rulesVersion, result);
                 return *result;
             }
         }
@@ -1571,6 +1598,16 @@ SetHook::setHook()
                         return tecINTERNAL;
                     }
 
+                    // warm the module cache so the first execution of this
+                    // hook doesn't pay for parsing and validation
+                    {
+                        std::string error;
+                        hook::HookModuleCache::instance().fetchOrCompile(
+                            *createHookHash,
+                            ripple::Slice(wasmBytes.data(), wasmBytes.size()),
+                            error);
+                    }
+
                     // decrement the hook definition and mark it for deletion if
                     // appropriate
                     if (oldDefSLE)
@@ -18,7 +18,9 @@
 //==============================================================================
 
 #include <ripple/app/hook/Enum.h>
+#include <ripple/app/hook/HookStatePrefetch.h>
 #include <ripple/app/hook/applyHook.h>
+#include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/main/Application.h>
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
@@ -1421,6 +1423,8 @@ Transactor::doHookCallback(
                 hook::finalizeHookState(
                     stateMap, ctx_, ctx_.tx.getTransactionID());
 
+            hook::HookStatePrefetcher::instance().record(stateMap);
+
             // write the final result
             ripple::TER result =
                 finalizeHookResult(callbackResult, ctx_, success);
@@ -1471,6 +1475,62 @@ Transactor::addWeakTSHFromSandbox(detail::ApplyViewBase const& pv)
     }
 }
 
+void
+Transactor::prefetchHookState(bool strong)
+{
+    auto& prefetcher = hook::HookStatePrefetcher::instance();
+    if (!prefetcher.enabled())
+        return;
+
+    // Reads are issued against the last closed ledger, which the open view
+    // is (almost always) built on. Nothing is read into the view itself.
+    auto const ledger = ctx_.app.getLedgerMaster().getClosedLedger();
+    if (!ledger)
+        return;
+
+    auto& view = ctx_.view();
+
+    std::vector<AccountID> accounts;
+    if (strong && !ctx_.isEmittedTxn())
+        accounts.push_back(account_);
+
+    for (auto const& [tshAccountID, canRollback] :
+         hook::getTransactionalStakeHolders(ctx_.tx, view))
+        if (canRollback == strong && tshAccountID != account_)
+            accounts.push_back(tshAccountID);
+
+    if (!strong)
+        accounts.insert(
+            accounts.end(),
+            additionalWeakTSH_.begin(),
+            additionalWeakTSH_.end());
+
+    for (auto const& accountID : accounts)
+    {
+        auto const hookSLE = view.read(keylet::hook(accountID));
+        if (!hookSLE || !hookSLE->isFieldPresent(sfHooks))
+            continue;
+
+        for (auto const& hookObj : hookSLE->getFieldArray(sfHooks))
+        {
+            if (!hookObj.isFieldPresent(sfHookHash))
+                continue;
+
+            if (hookObj.isFieldPresent(sfHookNamespace))
+            {
+                prefetcher.prefetch(
+                    ledger, accountID, hookObj.getFieldH256(sfHookNamespace));
+                continue;
+            }
+
+            if (auto const hookDef = view.read(keylet::hookDefinition(
+                    hookObj.getFieldH256(sfHookHash))))
+                prefetcher.prefetch(
+                    ledger, accountID, hookDef->getFieldH256(sfHookNamespace));
+        }
+    }
+}
+
 TER
 Transactor::doTSH(
     bool strong,  // only strong iff true, only weak iff false
@@ -1745,6 +1805,8 @@ Transactor::operator()()
         // transaction also this map can get large so
         hook::HookStateMap stateMap;
 
+        prefetchHookState(true);
+
         auto const& accountID = ctx_.tx.getAccountID(sfAccount);
         std::vector<hook::HookResult> hookResults;
 
@@ -1770,6 +1832,8 @@ Transactor::operator()()
         if (isTesSuccess(result))
             hook::finalizeHookState(stateMap, ctx_, ctx_.tx.getTransactionID());
 
+        hook::HookStatePrefetcher::instance().record(stateMap);
+
         // write hook results
         // this happens irrespective of whether final result was a tesSUCCESS
         // because it contains error codes that any failed hooks would have
@@ -2017,6 +2081,8 @@ Transactor::operator()()
         hook::HookStateMap stateMap;
         std::vector<hook::HookResult> weakResults;
 
+        prefetchHookState(false);
+
         doTSH(false, stateMap, weakResults, proMeta);
 
         // execute any hooks that nominated for 'again as weak'
@@ -2025,6 +2091,7 @@ Transactor::operator()()
 
         // write hook results
         hook::finalizeHookState(stateMap, ctx_, ctx_.tx.getTransactionID());
+        hook::HookStatePrefetcher::instance().record(stateMap);
         for (auto& weakResult : weakResults)
             hook::finalizeHookResult(weakResult, ctx_, isTesSuccess(result));
 
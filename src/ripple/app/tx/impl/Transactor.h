@@ -215,6 +215,11 @@ protected:
     void
     addWeakTSHFromSandbox(detail::ApplyViewBase const& pv);
 
+    // Start loading the hook state the strong (or weak) hook chains of this
+    // transaction are likely to read, see hook::HookStatePrefetcher
+    void
+    prefetchHookState(bool strong);
+
     // hooks amendment fields, these are unpopulated and unused unless
     // featureHooks is enabled
     int executedHookCount_ =
@@ -25,12 +25,6 @@
 
 namespace ripple {
 
-// These are the same flags defined as SF_PRIVATE1-4 in HashRouter.h
-#define SF_SIGBAD SF_PRIVATE1     // Signature is bad
-#define SF_SIGGOOD SF_PRIVATE2    // Signature is good
-#define SF_LOCALBAD SF_PRIVATE3   // Local checks failed
-#define SF_LOCALGOOD SF_PRIVATE4  // Local checks passed
-
 //------------------------------------------------------------------------------
 
 std::pair<Validity, std::string>
@@ -116,6 +110,34 @@ checkValidity(
     return {Validity::Valid, ""};
 }
 
+void
+checkSignatures(
+    HashRouter& router,
+    std::vector<std::shared_ptr<STTx const>> const& txs,
+    Rules const& rules)
+{
+    auto const requireCanonicalSig =
+        rules.enabled(featureRequireFullyCanonicalSig)
+        ? STTx::RequireFullyCanonicalSig::yes
+        : STTx::RequireFullyCanonicalSig::no;
+
+    for (auto const& tx : txs)
+    {
+        // checkValidity doesn't check emitted transactions' signatures
+        if (rules.enabled(featureHooks) && tx->isFieldPresent(sfEmitDetails))
+            continue;
+
+        auto const id = tx->getTransactionID();
+        if (router.getFlags(id) & (SF_SIGBAD | SF_SIGGOOD))
+            continue;
+
+        router.setFlags(
+            id,
+            tx->checkSign(requireCanonicalSig, rules) ? SF_SIGGOOD
+                                                      : SF_SIGBAD);
+    }
+}
+
 void
 forceValidity(HashRouter& router, uint256 const& txid, Validity validity)
 {
@@ -0,0 +1,723 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_BASICS_SHARDEDCACHE_H_INCLUDED
+#define RIPPLE_BASICS_SHARDEDCACHE_H_INCLUDED
+
+#include <ripple/basics/Log.h>
+#include <ripple/basics/hardened_hash.h>
+#include <ripple/beast/clock/abstract_clock.h>
+#include <ripple/beast/insight/Insight.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace ripple {
+
+/** Map/cache combination, split into independently locked shards.
+
+    Like TaggedCache, this keeps recently used objects alive and tracks
+    those still in use elsewhere, so that code paths referencing the same
+    key get the same object. It has TaggedCache's interface for caches of
+    objects, so either can be used by changing the type.
+
+    Each key belongs to one of several shards with a lock of its own, so
+    threads working on different keys rarely wait for each other. Lookups
+    which find the object cached take their shard's lock shared.
+
+    A sweep holds a shard's lock for at most sweepChunk entries at a time.
+    It drops the objects not used for the target age. Then, if more than
+    the target size are still cached, it runs a CLOCK hand around each
+    shard: an object used since the hand last passed gets a second chance,
+    and the others are dropped until the shard is within its share of the
+    target size.
+*/
+template <
+    class Key,
+    class T,
+    class Hash = hardened_hash<>,
+    class KeyEqual = std::equal_to<Key>>
+class ShardedCache
+{
+public:
+    using key_type = Key;
+    using mapped_type = T;
+    using clock_type = beast::abstract_clock<std::chrono::steady_clock>;
+
+    /** The most entries a sweep visits while holding a shard's lock. */
+    static constexpr std::size_t sweepChunk = 256;
+
+    ShardedCache(
+        std::string const& name,
+        int size,
+        clock_type::duration expiration,
+        clock_type& clock,
+        beast::Journal journal,
+        beast::insight::Collector::ptr const& collector =
+            beast::insight::NullCollector::New())
+        : journal_(journal)
+        , clock_(clock)
+        , stats_(
+              name,
+              std::bind(&ShardedCache::collect_metrics, this),
+              collector)
+        , name_(name)
+        , targetSize_(size)
+        , targetAge_(expiration)
+        , shardCount_(defaultShardCount())
+        , shift_(64 - std::countr_zero(shardCount_))
+        , shards_(std::make_unique<Shard[]>(shardCount_))
+    {
+    }
+
+    /** Return the clock associated with the cache. */
+    clock_type&
+    clock()
+    {
+        return clock_;
+    }
+
+    /** Returns the number of items in the container. */
+    std::size_t
+    size() const
+    {
+        return getTrackSize();
+    }
+
+    void
+    setTargetSize(int s)
+    {
+        targetSize_ = s;
+
+        if (s > 0)
+        {
+            for (std::size_t i = 0; i < shardCount_; ++i)
+            {
+                std::lock_guard lock(shards_[i].mutex);
+                shards_[i].index.reserve((s + (s >> 2)) / shardCount_ + 1);
+            }
+        }
+
+        JLOG(journal_.debug()) << name_ << " target size set to " << s;
+    }
+
+    clock_type::duration
+    getTargetAge() const
+    {
+        return targetAge_;
+    }
+
+    void
+    setTargetAge(clock_type::duration s)
+    {
+        targetAge_ = s;
+        JLOG(journal_.debug())
+            << name_ << " target age set to " << s.count();
+    }
+
+    int
+    getCacheSize() const
+    {
+        int count = 0;
+        for (std::size_t i = 0; i < shardCount_; ++i)
+        {
+            std::shared_lock lock(shards_[i].mutex);
+            count += shards_[i].cached;
+        }
+        return count;
+    }
+
+    int
+    getTrackSize() const
+    {
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < shardCount_; ++i)
+        {
+            std::shared_lock lock(shards_[i].mutex);
+            count += shards_[i].index.size();
+        }
+        return count;
+    }
+
+    float
+    getHitRate()
+    {
+        auto const total = static_cast<float>(hits_ + misses_);
+        return hits_ * (100.0f / std::max(1.0f, total));
+    }
+
+    void
+    clear()
+    {
+        for (std::size_t i = 0; i < shardCount_; ++i)
+        {
+            auto& shard = shards_[i];
+            decltype(shard.index) index;
+            decltype(shard.slots) slots;
+
+            // The objects are released once the lock is
+            std::lock_guard lock(shard.mutex);
+            index.swap(shard.index);
+            slots.swap(shard.slots);
+            shard.unused.clear();
+            shard.hand = 0;
+            shard.cached = 0;
+        }
+    }
+
+    void
+    reset()
+    {
+        clear();
+        hits_ = 0;
+        misses_ = 0;
+    }
+
+    /** Refresh the last access time on a key if present.
+        @return `true` If the key was found.
+    */
+    bool
+    touch_if_exists(key_type const& key)
+    {
+        auto& shard = shardFor(key);
+        std::shared_lock lock(shard.mutex);
+        auto const it = shard.index.find(key);
+        if (it == shard.index.end())
+            return false;
+        touch(shard.slots[it->second], clock_.now());
+        return true;
+    }
+
+    void
+    sweep()
+    {
+        auto const start = std::chrono::steady_clock::now();
+        auto const whenExpire = clock_.now() - getTargetAge();
+        std::size_t expired = 0;
+        std::size_t evicted = 0;
+
+        for (std::size_t i = 0; i < shardCount_; ++i)
+            expired += expire(shards_[i], whenExpire);
+
+        if (int const target = targetSize_; target > 0)
+        {
+            int const cached = getCacheSize();
+            if (cached > target)
+            {
+                JLOG(journal_.trace())
+                    << name_ << " is growing fast " << cached << " of "
+                    << target;
+
+                int const shards = static_cast<int>(shardCount_);
+                int const quota = (target + shards - 1) / shards;
+                for (std::size_t i = 0; i < shardCount_; ++i)
+                    evicted += runHand(shards_[i], quota);
+            }
+        }
+
+        JLOG(journal_.debug())
+            << name_ << " ShardedCache sweep: " << expired << " expired, "
+            << evicted << " evicted in "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(
+                   std::chrono::steady_clock::now() - start)
+                   .count()
+            << "ms";
+    }
+
+    bool
+    del(key_type const& key, bool valid)
+    {
+        // Remove from cache, if !valid, remove from map too. Returns true if
+        // removed from cache
+        auto& shard = shardFor(key);
+        Released released;
+        std::lock_guard lock(shard.mutex);
+
+        auto const it = shard.index.find(key);
+        if (it == shard.index.end())
+            return false;
+
+        auto const i = it->second;
+        auto& slot = shard.slots[i];
+
+        bool ret = false;
+
+        if (slot.ptr)
+        {
+            --shard.cached;
+            released.strong.push_back(std::move(slot.ptr));
+            ret = true;
+        }
+
+        if (!valid || slot.weak_ptr.expired())
+            erase(shard, i, released);
+
+        return ret;
+    }
+
+    /** Replace aliased objects with originals.
+
+        As TaggedCache::canonicalize.
+
+        @param key The key corresponding to the object
+        @param data A shared pointer to the data corresponding to the object.
+        @param replace Function that decides if cache should be replaced
+
+        @return `true` If the key already existed.
+    */
+    bool
+    canonicalize(
+        key_type const& key,
+        std::shared_ptr<T>& data,
+        std::function<bool(std::shared_ptr<T> const&)>&& replace)
+    {
+        auto& shard = shardFor(key);
+        auto const now = clock_.now();
+        Released released;
+        std::lock_guard lock(shard.mutex);
+
+        auto const it = shard.index.find(key);
+        if (it == shard.index.end())
+        {
+            add(shard, key, data, now);
+            return false;
+        }
+
+        auto& slot = shard.slots[it->second];
+        touch(slot, now);
+
+        auto cachedData = slot.ptr ? slot.ptr : slot.weak_ptr.lock();
+        if (!cachedData)
+        {
+            slot.ptr = data;
+            slot.weak_ptr = data;
+            ++shard.cached;
+            return false;
+        }
+
+        if (!slot.ptr)
+            ++shard.cached;
+
+        if (replace(cachedData))
+        {
+            released.strong.push_back(std::move(cachedData));
+            slot.ptr = data;
+            slot.weak_ptr = data;
+        }
+        else
+        {
+            slot.ptr = cachedData;
+            data = std::move(cachedData);
+        }
+
+        return true;
+    }
+
+    bool
+    canonicalize_replace_cache(
+        key_type const& key,
+        std::shared_ptr<T> const& data)
+    {
+        return canonicalize(
+            key,
+            const_cast<std::shared_ptr<T>&>(data),
+            [](std::shared_ptr<T> const&) { return true; });
+    }
+
+    bool
+    canonicalize_replace_client(key_type const& key, std::shared_ptr<T>& data)
+    {
+        return canonicalize(
+            key, data, [](std::shared_ptr<T> const&) { return false; });
+    }
+
+    std::shared_ptr<T>
+    fetch(key_type const& key)
+    {
+        auto ret = initialFetch(key);
+        if (!ret)
+            ++misses_;
+        return ret;
+    }
+
+    /** Insert the element into the container.
+        If the key already exists, nothing happens.
+        @return `true` If the element was inserted
+    */
+    bool
+    insert(key_type const& key, T const& value)
+    {
+        auto p = std::make_shared<T>(std::cref(value));
+        return canonicalize_replace_client(key, p);
+    }
+
+    bool
+    retrieve(key_type const& key, T& data)
+    {
+        // retrieve the value of the stored data
+        auto entry = fetch(key);
+
+        if (!entry)
+            return false;
+
+        data = *entry;
+        return true;
+    }
+
+    std::vector<key_type>
+    getKeys() const
+    {
+        std::vector<key_type> v;
+        for (std::size_t i = 0; i < shardCount_; ++i)
+        {
+            std::shared_lock lock(shards_[i].mutex);
+            for (auto const& [key, _] : shards_[i].index)
+                v.push_back(key);
+        }
+        return v;
+    }
+
+    /** Returns the fraction of cache hits. */
+    double
+    rate() const
+    {
+        auto const hits = hits_.load();
+        auto const tot = hits + misses_;
+        if (tot == 0)
+            return 0;
+        return double(hits) / tot;
+    }
+
+    /** Fetch an item from the cache.
+        If the digest was not found, Handler
+        will be called with this signature:
+            std::shared_ptr<SLE const>(void)
+    */
+    template <class Handler>
+    std::shared_ptr<T>
+    fetch(key_type const& digest, Handler const& h)
+    {
+        if (auto ret = initialFetch(digest))
+            return ret;
+
+        std::shared_ptr<T> sle = h();
+        if (!sle)
+            return {};
+
+        ++misses_;
+        canonicalize_replace_client(digest, sle);
+        return sle;
+    }
+
+private:
+    struct Slot
+    {
+        // Points to the key in the shard's index, or is null if unused
+        key_type const* key = nullptr;
+
+        std::shared_ptr<mapped_type> ptr;
+        std::weak_ptr<mapped_type> weak_ptr;
+
+        // Updated under a shared lock
+        std::atomic<clock_type::time_point> last_access{};
+        std::atomic<bool> referenced{false};
+    };
+
+    struct Shard
+    {
+        std::shared_mutex mutable mutex;
+
+        std::unordered_map<key_type, std::uint32_t, Hash, KeyEqual> index;
+
+        // The ring the CLOCK hand goes around. Slots never move.
+        std::deque<Slot> slots;
+        std::vector<std::uint32_t> unused;
+        std::size_t hand = 0;
+
+        // Slots whose object is cached
+        int cached = 0;
+    };
+
+    // Objects let go of while a shard is locked, to be released after
+    struct Released
+    {
+        std::vector<std::shared_ptr<mapped_type>> strong;
+        std::vector<std::weak_ptr<mapped_type>> weak;
+    };
+
+    static std::size_t
+    defaultShardCount()
+    {
+        auto const threads = std::max(std::thread::hardware_concurrency(), 1u);
+        return std::clamp<std::size_t>(std::bit_ceil(threads * 4), 8, 256);
+    }
+
+    Shard&
+    shardFor(key_type const& key) const
+    {
+        // Use the hash's high bits, which the shard's index doesn't favor
+        auto const h = static_cast<std::uint64_t>(hash_(key));
+        return shards_[(h * 0x9E3779B97F4A7C15ull) >> shift_];
+    }
+
+    static void
+    touch(Slot& slot, clock_type::time_point now)
+    {
+        slot.last_access.store(now, std::memory_order_relaxed);
+        slot.referenced.store(true, std::memory_order_relaxed);
+    }
+
+    // New objects start unreferenced, so that those used only once go
+    // before those used again.
+    void
+    add(Shard& shard,
+        key_type const& key,
+        std::shared_ptr<T> const& data,
+        clock_type::time_point now)
+    {
+        std::uint32_t i;
+        if (shard.unused.empty())
+        {
+            i = shard.slots.size();
+            shard.slots.emplace_back();
+        }
+        else
+        {
+            i = shard.unused.back();
+            shard.unused.pop_back();
+        }
+
+        auto& slot = shard.slots[i];
+        slot.key = &shard.index.emplace(key, i).first->first;
+        slot.ptr = data;
+        slot.weak_ptr = data;
+        slot.last_access.store(now, std::memory_order_relaxed);
+        slot.referenced.store(false, std::memory_order_relaxed);
+        ++shard.cached;
+    }
+
+    void
+    erase(Shard& shard, std::uint32_t i, Released& released)
+    {
+        auto& slot = shard.slots[i];
+        if (slot.ptr)
+        {
+            --shard.cached;
+            released.strong.push_back(std::move(slot.ptr));
+        }
+        released.weak.push_back(std::move(slot.weak_ptr));
+        shard.index.erase(*slot.key);
+        slot.key = nullptr;
+        shard.unused.push_back(i);
+    }
+
+    // Stops caching a slot's object, and stops tracking it too unless it's
+    // used elsewhere.
+    void
+    uncache(Shard& shard, std::uint32_t i, Released& released)
+    {
+        auto& slot = shard.slots[i];
+        if (slot.ptr.use_count() == 1)
+        {
+            erase(shard, i, released);
+            return;
+        }
+        --shard.cached;
+        slot.ptr.reset();
+    }
+
+    std::shared_ptr<T>
+    initialFetch(key_type const& key)
+    {
+        auto& shard = shardFor(key);
+        auto const now = clock_.now();
+        {
+            std::shared_lock lock(shard.mutex);
+            auto const it = shard.index.find(key);
+            if (it == shard.index.end())
+                return {};
+
+            auto& slot = shard.slots[it->second];
+            if (slot.ptr)
+            {
+                ++hits_;
+                touch(slot, now);
+                return slot.ptr;
+            }
+        }
+
+        Released released;
+        std::lock_guard lock(shard.mutex);
+        auto const it = shard.index.find(key);
+        if (it == shard.index.end())
+            return {};
+
+        auto& slot = shard.slots[it->second];
+        if (slot.ptr)
+        {
+            ++hits_;
+            touch(slot, now);
+            return slot.ptr;
+        }
+
+        slot.ptr = slot.weak_ptr.lock();
+        if (slot.ptr)
+        {
+            // independent of cache size, so not counted as a hit
+            ++shard.cached;
+            touch(slot, now);
+            return slot.ptr;
+        }
+
+        erase(shard, it->second, released);
+        return {};
+    }
+
+    // Drops the objects last used at or before whenExpire, and the entries
+    // of objects no longer used elsewhere.
+    std::size_t
+    expire(Shard& shard, clock_type::time_point whenExpire)
+    {
+        std::size_t expired = 0;
+        for (std::size_t begin = 0;; begin += sweepChunk)
+        {
+            Released released;
+            std::lock_guard lock(shard.mutex);
+
+            auto const end = std::min(begin + sweepChunk, shard.slots.size());
+            if (begin >= end)
+                return expired;
+
+            for (auto i = begin; i < end; ++i)
+            {
+                auto& slot = shard.slots[i];
+                if (!slot.key)
+                    continue;
+
+                if (!slot.ptr)
+                {
+                    if (slot.weak_ptr.expired())
+                        erase(shard, i, released);
+                }
+                else if (
+                    slot.last_access.load(std::memory_order_relaxed) <=
+                    whenExpire)
+                {
+                    uncache(shard, i, released);
+                    ++expired;
+                }
+            }
+        }
+    }
+
+    // Advances the shard's CLOCK hand, dropping objects not used since it
+    // last passed, until the shard caches at most quota objects or the hand
+    // has gone around twice.
+    std::size_t
+    runHand(Shard& shard, int quota)
+    {
+        std::size_t evicted = 0;
+        std::size_t steps = 0;
+        while (true)
+        {
+            Released released;
+            std::lock_guard lock(shard.mutex);
+
+            auto const size = shard.slots.size();
+            for (std::size_t n = 0; n < sweepChunk; ++n, ++steps)
+            {
+                if (shard.cached <= quota || steps >= 2 * size)
+                    return evicted;
+
+                auto const i = shard.hand;
+                shard.hand = (shard.hand + 1) % size;
+
+                auto& slot = shard.slots[i];
+                if (!slot.key || !slot.ptr ||
+                    slot.referenced.exchange(false, std::memory_order_relaxed))
+                    continue;
+
+                uncache(shard, i, released);
+                ++evicted;
+            }
+        }
+    }
+
+    void
+    collect_metrics()
+    {
+        stats_.size.set(getCacheSize());
+
+        auto const hits = hits_.load();
+        auto const total = hits + misses_;
+        stats_.hit_rate.set(total == 0 ? 0 : (hits * 100) / total);
+    }
+
+    struct Stats
+    {
+        template <class Handler>
+        Stats(
+            std::string const& prefix,
+            Handler const& handler,
+            beast::insight::Collector::ptr const& collector)
+            : hook(collector->make_hook(handler))
+            , size(collector->make_gauge(prefix, "size"))
+            , hit_rate(collector->make_gauge(prefix, "hit_rate"))
+        {
+        }
+
+        beast::insight::Hook hook;
+        beast::insight::Gauge size;
+        beast::insight::Gauge hit_rate;
+    };
+
+    beast::Journal journal_;
+    clock_type& clock_;
+    Stats stats_;
+
+    // Used for logging
+    std::string const name_;
+
+    // Desired number of cache entries (0 = ignore)
+    std::atomic<int> targetSize_;
+
+    // Desired maximum cache age
+    std::atomic<clock_type::duration> targetAge_;
+
+    Hash const hash_;
+    std::size_t const shardCount_;
+    unsigned const shift_;
+    std::unique_ptr<Shard[]> shards_;
+
+    std::atomic<std::uint64_t> hits_{0};
+    std::atomic<std::uint64_t> misses_{0};
+};
+
+}  // namespace ripple
+
+#endif
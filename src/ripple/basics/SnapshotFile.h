@@ -0,0 +1,118 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_BASICS_SNAPSHOTFILE_H_INCLUDED
+#define RIPPLE_BASICS_SNAPSHOTFILE_H_INCLUDED
+
+#include <ripple/basics/Slice.h>
+#include <boost/filesystem.hpp>
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+
+namespace ripple {
+
+/** An append-only file of checksummed records.
+
+    Used by the in-memory stores to keep a copy of their contents on disk so
+    that they can be reloaded after a restart.
+
+    The file starts with a 16 byte header: the magic "XRWDBSNP", a format
+    version and a tag naming what the records contain, so one store never
+    loads another's file. Each record follows as its size and the low 32 bits
+    of the XXH64 of its payload, both little endian, then the payload itself.
+    Nothing is ever rewritten in place, so a record interrupted by a crash can
+    only be the last one; load() drops it and the file carries on from the
+    last intact record.
+
+    The file is memory mapped while loading, each record is handed to the
+    caller as a slice into the mapping.
+*/
+class SnapshotFile
+{
+public:
+    static constexpr std::size_t headerBytes = 16;
+    static constexpr std::size_t recordHeaderBytes = 8;
+
+    SnapshotFile(boost::filesystem::path path, std::uint32_t tag);
+
+    ~SnapshotFile();
+
+    SnapshotFile(SnapshotFile const&) = delete;
+    SnapshotFile&
+    operator=(SnapshotFile const&) = delete;
+
+    boost::filesystem::path const&
+    path() const
+    {
+        return path_;
+    }
+
+    /** Call f with the payload of every intact record, in order.
+
+        A missing or empty file has no records. A torn record at the end is
+        cut off so that later appends follow the last intact one.
+
+        @return The number of records loaded.
+        @throws std::runtime_error if the file isn't a snapshot with our tag.
+    */
+    std::size_t
+    load(std::function<void(Slice)> const& f);
+
+    /** Add a record. It is buffered until sync() or close().
+
+        If a write fails, every record appended since the last successful
+        sync() is dropped from the file and the error is thrown. The caller
+        must append those records again.
+    */
+    void
+    append(Slice payload);
+
+    /** Write out buffered records and wait for them to reach the disk.
+
+        On failure the records appended since the last successful sync()
+        are dropped, as for append().
+    */
+    void
+    sync();
+
+    /** Sync and close the file. Appending again reopens it. */
+    void
+    close();
+
+    /** Close and delete the file. */
+    void
+    remove();
+
+private:
+    void
+    openForAppend();
+
+    [[noreturn]] void
+    failWrite(char const* what);
+
+    boost::filesystem::path const path_;
+    std::uint32_t const tag_;
+    std::FILE* file_ = nullptr;
+    std::uint64_t synced_ = 0;  // size of the file as of the last sync
+};
+
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,247 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/SnapshotFile.h>
+#include <ripple/basics/contract.h>
+#include <ripple/basics/scope.h>
+#include <ripple/beast/hash/xxhasher.h>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace ripple {
+
+namespace {
+
+constexpr char magic[8] = {'X', 'R', 'W', 'D', 'B', 'S', 'N', 'P'};
+constexpr std::uint32_t version = 1;
+
+void
+put32(std::uint8_t* p, std::uint32_t v)
+{
+    for (int i = 0; i < 4; ++i)
+        p[i] = static_cast<std::uint8_t>(v >> (8 * i));
+}
+
+std::uint32_t
+get32(std::uint8_t const* p)
+{
+    std::uint32_t v = 0;
+    for (int i = 0; i < 4; ++i)
+        v |= static_cast<std::uint32_t>(p[i]) << (8 * i);
+    return v;
+}
+
+std::uint32_t
+checksum(void const* data, std::size_t size)
+{
+    beast::xxhasher h;
+    h(data, size);
+    return static_cast<std::uint32_t>(static_cast<std::size_t>(h));
+}
+
+[[noreturn]] void
+fail(boost::filesystem::path const& path, char const* what)
+{
+    Throw<std::runtime_error>(
+        "snapshot " + path.string() + ": " + what + ": " +
+        std::strerror(errno));
+}
+
+}  // namespace
+
+SnapshotFile::SnapshotFile(boost::filesystem::path path, std::uint32_t tag)
+    : path_(std::move(path)), tag_(tag)
+{
+}
+
+SnapshotFile::~SnapshotFile()
+{
+    if (file_)
+        std::fclose(file_);
+}
+
+std::size_t
+SnapshotFile::load(std::function<void(Slice)> const& f)
+{
+    close();
+
+    int const fd = ::open(path_.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        if (errno == ENOENT)
+            return 0;
+        fail(path_, "open");
+    }
+    scope_exit closeFd{[fd] { ::close(fd); }};
+
+    struct stat st;
+    if (::fstat(fd, &st) != 0)
+        fail(path_, "stat");
+    auto const size = static_cast<std::size_t>(st.st_size);
+
+    std::size_t good = 0;
+    std::size_t count = 0;
+    if (size >= headerBytes)
+    {
+        void* const map = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (map == MAP_FAILED)
+            fail(path_, "mmap");
+        scope_exit unmap{[map, size] { ::munmap(map, size); }};
+        ::madvise(map, size, MADV_SEQUENTIAL);
+
+        auto const* const data = static_cast<std::uint8_t const*>(map);
+        if (std::memcmp(data, magic, sizeof(magic)) != 0 ||
+            get32(data + 8) != version || get32(data + 12) != tag_)
+            Throw<std::runtime_error>(
+                "snapshot " + path_.string() +
+                ": not a snapshot of this store");
+
+        good = headerBytes;
+        while (size - good >= recordHeaderBytes)
+        {
+            auto const* const p = data + good;
+            std::size_t const n = get32(p);
+            if (size - good - recordHeaderBytes < n ||
+                checksum(p + recordHeaderBytes, n) != get32(p + 4))
+                break;
+
+            f(Slice(p + recordHeaderBytes, n));
+            good += recordHeaderBytes + n;
+            ++count;
+        }
+    }
+
+    // A crash while appending leaves a partial record, or even a partial
+    // header, at the end. Cut it off so appending resumes after the last
+    // intact record.
+    if (good != size)
+    {
+        boost::system::error_code ec;
+        boost::filesystem::resize_file(path_, good, ec);
+        if (ec)
+            Throw<std::runtime_error>(
+                "snapshot " + path_.string() + ": " + ec.message());
+    }
+
+    return count;
+}
+
+void
+SnapshotFile::openForAppend()
+{
+    file_ = std::fopen(path_.c_str(), "ab");
+    if (!file_)
+        fail(path_, "open");
+
+    // 64KiB of buffering: records are mostly a few hundred bytes
+    std::setvbuf(file_, nullptr, _IOFBF, 1 << 16);
+
+    if (std::fseek(file_, 0, SEEK_END) != 0)
+        fail(path_, "seek");
+    synced_ = std::ftell(file_);
+    if (synced_ == 0)
+    {
+        std::uint8_t header[headerBytes];
+        std::memcpy(header, magic, sizeof(magic));
+        put32(header + 8, version);
+        put32(header + 12, tag_);
+        if (std::fwrite(header, 1, sizeof(header), file_) != sizeof(header))
+            failWrite("write");
+    }
+}
+
+// A failed write can leave a partial record in the file, and load() stops
+// at the first one it finds, hiding every record appended after it. So the
+// file is cut back to its size at the last sync and the caller appends the
+// records since then again.
+void
+SnapshotFile::failWrite(char const* what)
+{
+    std::string const error =
+        "snapshot " + path_.string() + ": " + what + ": " +
+        std::strerror(errno);
+
+    if (file_)
+    {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+
+    boost::system::error_code ec;
+    boost::filesystem::resize_file(path_, synced_, ec);
+
+    Throw<std::runtime_error>(error);
+}
+
+void
+SnapshotFile::append(Slice payload)
+{
+    if (!file_)
+        openForAppend();
+
+    std::uint8_t header[recordHeaderBytes];
+    put32(header, static_cast<std::uint32_t>(payload.size()));
+    put32(header + 4, checksum(payload.data(), payload.size()));
+    if (std::fwrite(header, 1, sizeof(header), file_) != sizeof(header) ||
+        std::fwrite(payload.data(), 1, payload.size(), file_) !=
+            payload.size())
+        failWrite("write");
+}
+
+void
+SnapshotFile::sync()
+{
+    if (!file_)
+        return;
+
+    if (std::fflush(file_) != 0 || ::fsync(::fileno(file_)) != 0)
+        failWrite("sync");
+    synced_ = std::ftell(file_);
+}
+
+void
+SnapshotFile::close()
+{
+    if (!file_)
+        return;
+
+    sync();
+    std::fclose(file_);
+    file_ = nullptr;
+}
+
+void
+SnapshotFile::remove()
+{
+    if (file_)
+    {
+        std::fclose(file_);
+        file_ = nullptr;
+    }
+
+    boost::system::error_code ec;
+    boost::filesystem::remove(path_, ec);
+}
+
+}  // namespace ripple
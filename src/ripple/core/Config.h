@@ -253,6 +253,14 @@ public:
     int IO_WORKERS = 0;        // io svc thread count. default: 2
     int PREFETCH_WORKERS = 0;  // prefetch thread count. default: 4
 
+    // Threads applying consensus transactions when building a ledger, see
+    // ParallelApply. Zero or one applies them one at a time.
+    int PARALLEL_APPLY_THREADS = 0;
+
+    // Threads checking the signatures of transactions from peers, see
+    // SigVerifier. Zero checks each in the job that handles it.
+    int SIG_VERIFY_WORKERS = 0;
+
     // Can only be set in code, specifically unit tests
     bool FORCE_MULTI_THREAD = false;
 
@@ -308,6 +316,21 @@ public:
     // First, attempt to load the latest ledger directly from disk.
     bool FAST_LOAD = false;
 
+    // Approximate memory, in bytes, used to keep parsed hook modules between
+    // executions. Zero disables the hook module cache.
+    std::size_t HOOK_MODULE_CACHE_SIZE = 64 * 1024 * 1024;
+
+    // Instantiated hooks kept for reuse by each thread executing hooks. Zero
+    // disables pooling, see hook::HookInstancePool.
+    std::size_t HOOK_INSTANCE_POOL_SIZE = 0;
+
+    // Start reading the hook state a hook chain is likely to need before the
+    // chain executes.
+    bool HOOK_STATE_PREFETCH = false;
+
+    // Record where hook execution time is spent, see hook::HookProfiler.
+    bool HOOK_PROFILE = false;
+
 public:
     Config();
 
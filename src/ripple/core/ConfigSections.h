@@ -56,6 +56,7 @@ struct ConfigSection
 #define SECTION_FEE_DEFAULT "fee_default"
 #define SECTION_FETCH_DEPTH "fetch_depth"
 #define SECTION_HISTORICAL_SHARD_PATHS "historical_shard_paths"
+#define SECTION_HOOKS "hooks"
 #define SECTION_INSIGHT "insight"
 #define SECTION_IPS "ips"
 #define SECTION_IPS_FIXED "ips_fixed"
@@ -96,6 +97,8 @@ struct ConfigSection
 #define SECTION_WORKERS "workers"
 #define SECTION_IO_WORKERS "io_workers"
 #define SECTION_PREFETCH_WORKERS "prefetch_workers"
+#define SECTION_PARALLEL_APPLY "parallel_apply"
+#define SECTION_SIG_VERIFY_WORKERS "sig_verify_workers"
 #define SECTION_LEDGER_REPLAY "ledger_replay"
 #define SECTION_BETA_RPC_API "beta_rpc_api"
 #define SECTION_SWEEP_INTERVAL "sweep_interval"
@@ -65,6 +65,7 @@ enum JobType {
     jtREQUESTED_TXN,      // Reply with requested transactions
     jtBATCH,              // Apply batched transactions
     jtLEDGER_DATA,        // Received data for a ledger we're acquiring
+    jtFETCH_DONE,         // Deliver node objects read asynchronously
     jtADVANCE,            // Advance validated/acquired ledgers
     jtPUBLEDGER,          // Publish a fully-accepted ledger
     jtTXN_DATA,           // Fetch a proposed set
@@ -79,6 +79,7 @@ private:
         add(jtPROPOSAL_ut,       "untrustedProposal",    maxLimit,   500ms,  1250ms);
         add(jtREPLAY_TASK,       "ledgerReplayTask",     maxLimit,     0ms,     0ms);
         add(jtLEDGER_DATA,       "ledgerData",                  3,     0ms,     0ms);
+        add(jtFETCH_DONE,        "fetchDone",            maxLimit,     0ms,     0ms);
         add(jtCLIENT,            "clientCommand",        maxLimit,  2000ms,  5000ms);
         add(jtCLIENT_SUBSCRIBE,  "clientSubscribe",      maxLimit,  2000ms,  5000ms);
         add(jtCLIENT_FEE_CHANGE, "clientFeeChange",      maxLimit,  2000ms,  5000ms);
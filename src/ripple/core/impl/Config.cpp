@@ -705,6 +705,26 @@ Config::loadFromString(std::string const& fileContents)
                 ": must be between 1 and 1024 inclusive.");
     }
 
+    if (getSingleSection(secConfig, SECTION_PARALLEL_APPLY, strTemp, j_))
+    {
+        PARALLEL_APPLY_THREADS = beast::lexicalCastThrow<int>(strTemp);
+
+        if (PARALLEL_APPLY_THREADS < 0 || PARALLEL_APPLY_THREADS > 64)
+            Throw<std::runtime_error>(
+                "Invalid " SECTION_PARALLEL_APPLY
+                ": must be between 0 and 64 inclusive.");
+    }
+
+    if (getSingleSection(secConfig, SECTION_SIG_VERIFY_WORKERS, strTemp, j_))
+    {
+        SIG_VERIFY_WORKERS = beast::lexicalCastThrow<int>(strTemp);
+
+        if (SIG_VERIFY_WORKERS < 0 || SIG_VERIFY_WORKERS > 1024)
+            Throw<std::runtime_error>(
+                "Invalid " SECTION_SIG_VERIFY_WORKERS
+                ": must be between 0 and 1024 inclusive.");
+    }
+
     if (getSingleSection(secConfig, SECTION_COMPRESSION, strTemp, j_))
         COMPRESSION = beast::lexicalCastThrow<bool>(strTemp);
 
@@ -729,6 +749,36 @@ Config::loadFromString(std::string const& fileContents)
                 "and less or equal to 100");
     }
 
+    if (exists(SECTION_HOOKS))
+    {
+        auto const sec = section(SECTION_HOOKS);
+
+        // module_cache_size is specified in megabytes
+        if (auto const mb = sec.get<std::size_t>("module_cache_size"))
+        {
+            if (*mb > 16 * 1024)
+                Throw<std::runtime_error>(
+                    "Invalid " SECTION_HOOKS
+                    ", module_cache_size must be between 0 and 16384");
+            HOOK_MODULE_CACHE_SIZE = *mb * 1024 * 1024;
+        }
+
+        if (auto const pool = sec.get<std::size_t>("instance_pool"))
+        {
+            if (*pool > 1024)
+                Throw<std::runtime_error>(
+                    "Invalid " SECTION_HOOKS
+                    ", instance_pool must be between 0 and 1024");
+            HOOK_INSTANCE_POOL_SIZE = *pool;
+        }
+
+        if (auto const prefetch = sec.get("state_prefetch"))
+            HOOK_STATE_PREFETCH = beast::lexicalCastThrow<bool>(*prefetch);
+
+        if (auto const profile = sec.get("profile"))
+            HOOK_PROFILE = beast::lexicalCastThrow<bool>(*profile);
+    }
+
     if (getSingleSection(secConfig, SECTION_MAX_TRANSACTIONS, strTemp, j_))
     {
         MAX_TRANSACTIONS = std::clamp(
@@ -618,6 +618,27 @@ private:
         return jvRequest;
     }
 
+    // hook_profile [on|off|clear]
+    Json::Value
+    parseHookProfile(Json::Value const& jvParams)
+    {
+        Json::Value jvRequest(Json::objectValue);
+
+        if (jvParams.size())
+        {
+            auto const arg = jvParams[0u].asString();
+
+            if (arg == "on" || arg == "off")
+                jvRequest[jss::enabled] = (arg == "on");
+            else if (arg == "clear")
+                jvRequest[jss::clear] = true;
+            else
+                return rpcError(rpcINVALID_PARAMS);
+        }
+
+        return jvRequest;
+    }
+
     // sign_for <account> <secret> <json> offline
     // sign_for <account> <secret> <json>
     Json::Value
@@ -1411,6 +1432,7 @@ public:
             {"fetch_info", &RPCParser::parseFetchInfo, 0, 1},
             {"gateway_balances", &RPCParser::parseGatewayBalances, 1, -1},
             {"get_counts", &RPCParser::parseGetCounts, 0, 1},
+            {"hook_profile", &RPCParser::parseHookProfile, 0, 1},
             {"json", &RPCParser::parseJson, 2, 2},
             {"json2", &RPCParser::parseJson2, 1, 1},
             {"ledger", &RPCParser::parseLedger, 0, 2},
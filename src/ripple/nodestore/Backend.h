@@ -124,6 +124,23 @@ public:
     virtual std::pair<std::vector<std::shared_ptr<NodeObject>>, Status>
     fetchBatch(std::vector<uint256 const*> const& hashes) = 0;
 
+    /** Fetch a single object without blocking the caller.
+        The callback is invoked exactly once, through the scheduler's
+        scheduleCompletions, with the object or with nullptr. nullptr only
+        means the object wasn't found this way: the caller should use
+        fetch() to know whether it exists.
+        @note This will be called concurrently.
+        @return false, without invoking the callback, if the backend
+                doesn't fetch asynchronously.
+    */
+    virtual bool
+    fetchAsync(
+        uint256 const& hash,
+        std::function<void(std::shared_ptr<NodeObject>)> callback)
+    {
+        return false;
+    }
+
     /** Store a single object.
         Depending on the implementation this may happen immediately
         or deferred using a scheduled task.
@@ -133,6 +150,21 @@ public:
     virtual void
     store(std::shared_ptr<NodeObject> const& object) = 0;
 
+    /** Store a single object, with the ledger it belongs to.
+        Backends that keep recent ledgers' objects apart use the ledger
+        sequence. By default the object is just stored.
+        @note This will be called concurrently.
+        @param object The object to store.
+        @param ledgerSeq The ledger's sequence, or 0 if unknown.
+    */
+    virtual void
+    storeForLedger(
+        std::shared_ptr<NodeObject> const& object,
+        std::uint32_t ledgerSeq)
+    {
+        store(object);
+    }
+
     /** Store a group of objects.
         @note This function will not be called concurrently with
               itself or @ref store.
@@ -160,6 +192,14 @@ public:
     virtual void
     setDeletePath() = 0;
 
+    /** Called once nothing more is stored here, when a rotating database
+        makes this its archive. The backend only serves reads from then on.
+    */
+    virtual void
+    setArchived()
+    {
+    }
+
     /** Perform consistency checks on database.
      *
      * This method is implemented only by NuDBBackend. It is not yet called
@@ -185,6 +225,36 @@ public:
     {
         return std::nullopt;
     }
+
+    /** Counts of the batches a backend has grouped its writes into. */
+    struct WriteBatchCounters
+    {
+        std::uint64_t batches = 0;
+        std::uint64_t objects = 0;
+
+        // The sum, over batches, of how long the first object waited
+        std::uint64_t queueDelayUs = 0;
+    };
+
+    /** Returns counts of the batches written.
+
+        @note Only reported by backends which batch their writes.
+    */
+    virtual std::optional<WriteBatchCounters>
+    writeBatchCounters() const
+    {
+        return std::nullopt;
+    }
+
+    /** Returns the bytes of memory used to hold the stored objects.
+
+        @note Only reported by backends which keep them in memory.
+    */
+    virtual std::optional<std::uint64_t>
+    memoryUsage() const
+    {
+        return std::nullopt;
+    }
 };
 
 }  // namespace NodeStore
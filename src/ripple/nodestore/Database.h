@@ -305,6 +305,10 @@ protected:
     std::atomic<std::uint32_t> fetchHitCount_{0};
     std::atomic<std::uint32_t> fetchSz_{0};
 
+    // Set when fetches go through lookup filters, which enables reporting
+    // their counts.
+    bool lookupFilter_{false};
+
     // The default is DEFAULT_LEDGERS_PER_SHARD (16384) to match the XRP ledger
     // network. Can be set through the configuration file using the
     // 'ledgers_per_shard' field under the 'node_db' and 'shard_db' stanzas.
@@ -359,6 +363,8 @@ private:
     std::atomic<std::uint64_t> fetchTotalCount_{0};
     std::atomic<std::uint64_t> fetchDurationUs_{0};
     std::atomic<std::uint64_t> storeDurationUs_{0};
+    std::atomic<std::uint64_t> fetchFilterSkips_{0};
+    std::atomic<std::uint64_t> fetchFilterFalsePositives_{0};
 
     mutable std::mutex readLock_;
     std::condition_variable readCondVar_;
@@ -403,6 +409,27 @@ private:
         return std::nullopt;
     }
 
+    /** Returns the memory used by in-memory backends, if any. */
+    virtual std::optional<std::uint64_t>
+    getMemoryUsage() const
+    {
+        return std::nullopt;
+    }
+
+    /** Returns counts of the batches backends grouped writes into, if any. */
+    virtual std::optional<Backend::WriteBatchCounters>
+    getWriteBatchCounters() const
+    {
+        return std::nullopt;
+    }
+
+    /** Returns how many objects backends found with Backend::fetchAsync. */
+    virtual std::optional<std::uint64_t>
+    getAsyncReads() const
+    {
+        return std::nullopt;
+    }
+
     void
     threadEntry();
 };
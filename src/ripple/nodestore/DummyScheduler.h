@@ -37,6 +37,8 @@ public:
     onFetch(FetchReport const& report) override;
     void
     onBatchWrite(BatchWriteReport const& report) override;
+    void
+    scheduleCompletions(std::function<void()> f) override;
 };
 
 }  // namespace NodeStore
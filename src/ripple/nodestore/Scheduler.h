@@ -22,6 +22,8 @@
 
 #include <ripple/nodestore/Task.h>
 #include <chrono>
+#include <cstdint>
+#include <functional>
 
 namespace ripple {
 namespace NodeStore {
@@ -38,6 +40,11 @@ struct FetchReport
     std::chrono::milliseconds elapsed;
     FetchType const fetchType;
     bool wasFound = false;
+
+    // Backend lookups skipped because a lookup filter ruled the key out,
+    // and lookups the filter let through that found nothing.
+    std::uint32_t filterSkips = 0;
+    std::uint32_t filterFalsePositives = 0;
 };
 
 /** Contains information about a batch write operation. */
@@ -81,6 +88,14 @@ public:
     */
     virtual void
     onBatchWrite(BatchWriteReport const& report) = 0;
+
+    /** Runs the callbacks of completed asynchronous fetches.
+        Depending on the implementation, the function may be invoked either
+        on the current thread of execution, or a foreign thread. It is
+        always invoked, even while shutting down.
+    */
+    virtual void
+    scheduleCompletions(std::function<void()> f) = 0;
 };
 
 }  // namespace NodeStore
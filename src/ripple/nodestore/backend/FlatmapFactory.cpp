@@ -1,9 +1,7 @@
 #include <ripple/basics/contract.h>
 #include <ripple/nodestore/Factory.h>
 #include <ripple/nodestore/Manager.h>
-#include <ripple/nodestore/impl/DecodedBlob.h>
-#include <ripple/nodestore/impl/EncodedBlob.h>
-#include <ripple/nodestore/impl/codec.h>
+#include <ripple/nodestore/impl/StoredObject.h>
 #include <boost/beast/core/string.hpp>
 #include <boost/core/ignore_unused.hpp>
 #include <boost/unordered/concurrent_flat_map.hpp>
@@ -31,12 +29,11 @@ private:
         }
     };
 
-    using DataStore = boost::unordered::concurrent_flat_map<
-        uint256,
-        std::vector<std::uint8_t>,  // Store compressed blob data
-        base_uint_hasher>;
+    using DataStore = boost::unordered::
+        concurrent_flat_map<uint256, StoredObject, base_uint_hasher>;
 
     DataStore table_;
+    bool compress_{true};
 
 public:
     FlatmapBackend(
@@ -46,6 +43,7 @@ public:
         : name_(get(keyValues, "path")), journal_(journal)
     {
         boost::ignore_unused(journal_);
+        get_if_exists(keyValues, "compress", compress_);
         if (name_.empty())
             name_ = "node_db";
     }
@@ -91,16 +89,7 @@ public:
         uint256 const hash(uint256::fromVoid(key));
 
         bool found = table_.visit(hash, [&](const auto& key_value_pair) {
-            nudb::detail::buffer bf;
-            auto const result = nodeobject_decompress(
-                key_value_pair.second.data(), key_value_pair.second.size(), bf);
-            DecodedBlob decoded(hash.data(), result.first, result.second);
-            if (!decoded.wasOk())
-            {
-                *pObject = nullptr;
-                return;
-            }
-            *pObject = decoded.createObject();
+            *pObject = key_value_pair.second.object(hash);
         });
         return found ? (*pObject ? ok : dataCorrupt) : notFound;
     }
@@ -131,16 +120,8 @@ public:
         if (!object)
             return;
 
-        EncodedBlob encoded(object);
-        nudb::detail::buffer bf;
-        auto const result =
-            nodeobject_compress(encoded.getData(), encoded.getSize(), bf);
-
-        std::vector<std::uint8_t> compressed(
-            static_cast<const std::uint8_t*>(result.first),
-            static_cast<const std::uint8_t*>(result.first) + result.second);
-
-        table_.insert_or_assign(object->getHash(), std::move(compressed));
+        table_.insert_or_assign(
+            object->getHash(), StoredObject(object, compress_, nullptr));
     }
 
     void
@@ -162,13 +143,8 @@ public:
             return;
 
         table_.visit_all([&f](const auto& entry) {
-            nudb::detail::buffer bf;
-            auto const result = nodeobject_decompress(
-                entry.second.data(), entry.second.size(), bf);
-            DecodedBlob decoded(
-                entry.first.data(), result.first, result.second);
-            if (decoded.wasOk())
-                f(decoded.createObject());
+            if (auto object = entry.second.object(entry.first))
+                f(std::move(object));
         });
     }
 
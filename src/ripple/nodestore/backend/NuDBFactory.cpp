@@ -20,8 +20,10 @@
 #include <ripple/basics/contract.h>
 #include <ripple/nodestore/Factory.h>
 #include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/BatchWriter.h>
 #include <ripple/nodestore/impl/DecodedBlob.h>
 #include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/nodestore/impl/NuDBReader.h>
 #include <ripple/nodestore/impl/codec.h>
 #include <boost/filesystem.hpp>
 #include <cassert>
@@ -35,7 +37,7 @@
 namespace ripple {
 namespace NodeStore {
 
-class NuDBBackend : public Backend
+class NuDBBackend : public Backend, public BatchWriter::Callback
 {
 public:
     static constexpr std::uint64_t currentType = 1;
@@ -48,7 +50,11 @@ public:
     size_t const keyBytes_;
     std::size_t const burstSize_;
     std::string const name_;
+    ZstdDictionary const* const dictionary_;
+    unsigned const ioUringDepth_;
     nudb::store db_;
+    std::unique_ptr<NuDBReader> reader_;
+    std::unique_ptr<BatchWriter> batch_;
     std::atomic<bool> deletePath_;
     Scheduler& scheduler_;
 
@@ -62,12 +68,20 @@ public:
         , keyBytes_(keyBytes)
         , burstSize_(burstSize)
         , name_(get(keyValues, "path"))
+        , dictionary_(ZstdDictionary::fromConfig(keyValues))
+        , ioUringDepth_(get<unsigned>(keyValues, "io_uring_depth", 0))
         , deletePath_(false)
         , scheduler_(scheduler)
     {
         if (name_.empty())
             Throw<std::runtime_error>(
                 "nodestore: Missing path in NuDB backend");
+
+        if (auto const groupCommit = BatchWriter::GroupCommit::fromConfig(
+                keyValues);
+            groupCommit.batchSize != 0)
+            batch_ = std::make_unique<BatchWriter>(
+                *this, scheduler_, groupCommit);
     }
 
     NuDBBackend(
@@ -81,6 +95,8 @@ public:
         , keyBytes_(keyBytes)
         , burstSize_(burstSize)
         , name_(get(keyValues, "path"))
+        , dictionary_(ZstdDictionary::fromConfig(keyValues))
+        , ioUringDepth_(get<unsigned>(keyValues, "io_uring_depth", 0))
         , db_(context)
         , deletePath_(false)
         , scheduler_(scheduler)
@@ -88,6 +104,12 @@ public:
         if (name_.empty())
             Throw<std::runtime_error>(
                 "nodestore: Missing path in NuDB backend");
+
+        if (auto const groupCommit = BatchWriter::GroupCommit::fromConfig(
+                keyValues);
+            groupCommit.batchSize != 0)
+            batch_ = std::make_unique<BatchWriter>(
+                *this, scheduler_, groupCommit);
     }
 
     ~NuDBBackend() override
@@ -161,6 +183,9 @@ public:
             (db_.appnum() & deterministicMask) != deterministicType)
             Throw<std::runtime_error>("nodestore: unknown appnum");
         db_.set_burst(burstSize_);
+
+        if (ioUringDepth_ != 0)
+            reader_ = NuDBReader::make(name_, ioUringDepth_, scheduler_, j_);
     }
 
     bool
@@ -180,6 +205,10 @@ public:
     {
         if (db_.is_open())
         {
+            // Write out what's waiting for a batch
+            batch_.reset();
+            reader_.reset();
+
             nudb::error_code ec;
             db_.close(ec);
             if (ec)
@@ -203,6 +232,22 @@ public:
 
     Status
     fetch(void const* key, std::shared_ptr<NodeObject>* pno) override
+    {
+        auto status = fetchStored(key, pno);
+
+        // An object waiting for its batch is found there, or in the
+        // database if the batch was written in the meantime.
+        if (status == notFound && batch_)
+        {
+            if ((*pno = batch_->find(uint256::fromVoid(key))))
+                return ok;
+            status = fetchStored(key, pno);
+        }
+        return status;
+    }
+
+    Status
+    fetchStored(void const* key, std::shared_ptr<NodeObject>* pno)
     {
         Status status;
         pno->reset();
@@ -247,13 +292,22 @@ public:
         return {results, ok};
     }
 
+    bool
+    fetchAsync(
+        uint256 const& hash,
+        std::function<void(std::shared_ptr<NodeObject>)> callback) override
+    {
+        return reader_ && reader_->fetch(hash, std::move(callback));
+    }
+
     void
     do_insert(std::shared_ptr<NodeObject> const& no)
     {
         EncodedBlob e(no);
         nudb::error_code ec;
         nudb::detail::buffer bf;
-        auto const result = nodeobject_compress(e.getData(), e.getSize(), bf);
+        auto const result =
+            nodeobject_compress(e.getData(), e.getSize(), bf, dictionary_);
         db_.insert(e.getKey(), result.first, result.second, ec);
         if (ec && ec != nudb::error::key_exists)
             Throw<nudb::system_error>(ec);
@@ -262,6 +316,9 @@ public:
     void
     store(std::shared_ptr<NodeObject> const& no) override
     {
+        if (batch_)
+            return batch_->store(no);
+
         BatchWriteReport report;
         report.writeCount = 1;
         auto const start = std::chrono::steady_clock::now();
@@ -329,7 +386,25 @@ public:
     int
     getWriteLoad() override
     {
-        return 0;
+        return batch_ ? batch_->getWriteLoad() : 0;
+    }
+
+    std::optional<WriteBatchCounters>
+    writeBatchCounters() const override
+    {
+        if (!batch_)
+            return std::nullopt;
+        return batch_->counters();
+    }
+
+    // Called by the BatchWriter with a group of stored objects. NuDB has
+    // no batch insert, so the objects are still inserted one at a time;
+    // grouping only moves the inserts off the storing threads.
+    void
+    writeBatch(Batch const& batch) override
+    {
+        for (auto const& e : batch)
+            do_insert(e);
     }
 
     void
@@ -360,7 +435,8 @@ public:
     int
     fdRequired() const override
     {
-        return 3;
+        // The io_uring reader opens the key and data files again
+        return ioUringDepth_ != 0 ? 6 : 3;
     }
 };
 
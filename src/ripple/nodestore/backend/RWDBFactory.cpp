@@ -1,14 +1,19 @@
+#include <ripple/basics/Log.h>
+#include <ripple/basics/SnapshotFile.h>
 #include <ripple/basics/contract.h>
+#include <ripple/beast/core/CurrentThreadName.h>
 #include <ripple/nodestore/Factory.h>
 #include <ripple/nodestore/Manager.h>
-#include <ripple/nodestore/impl/DecodedBlob.h>
-#include <ripple/nodestore/impl/EncodedBlob.h>
-#include <ripple/nodestore/impl/codec.h>
+#include <ripple/nodestore/impl/StoredObject.h>
+#include <ripple/nodestore/impl/ZstdDictionary.h>
 #include <boost/beast/core/string.hpp>
-#include <boost/core/ignore_unused.hpp>
 #include <boost/unordered/concurrent_flat_map.hpp>
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
 #include <memory>
 #include <mutex>
+#include <thread>
 
 namespace ripple {
 namespace NodeStore {
@@ -18,6 +23,7 @@ class RWDBBackend : public Backend
 private:
     std::string name_;
     beast::Journal journal_;
+    ZstdDictionary const* const dictionary_;
     bool isOpen_{false};
 
     struct base_uint_hasher
@@ -31,29 +37,70 @@ private:
         }
     };
 
-    using DataStore =
-        std::map<uint256, std::vector<std::uint8_t>>;  // Store compressed blob
-                                                       // data
+    using DataStore = std::map<uint256, StoredObject>;
+    bool compress_{true};
     mutable std::recursive_mutex
         mutex_;  // Only needed for std::map implementation
 
     DataStore table_;
 
+    // Optional on disk copy of table_, reloaded by open(). Objects are
+    // appended as they are first stored, by a background thread every
+    // snapshotInterval_ and on close(). Nothing is ever removed from the
+    // table, so the file only grows, like the table itself.
+    static constexpr std::uint32_t snapshotTag = 0x4e4f4445;  // "NODE"
+
+    std::unique_ptr<SnapshotFile> snapshot_;
+    std::chrono::seconds snapshotInterval_{0};
+    std::vector<uint256> unsaved_;  // guarded by mutex_
+    bool deletePath_{false};
+
+    std::thread snapshotThread_;
+    std::mutex snapshotMutex_;
+    std::condition_variable snapshotCond_;
+    bool stopSnapshots_{false};
+
 public:
     RWDBBackend(
         size_t keyBytes,
         Section const& keyValues,
         beast::Journal journal)
-        : name_(get(keyValues, "path")), journal_(journal)
+        : name_(get(keyValues, "path"))
+        , journal_(journal)
+        , dictionary_(ZstdDictionary::fromConfig(keyValues))
     {
-        boost::ignore_unused(journal_);
+        get_if_exists(keyValues, "compress", compress_);
+
+        bool snapshot = false;
+        get_if_exists(keyValues, "snapshot", snapshot);
+        if (snapshot)
+        {
+            if (name_.empty())
+                Throw<std::runtime_error>(
+                    "nodestore: Missing path for RWDB snapshot");
+
+            snapshot_ = std::make_unique<SnapshotFile>(
+                boost::filesystem::path(name_) / "rwdb.snapshot",
+                snapshotTag);
+            snapshotInterval_ = std::chrono::seconds(
+                get<std::uint32_t>(keyValues, "snapshot_interval", 0));
+        }
+
         if (name_.empty())
             name_ = "node_db";
     }
 
     ~RWDBBackend() override
     {
-        close();
+        try
+        {
+            close();
+        }
+        catch (std::exception const& e)
+        {
+            // Don't allow exceptions to propagate out of destructors.
+            JLOG(journal_.error()) << "RWDB snapshot: " << e.what();
+        }
     }
 
     std::string
@@ -68,6 +115,37 @@ public:
         std::lock_guard lock(mutex_);
         if (isOpen_)
             Throw<std::runtime_error>("already open");
+
+        if (snapshot_)
+        {
+            auto const start = std::chrono::steady_clock::now();
+            boost::filesystem::create_directories(name_);
+            auto const loaded = snapshot_->load([this](Slice record) {
+                if (record.size() < uint256::size())
+                    return;
+                auto const hash = uint256::fromVoid(record.data());
+                table_.insert_or_assign(
+                    hash,
+                    StoredObject(
+                        hash,
+                        record.substr(uint256::size()),
+                        compress_));
+            });
+            JLOG(journal_.info())
+                << "RWDB loaded " << loaded << " objects from "
+                << snapshot_->path().string() << " in "
+                << std::chrono::duration_cast<std::chrono::milliseconds>(
+                       std::chrono::steady_clock::now() - start)
+                       .count()
+                << "ms";
+
+            if (snapshotInterval_.count() > 0)
+            {
+                stopSnapshots_ = false;
+                snapshotThread_ = std::thread(&RWDBBackend::runSnapshots, this);
+            }
+        }
+
         isOpen_ = true;
     }
 
@@ -80,8 +158,29 @@ public:
     void
     close() override
     {
+        if (snapshotThread_.joinable())
+        {
+            {
+                std::lock_guard lock(snapshotMutex_);
+                stopSnapshots_ = true;
+            }
+            snapshotCond_.notify_all();
+            snapshotThread_.join();
+        }
+
         std::lock_guard lock(mutex_);
+        if (snapshot_ && isOpen_)
+        {
+            if (deletePath_)
+                snapshot_->remove();
+            else
+            {
+                saveSnapshot();
+                snapshot_->close();
+            }
+        }
         table_.clear();
+        unsaved_.clear();
         isOpen_ = false;
     }
 
@@ -98,14 +197,8 @@ public:
         if (it == table_.end())
             return notFound;
 
-        nudb::detail::buffer bf;
-        auto const result =
-            nodeobject_decompress(it->second.data(), it->second.size(), bf);
-        DecodedBlob decoded(hash.data(), result.first, result.second);
-        if (!decoded.wasOk())
-            return dataCorrupt;
-        *pObject = decoded.createObject();
-        return ok;
+        *pObject = it->second.object(hash);
+        return *pObject ? ok : dataCorrupt;
     }
 
     std::pair<std::vector<std::shared_ptr<NodeObject>>, Status>
@@ -134,17 +227,13 @@ public:
         if (!object)
             return;
 
-        EncodedBlob encoded(object);
-        nudb::detail::buffer bf;
-        auto const result =
-            nodeobject_compress(encoded.getData(), encoded.getSize(), bf);
-
-        std::vector<std::uint8_t> compressed(
-            static_cast<const std::uint8_t*>(result.first),
-            static_cast<const std::uint8_t*>(result.first) + result.second);
+        StoredObject stored(object, compress_, dictionary_);
 
         std::lock_guard lock(mutex_);
-        table_[object->getHash()] = std::move(compressed);
+        auto const [it, inserted] =
+            table_.insert_or_assign(object->getHash(), std::move(stored));
+        if (inserted && snapshot_)
+            unsaved_.push_back(it->first);
     }
 
     void
@@ -168,13 +257,8 @@ public:
         std::lock_guard lock(mutex_);
         for (const auto& entry : table_)
         {
-            nudb::detail::buffer bf;
-            auto const result = nodeobject_decompress(
-                entry.second.data(), entry.second.size(), bf);
-            DecodedBlob decoded(
-                entry.first.data(), result.first, result.second);
-            if (decoded.wasOk())
-                f(decoded.createObject());
+            if (auto object = entry.second.object(entry.first))
+                f(std::move(object));
         }
     }
 
@@ -187,6 +271,7 @@ public:
     void
     setDeletePath() override
     {
+        deletePath_ = true;
         close();
     }
 
@@ -203,6 +288,90 @@ private:
         std::lock_guard lock(mutex_);
         return table_.size();
     }
+
+    // Append the objects stored since the last call to the snapshot and
+    // sync it. If that fails the file drops everything since its last sync,
+    // so the objects are kept to be saved again by the next call.
+    void
+    saveSnapshot()
+    {
+        std::vector<uint256> unsaved;
+        {
+            std::lock_guard lock(mutex_);
+            unsaved.swap(unsaved_);
+        }
+
+        try
+        {
+            appendSnapshot(unsaved);
+            snapshot_->sync();
+        }
+        catch (...)
+        {
+            std::lock_guard lock(mutex_);
+            unsaved_.insert(unsaved_.end(), unsaved.begin(), unsaved.end());
+            throw;
+        }
+    }
+
+    void
+    appendSnapshot(std::vector<uint256> const& unsaved)
+    {
+        // Copy out a chunk of records at a time so fetches and stores are
+        // only held up for the copy, not for the writes.
+        std::size_t constexpr chunkSize = 1024;
+        std::vector<std::uint8_t> records;
+        std::vector<std::size_t> sizes;
+        for (std::size_t i = 0; i < unsaved.size(); i += chunkSize)
+        {
+            records.clear();
+            sizes.clear();
+            {
+                std::lock_guard lock(mutex_);
+                auto const end = std::min(i + chunkSize, unsaved.size());
+                for (auto j = i; j < end; ++j)
+                {
+                    auto const it = table_.find(unsaved[j]);
+                    if (it == table_.end())
+                        continue;
+                    records.insert(
+                        records.end(), it->first.begin(), it->first.end());
+                    sizes.push_back(
+                        uint256::size() +
+                        it->second.encode(records, dictionary_));
+                }
+            }
+
+            auto const* p = records.data();
+            for (auto const n : sizes)
+            {
+                snapshot_->append(Slice(p, n));
+                p += n;
+            }
+        }
+    }
+
+    void
+    runSnapshots()
+    {
+        beast::setCurrentThreadName("RWDB snapshot");
+
+        std::unique_lock lock(snapshotMutex_);
+        while (!snapshotCond_.wait_for(
+            lock, snapshotInterval_, [this] { return stopSnapshots_; }))
+        {
+            lock.unlock();
+            try
+            {
+                saveSnapshot();
+            }
+            catch (std::exception const& e)
+            {
+                JLOG(journal_.error()) << "RWDB snapshot: " << e.what();
+            }
+            lock.lock();
+        }
+    }
 };
 
 class RWDBFactory : public Factory
@@ -91,6 +91,7 @@ public:
     beast::Journal m_journal;
     size_t const m_keyBytes;
     BatchWriter m_batch;
+    bool m_walSync = false;
     std::string m_name;
     std::unique_ptr<rocksdb::DB> m_db;
     int fdRequired_ = 2048;
@@ -105,11 +106,18 @@ public:
         : m_deletePath(false)
         , m_journal(journal)
         , m_keyBytes(keyBytes)
-        , m_batch(*this, scheduler)
+        , m_batch(
+              *this,
+              scheduler,
+              BatchWriter::GroupCommit::fromConfig(keyValues))
     {
         if (!get_if_exists(keyValues, "path", m_name))
             Throw<std::runtime_error>("Missing path in RocksDBFactory backend");
 
+        // Each batch is synced to the write ahead log, which group commit
+        // makes affordable.
+        get_if_exists(keyValues, "wal_sync", m_walSync);
+
         rocksdb::BlockBasedTableOptions table_options;
         m_options.env = env;
 
@@ -253,6 +261,7 @@ public:
     {
         if (m_db)
         {
+            m_batch.waitForWriting();
             m_db.reset();
             if (m_deletePath)
             {
@@ -272,6 +281,23 @@ public:
 
     Status
     fetch(void const* key, std::shared_ptr<NodeObject>* pObject) override
+    {
+        auto status = fetchStored(key, pObject);
+
+        // With group commit an object waiting for its batch is found
+        // there, or in the database if the batch was written in the
+        // meantime.
+        if (status == notFound && m_batch.isIndexed())
+        {
+            if ((*pObject = m_batch.find(uint256::fromVoid(key))))
+                return ok;
+            status = fetchStored(key, pObject);
+        }
+        return status;
+    }
+
+    Status
+    fetchStored(void const* key, std::shared_ptr<NodeObject>* pObject)
     {
         assert(m_db);
         pObject->reset();
@@ -365,7 +391,8 @@ public:
                     encoded.getSize()));
         }
 
-        rocksdb::WriteOptions const options;
+        rocksdb::WriteOptions options;
+        options.sync = m_walSync;
 
         auto ret = m_db->Write(options, &wb);
 
@@ -420,6 +447,12 @@ public:
         return m_batch.getWriteLoad();
     }
 
+    std::optional<WriteBatchCounters>
+    writeBatchCounters() const override
+    {
+        return m_batch.counters();
+    }
+
     void
     setDeletePath() override
     {
@@ -0,0 +1,506 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/contract.h>
+#include <ripple/basics/hardened_hash.h>
+#include <ripple/nodestore/Factory.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/DecodedBlob.h>
+#include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/nodestore/impl/codec.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+/** A memory only backend which packs objects densely.
+
+    The map based memory backends pay for a heap allocation, a vector and a
+    tree or table node for every object, which over tens of millions of
+    objects adds up to gigabytes. Here the compressed blobs are instead
+    appended to large pages, each prefixed by its size, and an open
+    addressing table maps every key to the location of its blob.
+
+    Keys are spread over shards, each with its own lock, pages and table,
+    so stores to different shards proceed in parallel. Fetches take no lock:
+    a slot's key is written before its location is published, blobs are
+    written before the slot is, and neither changes afterwards. When a
+    table fills up it is copied into one twice the size and the old one is
+    retired rather than freed, as a fetch may still be probing it; retired
+    tables are released on close, and add at most the size of the current
+    table.
+
+    Each fetch registers itself with its shard for as long as it reads the
+    shard's tables and pages. Closing the backend, which happens to the
+    archive on every rotation while fetches may still be running against
+    it, unpublishes the table and then waits for the registered fetches to
+    finish before anything is freed.
+*/
+class SlabBackend : public Backend
+{
+private:
+    static constexpr std::size_t shardCount = 16;
+    static constexpr std::size_t pageBytes = 8 * 1024 * 1024;
+    static constexpr std::size_t maxPages = 16 * 1024;
+    static constexpr std::size_t initialSlots = 1024;
+
+    struct Slot
+    {
+        uint256 key;
+        // (page + 1) << 32 | offset, zero while the slot is empty
+        std::atomic<std::uint64_t> location{0};
+    };
+
+    struct Table
+    {
+        explicit Table(std::size_t size) : mask(size - 1), slots(size)
+        {
+        }
+
+        std::size_t const mask;
+        std::vector<Slot> slots;
+    };
+
+    struct alignas(64) Shard
+    {
+        std::mutex mutable mutex;
+        std::atomic<Table const*> table{nullptr};
+
+        // Fetches currently reading the table or pages, see ReadGuard
+        std::atomic<std::uint32_t> mutable readers{0};
+
+        // Everything below is guarded by mutex
+        std::unique_ptr<Table> current;
+        std::vector<std::unique_ptr<Table>> retired;
+        std::size_t count = 0;
+
+        std::unique_ptr<std::atomic<std::uint8_t*>[]> pages;
+        std::vector<std::unique_ptr<std::uint8_t[]>> owned;
+        std::size_t pageCount = 0;
+        std::size_t pageUsed = 0;
+        std::size_t pageSize = 0;
+        std::size_t pageTotal = 0;
+    };
+
+    // Registers a fetch with a shard until it is done reading from it.
+    // Together with the sequentially consistent table accesses this is a
+    // Dekker style handshake with close(): either close() sees the reader
+    // and waits for it, or the reader sees the table already unpublished.
+    class ReadGuard
+    {
+        std::atomic<std::uint32_t>& readers_;
+
+    public:
+        explicit ReadGuard(Shard const& shard) : readers_(shard.readers)
+        {
+            readers_.fetch_add(1, std::memory_order_seq_cst);
+        }
+
+        ~ReadGuard()
+        {
+            readers_.fetch_sub(1, std::memory_order_release);
+        }
+
+        ReadGuard(ReadGuard const&) = delete;
+        ReadGuard&
+        operator=(ReadGuard const&) = delete;
+    };
+
+    std::string name_;
+    ZstdDictionary const* const dictionary_;
+    std::atomic<bool> isOpen_{false};
+    hardened_hash<> const hasher_;
+    std::array<Shard, shardCount> shards_;
+
+public:
+    SlabBackend(size_t keyBytes, Section const& keyValues)
+        : name_(get(keyValues, "path"))
+        , dictionary_(ZstdDictionary::fromConfig(keyValues))
+    {
+        if (name_.empty())
+            name_ = "node_db";
+    }
+
+    ~SlabBackend() override
+    {
+        close();
+    }
+
+    std::string
+    getName() override
+    {
+        return name_;
+    }
+
+    void
+    open(bool createIfMissing) override
+    {
+        if (isOpen_)
+            Throw<std::runtime_error>("already open");
+
+        for (auto& shard : shards_)
+        {
+            std::lock_guard lock(shard.mutex);
+            shard.current = std::make_unique<Table>(initialSlots);
+            shard.table.store(shard.current.get(), std::memory_order_release);
+            shard.pages.reset(new std::atomic<std::uint8_t*>[maxPages]);
+            for (std::size_t i = 0; i < maxPages; ++i)
+                shard.pages[i].store(nullptr, std::memory_order_relaxed);
+        }
+        isOpen_ = true;
+    }
+
+    bool
+    isOpen() override
+    {
+        return isOpen_;
+    }
+
+    void
+    close() override
+    {
+        isOpen_ = false;
+        for (auto& shard : shards_)
+        {
+            std::lock_guard lock(shard.mutex);
+            shard.table.store(nullptr, std::memory_order_seq_cst);
+
+            // Fetches which found the table before it was unpublished may
+            // still be reading it or the pages
+            while (shard.readers.load(std::memory_order_seq_cst) != 0)
+                std::this_thread::yield();
+
+            shard.current.reset();
+            shard.retired.clear();
+            shard.count = 0;
+            shard.pages.reset();
+            shard.owned.clear();
+            shard.pageCount = 0;
+            shard.pageUsed = 0;
+            shard.pageSize = 0;
+            shard.pageTotal = 0;
+        }
+    }
+
+    Status
+    fetch(void const* key, std::shared_ptr<NodeObject>* pObject) override
+    {
+        if (!isOpen_)
+            return notFound;
+
+        uint256 const hash(uint256::fromVoid(key));
+        auto const h = hasher_(hash);
+        auto const& shard = shards_[shardOf(h)];
+
+        ReadGuard const guard(shard);
+        auto const* table = shard.table.load(std::memory_order_seq_cst);
+        if (!table)
+            return notFound;
+
+        for (auto i = h & table->mask;; i = (i + 1) & table->mask)
+        {
+            auto const& slot = table->slots[i];
+            auto const location = slot.location.load(std::memory_order_acquire);
+            if (location == 0)
+                return notFound;
+            if (slot.key != hash)
+                continue;
+
+            auto const* record =
+                shard.pages[(location >> 32) - 1].load(
+                    std::memory_order_relaxed) +
+                (location & 0xffffffff);
+            std::uint32_t size;
+            std::memcpy(&size, record, sizeof(size));
+
+            nudb::detail::buffer bf;
+            auto const result =
+                nodeobject_decompress(record + sizeof(size), size, bf);
+            DecodedBlob decoded(hash.data(), result.first, result.second);
+            if (!decoded.wasOk())
+                return dataCorrupt;
+            *pObject = decoded.createObject();
+            return ok;
+        }
+    }
+
+    std::pair<std::vector<std::shared_ptr<NodeObject>>, Status>
+    fetchBatch(std::vector<uint256 const*> const& hashes) override
+    {
+        std::vector<std::shared_ptr<NodeObject>> results;
+        results.reserve(hashes.size());
+        for (auto const& h : hashes)
+        {
+            std::shared_ptr<NodeObject> nObj;
+            Status status = fetch(h->begin(), &nObj);
+            if (status != ok)
+                results.push_back({});
+            else
+                results.push_back(nObj);
+        }
+        return {results, ok};
+    }
+
+    void
+    store(std::shared_ptr<NodeObject> const& object) override
+    {
+        if (!isOpen_)
+            return;
+
+        if (!object)
+            return;
+
+        EncodedBlob encoded(object);
+        nudb::detail::buffer bf;
+        auto const result = nodeobject_compress(
+            encoded.getData(), encoded.getSize(), bf, dictionary_);
+
+        auto const& hash = object->getHash();
+        auto const h = hasher_(hash);
+        auto& shard = shards_[shardOf(h)];
+
+        std::lock_guard lock(shard.mutex);
+        if (!shard.current)
+            return;
+
+        // Keep the load factor at or below 3/4
+        if ((shard.count + 1) * 4 > shard.current->slots.size() * 3)
+            grow(shard);
+
+        auto& table = *shard.current;
+        auto i = h & table.mask;
+        for (;; i = (i + 1) & table.mask)
+        {
+            auto const location =
+                table.slots[i].location.load(std::memory_order_relaxed);
+            if (location == 0)
+                break;
+            // Objects are immutable, storing one again changes nothing
+            if (table.slots[i].key == hash)
+                return;
+        }
+
+        auto const location = append(
+            shard,
+            static_cast<std::uint8_t const*>(result.first),
+            result.second);
+        table.slots[i].key = hash;
+        table.slots[i].location.store(location, std::memory_order_release);
+        ++shard.count;
+    }
+
+    void
+    storeBatch(Batch const& batch) override
+    {
+        for (auto const& e : batch)
+            store(e);
+    }
+
+    void
+    sync() override
+    {
+    }
+
+    void
+    for_each(std::function<void(std::shared_ptr<NodeObject>)> f) override
+    {
+        if (!isOpen_)
+            return;
+
+        for (auto& shard : shards_)
+        {
+            std::lock_guard lock(shard.mutex);
+            if (!shard.current)
+                continue;
+
+            for (auto const& slot : shard.current->slots)
+            {
+                auto const location =
+                    slot.location.load(std::memory_order_relaxed);
+                if (location == 0)
+                    continue;
+
+                auto const* record =
+                    shard.pages[(location >> 32) - 1].load(
+                        std::memory_order_relaxed) +
+                    (location & 0xffffffff);
+                std::uint32_t size;
+                std::memcpy(&size, record, sizeof(size));
+
+                nudb::detail::buffer bf;
+                auto const result =
+                    nodeobject_decompress(record + sizeof(size), size, bf);
+                DecodedBlob decoded(
+                    slot.key.data(), result.first, result.second);
+                if (decoded.wasOk())
+                    f(decoded.createObject());
+            }
+        }
+    }
+
+    int
+    getWriteLoad() override
+    {
+        return 0;
+    }
+
+    void
+    setDeletePath() override
+    {
+        close();
+    }
+
+    int
+    fdRequired() const override
+    {
+        return 0;
+    }
+
+    std::optional<std::uint64_t>
+    memoryUsage() const override
+    {
+        std::uint64_t bytes = 0;
+        for (auto const& shard : shards_)
+        {
+            std::lock_guard lock(shard.mutex);
+            if (!shard.current)
+                continue;
+
+            bytes += shard.pageTotal;
+            bytes += shard.current->slots.size() * sizeof(Slot);
+            for (auto const& t : shard.retired)
+                bytes += t->slots.size() * sizeof(Slot);
+            bytes += maxPages * sizeof(std::atomic<std::uint8_t*>);
+        }
+        return bytes;
+    }
+
+private:
+    static std::size_t
+    shardOf(std::size_t h)
+    {
+        // The table uses the low bits, pick the shard from the high ones
+        return h >> (64 - 4);
+    }
+
+    // Copy the shard's table into one twice the size. The old table stays
+    // valid for fetches still probing it.
+    void
+    grow(Shard& shard) const
+    {
+        auto const& from = *shard.current;
+        auto to = std::make_unique<Table>(from.slots.size() * 2);
+
+        // Nothing else writes to either table and the new one isn't visible
+        // until it is published below, so relaxed is enough here.
+        for (auto const& slot : from.slots)
+        {
+            auto const location =
+                slot.location.load(std::memory_order_relaxed);
+            if (location == 0)
+                continue;
+
+            auto i = hasher_(slot.key) & to->mask;
+            while (to->slots[i].location.load(std::memory_order_relaxed) != 0)
+                i = (i + 1) & to->mask;
+            to->slots[i].key = slot.key;
+            to->slots[i].location.store(location, std::memory_order_relaxed);
+        }
+
+        shard.table.store(to.get(), std::memory_order_release);
+        shard.retired.push_back(std::move(shard.current));
+        shard.current = std::move(to);
+    }
+
+    std::uint64_t
+    append(Shard& shard, std::uint8_t const* data, std::size_t size)
+    {
+        auto const bytes = sizeof(std::uint32_t) + size;
+        if (shard.pageCount == 0 || shard.pageUsed + bytes > shard.pageSize)
+        {
+            if (shard.pageCount == maxPages)
+                Throw<std::runtime_error>("nodestore: slab backend is full");
+
+            // A blob too large for a page gets a page of its own
+            auto const pageSize = std::max(pageBytes, bytes);
+            shard.owned.emplace_back(new std::uint8_t[pageSize]);
+            shard.pages[shard.pageCount].store(
+                shard.owned.back().get(), std::memory_order_relaxed);
+            ++shard.pageCount;
+            shard.pageUsed = 0;
+            shard.pageSize = pageSize;
+            shard.pageTotal += pageSize;
+        }
+
+        auto* record = shard.owned.back().get() + shard.pageUsed;
+        auto const size32 = static_cast<std::uint32_t>(size);
+        std::memcpy(record, &size32, sizeof(size32));
+        std::memcpy(record + sizeof(size32), data, size);
+
+        std::uint64_t const location =
+            (static_cast<std::uint64_t>(shard.pageCount) << 32) |
+            shard.pageUsed;
+        shard.pageUsed += bytes;
+        return location;
+    }
+};
+
+class SlabFactory : public Factory
+{
+public:
+    SlabFactory()
+    {
+        Manager::instance().insert(*this);
+    }
+
+    ~SlabFactory() override
+    {
+        Manager::instance().erase(*this);
+    }
+
+    std::string
+    getName() const override
+    {
+        return "Slab";
+    }
+
+    std::unique_ptr<Backend>
+    createInstance(
+        size_t keyBytes,
+        Section const& keyValues,
+        std::size_t burstSize,
+        Scheduler& scheduler,
+        beast::Journal journal) override
+    {
+        return std::make_unique<SlabBackend>(keyBytes, keyValues);
+    }
+};
+
+static SlabFactory slabFactory;
+
+}  // namespace NodeStore
+}  // namespace ripple
@@ -0,0 +1,510 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/contract.h>
+#include <ripple/basics/hardened_hash.h>
+#include <ripple/nodestore/Factory.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/BatchWriter.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+/** A memory tier for recent ledgers over a persistent backend.
+
+    Every object is stored in the persistent cold tier, configured by
+    cold_type and the other keys of the section. The objects of the last
+    hot_ledgers ledgers are also kept in memory, so that the reads around
+    ledger close, which are mostly for recent objects, are served from
+    memory. An object fetched from the cold tier is promoted to the memory
+    tier as if stored in the newest ledger, while the memory tier holds
+    less than hot_max_mb.
+
+    Objects are written to the cold tier as they are stored, and nothing
+    is lost on restart but the memory tier's contents, which fill again as
+    the node works. With write_behind the cold tier is instead written in
+    batches by a scheduled task, and stores only wait for the memory tier.
+    Stores are then acknowledged before the cold tier has them: the
+    objects of batches not yet written, at most a batch or the group
+    commit latency's worth, are lost if the process dies. They are
+    written out on close and on sync().
+
+    The memory tier ages objects out by ledger: each shard keeps, for each
+    ledger, the keys stored or promoted in it, and drops those not touched
+    since when the ledger falls out of the window. Nothing moves the window
+    once a rotation makes the backend the archive, so the memory tier is
+    then dropped and reads are no longer promoted.
+*/
+class TieredBackend : public Backend, public BatchWriter::Callback
+{
+private:
+    static constexpr std::size_t shardCount = 16;
+
+    // A rough per object cost of the memory tier, over the data itself
+    static constexpr std::size_t entryBytes =
+        sizeof(NodeObject) + 2 * uint256::size() + 64;
+
+    struct Entry
+    {
+        std::shared_ptr<NodeObject> object;
+        std::uint32_t ledgerSeq;
+    };
+
+    struct Shard
+    {
+        std::mutex mutex;
+        std::unordered_map<uint256, Entry, hardened_hash<>> objects;
+
+        // The keys stored or promoted in each ledger
+        std::map<std::uint32_t, std::vector<uint256>> ledgers;
+    };
+
+    std::string const name_;
+    std::unique_ptr<Backend> cold_;
+    std::uint32_t const hotLedgers_;
+    std::uint64_t const hotMaxBytes_;
+    Scheduler& scheduler_;
+    std::unique_ptr<BatchWriter> batch_;
+
+    // The newest ledger an object was stored for
+    std::atomic<std::uint32_t> newest_{0};
+    std::atomic<std::uint64_t> hotBytes_{0};
+    std::atomic<bool> archived_{false};
+    std::array<Shard, shardCount> shards_;
+
+public:
+    TieredBackend(
+        std::unique_ptr<Backend> cold,
+        std::uint32_t hotLedgers,
+        std::uint64_t hotMaxBytes,
+        Scheduler& scheduler,
+        std::optional<BatchWriter::GroupCommit> writeBehind)
+        : name_(cold->getName())
+        , cold_(std::move(cold))
+        , hotLedgers_(std::max<std::uint32_t>(hotLedgers, 1))
+        , hotMaxBytes_(hotMaxBytes)
+        , scheduler_(scheduler)
+    {
+        // Stores are acknowledged before the cold tier has them, so the
+        // objects waiting to be written must always be found
+        if (writeBehind)
+            batch_ = std::make_unique<BatchWriter>(
+                *this, scheduler, *writeBehind, true);
+    }
+
+    ~TieredBackend() override
+    {
+        batch_.reset();
+    }
+
+    std::string
+    getName() override
+    {
+        return name_;
+    }
+
+    void
+    open(bool createIfMissing) override
+    {
+        cold_->open(createIfMissing);
+    }
+
+    void
+    open(bool createIfMissing, uint64_t appType, uint64_t uid, uint64_t salt)
+        override
+    {
+        cold_->open(createIfMissing, appType, uid, salt);
+    }
+
+    bool
+    isOpen() override
+    {
+        return cold_->isOpen();
+    }
+
+    void
+    close() override
+    {
+        if (batch_)
+            batch_->waitForWriting();
+        clearHot();
+        cold_->close();
+    }
+
+    Status
+    fetch(void const* key, std::shared_ptr<NodeObject>* pObject) override
+    {
+        uint256 const hash(uint256::fromVoid(key));
+        if ((*pObject = fetchHot(hash)))
+            return ok;
+
+        // Written behind, an object leaves the batch only once the cold
+        // tier has it
+        if (batch_ && (*pObject = batch_->find(hash)))
+            return ok;
+
+        auto const status = cold_->fetch(key, pObject);
+        if (status == ok && *pObject)
+            promote(*pObject);
+        return status;
+    }
+
+    std::pair<std::vector<std::shared_ptr<NodeObject>>, Status>
+    fetchBatch(std::vector<uint256 const*> const& hashes) override
+    {
+        std::vector<std::shared_ptr<NodeObject>> results;
+        results.reserve(hashes.size());
+        for (auto const& h : hashes)
+        {
+            std::shared_ptr<NodeObject> nObj;
+            Status status = fetch(h->begin(), &nObj);
+            if (status != ok)
+                results.push_back({});
+            else
+                results.push_back(nObj);
+        }
+        return {results, ok};
+    }
+
+    bool
+    fetchAsync(
+        uint256 const& hash,
+        std::function<void(std::shared_ptr<NodeObject>)> callback) override
+    {
+        auto object = fetchHot(hash);
+        if (!object && batch_)
+            object = batch_->find(hash);
+        if (object)
+        {
+            scheduler_.scheduleCompletions(
+                [callback = std::move(callback), object = std::move(object)] {
+                    callback(object);
+                });
+            return true;
+        }
+
+        return cold_->fetchAsync(
+            hash,
+            [this, callback = std::move(callback)](
+                std::shared_ptr<NodeObject> object) {
+                if (object)
+                    promote(object);
+                callback(std::move(object));
+            });
+    }
+
+    void
+    store(std::shared_ptr<NodeObject> const& object) override
+    {
+        storeForLedger(object, 0);
+    }
+
+    void
+    storeForLedger(
+        std::shared_ptr<NodeObject> const& object,
+        std::uint32_t ledgerSeq) override
+    {
+        // Objects of ledgers older than the memory tier's, as when
+        // acquiring history, go to the cold tier only
+        if (ledgerSeq == 0)
+            ledgerSeq = newest_;
+        else
+            advance(ledgerSeq);
+        if (!archived_ && std::uint64_t(ledgerSeq) + hotLedgers_ > newest_)
+            insertHot(object, ledgerSeq);
+
+        if (batch_)
+            batch_->store(object);
+        else
+            cold_->store(object);
+    }
+
+    void
+    storeBatch(Batch const& batch) override
+    {
+        for (auto const& e : batch)
+            store(e);
+    }
+
+    void
+    sync() override
+    {
+        if (batch_)
+            batch_->waitForWriting();
+        cold_->sync();
+    }
+
+    void
+    for_each(std::function<void(std::shared_ptr<NodeObject>)> f) override
+    {
+        if (batch_)
+            batch_->waitForWriting();
+        cold_->for_each(f);
+    }
+
+    int
+    getWriteLoad() override
+    {
+        return cold_->getWriteLoad() + (batch_ ? batch_->getWriteLoad() : 0);
+    }
+
+    void
+    setDeletePath() override
+    {
+        cold_->setDeletePath();
+    }
+
+    void
+    setArchived() override
+    {
+        archived_ = true;
+        clearHot();
+        cold_->setArchived();
+    }
+
+    void
+    verify() override
+    {
+        cold_->verify();
+    }
+
+    int
+    fdRequired() const override
+    {
+        return cold_->fdRequired();
+    }
+
+    std::optional<Counters<std::uint64_t>>
+    counters() const override
+    {
+        return cold_->counters();
+    }
+
+    std::optional<WriteBatchCounters>
+    writeBatchCounters() const override
+    {
+        if (batch_)
+            return batch_->counters();
+        return cold_->writeBatchCounters();
+    }
+
+    std::optional<std::uint64_t>
+    memoryUsage() const override
+    {
+        return hotBytes_.load();
+    }
+
+    // Called by the BatchWriter with a group of stored objects
+    void
+    writeBatch(Batch const& batch) override
+    {
+        cold_->storeBatch(batch);
+    }
+
+private:
+    Shard&
+    shardFor(uint256 const& hash)
+    {
+        // Keys are hashes already, so any byte spreads them evenly
+        return shards_[*hash.data() % shardCount];
+    }
+
+    static std::uint64_t
+    bytesOf(NodeObject const& object)
+    {
+        return object.getData().size() + entryBytes;
+    }
+
+    std::shared_ptr<NodeObject>
+    fetchHot(uint256 const& hash)
+    {
+        auto& shard = shardFor(hash);
+        std::lock_guard lock(shard.mutex);
+        auto const it = shard.objects.find(hash);
+        if (it == shard.objects.end())
+            return nullptr;
+
+        // Keep objects which are still read, but don't list an object for
+        // every ledger it is read in
+        auto& entry = it->second;
+        auto const newest = newest_.load();
+        if (std::uint64_t(entry.ledgerSeq) + hotLedgers_ / 2 < newest)
+        {
+            entry.ledgerSeq = newest;
+            shard.ledgers[newest].push_back(hash);
+        }
+        return entry.object;
+    }
+
+    // Keep an object read from the cold tier as if stored in the newest
+    // ledger, unless the memory tier is full
+    void
+    promote(std::shared_ptr<NodeObject> const& object)
+    {
+        if (!archived_ && hotBytes_ < hotMaxBytes_)
+            insertHot(object, newest_);
+    }
+
+    void
+    clearHot()
+    {
+        for (auto& shard : shards_)
+        {
+            std::lock_guard lock(shard.mutex);
+            for (auto const& [_, entry] : shard.objects)
+                hotBytes_ -= bytesOf(*entry.object);
+            shard.objects.clear();
+            shard.ledgers.clear();
+        }
+    }
+
+    void
+    insertHot(
+        std::shared_ptr<NodeObject> const& object,
+        std::uint32_t ledgerSeq)
+    {
+        auto const& hash = object->getHash();
+        auto& shard = shardFor(hash);
+        std::lock_guard lock(shard.mutex);
+        auto const [it, inserted] =
+            shard.objects.try_emplace(hash, Entry{object, ledgerSeq});
+        if (inserted)
+            hotBytes_ += bytesOf(*object);
+        else if (it->second.ledgerSeq < ledgerSeq)
+            it->second.ledgerSeq = ledgerSeq;
+        else
+            return;
+        shard.ledgers[ledgerSeq].push_back(hash);
+    }
+
+    // Move the window of ledgers held in memory forward
+    void
+    advance(std::uint32_t ledgerSeq)
+    {
+        auto newest = newest_.load();
+        do
+        {
+            if (ledgerSeq <= newest)
+                return;
+        } while (!newest_.compare_exchange_weak(newest, ledgerSeq));
+
+        if (ledgerSeq < hotLedgers_)
+            return;
+        auto const oldest = ledgerSeq - hotLedgers_ + 1;
+        for (auto& shard : shards_)
+        {
+            std::lock_guard lock(shard.mutex);
+            auto const end = shard.ledgers.lower_bound(oldest);
+            for (auto it = shard.ledgers.begin(); it != end; ++it)
+            {
+                for (auto const& hash : it->second)
+                {
+                    auto const entry = shard.objects.find(hash);
+                    if (entry != shard.objects.end() &&
+                        entry->second.ledgerSeq == it->first)
+                    {
+                        hotBytes_ -= bytesOf(*entry->second.object);
+                        shard.objects.erase(entry);
+                    }
+                }
+            }
+            shard.ledgers.erase(shard.ledgers.begin(), end);
+        }
+    }
+};
+
+//------------------------------------------------------------------------------
+
+class TieredFactory : public Factory
+{
+public:
+    TieredFactory()
+    {
+        Manager::instance().insert(*this);
+    }
+
+    ~TieredFactory() override
+    {
+        Manager::instance().erase(*this);
+    }
+
+    std::string
+    getName() const override
+    {
+        return "Tiered";
+    }
+
+    std::unique_ptr<Backend>
+    createInstance(
+        size_t keyBytes,
+        Section const& keyValues,
+        std::size_t burstSize,
+        Scheduler& scheduler,
+        beast::Journal journal) override
+    {
+        auto const coldType =
+            get(keyValues, "cold_type", std::string("NuDB"));
+        auto const factory = Manager::instance().find(coldType);
+        if (!factory || factory == this)
+            Throw<std::runtime_error>(
+                "nodestore: Unknown cold_type '" + coldType + "'");
+
+        bool writeBehind = false;
+        get_if_exists(keyValues, "write_behind", writeBehind);
+
+        // The cold tier gets the rest of the section, except the group
+        // commit keys when this backend groups the writes itself
+        Section cold(keyValues.name());
+        for (auto const& [key, value] : keyValues)
+        {
+            if (key == "type" || key == "cold_type" || key == "hot_ledgers" ||
+                key == "hot_max_mb" || key == "write_behind")
+                continue;
+            if (writeBehind && key.starts_with("group_commit_"))
+                continue;
+            cold.set(key, value);
+        }
+        cold.set("type", coldType);
+
+        std::optional<BatchWriter::GroupCommit> groupCommit;
+        if (writeBehind)
+            groupCommit = BatchWriter::GroupCommit::fromConfig(keyValues);
+
+        return std::make_unique<TieredBackend>(
+            factory->createInstance(
+                keyBytes, cold, burstSize, scheduler, journal),
+            get<std::uint32_t>(keyValues, "hot_ledgers", 256),
+            get<std::uint64_t>(keyValues, "hot_max_mb", 1024) * 1024 * 1024,
+            scheduler,
+            groupCommit);
+    }
+};
+
+static TieredFactory tieredFactory;
+
+}  // namespace NodeStore
+}  // namespace ripple
@@ -18,15 +18,39 @@
 //==============================================================================
 
 #include <ripple/nodestore/impl/BatchWriter.h>
+#include <algorithm>
 
 namespace ripple {
 namespace NodeStore {
 
+BatchWriter::GroupCommit
+BatchWriter::GroupCommit::fromConfig(Section const& config)
+{
+    GroupCommit groupCommit;
+    groupCommit.batchSize = std::min<std::size_t>(
+        get<std::size_t>(config, "group_commit_size", 0), batchWriteLimitSize);
+    if (groupCommit.batchSize != 0)
+        groupCommit.maxDelay = std::chrono::milliseconds(
+            get<std::uint32_t>(config, "group_commit_latency_ms", 10));
+    return groupCommit;
+}
+
 BatchWriter::BatchWriter(Callback& callback, Scheduler& scheduler)
+    : BatchWriter(callback, scheduler, GroupCommit{})
+{
+}
+
+BatchWriter::BatchWriter(
+    Callback& callback,
+    Scheduler& scheduler,
+    GroupCommit const& groupCommit,
+    bool indexPending)
     : m_callback(callback)
     , m_scheduler(scheduler)
+    , mGroupCommit(groupCommit)
     , mWriteLoad(0)
     , mWritePending(false)
+    , mIndexed(indexPending || groupCommit.batchSize != 0)
 {
     mWriteSet.reserve(batchWritePreallocationSize);
 }
@@ -39,21 +63,36 @@ BatchWriter::~BatchWriter()
 void
 BatchWriter::store(std::shared_ptr<NodeObject> const& object)
 {
-    std::unique_lock<decltype(mWriteMutex)> sl(mWriteMutex);
+    {
+        std::unique_lock<decltype(mWriteMutex)> sl(mWriteMutex);
 
-    // If the batch has reached its limit, we wait
-    // until the batch writer is finished
-    while (mWriteSet.size() >= batchWriteLimitSize)
-        mWriteCondition.wait(sl);
+        // If the batch has reached its limit, we wait
+        // until the batch writer is finished
+        while (mWriteSet.size() >= batchWriteLimitSize)
+            mWriteCondition.wait(sl);
 
-    mWriteSet.push_back(object);
+        if (mWriteSet.empty())
+            mFirstQueued = std::chrono::steady_clock::now();
+        mWriteSet.push_back(object);
 
-    if (!mWritePending)
-    {
-        mWritePending = true;
+        if (mIndexed)
+        {
+            std::lock_guard pl(mPendingMutex);
+            mPending.insert_or_assign(object->getHash(), object);
+        }
+
+        // Wake the writer waiting for the batch to fill
+        if (mWriteSet.size() == mGroupCommit.batchSize)
+            mWriteCondition.notify_all();
 
-        m_scheduler.scheduleTask(*this);
+        if (mWritePending)
+            return;
+        mWritePending = true;
     }
+
+    // Not holding the lock, which the task may wait on to let the batch
+    // fill, if the scheduler runs it here.
+    m_scheduler.scheduleTask(*this);
 }
 
 int
@@ -64,6 +103,28 @@ BatchWriter::getWriteLoad()
     return std::max(mWriteLoad, static_cast<int>(mWriteSet.size()));
 }
 
+std::shared_ptr<NodeObject>
+BatchWriter::find(uint256 const& hash)
+{
+    if (!mIndexed)
+        return nullptr;
+
+    std::lock_guard pl(mPendingMutex);
+
+    auto const it = mPending.find(hash);
+    if (it == mPending.end())
+        return nullptr;
+    return it->second;
+}
+
+Backend::WriteBatchCounters
+BatchWriter::counters() const
+{
+    std::lock_guard sl(mWriteMutex);
+
+    return mCounters;
+}
+
 void
 BatchWriter::performScheduledTask()
 {
@@ -79,12 +140,25 @@ BatchWriter::writeBatch()
 
         set.reserve(batchWritePreallocationSize);
 
+        std::chrono::steady_clock::time_point firstQueued;
+
         {
-            std::lock_guard sl(mWriteMutex);
+            std::unique_lock<decltype(mWriteMutex)> sl(mWriteMutex);
+
+            // With group commit, let the batch fill until its first
+            // object has waited as long as allowed.
+            if (mGroupCommit.batchSize != 0 && !mWriteSet.empty())
+            {
+                mWriteCondition.wait_until(
+                    sl, mFirstQueued + mGroupCommit.maxDelay, [this] {
+                        return mWriteSet.size() >= mGroupCommit.batchSize;
+                    });
+            }
 
             mWriteSet.swap(set);
             assert(mWriteSet.empty());
             mWriteLoad = set.size();
+            firstQueued = mFirstQueued;
 
             if (set.empty())
             {
@@ -102,8 +176,33 @@ BatchWriter::writeBatch()
 
         m_callback.writeBatch(set);
 
+        auto const after = std::chrono::steady_clock::now();
         report.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
-            std::chrono::steady_clock::now() - before);
+            after - before);
+
+        if (mIndexed)
+        {
+            // Written, so the backend finds these now. An object stored
+            // again since stays until its newer copy is written.
+            std::lock_guard pl(mPendingMutex);
+            for (auto const& object : set)
+            {
+                auto const it = mPending.find(object->getHash());
+                if (it != mPending.end() && it->second == object)
+                    mPending.erase(it);
+            }
+        }
+
+        {
+            std::lock_guard sl(mWriteMutex);
+
+            ++mCounters.batches;
+            mCounters.objects += set.size();
+            mCounters.queueDelayUs +=
+                std::chrono::duration_cast<std::chrono::microseconds>(
+                    before - firstQueued)
+                    .count();
+        }
 
         m_scheduler.onBatchWrite(report);
     }
@@ -20,9 +20,12 @@
 #ifndef RIPPLE_NODESTORE_BATCHWRITER_H_INCLUDED
 #define RIPPLE_NODESTORE_BATCHWRITER_H_INCLUDED
 
+#include <ripple/basics/UnorderedContainers.h>
+#include <ripple/nodestore/Backend.h>
 #include <ripple/nodestore/Scheduler.h>
 #include <ripple/nodestore/Task.h>
 #include <ripple/nodestore/Types.h>
+#include <chrono>
 #include <condition_variable>
 #include <mutex>
 
@@ -35,6 +38,11 @@ namespace NodeStore {
     class it not required. A backend can implement its own write batching,
     or skip write batching if doing so yields a performance benefit.
 
+    By default a batch holds whatever was stored by the time the task
+    runs. With group commit, the task waits for a batch to fill to a
+    target size, for at most a set time after its first object arrived,
+    so that concurrent stores share fewer and larger writes.
+
     @see Scheduler
 */
 class BatchWriter : private Task
@@ -53,9 +61,34 @@ public:
         writeBatch(Batch const& batch) = 0;
     };
 
+    /** How to group writes. */
+    struct GroupCommit
+    {
+        // The number of objects to wait for, or 0 not to wait
+        std::size_t batchSize = 0;
+
+        // The longest the first object of a batch waits for the rest
+        std::chrono::milliseconds maxDelay{0};
+
+        /** Read the group_commit_size and group_commit_latency_ms keys. */
+        static GroupCommit
+        fromConfig(Section const& config);
+    };
+
     /** Create a batch writer. */
     BatchWriter(Callback& callback, Scheduler& scheduler);
 
+    /** Create a batch writer grouping writes.
+
+        With group commit, or if indexPending is set, the objects waiting to
+        be written are indexed so that find() can return them.
+    */
+    BatchWriter(
+        Callback& callback,
+        Scheduler& scheduler,
+        GroupCommit const& groupCommit,
+        bool indexPending = false);
+
     /** Destroy a batch writer.
 
         Anything pending in the batch is written out before this returns.
@@ -74,13 +107,35 @@ public:
     int
     getWriteLoad();
 
+    /** Wait until everything stored has been written out. */
+    void
+    waitForWriting();
+
+    /** Returns true if find() can return objects not yet written out. */
+    bool
+    isIndexed() const
+    {
+        return mIndexed;
+    }
+
+    /** Find an object stored but not yet written out.
+
+        A backend can look here when it doesn't find an object, since
+        writes wait longer with group commit. Always returns nullptr unless
+        isIndexed().
+    */
+    std::shared_ptr<NodeObject>
+    find(uint256 const& hash);
+
+    /** Counts of the batches written so far. */
+    Backend::WriteBatchCounters
+    counters() const;
+
 private:
     void
     performScheduledTask() override;
     void
     writeBatch();
-    void
-    waitForWriting();
 
 private:
     using LockType = std::recursive_mutex;
@@ -88,11 +143,20 @@ private:
 
     Callback& m_callback;
     Scheduler& m_scheduler;
-    LockType mWriteMutex;
+    GroupCommit const mGroupCommit;
+    mutable LockType mWriteMutex;
     CondvarType mWriteCondition;
     int mWriteLoad;
     bool mWritePending;
     Batch mWriteSet;
+    std::chrono::steady_clock::time_point mFirstQueued;
+    Backend::WriteBatchCounters mCounters;
+
+    // The objects stored and not yet written out, when indexed. This has a
+    // lock of its own so that lookups don't wait on writers.
+    bool const mIndexed;
+    std::mutex mPendingMutex;
+    hash_map<uint256, std::shared_ptr<NodeObject>> mPending;
 };
 
 }  // namespace NodeStore
@@ -269,6 +269,10 @@ Database::fetchNodeObject(
         fetchSz_ += nodeObject->getData().size();
     }
     ++fetchTotalCount_;
+    if (fetchReport.filterSkips)
+        fetchFilterSkips_ += fetchReport.filterSkips;
+    if (fetchReport.filterFalsePositives)
+        fetchFilterFalsePositives_ += fetchReport.filterFalsePositives;
 
     fetchReport.elapsed = duration_cast<milliseconds>(dur);
     scheduler_.onFetch(fetchReport);
@@ -395,6 +399,13 @@ Database::getCountsJson(Json::Value& obj)
     obj[jss::node_read_bytes] = std::to_string(fetchSz_);
     obj[jss::node_reads_duration_us] = std::to_string(fetchDurationUs_);
 
+    if (lookupFilter_)
+    {
+        obj[jss::node_reads_filtered] = std::to_string(fetchFilterSkips_);
+        obj[jss::node_reads_filter_false_positives] =
+            std::to_string(fetchFilterFalsePositives_);
+    }
+
     if (auto c = getCounters())
     {
         obj[jss::node_read_errors] = std::to_string(c->readErrors);
@@ -403,6 +414,19 @@ Database::getCountsJson(Json::Value& obj)
         obj[jss::node_writes_delayed] = std::to_string(c->writesDelayed);
         obj[jss::node_writes_duration_us] = std::to_string(c->writeDurationUs);
     }
+
+    if (auto const bytes = getMemoryUsage())
+        obj[jss::node_memory_bytes] = std::to_string(*bytes);
+
+    if (auto const c = getWriteBatchCounters())
+    {
+        obj[jss::node_write_batches] = std::to_string(c->batches);
+        obj[jss::node_write_batch_objects] = std::to_string(c->objects);
+        obj[jss::node_write_queue_us] = std::to_string(c->queueDelayUs);
+    }
+
+    if (auto const reads = getAsyncReads())
+        obj[jss::node_reads_async] = std::to_string(*reads);
 }
 
 }  // namespace NodeStore
@@ -29,12 +29,12 @@ DatabaseNodeImp::store(
     NodeObjectType type,
     Blob&& data,
     uint256 const& hash,
-    std::uint32_t)
+    std::uint32_t ledgerSeq)
 {
     storeStats(1, data.size());
 
     auto obj = NodeObject::createObject(type, std::move(data), hash);
-    backend_->store(obj);
+    backend_->storeForLedger(obj, ledgerSeq);
     if (cache_)
     {
         // After the store, replace a negative cache entry if there is one
@@ -60,9 +60,62 @@ DatabaseNodeImp::asyncFetch(
             return;
         }
     }
+
+    if (!isStopping())
+    {
+        // The backend may read without tying up a read thread. What it
+        // doesn't find that way goes to the read threads, which know
+        // whether the object exists.
+        auto cb = std::make_shared<
+            std::function<void(std::shared_ptr<NodeObject> const&)>>(
+            std::move(callback));
+        auto const begin = std::chrono::steady_clock::now();
+
+        ++asyncReads_;
+        if (backend_->fetchAsync(
+                hash,
+                [this, hash, ledgerSeq, begin, cb](
+                    std::shared_ptr<NodeObject> nodeObject) {
+                    if (!nodeObject)
+                        Database::asyncFetch(hash, ledgerSeq, std::move(*cb));
+                    else
+                        fetched(hash, std::move(nodeObject), begin, *cb);
+                    --asyncReads_;
+                }))
+            return;
+        --asyncReads_;
+
+        callback = std::move(*cb);
+    }
     Database::asyncFetch(hash, ledgerSeq, std::move(callback));
 }
 
+void
+DatabaseNodeImp::fetched(
+    uint256 const& hash,
+    std::shared_ptr<NodeObject> nodeObject,
+    std::chrono::steady_clock::time_point begin,
+    std::function<void(std::shared_ptr<NodeObject> const&)> const& callback)
+{
+    using namespace std::chrono;
+
+    ++asyncFound_;
+    if (cache_)
+        cache_->canonicalize_replace_client(hash, nodeObject);
+
+    auto const elapsed = steady_clock::now() - begin;
+    updateFetchMetrics(1, 1, duration_cast<microseconds>(elapsed).count());
+    fetchSz_ += nodeObject->getData().size();
+
+    FetchReport fetchReport(FetchType::async);
+    fetchReport.elapsed = duration_cast<milliseconds>(elapsed);
+    fetchReport.wasFound = true;
+    scheduler_.onFetch(fetchReport);
+
+    if (!isStopping())
+        callback(nodeObject);
+}
+
 void
 DatabaseNodeImp::sweep()
 {
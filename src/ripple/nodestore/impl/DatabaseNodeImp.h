@@ -23,6 +23,8 @@
 #include <ripple/basics/TaggedCache.h>
 #include <ripple/basics/chrono.h>
 #include <ripple/nodestore/Database.h>
+#include <atomic>
+#include <thread>
 
 namespace ripple {
 namespace NodeStore {
@@ -82,6 +84,10 @@ public:
     ~DatabaseNodeImp()
     {
         stop();
+
+        // The backend still completes the reads it started
+        while (asyncReads_ != 0)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
     }
 
     std::string
@@ -143,6 +149,19 @@ private:
     std::shared_ptr<TaggedCache<uint256, NodeObject>> cache_;
     // Persistent key/value storage
     std::shared_ptr<Backend> backend_;
+    // Reads started with Backend::fetchAsync and not yet completed
+    std::atomic<int> asyncReads_{0};
+    // Objects found by reads started with Backend::fetchAsync
+    std::atomic<std::uint64_t> asyncFound_{0};
+
+    // Completes a read the backend did asynchronously
+    void
+    fetched(
+        uint256 const& hash,
+        std::shared_ptr<NodeObject> nodeObject,
+        std::chrono::steady_clock::time_point begin,
+        std::function<void(std::shared_ptr<NodeObject> const&)> const&
+            callback);
 
     std::shared_ptr<NodeObject>
     fetchNodeObject(
@@ -162,6 +181,26 @@ private:
     {
         return backend_->counters();
     }
+
+    std::optional<std::uint64_t>
+    getMemoryUsage() const override
+    {
+        return backend_->memoryUsage();
+    }
+
+    std::optional<Backend::WriteBatchCounters>
+    getWriteBatchCounters() const override
+    {
+        return backend_->writeBatchCounters();
+    }
+
+    std::optional<std::uint64_t>
+    getAsyncReads() const override
+    {
+        if (auto const found = asyncFound_.load(); found != 0)
+            return found;
+        return std::nullopt;
+    }
 };
 
 }  // namespace NodeStore
@@ -34,11 +34,57 @@ DatabaseRotatingImp::DatabaseRotatingImp(
     : DatabaseRotating(scheduler, readThreads, config, j)
     , writableBackend_(std::move(writableBackend))
     , archiveBackend_(std::move(archiveBackend))
+    , filterItems_(get<std::uint64_t>(config, "lookup_filter", 0))
 {
     if (writableBackend_)
         fdRequired_ += writableBackend_->fdRequired();
     if (archiveBackend_)
         fdRequired_ += archiveBackend_->fdRequired();
+
+    if (filterItems_ != 0)
+    {
+        lookupFilter_ = true;
+        writableFilter_ =
+            LookupFilter::load(filterPath(*writableBackend_), filterItems_);
+        archiveFilter_ =
+            LookupFilter::load(filterPath(*archiveBackend_), filterItems_);
+        JLOG(j_.info()) << "Lookup filters for " << filterItems_
+                        << " objects, writable "
+                        << (writableFilter_ ? "loaded" : "after rotation")
+                        << ", archive "
+                        << (archiveFilter_ ? "loaded" : "after rotation");
+    }
+}
+
+DatabaseRotatingImp::~DatabaseRotatingImp()
+{
+    stop();
+
+    // Nothing is written from here on, so the filters can be saved for the
+    // next start.
+    for (auto const& [backend, filter] :
+         {std::make_pair(writableBackend_, writableFilter_),
+          std::make_pair(archiveBackend_, archiveFilter_)})
+    {
+        // Only backends kept on disk outlive the process
+        if (!filter || !boost::filesystem::is_directory(backend->getName()))
+            continue;
+
+        try
+        {
+            filter->save(filterPath(*backend));
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(j_.warn()) << "Saving lookup filter: " << e.what();
+        }
+    }
+}
+
+boost::filesystem::path
+DatabaseRotatingImp::filterPath(Backend& backend)
+{
+    return backend.getName() + ".filter";
 }
 
 void
@@ -51,7 +97,15 @@ DatabaseRotatingImp::rotateWithLock(
     auto newBackend = f(writableBackend_->getName());
     archiveBackend_->setDeletePath();
     archiveBackend_ = std::move(writableBackend_);
+    archiveBackend_->setArchived();
     writableBackend_ = std::move(newBackend);
+
+    if (filterItems_ != 0)
+    {
+        // The new backend starts out empty, so its filter is complete
+        archiveFilter_ = std::move(writableFilter_);
+        writableFilter_ = std::make_shared<LookupFilter>(filterItems_);
+    }
 }
 
 std::string
@@ -71,8 +125,10 @@ DatabaseRotatingImp::getWriteLoad() const
 void
 DatabaseRotatingImp::importDatabase(Database& source)
 {
+    // These writes bypass the filter
     auto const backend = [&] {
         std::lock_guard lock(mutex_);
+        writableFilter_.reset();
         return writableBackend_;
     }();
 
@@ -82,8 +138,10 @@ DatabaseRotatingImp::importDatabase(Database& source)
 bool
 DatabaseRotatingImp::storeLedger(std::shared_ptr<Ledger const> const& srcLedger)
 {
+    // These writes bypass the filter
     auto const backend = [&] {
         std::lock_guard lock(mutex_);
+        writableFilter_.reset();
         return writableBackend_;
     }();
 
@@ -102,16 +160,19 @@ DatabaseRotatingImp::store(
     NodeObjectType type,
     Blob&& data,
     uint256 const& hash,
-    std::uint32_t)
+    std::uint32_t ledgerSeq)
 {
     auto nObj = NodeObject::createObject(type, std::move(data), hash);
 
-    auto const backend = [&] {
+    auto const [backend, filter] = [&] {
         std::lock_guard lock(mutex_);
-        return writableBackend_;
+        return std::make_pair(writableBackend_, writableFilter_);
     }();
 
-    backend->store(nObj);
+    // Into the filter first, so that no fetch can miss the object
+    if (filter)
+        filter->insert(hash);
+    backend->storeForLedger(nObj, ledgerSeq);
     storeStats(1, nObj->getData().size());
 }
 
@@ -121,6 +182,42 @@ DatabaseRotatingImp::sweep()
     // nothing to do
 }
 
+std::optional<std::uint64_t>
+DatabaseRotatingImp::getMemoryUsage() const
+{
+    auto const [writable, archive] = [&] {
+        std::lock_guard lock(mutex_);
+        return std::make_pair(writableBackend_, archiveBackend_);
+    }();
+
+    auto const w = writable->memoryUsage();
+    auto const a = archive->memoryUsage();
+    if (!w && !a)
+        return std::nullopt;
+    return w.value_or(0) + a.value_or(0);
+}
+
+std::optional<Backend::WriteBatchCounters>
+DatabaseRotatingImp::getWriteBatchCounters() const
+{
+    auto const [writable, archive] = [&] {
+        std::lock_guard lock(mutex_);
+        return std::make_pair(writableBackend_, archiveBackend_);
+    }();
+
+    auto w = writable->writeBatchCounters();
+    auto const a = archive->writeBatchCounters();
+    if (!w)
+        return a;
+    if (a)
+    {
+        w->batches += a->batches;
+        w->objects += a->objects;
+        w->queueDelayUs += a->queueDelayUs;
+    }
+    return w;
+}
+
 std::shared_ptr<NodeObject>
 DatabaseRotatingImp::fetchNodeObject(
     uint256 const& hash,
@@ -128,7 +225,14 @@ DatabaseRotatingImp::fetchNodeObject(
     FetchReport& fetchReport,
     bool duplicate)
 {
-    auto fetch = [&](std::shared_ptr<Backend> const& backend) {
+    auto fetch = [&](std::shared_ptr<Backend> const& backend,
+                     std::shared_ptr<LookupFilter> const& filter) {
+        if (filter && !filter->mayContain(hash))
+        {
+            ++fetchReport.filterSkips;
+            return std::shared_ptr<NodeObject>();
+        }
+
         Status status;
         std::shared_ptr<NodeObject> nodeObject;
         try
@@ -154,34 +258,47 @@ DatabaseRotatingImp::fetchNodeObject(
                 break;
         }
 
+        if (filter && !nodeObject)
+            ++fetchReport.filterFalsePositives;
+
         return nodeObject;
     };
 
     // See if the node object exists in the cache
     std::shared_ptr<NodeObject> nodeObject;
 
-    auto [writable, archive] = [&] {
+    std::shared_ptr<Backend> writable, archive;
+    std::shared_ptr<LookupFilter> writableFilter, archiveFilter;
+    {
         std::lock_guard lock(mutex_);
-        return std::make_pair(writableBackend_, archiveBackend_);
-    }();
+        writable = writableBackend_;
+        archive = archiveBackend_;
+        writableFilter = writableFilter_;
+        archiveFilter = archiveFilter_;
+    }
 
     // Try to fetch from the writable backend
-    nodeObject = fetch(writable);
+    nodeObject = fetch(writable, writableFilter);
     if (!nodeObject)
     {
         // Otherwise try to fetch from the archive backend
-        nodeObject = fetch(archive);
+        nodeObject = fetch(archive, archiveFilter);
         if (nodeObject)
         {
             {
                 // Refresh the writable backend pointer
                 std::lock_guard lock(mutex_);
                 writable = writableBackend_;
+                writableFilter = writableFilter_;
             }
 
             // Update writable backend with data from the archive backend
             if (duplicate)
+            {
+                if (writableFilter)
+                    writableFilter->insert(hash);
                 writable->store(nodeObject);
+            }
         }
     }
 
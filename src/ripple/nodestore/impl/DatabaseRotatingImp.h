@@ -21,6 +21,7 @@
 #define RIPPLE_NODESTORE_DATABASEROTATINGIMP_H_INCLUDED
 
 #include <ripple/nodestore/DatabaseRotating.h>
+#include <ripple/nodestore/impl/LookupFilter.h>
 
 namespace ripple {
 namespace NodeStore {
@@ -41,10 +42,7 @@ public:
         Section const& config,
         beast::Journal j);
 
-    ~DatabaseRotatingImp()
-    {
-        stop();
-    }
+    ~DatabaseRotatingImp();
 
     void
     rotateWithLock(
@@ -79,11 +77,29 @@ public:
     void
     sweep() override;
 
+    std::optional<std::uint64_t>
+    getMemoryUsage() const override;
+
+    std::optional<Backend::WriteBatchCounters>
+    getWriteBatchCounters() const override;
+
 private:
     std::shared_ptr<Backend> writableBackend_;
     std::shared_ptr<Backend> archiveBackend_;
+
+    // Filters of the keys in each backend, sized for filterItems_ keys.
+    // Null when disabled, or when the backend may hold keys its filter
+    // doesn't: a backend only gets a complete filter when it is created
+    // empty at rotation, or from the file saved at a clean shutdown.
+    std::uint64_t const filterItems_;
+    std::shared_ptr<LookupFilter> writableFilter_;
+    std::shared_ptr<LookupFilter> archiveFilter_;
+
     mutable std::mutex mutex_;
 
+    static boost::filesystem::path
+    filterPath(Backend& backend);
+
     std::shared_ptr<NodeObject>
     fetchNodeObject(
         uint256 const& hash,
@@ -87,5 +87,29 @@ DecodedBlob::createObject()
     return object;
 }
 
+std::shared_ptr<NodeObject>
+DecodedBlob::createObject(Blob&& storage)
+{
+    assert(m_success);
+    assert(
+        m_objectData >= storage.data() &&
+        m_objectData + m_dataBytes == storage.data() + storage.size());
+
+    std::shared_ptr<NodeObject> object;
+
+    if (m_success)
+    {
+        auto const hash = uint256::fromVoid(m_key);
+        storage.erase(
+            storage.begin(),
+            storage.begin() + (m_objectData - storage.data()));
+
+        object =
+            NodeObject::createObject(m_objectType, std::move(storage), hash);
+    }
+
+    return object;
+}
+
 }  // namespace NodeStore
 }  // namespace ripple
@@ -52,6 +52,15 @@ public:
     std::shared_ptr<NodeObject>
     createObject();
 
+    /** Create a NodeObject from this data, taking over its storage.
+
+        The value this was constructed from must be the contents of
+        storage. The prefix is removed in place, so the object's data is
+        not copied.
+    */
+    std::shared_ptr<NodeObject>
+    createObject(Blob&& storage);
+
 private:
     bool m_success;
 
@@ -39,5 +39,11 @@ DummyScheduler::onBatchWrite(const BatchWriteReport& report)
 {
 }
 
+void
+DummyScheduler::scheduleCompletions(std::function<void()> f)
+{
+    f();
+}
+
 }  // namespace NodeStore
 }  // namespace ripple
@@ -0,0 +1,300 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/contract.h>
+#include <ripple/nodestore/impl/IoUring.h>
+#include <boost/predef.h>
+#include <system_error>
+
+#if BOOST_OS_LINUX && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#endif
+
+// Reads need IORING_OP_READ, and probing for it, both from Linux 5.6
+#if defined(IO_URING_OP_SUPPORTED)
+#define RIPPLE_IO_URING 1
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+#endif
+
+namespace ripple {
+namespace NodeStore {
+
+#ifdef RIPPLE_IO_URING
+
+namespace {
+
+// The kernel updates the other side of each ring concurrently
+unsigned
+loadAcquire(unsigned const* p)
+{
+    return std::atomic_ref<unsigned const>(*p).load(std::memory_order_acquire);
+}
+
+void
+storeRelease(unsigned* p, unsigned v)
+{
+    std::atomic_ref<unsigned>(*p).store(v, std::memory_order_release);
+}
+
+struct Mapping
+{
+    void* p = MAP_FAILED;
+    std::size_t size = 0;
+
+    Mapping(int fd, std::size_t size_, off_t offset) : size(size_)
+    {
+        p = mmap(
+            nullptr,
+            size,
+            PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_POPULATE,
+            fd,
+            offset);
+    }
+
+    ~Mapping()
+    {
+        if (p != MAP_FAILED)
+            munmap(p, size);
+    }
+
+    Mapping(Mapping const&) = delete;
+    Mapping&
+    operator=(Mapping const&) = delete;
+
+    template <class T>
+    T*
+    at(std::size_t offset) const
+    {
+        return reinterpret_cast<T*>(static_cast<char*>(p) + offset);
+    }
+};
+
+}  // namespace
+
+struct IoUring::Rings
+{
+    std::unique_ptr<Mapping> sq;
+    std::unique_ptr<Mapping> cq;  // null if shared with sq
+    std::unique_ptr<Mapping> sqes;
+
+    unsigned* sqHead;
+    unsigned* sqTail;
+    unsigned sqMask;
+    unsigned sqEntries;
+    unsigned* sqArray;
+
+    unsigned* cqHead;
+    unsigned* cqTail;
+    unsigned cqMask;
+    io_uring_cqe* cqes;
+};
+
+std::unique_ptr<IoUring>
+IoUring::make(unsigned entries)
+{
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    int const fd = static_cast<int>(
+        syscall(__NR_io_uring_setup, std::max(entries, 1u), &params));
+    if (fd < 0)
+        return nullptr;
+
+    auto close = [fd] {
+        ::close(fd);
+        return nullptr;
+    };
+
+    // Check the kernel knows IORING_OP_READ
+    std::vector<std::uint8_t> buffer(
+        sizeof(io_uring_probe) + 256 * sizeof(io_uring_probe_op));
+    auto const probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+    if (syscall(
+            __NR_io_uring_register, fd, IORING_REGISTER_PROBE, probe, 256) <
+            0 ||
+        probe->last_op < IORING_OP_READ ||
+        !(probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED))
+        return close();
+
+    auto rings = std::make_unique<Rings>();
+    auto const sqSize =
+        params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    auto const cqSize =
+        params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+    bool const single = params.features & IORING_FEAT_SINGLE_MMAP;
+
+    rings->sq = std::make_unique<Mapping>(
+        fd, single ? std::max(sqSize, cqSize) : sqSize, IORING_OFF_SQ_RING);
+    if (!single)
+        rings->cq = std::make_unique<Mapping>(fd, cqSize, IORING_OFF_CQ_RING);
+    rings->sqes = std::make_unique<Mapping>(
+        fd, params.sq_entries * sizeof(io_uring_sqe), IORING_OFF_SQES);
+    auto const& cq = single ? *rings->sq : *rings->cq;
+    if (rings->sq->p == MAP_FAILED || cq.p == MAP_FAILED ||
+        rings->sqes->p == MAP_FAILED)
+        return close();
+
+    auto const& sq = *rings->sq;
+    rings->sqHead = sq.at<unsigned>(params.sq_off.head);
+    rings->sqTail = sq.at<unsigned>(params.sq_off.tail);
+    rings->sqMask = *sq.at<unsigned>(params.sq_off.ring_mask);
+    rings->sqEntries = *sq.at<unsigned>(params.sq_off.ring_entries);
+    rings->sqArray = sq.at<unsigned>(params.sq_off.array);
+    rings->cqHead = cq.at<unsigned>(params.cq_off.head);
+    rings->cqTail = cq.at<unsigned>(params.cq_off.tail);
+    rings->cqMask = *cq.at<unsigned>(params.cq_off.ring_mask);
+    rings->cqes = cq.at<io_uring_cqe>(params.cq_off.cqes);
+
+    return std::unique_ptr<IoUring>(new IoUring(fd, std::move(rings)));
+}
+
+IoUring::IoUring(int fd, std::unique_ptr<Rings> rings)
+    : fd_(fd), rings_(std::move(rings))
+{
+}
+
+IoUring::~IoUring()
+{
+    rings_.reset();
+    ::close(fd_);
+}
+
+bool
+IoUring::read(
+    int fd,
+    void* buffer,
+    std::uint32_t bytes,
+    std::uint64_t offset,
+    std::uint64_t tag)
+{
+    auto& r = *rings_;
+    auto const tail = *r.sqTail;
+    if (tail - loadAcquire(r.sqHead) >= r.sqEntries)
+        return false;
+
+    auto const index = tail & r.sqMask;
+    auto* const sqe = r.sqes->at<io_uring_sqe>(0) + index;
+    std::memset(sqe, 0, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = reinterpret_cast<std::uint64_t>(buffer);
+    sqe->len = bytes;
+    sqe->off = offset;
+    sqe->user_data = tag;
+    r.sqArray[index] = index;
+
+    storeRelease(r.sqTail, tail + 1);
+    ++queued_;
+    return true;
+}
+
+void
+IoUring::submit(unsigned wait)
+{
+    while (true)
+    {
+        auto const n = syscall(
+            __NR_io_uring_enter,
+            fd_,
+            queued_,
+            wait,
+            wait ? IORING_ENTER_GETEVENTS : 0,
+            nullptr,
+            0);
+        if (n >= 0)
+        {
+            queued_ -= static_cast<unsigned>(n);
+            return;
+        }
+
+        // Interrupted, or the completion queue needs reaping first
+        if (errno == EINTR || errno == EBUSY || errno == EAGAIN)
+        {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+        Throw<std::system_error>(
+            errno, std::generic_category(), "io_uring_enter");
+    }
+}
+
+unsigned
+IoUring::reap(std::function<void(std::uint64_t, int)> const& f)
+{
+    auto& r = *rings_;
+    auto head = *r.cqHead;
+    auto const tail = loadAcquire(r.cqTail);
+    unsigned n = 0;
+    for (; head != tail; ++head, ++n)
+    {
+        auto const& cqe = r.cqes[head & r.cqMask];
+        f(cqe.user_data, cqe.res);
+    }
+    storeRelease(r.cqHead, head);
+    return n;
+}
+
+#else
+
+struct IoUring::Rings
+{
+};
+
+std::unique_ptr<IoUring>
+IoUring::make(unsigned)
+{
+    return nullptr;
+}
+
+IoUring::IoUring(int fd, std::unique_ptr<Rings> rings)
+    : fd_(fd), rings_(std::move(rings))
+{
+}
+
+IoUring::~IoUring() = default;
+
+bool
+IoUring::read(int, void*, std::uint32_t, std::uint64_t, std::uint64_t)
+{
+    return false;
+}
+
+void
+IoUring::submit(unsigned)
+{
+}
+
+unsigned
+IoUring::reap(std::function<void(std::uint64_t, int)> const&)
+{
+    return 0;
+}
+
+#endif
+
+}  // namespace NodeStore
+}  // namespace ripple
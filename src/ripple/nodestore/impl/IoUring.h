@@ -0,0 +1,100 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_IOURING_H_INCLUDED
+#define RIPPLE_NODESTORE_IOURING_H_INCLUDED
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+namespace ripple {
+namespace NodeStore {
+
+/** A Linux io_uring used for positioned file reads.
+
+    Reads are queued with read(), handed to the kernel together by submit(),
+    and their results collected with reap(). Many reads can be in flight at
+    once without a thread blocked on each.
+
+    The ring is used through the system calls directly, so there is no
+    library to depend on. It is not thread safe: one thread queues, submits
+    and reaps.
+*/
+class IoUring
+{
+public:
+    /** Create a ring able to hold the given number of queued reads.
+
+        @return nullptr if io_uring is unavailable, as on other systems, on
+                kernels before 5.6, or where it has been disabled.
+    */
+    static std::unique_ptr<IoUring>
+    make(unsigned entries);
+
+    ~IoUring();
+
+    IoUring(IoUring const&) = delete;
+    IoUring&
+    operator=(IoUring const&) = delete;
+
+    /** Queue a read of bytes at offset in fd into buffer.
+
+        @param tag Identifies the read to reap().
+        @return false if the queue is full.
+    */
+    bool
+    read(
+        int fd,
+        void* buffer,
+        std::uint32_t bytes,
+        std::uint64_t offset,
+        std::uint64_t tag);
+
+    /** Hand queued reads to the kernel, waiting until at least `wait`
+        reads have completed.
+
+        @throws std::system_error on failure.
+    */
+    void
+    submit(unsigned wait);
+
+    /** Collect completed reads.
+
+        @param f Called with the tag of each read and its result: the
+                 number of bytes read, or a negated errno value.
+        @return The number of reads collected.
+    */
+    unsigned
+    reap(std::function<void(std::uint64_t tag, int result)> const& f);
+
+private:
+    struct Rings;
+
+    IoUring(int fd, std::unique_ptr<Rings> rings);
+
+    int const fd_;
+    std::unique_ptr<Rings> rings_;
+    unsigned queued_ = 0;
+};
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,172 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/SnapshotFile.h>
+#include <ripple/nodestore/impl/LookupFilter.h>
+#include <ripple/protocol/Serializer.h>
+#include <algorithm>
+#include <cstring>
+
+namespace ripple {
+namespace NodeStore {
+
+namespace {
+
+constexpr std::uint32_t filterTag = 0x52544c46;  // "FLTR"
+
+// Words per record of a saved filter
+constexpr std::size_t chunkWords = 64 * 1024;
+
+std::uint64_t
+keyWord(uint256 const& key, std::size_t i)
+{
+    std::uint64_t w;
+    std::memcpy(&w, key.data() + i * sizeof(w), sizeof(w));
+    return w;
+}
+
+}  // namespace
+
+LookupFilter::LookupFilter(std::uint64_t items)
+    : items_(items)
+    , blocks_(std::max<std::uint64_t>(
+          1,
+          (items * bitsPerItem + blockWords * 64 - 1) / (blockWords * 64)))
+    , words_(blocks_ * blockWords)
+{
+}
+
+void
+LookupFilter::insert(uint256 const& key)
+{
+    auto* const block = &words_[(keyWord(key, 0) % blocks_) * blockWords];
+    auto bits = keyWord(key, 1);
+    for (std::size_t i = 0; i < bitsPerKey; ++i, bits >>= 9)
+    {
+        auto& word = block[(bits >> 6) & (blockWords - 1)];
+        auto const mask = std::uint64_t(1) << (bits & 63);
+
+        // Most keys land on bits that are set already; only write when
+        // something changes so readers' cache lines stay shared.
+        if ((word.load(std::memory_order_relaxed) & mask) == 0)
+            word.fetch_or(mask, std::memory_order_release);
+    }
+}
+
+bool
+LookupFilter::mayContain(uint256 const& key) const
+{
+    auto const* const block =
+        &words_[(keyWord(key, 0) % blocks_) * blockWords];
+    auto bits = keyWord(key, 1);
+    for (std::size_t i = 0; i < bitsPerKey; ++i, bits >>= 9)
+    {
+        auto const& word = block[(bits >> 6) & (blockWords - 1)];
+        auto const mask = std::uint64_t(1) << (bits & 63);
+        if ((word.load(std::memory_order_acquire) & mask) == 0)
+            return false;
+    }
+    return true;
+}
+
+void
+LookupFilter::save(boost::filesystem::path const& path) const
+{
+    SnapshotFile file(path, filterTag);
+    file.remove();
+
+    Serializer header(16);
+    header.add64(items_);
+    header.add64(words_.size());
+    file.append(header.slice());
+
+    // In native byte order: the file never leaves this machine.
+    std::vector<std::uint64_t> chunk;
+    chunk.reserve(chunkWords);
+    for (std::size_t i = 0; i < words_.size(); i += chunkWords)
+    {
+        chunk.clear();
+        auto const end = std::min(words_.size(), i + chunkWords);
+        for (auto j = i; j < end; ++j)
+            chunk.push_back(words_[j].load(std::memory_order_relaxed));
+        file.append(
+            Slice(chunk.data(), chunk.size() * sizeof(std::uint64_t)));
+    }
+    file.close();
+}
+
+std::shared_ptr<LookupFilter>
+LookupFilter::load(boost::filesystem::path const& path, std::uint64_t items)
+{
+    boost::system::error_code ec;
+    if (!boost::filesystem::exists(path, ec))
+        return nullptr;
+
+    auto filter = std::make_shared<LookupFilter>(items);
+    SnapshotFile file(path, filterTag);
+
+    bool good = true;
+    bool sawHeader = false;
+    std::size_t loaded = 0;
+    try
+    {
+        file.load([&](Slice record) {
+            if (!good)
+                return;
+
+            if (!sawHeader)
+            {
+                sawHeader = true;
+                SerialIter sit(record);
+                good = record.size() == 16 && sit.get64() == items &&
+                    sit.get64() == filter->words_.size();
+                return;
+            }
+
+            auto const n = record.size() / sizeof(std::uint64_t);
+            if (record.size() % sizeof(std::uint64_t) != 0 ||
+                n > filter->words_.size() - loaded)
+            {
+                good = false;
+                return;
+            }
+
+            for (std::size_t i = 0; i < n; ++i)
+            {
+                std::uint64_t w;
+                std::memcpy(
+                    &w, record.data() + i * sizeof(w), sizeof(w));
+                filter->words_[loaded++].store(w, std::memory_order_relaxed);
+            }
+        });
+    }
+    catch (std::exception const&)
+    {
+        good = false;
+    }
+
+    file.remove();
+
+    if (!good || !sawHeader || loaded != filter->words_.size())
+        return nullptr;
+    return filter;
+}
+
+}  // namespace NodeStore
+}  // namespace ripple
@@ -0,0 +1,101 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_LOOKUPFILTER_H_INCLUDED
+#define RIPPLE_NODESTORE_LOOKUPFILTER_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <boost/filesystem.hpp>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+/** A filter of the keys stored in a backend.
+
+    A fetch asks the filter first, and only goes to disk when the filter says
+    the key may be there. Keys are never missed; a key that was never inserted
+    gets through about one time in a hundred when the filter holds the number
+    of keys it was sized for.
+
+    This is a blocked Bloom filter: each key sets a few bits within one 64
+    byte block, so a lookup touches a single cache line. Node store keys are
+    already hashes, so their own bits choose the block and the bits.
+
+    Insertion and lookup may run concurrently from any number of threads.
+*/
+class LookupFilter
+{
+public:
+    /** Create an empty filter sized for the given number of keys. */
+    explicit LookupFilter(std::uint64_t items);
+
+    LookupFilter(LookupFilter const&) = delete;
+    LookupFilter&
+    operator=(LookupFilter const&) = delete;
+
+    void
+    insert(uint256 const& key);
+
+    /** Returns false if the key was certainly never inserted. */
+    bool
+    mayContain(uint256 const& key) const;
+
+    /** The memory held by the filter. */
+    std::uint64_t
+    bytes() const
+    {
+        return words_.size() * sizeof(std::uint64_t);
+    }
+
+    /** Write the filter to a file.
+
+        @throws std::runtime_error on failure.
+    */
+    void
+    save(boost::filesystem::path const& path) const;
+
+    /** Read back a filter written by save() and delete the file.
+
+        The file is deleted so that a filter is only ever reloaded after a
+        clean shutdown, as the backend may be written to afterwards.
+
+        @return The filter, or nullptr if there is no file or it was saved
+                with a different size.
+    */
+    static std::shared_ptr<LookupFilter>
+    load(boost::filesystem::path const& path, std::uint64_t items);
+
+private:
+    static constexpr std::size_t bitsPerItem = 10;
+    static constexpr std::size_t blockWords = 8;
+    static constexpr std::size_t bitsPerKey = 7;
+
+    std::uint64_t const items_;
+    std::uint64_t const blocks_;
+    std::vector<std::atomic<std::uint64_t>> words_;
+};
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
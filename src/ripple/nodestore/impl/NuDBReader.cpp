@@ -0,0 +1,498 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Log.h>
+#include <ripple/beast/core/CurrentThreadName.h>
+#include <ripple/nodestore/impl/DecodedBlob.h>
+#include <ripple/nodestore/impl/NuDBReader.h>
+#include <ripple/nodestore/impl/codec.h>
+#include <boost/filesystem.hpp>
+#include <boost/predef.h>
+#include <nudb/detail/bucket.hpp>
+#include <nudb/detail/buffer.hpp>
+#include <nudb/detail/format.hpp>
+#include <nudb/native_file.hpp>
+#include <nudb/xxhasher.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+
+#if BOOST_OS_LINUX
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ripple {
+namespace NodeStore {
+
+struct NuDBReader::Lookup
+{
+    uint256 key;
+    Callback callback;
+
+    // The key's hash as bucket entries store it
+    std::uint64_t hash = 0;
+
+    // Candidate records, the next one to read, and the next spill bucket
+    Records records;
+    std::size_t next = 0;
+    std::uint64_t spill = 0;
+    int spills = 0;
+
+    // What the buffer is being filled with
+    enum { bucket, record } reading = bucket;
+    std::vector<std::uint8_t> buffer;
+};
+
+std::optional<NuDBReader::Header>
+NuDBReader::Header::read(std::string const& dir, beast::Journal journal)
+{
+    auto const folder = boost::filesystem::path(dir);
+    nudb::error_code ec;
+    nudb::detail::dat_file_header dh;
+    nudb::detail::key_file_header kh;
+    {
+        nudb::native_file df;
+        df.open(nudb::file_mode::read, (folder / "nudb.dat").string(), ec);
+        if (!ec)
+            nudb::detail::read(df, dh, ec);
+        if (!ec)
+            nudb::detail::verify(dh, ec);
+    }
+    if (!ec)
+    {
+        nudb::native_file kf;
+        kf.open(nudb::file_mode::read, (folder / "nudb.key").string(), ec);
+        if (!ec)
+            nudb::detail::read(kf, kh, ec);
+        if (!ec)
+            nudb::detail::verify<nudb::xxhasher>(dh, kh, ec);
+    }
+    if (ec)
+    {
+        JLOG(journal.warn()) << "Unrecognized NuDB files in " << dir << ": "
+                             << ec.message() << "; not using io_uring";
+        return std::nullopt;
+    }
+    if (kh.key_size != uint256::size())
+    {
+        JLOG(journal.warn()) << "NuDB in " << dir << " has " << kh.key_size
+                             << " byte keys; not using io_uring";
+        return std::nullopt;
+    }
+    return Header{kh.salt, kh.block_size, kh.capacity};
+}
+
+std::uint64_t
+NuDBReader::Header::hash(uint256 const& key) const
+{
+    return nudb::detail::hash<nudb::xxhasher>(key.data(), key.size(), salt);
+}
+
+std::uint64_t
+NuDBReader::Header::bucket(std::uint64_t hash, std::uint64_t buckets)
+{
+    return nudb::detail::bucket_index(
+        hash, buckets, nudb::detail::ceil_pow2(buckets));
+}
+
+std::optional<std::uint64_t>
+NuDBReader::Header::parse(
+    std::uint8_t* bucket,
+    std::size_t size,
+    std::uint64_t hash,
+    Records& records) const
+{
+    if (size < nudb::detail::bucket_size(0))
+        return std::nullopt;
+
+    nudb::detail::bucket b(blockSize, bucket);
+    if (b.size() > capacity || nudb::detail::bucket_size(b.size()) > size)
+        return std::nullopt;
+
+    // Entries are sorted by hash
+    for (auto i = b.lower_bound(hash); i < b.size(); ++i)
+    {
+        auto const e = b[i];
+        if (e.hash != hash)
+            break;
+        records.emplace_back(e.offset, e.size);
+    }
+    return b.spill();
+}
+
+#if BOOST_OS_LINUX
+
+namespace {
+
+// A data record: value size (6), key, value
+std::size_t constexpr recordHeaderBytes = 6 + uint256::size();
+
+std::uint64_t
+readBig(std::uint8_t const* p, std::size_t bytes)
+{
+    std::uint64_t v = 0;
+    for (std::size_t i = 0; i != bytes; ++i)
+        v = (v << 8) | p[i];
+    return v;
+}
+
+// Follow no more spill buckets than this for one lookup
+int constexpr maxSpills = 64;
+
+// Leave larger values to NuDB
+std::uint64_t constexpr maxValueBytes = 16 * 1024 * 1024;
+
+// Reads as much as it can of [offset, offset + size)
+std::size_t
+readAt(int fd, void* buffer, std::size_t size, std::uint64_t offset)
+{
+    std::size_t done = 0;
+    while (done < size)
+    {
+        auto const n = ::pread(
+            fd,
+            static_cast<char*>(buffer) + done,
+            size - done,
+            static_cast<off_t>(offset + done));
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            break;
+        done += static_cast<std::size_t>(n);
+    }
+    return done;
+}
+
+}  // namespace
+
+std::unique_ptr<NuDBReader>
+NuDBReader::make(
+    std::string const& dir,
+    unsigned depth,
+    Scheduler& scheduler,
+    beast::Journal journal)
+{
+    auto const header = Header::read(dir, journal);
+    if (!header)
+        return nullptr;
+
+    depth = std::clamp(depth, 1u, 4096u);
+    auto ring = IoUring::make(depth);
+    if (!ring)
+    {
+        JLOG(journal.warn()) << "io_uring is unavailable";
+        return nullptr;
+    }
+
+    auto const folder = boost::filesystem::path(dir);
+    int const keyFile =
+        ::open((folder / "nudb.key").c_str(), O_RDONLY | O_CLOEXEC);
+    int const dataFile =
+        ::open((folder / "nudb.dat").c_str(), O_RDONLY | O_CLOEXEC);
+    if (keyFile < 0 || dataFile < 0)
+    {
+        JLOG(journal.warn()) << "Unable to open " << dir << " for io_uring";
+        if (keyFile >= 0)
+            ::close(keyFile);
+        if (dataFile >= 0)
+            ::close(dataFile);
+        return nullptr;
+    }
+
+    JLOG(journal.info()) << "Reading " << dir << " with io_uring";
+    return std::unique_ptr<NuDBReader>(new NuDBReader(
+        *header,
+        keyFile,
+        dataFile,
+        std::move(ring),
+        depth,
+        scheduler,
+        journal));
+}
+
+NuDBReader::NuDBReader(
+    Header const& header,
+    int keyFile,
+    int dataFile,
+    std::unique_ptr<IoUring> ring,
+    unsigned depth,
+    Scheduler& scheduler,
+    beast::Journal journal)
+    : header_(header)
+    , keyFile_(keyFile)
+    , dataFile_(dataFile)
+    , ring_(std::move(ring))
+    , scheduler_(scheduler)
+    , j_(journal)
+    , slots_(depth)
+{
+    free_.reserve(depth);
+    for (auto i = depth; i != 0; --i)
+        free_.push_back(i - 1);
+    thread_ = std::thread(&NuDBReader::run, this);
+}
+
+NuDBReader::~NuDBReader()
+{
+    {
+        std::lock_guard lock(mutex_);
+        stopping_ = true;
+    }
+    cond_.notify_all();
+    thread_.join();
+    ::close(keyFile_);
+    ::close(dataFile_);
+}
+
+bool
+NuDBReader::fetch(uint256 const& key, Callback callback)
+{
+    {
+        std::lock_guard lock(mutex_);
+        if (stopping_)
+            return false;
+        queue_.emplace_back(key, std::move(callback));
+    }
+    cond_.notify_one();
+    return true;
+}
+
+std::uint64_t
+NuDBReader::buckets() const
+{
+    // The key file is a header block followed by one block per bucket
+    struct stat st;
+    if (::fstat(keyFile_, &st) != 0 ||
+        static_cast<std::uint64_t>(st.st_size) < header_.blockSize)
+        return 0;
+    return (st.st_size - header_.blockSize) / header_.blockSize;
+}
+
+void
+NuDBReader::run()
+{
+    beast::setCurrentThreadName("db io_uring");
+
+    std::vector<std::pair<uint256, Callback>> starting;
+    while (true)
+    {
+        {
+            std::unique_lock lock(mutex_);
+            if (inFlight_ == 0)
+                cond_.wait(
+                    lock, [this] { return stopping_ || !queue_.empty(); });
+
+            if (stopping_)
+            {
+                for (auto& [key, callback] : queue_)
+                    done_.emplace_back(std::move(callback), nullptr);
+                queue_.clear();
+            }
+
+            while (!queue_.empty() && starting.size() < free_.size())
+            {
+                starting.push_back(std::move(queue_.front()));
+                queue_.pop_front();
+            }
+        }
+
+        if (!starting.empty())
+        {
+            // NuDB adds buckets as it grows
+            auto const count = buckets();
+            for (auto& [key, callback] : starting)
+            {
+                auto& lookup = slots_[free_.back()];
+                free_.pop_back();
+                lookup.key = key;
+                lookup.callback = std::move(callback);
+                start(lookup, count);
+            }
+            starting.clear();
+        }
+
+        if (inFlight_ != 0)
+        {
+            try
+            {
+                ring_->submit(1);
+            }
+            catch (std::exception const& e)
+            {
+                JLOG(j_.error()) << "io_uring: " << e.what();
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+            ring_->reap([this](std::uint64_t tag, int result) {
+                advance(slots_[tag], result);
+            });
+        }
+
+        dispatch();
+
+        if (inFlight_ == 0)
+        {
+            std::lock_guard lock(mutex_);
+            if (stopping_ && queue_.empty())
+                break;
+        }
+    }
+}
+
+void
+NuDBReader::start(Lookup& lookup, std::uint64_t buckets)
+{
+    if (buckets == 0)
+        return finish(lookup, nullptr);
+
+    lookup.hash = header_.hash(lookup.key);
+    lookup.records.clear();
+    lookup.next = 0;
+    lookup.spill = 0;
+    lookup.spills = 0;
+    lookup.reading = Lookup::bucket;
+    lookup.buffer.resize(header_.blockSize);
+    read(
+        lookup,
+        keyFile_,
+        (Header::bucket(lookup.hash, buckets) + 1) * header_.blockSize);
+}
+
+void
+NuDBReader::read(Lookup& lookup, int fd, std::uint64_t offset)
+{
+    if (!ring_->read(
+            fd,
+            lookup.buffer.data(),
+            static_cast<std::uint32_t>(lookup.buffer.size()),
+            offset,
+            &lookup - slots_.data()))
+        return finish(lookup, nullptr);
+    ++inFlight_;
+}
+
+void
+NuDBReader::advance(Lookup& lookup, int result)
+{
+    --inFlight_;
+    if (result < 0)
+        return finish(lookup, nullptr);
+
+    auto const p = lookup.buffer.data();
+    auto const size = static_cast<std::size_t>(result);
+
+    if (lookup.reading == Lookup::record)
+    {
+        auto const bytes = lookup.records[lookup.next - 1].second;
+        if (size != lookup.buffer.size() || readBig(p, 6) != bytes ||
+            std::memcmp(p + 6, lookup.key.data(), lookup.key.size()) != 0)
+            return next(lookup);
+
+        std::shared_ptr<NodeObject> object;
+        try
+        {
+            nudb::detail::buffer bf;
+            auto const data =
+                nodeobject_decompress(p + recordHeaderBytes, bytes, bf);
+            DecodedBlob decoded(lookup.key.data(), data.first, data.second);
+            if (decoded.wasOk())
+                object = decoded.createObject();
+        }
+        catch (std::exception const& e)
+        {
+            JLOG(j_.warn()) << "io_uring: " << lookup.key << ": " << e.what();
+        }
+        return finish(lookup, std::move(object));
+    }
+
+    auto const spill = header_.parse(p, size, lookup.hash, lookup.records);
+    if (!spill)
+        return finish(lookup, nullptr);
+    lookup.spill = *spill;
+    next(lookup);
+}
+
+void
+NuDBReader::next(Lookup& lookup)
+{
+    while (lookup.next < lookup.records.size())
+    {
+        auto const [offset, bytes] = lookup.records[lookup.next++];
+        if (bytes == 0 || bytes > maxValueBytes)
+            continue;
+        lookup.reading = Lookup::record;
+        lookup.buffer.resize(recordHeaderBytes + bytes);
+        return read(lookup, dataFile_, offset);
+    }
+
+    if (lookup.spill != 0 && ++lookup.spills <= maxSpills)
+    {
+        // A spill offset is that of the bucket in its spill record
+        lookup.reading = Lookup::bucket;
+        lookup.buffer.resize(nudb::detail::bucket_size(header_.capacity));
+        return read(lookup, dataFile_, std::exchange(lookup.spill, 0));
+    }
+
+    finish(lookup, nullptr);
+}
+
+void
+NuDBReader::finish(Lookup& lookup, std::shared_ptr<NodeObject> object)
+{
+    if (object)
+        found_.fetch_add(1, std::memory_order_relaxed);
+    done_.emplace_back(std::move(lookup.callback), std::move(object));
+    lookup.callback = nullptr;
+    free_.push_back(&lookup - slots_.data());
+}
+
+void
+NuDBReader::dispatch()
+{
+    if (done_.empty())
+        return;
+
+    scheduler_.scheduleCompletions([done = std::move(done_)]() {
+        for (auto const& [callback, object] : done)
+            callback(object);
+    });
+    done_.clear();
+}
+
+#else
+
+std::unique_ptr<NuDBReader>
+NuDBReader::make(std::string const&, unsigned, Scheduler&, beast::Journal)
+{
+    return nullptr;
+}
+
+NuDBReader::~NuDBReader() = default;
+
+bool
+NuDBReader::fetch(uint256 const&, Callback)
+{
+    return false;
+}
+
+#endif
+
+}  // namespace NodeStore
+}  // namespace ripple
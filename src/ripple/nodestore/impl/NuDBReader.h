@@ -0,0 +1,194 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_NUDBREADER_H_INCLUDED
+#define RIPPLE_NODESTORE_NUDBREADER_H_INCLUDED
+
+#include <ripple/basics/base_uint.h>
+#include <ripple/beast/utility/Journal.h>
+#include <ripple/nodestore/NodeObject.h>
+#include <ripple/nodestore/Scheduler.h>
+#include <ripple/nodestore/impl/IoUring.h>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+/** Reads objects from a NuDB database's files with io_uring.
+
+    NuDB's fetch() blocks its caller on each read, so the node store's read
+    threads limit how many reads are in flight. This reader does the same
+    lookup: the key's bucket in the key file, any spill buckets, then the
+    record in the data file. It does so with positioned reads from a single
+    thread that keeps up to `depth` lookups going at once.
+
+    It only sees what NuDB has written to its files. A lookup for an object
+    inserted since NuDB's last commit, or one that fails for any other
+    reason, completes with nullptr; the caller then falls back to fetch().
+
+    The files are read with NuDB's own format code, so the reader finds
+    records exactly as fetch() would.
+*/
+class NuDBReader
+{
+public:
+    using Callback = std::function<void(std::shared_ptr<NodeObject>)>;
+
+    /** Create a reader for the database in a directory.
+
+        @return nullptr if io_uring is unavailable or the files can't be
+                opened.
+    */
+    static std::unique_ptr<NuDBReader>
+    make(
+        std::string const& dir,
+        unsigned depth,
+        Scheduler& scheduler,
+        beast::Journal journal);
+
+    /** Finishes the lookups in flight and fails the rest, then stops. */
+    ~NuDBReader();
+
+    NuDBReader(NuDBReader const&) = delete;
+    NuDBReader&
+    operator=(NuDBReader const&) = delete;
+
+    /** Queue a lookup.
+
+        The callback is run through Scheduler::scheduleCompletions with the
+        object, or with nullptr if it wasn't found this way.
+
+        @return false, without calling the callback, if the reader isn't
+                serving lookups.
+    */
+    bool
+    fetch(uint256 const& key, Callback callback);
+
+    // Record offsets and sizes
+    using Records = std::vector<std::pair<std::uint64_t, std::uint64_t>>;
+
+    // What a lookup needs from the key file header
+    struct Header
+    {
+        std::uint64_t salt;
+        std::size_t blockSize;
+        // Entries per bucket
+        std::size_t capacity;
+
+        // Reads and verifies the headers of the database in a directory
+        static std::optional<Header>
+        read(std::string const& dir, beast::Journal journal);
+
+        // The key's hash as NuDB computes and stores it
+        std::uint64_t
+        hash(uint256 const& key) const;
+
+        static std::uint64_t
+        bucket(std::uint64_t hash, std::uint64_t buckets);
+
+        // Adds the entries matching a hash to records, returning the offset
+        // of the next bucket in the chain, or 0.
+        std::optional<std::uint64_t>
+        parse(
+            std::uint8_t* bucket,
+            std::size_t size,
+            std::uint64_t hash,
+            Records& records) const;
+    };
+
+    /** Lookups which found their object. */
+    std::uint64_t
+    found() const
+    {
+        return found_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Lookup;
+
+    NuDBReader(
+        Header const& header,
+        int keyFile,
+        int dataFile,
+        std::unique_ptr<IoUring> ring,
+        unsigned depth,
+        Scheduler& scheduler,
+        beast::Journal journal);
+
+    std::uint64_t
+    buckets() const;
+
+    void
+    run();
+
+    void
+    start(Lookup& lookup, std::uint64_t buckets);
+
+    void
+    read(Lookup& lookup, int fd, std::uint64_t offset);
+
+    void
+    advance(Lookup& lookup, int result);
+
+    void
+    next(Lookup& lookup);
+
+    void
+    finish(Lookup& lookup, std::shared_ptr<NodeObject> object);
+
+    void
+    dispatch();
+
+    Header const header_;
+    int const keyFile_;
+    int const dataFile_;
+    std::unique_ptr<IoUring> ring_;
+    Scheduler& scheduler_;
+    beast::Journal const j_;
+
+    std::atomic<std::uint64_t> found_{0};
+
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    std::deque<std::pair<uint256, Callback>> queue_;
+    bool stopping_ = false;
+
+    // Used only by the reader's thread. A lookup has at most one read in
+    // flight, tagged with its index in slots_.
+    std::vector<Lookup> slots_;
+    std::vector<std::size_t> free_;
+    std::vector<std::pair<Callback, std::shared_ptr<NodeObject>>> done_;
+    unsigned inFlight_ = 0;
+
+    std::thread thread_;
+};
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
@@ -0,0 +1,117 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/nodestore/impl/DecodedBlob.h>
+#include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/nodestore/impl/StoredObject.h>
+#include <ripple/nodestore/impl/codec.h>
+
+namespace ripple {
+namespace NodeStore {
+
+namespace {
+
+std::vector<std::uint8_t>
+compressObject(
+    std::shared_ptr<NodeObject> const& object,
+    ZstdDictionary const* dictionary)
+{
+    EncodedBlob encoded(object);
+    nudb::detail::buffer bf;
+    auto const result = nodeobject_compress(
+        encoded.getData(), encoded.getSize(), bf, dictionary);
+    auto const p = static_cast<std::uint8_t const*>(result.first);
+    return std::vector<std::uint8_t>(p, p + result.second);
+}
+
+// Decompresses into the Blob that becomes the object's data, rather than
+// into a temporary buffer that would then be copied.
+std::shared_ptr<NodeObject>
+decompressObject(uint256 const& hash, void const* data, std::size_t size)
+{
+    Blob storage;
+    auto const result =
+        nodeobject_decompress(data, size, [&storage](std::size_t n) {
+            storage.resize(n);
+            return storage.data();
+        });
+    DecodedBlob decoded(hash.data(), result.first, result.second);
+    if (!decoded.wasOk())
+        return nullptr;
+    if (result.first == storage.data())
+        return decoded.createObject(std::move(storage));
+    return decoded.createObject();
+}
+
+}  // namespace
+
+StoredObject::StoredObject(
+    std::shared_ptr<NodeObject> const& object,
+    bool compress,
+    ZstdDictionary const* dictionary)
+{
+    if (compress)
+        value_ = compressObject(object, dictionary);
+    else
+        value_ = object;
+}
+
+StoredObject::StoredObject(uint256 const& hash, Slice encoding, bool compress)
+{
+    if (!compress)
+    {
+        if (auto object =
+                decompressObject(hash, encoding.data(), encoding.size()))
+        {
+            value_ = std::move(object);
+            return;
+        }
+    }
+    value_ = std::vector<std::uint8_t>(encoding.begin(), encoding.end());
+}
+
+std::shared_ptr<NodeObject>
+StoredObject::object(uint256 const& hash) const
+{
+    if (auto const object = std::get_if<std::shared_ptr<NodeObject>>(&value_))
+        return *object;
+
+    auto const& compressed = std::get<std::vector<std::uint8_t>>(value_);
+    return decompressObject(hash, compressed.data(), compressed.size());
+}
+
+std::size_t
+StoredObject::encode(
+    std::vector<std::uint8_t>& out,
+    ZstdDictionary const* dictionary) const
+{
+    if (auto const object = std::get_if<std::shared_ptr<NodeObject>>(&value_))
+    {
+        auto const compressed = compressObject(*object, dictionary);
+        out.insert(out.end(), compressed.begin(), compressed.end());
+        return compressed.size();
+    }
+
+    auto const& compressed = std::get<std::vector<std::uint8_t>>(value_);
+    out.insert(out.end(), compressed.begin(), compressed.end());
+    return compressed.size();
+}
+
+}  // namespace NodeStore
+}  // namespace ripple
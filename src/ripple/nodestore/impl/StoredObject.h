@@ -0,0 +1,81 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_STOREDOBJECT_H_INCLUDED
+#define RIPPLE_NODESTORE_STOREDOBJECT_H_INCLUDED
+
+#include <ripple/basics/Slice.h>
+#include <ripple/nodestore/NodeObject.h>
+#include <cstdint>
+#include <memory>
+#include <variant>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+class ZstdDictionary;
+
+/** An object as held by an in-memory backend.
+
+    By default the object is held compressed, and each fetch decompresses
+    it into a new NodeObject. A backend configured with compress=0 holds
+    the NodeObject it was given instead: NodeObjects are immutable, so a
+    fetch returns that same object for the cost of a lookup and a
+    reference count increment, and its data is shared with the database's
+    cache rather than held twice.
+*/
+class StoredObject
+{
+public:
+    /** Hold an object, compressing it if compress is set. */
+    StoredObject(
+        std::shared_ptr<NodeObject> const& object,
+        bool compress,
+        ZstdDictionary const* dictionary);
+
+    /** Hold an object given its compressed encoding.
+
+        If compress isn't set the encoding is decoded now, unless it is
+        corrupt.
+    */
+    StoredObject(uint256 const& hash, Slice encoding, bool compress);
+
+    /** Returns the object, or nullptr if its encoding is corrupt. */
+    std::shared_ptr<NodeObject>
+    object(uint256 const& hash) const;
+
+    /** Append the compressed encoding of the object.
+
+        @return The number of bytes appended.
+    */
+    std::size_t
+    encode(
+        std::vector<std::uint8_t>& out,
+        ZstdDictionary const* dictionary) const;
+
+private:
+    std::variant<std::vector<std::uint8_t>, std::shared_ptr<NodeObject>>
+        value_;
+};
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
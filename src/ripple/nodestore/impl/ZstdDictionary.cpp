@@ -0,0 +1,277 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/FileUtilities.h>
+#include <ripple/basics/contract.h>
+#include <ripple/nodestore/impl/ZstdDictionary.h>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#include <zdict.h>
+#include <zstd.h>
+
+namespace ripple {
+namespace NodeStore {
+
+namespace {
+
+// A node only ever sees a handful of dictionaries; lookups are a lock free
+// scan of this table.
+constexpr std::size_t maxDictionaries = 256;
+
+std::array<std::atomic<ZstdDictionary const*>, maxDictionaries> registry{};
+std::mutex registryMutex;
+
+struct CCtxDeleter
+{
+    void
+    operator()(ZSTD_CCtx* ctx) const
+    {
+        ZSTD_freeCCtx(ctx);
+    }
+};
+
+struct DCtxDeleter
+{
+    void
+    operator()(ZSTD_DCtx* ctx) const
+    {
+        ZSTD_freeDCtx(ctx);
+    }
+};
+
+ZSTD_CCtx*
+compressionContext()
+{
+    thread_local std::unique_ptr<ZSTD_CCtx, CCtxDeleter> ctx = [] {
+        std::unique_ptr<ZSTD_CCtx, CCtxDeleter> ctx{ZSTD_createCCtx()};
+        if (!ctx)
+            Throw<std::runtime_error>("zstd: ZSTD_createCCtx");
+
+        // The blob header already carries the size and dictionary ID, so
+        // frames leave them out. The node store verifies objects by hash.
+        ZSTD_CCtx_setParameter(ctx.get(), ZSTD_c_contentSizeFlag, 0);
+        ZSTD_CCtx_setParameter(ctx.get(), ZSTD_c_checksumFlag, 0);
+        ZSTD_CCtx_setParameter(ctx.get(), ZSTD_c_dictIDFlag, 0);
+        return ctx;
+    }();
+    return ctx.get();
+}
+
+ZSTD_DCtx*
+decompressionContext()
+{
+    thread_local std::unique_ptr<ZSTD_DCtx, DCtxDeleter> ctx{
+        ZSTD_createDCtx()};
+    if (!ctx)
+        Throw<std::runtime_error>("zstd: ZSTD_createDCtx");
+    return ctx.get();
+}
+
+}  // namespace
+
+ZstdDictionary::ZstdDictionary(Blob content, int level)
+    : content_(std::move(content))
+    , id_(ZDICT_getDictID(content_.data(), content_.size()))
+    , cdict_(nullptr)
+    , ddict_(nullptr)
+{
+    // Zero means the content isn't a dictionary, only raw bytes
+    if (id_ == 0)
+        Throw<std::runtime_error>("zstd: not a dictionary");
+
+    cdict_ = ZSTD_createCDict(content_.data(), content_.size(), level);
+    ddict_ = ZSTD_createDDict(content_.data(), content_.size());
+    if (!cdict_ || !ddict_)
+    {
+        ZSTD_freeCDict(cdict_);
+        ZSTD_freeDDict(ddict_);
+        Throw<std::runtime_error>("zstd: unable to load dictionary");
+    }
+}
+
+ZstdDictionary::~ZstdDictionary()
+{
+    ZSTD_freeCDict(cdict_);
+    ZSTD_freeDDict(ddict_);
+}
+
+std::size_t
+ZstdDictionary::compressBound(std::size_t inSize)
+{
+    return ZSTD_compressBound(inSize);
+}
+
+std::size_t
+ZstdDictionary::compress(void const* in, std::size_t inSize, void* out) const
+{
+    auto const ctx = compressionContext();
+    auto result = ZSTD_CCtx_refCDict(ctx, cdict_);
+    if (!ZSTD_isError(result))
+        result = ZSTD_compress2(ctx, out, compressBound(inSize), in, inSize);
+    if (ZSTD_isError(result))
+        Throw<std::runtime_error>(
+            std::string("zstd compress: ") + ZSTD_getErrorName(result));
+    return result;
+}
+
+void
+ZstdDictionary::decompress(
+    void const* in,
+    std::size_t inSize,
+    void* out,
+    std::size_t outSize) const
+{
+    auto const result = ZSTD_decompress_usingDDict(
+        decompressionContext(), out, outSize, in, inSize, ddict_);
+    if (ZSTD_isError(result))
+        Throw<std::runtime_error>(
+            std::string("zstd decompress: ") + ZSTD_getErrorName(result));
+    if (result != outSize)
+        Throw<std::runtime_error>("zstd decompress: wrong size");
+}
+
+Blob
+ZstdDictionary::train(std::vector<Blob> const& samples, std::size_t bytes)
+{
+    Blob buffer;
+    std::vector<std::size_t> sizes;
+    sizes.reserve(samples.size());
+    for (auto const& sample : samples)
+    {
+        buffer.insert(buffer.end(), sample.begin(), sample.end());
+        sizes.push_back(sample.size());
+    }
+
+    Blob dictionary(bytes);
+    auto const result = ZDICT_trainFromBuffer(
+        dictionary.data(),
+        dictionary.size(),
+        buffer.data(),
+        sizes.data(),
+        static_cast<unsigned>(sizes.size()));
+    if (ZDICT_isError(result))
+        Throw<std::runtime_error>(
+            std::string("zstd train: ") + ZDICT_getErrorName(result));
+    dictionary.resize(result);
+    return dictionary;
+}
+
+void
+ZstdDictionary::save(boost::filesystem::path const& dir) const
+{
+    boost::system::error_code ec;
+    boost::filesystem::create_directories(dir, ec);
+    if (!ec)
+        writeFileContents(
+            ec,
+            dir / (std::to_string(id_) + ".dict"),
+            std::string(content_.begin(), content_.end()));
+    if (ec)
+        Throw<std::runtime_error>(
+            "zstd: unable to save dictionary: " + ec.message());
+}
+
+ZstdDictionary const&
+ZstdDictionary::add(std::unique_ptr<ZstdDictionary> dictionary)
+{
+    std::lock_guard lock(registryMutex);
+    for (auto& slot : registry)
+    {
+        auto const existing = slot.load(std::memory_order_acquire);
+        if (!existing)
+        {
+            // Never freed: blobs may be decoded until the process exits.
+            slot.store(dictionary.get(), std::memory_order_release);
+            return *dictionary.release();
+        }
+        if (existing->id() == dictionary->id())
+        {
+            if (existing->content() != dictionary->content())
+                Throw<std::runtime_error>(
+                    "zstd: two dictionaries with ID " +
+                    std::to_string(dictionary->id()));
+            return *existing;
+        }
+    }
+    Throw<std::runtime_error>("zstd: too many dictionaries");
+}
+
+ZstdDictionary const*
+ZstdDictionary::find(std::uint32_t id)
+{
+    for (auto const& slot : registry)
+    {
+        auto const dictionary = slot.load(std::memory_order_acquire);
+        if (!dictionary || dictionary->id() == id)
+            return dictionary;
+    }
+    return nullptr;
+}
+
+ZstdDictionary const*
+ZstdDictionary::loadDirectory(boost::filesystem::path const& dir)
+{
+    namespace fs = boost::filesystem;
+
+    boost::system::error_code ec;
+    if (!fs::is_directory(dir, ec))
+        return nullptr;
+
+    ZstdDictionary const* newest = nullptr;
+    std::time_t newestTime = 0;
+    for (auto const& entry : fs::directory_iterator(dir))
+    {
+        if (entry.path().extension() != ".dict" ||
+            !fs::is_regular_file(entry.status()))
+            continue;
+
+        auto const content = getFileContents(ec, entry.path());
+        if (ec)
+            Throw<std::runtime_error>(
+                "zstd: unable to read " + entry.path().string() + ": " +
+                ec.message());
+
+        auto const& dictionary = add(std::make_unique<ZstdDictionary>(
+            Blob(content.begin(), content.end())));
+
+        auto const written = fs::last_write_time(entry.path());
+        if (!newest || written > newestTime ||
+            (written == newestTime && dictionary.id() > newest->id()))
+        {
+            newest = &dictionary;
+            newestTime = written;
+        }
+    }
+    return newest;
+}
+
+ZstdDictionary const*
+ZstdDictionary::fromConfig(Section const& config)
+{
+    std::string dir;
+    if (!get_if_exists(config, "zstd_dictionaries", dir) || dir.empty())
+        return nullptr;
+    return loadDirectory(dir);
+}
+
+}  // namespace NodeStore
+}  // namespace ripple
@@ -0,0 +1,151 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#ifndef RIPPLE_NODESTORE_ZSTDDICTIONARY_H_INCLUDED
+#define RIPPLE_NODESTORE_ZSTDDICTIONARY_H_INCLUDED
+
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/basics/Blob.h>
+#include <boost/filesystem.hpp>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+struct ZSTD_CDict_s;
+struct ZSTD_DDict_s;
+
+namespace ripple {
+namespace NodeStore {
+
+/** A zstd dictionary for compressing node objects.
+
+    Ledger entries and transactions are small and mostly made of the same
+    field headers, accounts and currencies, so there is little for a
+    compressor to find within any one of them. A dictionary trained on the
+    node's own objects supplies the common parts up front.
+
+    Every blob compressed with a dictionary records its ID. All dictionaries
+    ever used must stay available to read those blobs back, so they are
+    registered for the whole process by ID and never unloaded.
+*/
+class ZstdDictionary
+{
+public:
+    /** Dictionaries are trained to this size unless told otherwise. */
+    static constexpr std::size_t defaultBytes = 112 * 1024;
+
+    /** Wrap trained dictionary content.
+
+        @throws std::runtime_error if it isn't a zstd dictionary.
+    */
+    explicit ZstdDictionary(Blob content, int level = 3);
+
+    ~ZstdDictionary();
+
+    ZstdDictionary(ZstdDictionary const&) = delete;
+    ZstdDictionary&
+    operator=(ZstdDictionary const&) = delete;
+
+    std::uint32_t
+    id() const
+    {
+        return id_;
+    }
+
+    Blob const&
+    content() const
+    {
+        return content_;
+    }
+
+    /** The most compressed output of inSize bytes can take. */
+    static std::size_t
+    compressBound(std::size_t inSize);
+
+    /** Compress into out, which has room for compressBound(inSize).
+
+        @return The compressed size.
+        @throws std::runtime_error on failure.
+    */
+    std::size_t
+    compress(void const* in, std::size_t inSize, void* out) const;
+
+    /** Decompress exactly outSize bytes into out.
+
+        @throws std::runtime_error if the input is corrupt or doesn't
+                decompress to outSize bytes.
+    */
+    void
+    decompress(
+        void const* in,
+        std::size_t inSize,
+        void* out,
+        std::size_t outSize) const;
+
+    /** Train a dictionary on sample node object blobs.
+
+        @throws std::runtime_error if the samples are too few or too small.
+    */
+    static Blob
+    train(std::vector<Blob> const& samples, std::size_t bytes = defaultBytes);
+
+    /** Write the dictionary into dir, as <id>.dict */
+    void
+    save(boost::filesystem::path const& dir) const;
+
+    /** Register a dictionary for decoding.
+
+        @return The registered dictionary: this one, or the one already
+                registered with the same ID and content.
+        @throws std::runtime_error if a different dictionary has the same ID.
+    */
+    static ZstdDictionary const&
+    add(std::unique_ptr<ZstdDictionary> dictionary);
+
+    /** The registered dictionary with the given ID, or nullptr. */
+    static ZstdDictionary const*
+    find(std::uint32_t id);
+
+    /** Register every dictionary in a directory.
+
+        @return The most recently written, for compressing new objects, or
+                nullptr if there are none.
+    */
+    static ZstdDictionary const*
+    loadDirectory(boost::filesystem::path const& dir);
+
+    /** The dictionary a backend should compress with, given its
+        configuration, after registering all those it may need to read.
+
+        @return nullptr unless zstd_dictionaries is set.
+    */
+    static ZstdDictionary const*
+    fromConfig(Section const& config);
+
+private:
+    Blob const content_;
+    std::uint32_t id_;
+    ZSTD_CDict_s* cdict_;
+    ZSTD_DDict_s* ddict_;
+};
+
+}  // namespace NodeStore
+}  // namespace ripple
+
+#endif
@@ -26,6 +26,7 @@
 #include <ripple/basics/contract.h>
 #include <ripple/basics/safe_cast.h>
 #include <ripple/nodestore/NodeObject.h>
+#include <ripple/nodestore/impl/ZstdDictionary.h>
 #include <ripple/nodestore/impl/varint.h>
 #include <ripple/protocol/HashPrefix.h>
 #include <cstddef>
@@ -92,6 +93,52 @@ lz4_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
     return result;
 }
 
+template <class BufferFactory>
+std::pair<void const*, std::size_t>
+zstd_decompress(void const* in, std::size_t in_size, BufferFactory&& bf)
+{
+    std::uint8_t const* p = reinterpret_cast<std::uint8_t const*>(in);
+    std::size_t id = 0;
+    std::size_t outSize = 0;
+
+    auto const n = read_varint(p, in_size, id);
+    if (n == 0 || n >= in_size)
+        Throw<std::runtime_error>("zstd_decompress: invalid blob");
+    auto const m = read_varint(p + n, in_size - n, outSize);
+    if (m == 0 || n + m >= in_size)
+        Throw<std::runtime_error>("zstd_decompress: invalid blob");
+
+    if (static_cast<int>(outSize) <= 0)
+        Throw<std::runtime_error>("zstd_decompress: integer overflow (output)");
+
+    auto const dictionary =
+        ZstdDictionary::find(static_cast<std::uint32_t>(id));
+    if (!dictionary || dictionary->id() != id)
+        Throw<std::runtime_error>(
+            "zstd_decompress: unknown dictionary " + std::to_string(id));
+
+    void* const out = bf(outSize);
+    dictionary->decompress(p + n + m, in_size - n - m, out, outSize);
+    return {out, outSize};
+}
+
+template <class BufferFactory>
+std::pair<void const*, std::size_t>
+zstd_compress(
+    void const* in,
+    std::size_t in_size,
+    ZstdDictionary const& dictionary,
+    BufferFactory&& bf)
+{
+    std::array<std::uint8_t, 2 * varint_traits<std::size_t>::max> vi;
+    auto n = write_varint(vi.data(), dictionary.id());
+    n += write_varint(vi.data() + n, in_size);
+    std::uint8_t* out = reinterpret_cast<std::uint8_t*>(
+        bf(n + ZstdDictionary::compressBound(in_size)));
+    std::memcpy(out, vi.data(), n);
+    return {out, n + dictionary.compress(in, in_size, out + n)};
+}
+
 //------------------------------------------------------------------------------
 
 /*
@@ -101,6 +148,8 @@ lz4_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
     1 = lz4 compressed
     2 = inner node compressed
     3 = full inner node
+    4 = zstd compressed with a dictionary: the dictionary ID, the
+        uncompressed size and then the frame
 */
 
 template <class BufferFactory>
@@ -131,6 +180,11 @@ nodeobject_decompress(void const* in, std::size_t in_size, BufferFactory&& bf)
             result = lz4_decompress(p, in_size, bf);
             break;
         }
+        case 4:  // zstd
+        {
+            result = zstd_decompress(p, in_size, bf);
+            break;
+        }
         case 2:  // compressed v1 inner node
         {
             auto const hs = field<std::uint16_t>::size;  // Mask
@@ -214,9 +268,18 @@ zero32()
     return v.data();
 }
 
+/** Compress an encoded node object.
+
+    Inner nodes have their own encodings. Anything else is compressed with
+    the dictionary if one is given, or with lz4.
+*/
 template <class BufferFactory>
 std::pair<void const*, std::size_t>
-nodeobject_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
+nodeobject_compress(
+    void const* in,
+    std::size_t in_size,
+    BufferFactory&& bf,
+    ZstdDictionary const* dictionary = nullptr)
 {
     using std::runtime_error;
     using namespace nudb::detail;
@@ -280,7 +343,7 @@ nodeobject_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
 
     std::array<std::uint8_t, varint_traits<std::size_t>::max> vi;
 
-    constexpr std::size_t codecType = 1;
+    std::size_t const codecType = dictionary ? 4 : 1;
     auto const vn = write_varint(vi.data(), codecType);
     std::pair<void const*, std::size_t> result;
     switch (codecType)
@@ -299,6 +362,19 @@ nodeobject_compress(void const* in, std::size_t in_size, BufferFactory&& bf)
             result.second = vn + lzr.second;
             break;
         }
+        case 4:  // zstd
+        {
+            std::uint8_t* p;
+            auto const zr = NodeStore::zstd_compress(
+                in, in_size, *dictionary, [&p, &vn, &bf](std::size_t n) {
+                    p = reinterpret_cast<std::uint8_t*>(bf(vn + n));
+                    return p + vn;
+                });
+            std::memcpy(p, vi.data(), vn);
+            result.first = p;
+            result.second = vn + zr.second;
+            break;
+        }
         default:
             Throw<std::logic_error>(
                 "nodeobject codec: unknown=" + std::to_string(codecType));
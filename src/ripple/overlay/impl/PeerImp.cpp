@@ -25,6 +25,7 @@
 #include <ripple/app/misc/HashRouter.h>
 #include <ripple/app/misc/LoadFeeTrack.h>
 #include <ripple/app/misc/NetworkOPs.h>
+#include <ripple/app/misc/SigVerifier.h>
 #include <ripple/app/misc/Transaction.h>
 #include <ripple/app/misc/ValidatorList.h>
 #include <ripple/app/tx/apply.h>
@@ -1605,16 +1606,24 @@ PeerImp::handleTransaction(
         }
         else
         {
-            app_.getJobQueue().addJob(
-                jtTRANSACTION,
-                "recvTransaction->checkTransaction",
-                [weak = std::weak_ptr<PeerImp>(shared_from_this()),
-                 flags,
-                 checkSignature,
-                 stx]() {
-                    if (auto peer = weak.lock())
-                        peer->checkTransaction(flags, checkSignature, stx);
-                });
+            auto check = [&app = app_,
+                          weak = std::weak_ptr<PeerImp>(shared_from_this()),
+                          flags,
+                          checkSignature,
+                          stx]() {
+                app.getJobQueue().addJob(
+                    jtTRANSACTION,
+                    "recvTransaction->checkTransaction",
+                    [weak, flags, checkSignature, stx]() {
+                        if (auto peer = weak.lock())
+                            peer->checkTransaction(flags, checkSignature, stx);
+                    });
+            };
+
+            // Have the signature checked in a batch before the job if we can
+            auto const verifier = app_.getSigVerifier();
+            if (!checkSignature || !verifier || !verifier->verify(stx, check))
+                check();
         }
     }
     catch (std::exception const& ex)
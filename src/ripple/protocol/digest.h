@@ -20,6 +20,7 @@
 #ifndef RIPPLE_PROTOCOL_DIGEST_H_INCLUDED
 #define RIPPLE_PROTOCOL_DIGEST_H_INCLUDED
 
+#include <ripple/basics/Slice.h>
 #include <ripple/basics/base_uint.h>
 #include <ripple/crypto/secure_erase.h>
 #include <boost/endian/conversion.hpp>
@@ -237,6 +238,48 @@ sha512Half_s(Args const&... args)
     return static_cast<typename sha512_half_hasher_s::result_type>(h);
 }
 
+//------------------------------------------------------------------------------
+
+/** Returns the SHA512-Half of each of several messages.
+
+    Messages which need the same number of SHA-512 blocks, such as inner
+    nodes, are hashed several at a time with SIMD instructions if the CPU
+    has them. The digests are the same as those of sha512Half.
+
+    @param messages The messages.
+    @param digests [out] The digest of each message, in order.
+    @param count The number of messages.
+*/
+void
+sha512HalfBatch(Slice const* messages, uint256* digests, std::size_t count);
+
+namespace detail {
+
+/** The ways sha512HalfBatch can hash messages */
+enum class Sha512Kernel {
+    scalar,  // One at a time
+    avx2,    // Four at a time
+    avx512   // Eight at a time
+};
+
+/** Returns true if this CPU can run a kernel. */
+bool
+sha512KernelSupported(Sha512Kernel kernel);
+
+/** Returns the kernel sha512HalfBatch uses on this CPU. */
+Sha512Kernel
+sha512Kernel();
+
+/** sha512HalfBatch, with a kernel this CPU can run. */
+void
+sha512HalfBatch(
+    Sha512Kernel kernel,
+    Slice const* messages,
+    uint256* digests,
+    std::size_t count);
+
+}  // namespace detail
+
 }  // namespace ripple
 
 #endif
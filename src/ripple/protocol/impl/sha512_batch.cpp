@@ -0,0 +1,314 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/protocol/digest.h>
+#include <boost/endian/conversion.hpp>
+#include <cassert>
+#include <cstring>
+
+// The SIMD kernels use the compiler's vector extensions, and are compiled
+// for the instruction sets they need whatever the build's target is.
+#if (defined(__GNUC__) || defined(__clang__)) && defined(__x86_64__)
+#define RIPPLE_SHA512_SIMD 1
+#endif
+
+namespace ripple {
+
+namespace {
+
+// SHA-512 works on 128 byte blocks. A message is followed by 0x80, zeros
+// and its size in bits as a 128-bit big-endian number.
+constexpr std::size_t blockBytes = 128;
+
+constexpr std::size_t
+blocksFor(std::size_t size)
+{
+    return (size + 17 + blockBytes - 1) / blockBytes;
+}
+
+#ifdef RIPPLE_SHA512_SIMD
+
+constexpr std::uint64_t K[80] = {
+    0x428a2f98d728ae22, 0x7137449123ef65cd, 0xb5c0fbcfec4d3b2f,
+    0xe9b5dba58189dbbc, 0x3956c25bf348b538, 0x59f111f1b605d019,
+    0x923f82a4af194f9b, 0xab1c5ed5da6d8118, 0xd807aa98a3030242,
+    0x12835b0145706fbe, 0x243185be4ee4b28c, 0x550c7dc3d5ffb4e2,
+    0x72be5d74f27b896f, 0x80deb1fe3b1696b1, 0x9bdc06a725c71235,
+    0xc19bf174cf692694, 0xe49b69c19ef14ad2, 0xefbe4786384f25e3,
+    0x0fc19dc68b8cd5b5, 0x240ca1cc77ac9c65, 0x2de92c6f592b0275,
+    0x4a7484aa6ea6e483, 0x5cb0a9dcbd41fbd4, 0x76f988da831153b5,
+    0x983e5152ee66dfab, 0xa831c66d2db43210, 0xb00327c898fb213f,
+    0xbf597fc7beef0ee4, 0xc6e00bf33da88fc2, 0xd5a79147930aa725,
+    0x06ca6351e003826f, 0x142929670a0e6e70, 0x27b70a8546d22ffc,
+    0x2e1b21385c26c926, 0x4d2c6dfc5ac42aed, 0x53380d139d95b3df,
+    0x650a73548baf63de, 0x766a0abb3c77b2a8, 0x81c2c92e47edaee6,
+    0x92722c851482353b, 0xa2bfe8a14cf10364, 0xa81a664bbc423001,
+    0xc24b8b70d0f89791, 0xc76c51a30654be30, 0xd192e819d6ef5218,
+    0xd69906245565a910, 0xf40e35855771202a, 0x106aa07032bbd1b8,
+    0x19a4c116b8d2d0c8, 0x1e376c085141ab53, 0x2748774cdf8eeb99,
+    0x34b0bcb5e19b48a8, 0x391c0cb3c5c95a63, 0x4ed8aa4ae3418acb,
+    0x5b9cca4f7763e373, 0x682e6ff3d6b2b8a3, 0x748f82ee5defb2fc,
+    0x78a5636f43172f60, 0x84c87814a1f0ab72, 0x8cc702081a6439ec,
+    0x90befffa23631e28, 0xa4506cebde82bde9, 0xbef9a3f7b2c67915,
+    0xc67178f2e372532b, 0xca273eceea26619c, 0xd186b8c721c0c207,
+    0xeada7dd6cde0eb1e, 0xf57d4f7fee6ed178, 0x06f067aa72176fba,
+    0x0a637dc5a2c898a6, 0x113f9804bef90dae, 0x1b710b35131c471b,
+    0x28db77f523047d84, 0x32caab7b40c72493, 0x3c9ebe0a15c9bebc,
+    0x431d67c49c100d4c, 0x4cc5d4becb3e42b6, 0x597f299cfc657e2a,
+    0x5fcb6fab3ad6faec, 0x6c44198c4a475817};
+
+constexpr std::uint64_t IV[8] = {
+    0x6a09e667f3bcc908,
+    0xbb67ae8584caa73b,
+    0x3c6ef372fe94f82b,
+    0xa54ff53a5f1d36f1,
+    0x510e527fade682d1,
+    0x9b05688c2b3e6c1f,
+    0x1f83d9abfb41bd6b,
+    0x5be0cd19137e2179};
+
+template <std::size_t Lanes>
+struct Vector
+{
+    using type [[gnu::vector_size(Lanes * 8)]] = std::uint64_t;
+};
+
+// Sets r to the rotations of x right by A and B bits and its rotation, or
+// with Shift its shift, by C bits, xored together. The result is set
+// through a reference because a function returning a vector wider than
+// the build's target changes the ABI, which GCC warns about even when the
+// call is inlined into a kernel compiled for that width.
+template <int A, int B, int C, bool Shift = false, class V>
+[[gnu::always_inline]] inline void
+sigma(V const& x, V& r)
+{
+    r = ((x >> A) | (x << (64 - A))) ^ ((x >> B) | (x << (64 - B)));
+    if constexpr (Shift)
+        r ^= x >> C;
+    else
+        r ^= (x >> C) | (x << (64 - C));
+}
+
+// Hashes Lanes messages which need the same number of blocks, one in each
+// lane of the vectors.
+template <std::size_t Lanes>
+[[gnu::always_inline]] inline void
+hashLanes(Slice const* messages, uint256* digests)
+{
+    using V = typename Vector<Lanes>::type;
+
+    auto const blocks = blocksFor(messages[0].size());
+
+    // The last one or two blocks of each message, with the padding
+    std::uint8_t tails[Lanes][2 * blockBytes];
+    std::uint8_t const* data[Lanes];
+    std::size_t full[Lanes];
+    for (std::size_t l = 0; l < Lanes; ++l)
+    {
+        auto const size = messages[l].size();
+        full[l] = size / blockBytes;
+        data[l] = messages[l].data();
+
+        auto const rest = size % blockBytes;
+        auto const tail = (blocks - full[l]) * blockBytes;
+        std::memset(tails[l], 0, tail);
+        if (rest != 0)
+            std::memcpy(tails[l], data[l] + full[l] * blockBytes, rest);
+        tails[l][rest] = 0x80;
+        boost::endian::store_big_u64(
+            tails[l] + tail - 8, static_cast<std::uint64_t>(size) << 3);
+        boost::endian::store_big_u64(
+            tails[l] + tail - 16, static_cast<std::uint64_t>(size) >> 61);
+    }
+
+    V h[8];
+    for (int i = 0; i < 8; ++i)
+        h[i] = V{} + IV[i];
+
+    for (std::size_t b = 0; b < blocks; ++b)
+    {
+        V w[16];
+        for (int t = 0; t < 16; ++t)
+        {
+            std::uint64_t words[Lanes];
+            for (std::size_t l = 0; l < Lanes; ++l)
+            {
+                auto const block = b < full[l]
+                    ? data[l] + b * blockBytes
+                    : tails[l] + (b - full[l]) * blockBytes;
+                words[l] = boost::endian::load_big_u64(block + 8 * t);
+            }
+            std::memcpy(&w[t], words, sizeof(V));
+        }
+
+        V a = h[0], bb = h[1], c = h[2], d = h[3];
+        V e = h[4], f = h[5], g = h[6], hh = h[7];
+
+        for (int t = 0; t < 80; ++t)
+        {
+            if (t >= 16)
+            {
+                V s0, s1;
+                sigma<1, 8, 7, true>(w[(t - 15) & 15], s0);
+                sigma<19, 61, 6, true>(w[(t - 2) & 15], s1);
+                w[t & 15] += s0 + w[(t - 7) & 15] + s1;
+            }
+
+            V s0, s1;
+            sigma<14, 18, 41>(e, s1);
+            auto const ch = (e & f) ^ (~e & g);
+            auto const t1 = hh + s1 + ch + K[t] + w[t & 15];
+            sigma<28, 34, 39>(a, s0);
+            auto const maj = (a & bb) ^ (a & c) ^ (bb & c);
+            auto const t2 = s0 + maj;
+
+            hh = g;
+            g = f;
+            f = e;
+            e = d + t1;
+            d = c;
+            c = bb;
+            bb = a;
+            a = t1 + t2;
+        }
+
+        h[0] += a;
+        h[1] += bb;
+        h[2] += c;
+        h[3] += d;
+        h[4] += e;
+        h[5] += f;
+        h[6] += g;
+        h[7] += hh;
+    }
+
+    // The digest is the first four words, big-endian
+    for (std::size_t l = 0; l < Lanes; ++l)
+    {
+        std::uint8_t half[32];
+        for (int i = 0; i < 4; ++i)
+            boost::endian::store_big_u64(half + 8 * i, h[i][l]);
+        digests[l] = uint256::fromVoid(half);
+    }
+}
+
+[[gnu::target("avx2")]] void
+hashAvx2(Slice const* messages, uint256* digests)
+{
+    hashLanes<4>(messages, digests);
+}
+
+[[gnu::target("avx512f")]] void
+hashAvx512(Slice const* messages, uint256* digests)
+{
+    hashLanes<8>(messages, digests);
+}
+
+#endif
+
+void
+hashScalar(Slice const& message, uint256& digest)
+{
+    sha512_half_hasher h;
+    h(message.data(), message.size());
+    digest = static_cast<sha512_half_hasher::result_type>(h);
+}
+
+}  // namespace
+
+namespace detail {
+
+bool
+sha512KernelSupported(Sha512Kernel kernel)
+{
+#ifdef RIPPLE_SHA512_SIMD
+    if (kernel == Sha512Kernel::avx512)
+        return __builtin_cpu_supports("avx512f");
+    if (kernel == Sha512Kernel::avx2)
+        return __builtin_cpu_supports("avx2");
+#endif
+    return kernel == Sha512Kernel::scalar;
+}
+
+Sha512Kernel
+sha512Kernel()
+{
+    static Sha512Kernel const kernel = [] {
+        for (auto k : {Sha512Kernel::avx512, Sha512Kernel::avx2})
+        {
+            if (sha512KernelSupported(k))
+                return k;
+        }
+        return Sha512Kernel::scalar;
+    }();
+    return kernel;
+}
+
+void
+sha512HalfBatch(
+    Sha512Kernel kernel,
+    Slice const* messages,
+    uint256* digests,
+    std::size_t count)
+{
+    assert(sha512KernelSupported(kernel));
+
+    std::size_t i = 0;
+
+#ifdef RIPPLE_SHA512_SIMD
+    std::size_t const lanes = kernel == Sha512Kernel::avx512 ? 8
+        : kernel == Sha512Kernel::avx2                       ? 4
+                                                             : 0;
+    auto const hash =
+        kernel == Sha512Kernel::avx512 ? &hashAvx512 : &hashAvx2;
+
+    // Messages which need the same number of blocks fill the lanes
+    while (lanes != 0 && count - i >= lanes)
+    {
+        auto const blocks = blocksFor(messages[i].size());
+        std::size_t n = 1;
+        while (n < lanes && blocksFor(messages[i + n].size()) == blocks)
+            ++n;
+
+        if (n == lanes)
+        {
+            hash(messages + i, digests + i);
+            i += lanes;
+        }
+        else
+        {
+            for (; n != 0; --n, ++i)
+                hashScalar(messages[i], digests[i]);
+        }
+    }
+#endif
+
+    for (; i < count; ++i)
+        hashScalar(messages[i], digests[i]);
+}
+
+}  // namespace detail
+
+void
+sha512HalfBatch(Slice const* messages, uint256* digests, std::size_t count)
+{
+    detail::sha512HalfBatch(detail::sha512Kernel(), messages, digests, count);
+}
+
+}  // namespace ripple
@@ -220,7 +220,7 @@ JSS(channel_id);             // out: AccountChannels
 JSS(channels);               // out: AccountChannels
 JSS(check);                  // in: AccountObjects
 JSS(check_nodes);            // in: LedgerCleaner
-JSS(clear);                  // in/out: FetchInfo
+JSS(clear);                  // in/out: FetchInfo, HookProfile
 JSS(close);                  // out: BookChanges
 JSS(close_flags);            // out: LedgerToJson
 JSS(close_time);             // in: Application, out: NetworkOPs,
@@ -289,7 +289,7 @@ JSS(drops);                   // out: TxQ
 JSS(duration_us);             // out: NetworkOPs
 JSS(effective);               // out: ValidatorList
                               // in: UNL
-JSS(enabled);                 // out: AmendmentTable
+JSS(enabled);                 // in: HookProfile; out: AmendmentTable
 JSS(engine_result);           // out: NetworkOPs, TransactionSign, Submit
 JSS(engine_result_code);      // out: NetworkOPs, TransactionSign, Submit
 JSS(engine_result_message);   // out: NetworkOPs, TransactionSign, Submit
@@ -347,6 +347,8 @@ JSS(highest_ticket);        // out: AccountInfo
 JSS(historical_perminute);  // historical_perminute.
 JSS(hook);                  // in: LedgerEntry
 JSS(hook_definition);       // in: LedgerEntry
+JSS(hook_guard_cache);      // out: GetCounts
+JSS(hook_module_cache);     // out: GetCounts
 JSS(hook_state);            // in: LedgerEntry
 JSS(hostid);                // out: NetworkOPs
 JSS(hotwallet);             // in: GatewayBalances
@@ -491,9 +493,13 @@ JSS(no_ripple);                  // out: AccountLines
 JSS(no_ripple_peer);             // out: AccountLines
 JSS(node);                       // out: LedgerEntry
 JSS(node_binary);                // out: LedgerEntry
+JSS(node_memory_bytes);          // out: GetCounts
 JSS(node_read_bytes);            // out: GetCounts
 JSS(node_read_errors);           // out: GetCounts
 JSS(node_read_retries);          // out: GetCounts
+JSS(node_reads_async);           // out: GetCounts
+JSS(node_reads_filtered);        // out: GetCounts
+JSS(node_reads_filter_false_positives);  // out: GetCounts
 JSS(node_reads_hit);             // out: GetCounts
 JSS(node_reads_total);           // out: GetCounts
 JSS(node_reads_duration_us);     // out: GetCounts
@@ -502,6 +508,9 @@ JSS(nodestore);                  // out: GetCounts
 JSS(node_writes);                // out: GetCounts
 JSS(node_written_bytes);         // out: GetCounts
 JSS(node_writes_duration_us);    // out: GetCounts
+JSS(node_write_batches);         // out: GetCounts
+JSS(node_write_batch_objects);   // out: GetCounts
+JSS(node_write_queue_us);        // out: GetCounts
 JSS(node_write_retries);         // out: GetCounts
 JSS(node_writes_delayed);        // out::GetCounts
 JSS(nth);                        // out: RPC server_definitions
@@ -17,6 +17,8 @@
 */
 //==============================================================================
 
+#include <ripple/app/hook/HookGuardCache.h>
+#include <ripple/app/hook/HookModuleCache.h>
 #include <ripple/app/ledger/AcceptedLedger.h>
 #include <ripple/app/ledger/InboundLedgers.h>
 #include <ripple/app/ledger/LedgerMaster.h>
@@ -118,6 +120,8 @@ getCountsJson(Application& app, int minObjectCount)
         app.getNodeFamily().getTreeNodeCache(0)->getCacheSize();
     ret[jss::treenode_track_size] =
         app.getNodeFamily().getTreeNodeCache(0)->getTrackSize();
+    ret[jss::hook_module_cache] = hook::HookModuleCache::instance().getJson();
+    ret[jss::hook_guard_cache] = hook::HookGuardCache::instance().getJson();
 
     std::string uptime;
     auto s = UptimeClock::now();
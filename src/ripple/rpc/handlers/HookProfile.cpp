@@ -0,0 +1,52 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/HookProfiler.h>
+#include <ripple/json/json_value.h>
+#include <ripple/protocol/ErrorCodes.h>
+#include <ripple/protocol/jss.h>
+#include <ripple/rpc/Context.h>
+
+namespace ripple {
+
+// {
+//   enabled: <bool>  // optional, turn the profiler on or off
+//   clear: <bool>    // optional, discard everything recorded so far
+// }
+Json::Value
+doHookProfile(RPC::JsonContext& context)
+{
+    auto& profiler = hook::HookProfiler::instance();
+
+    if (context.params.isMember(jss::enabled))
+    {
+        if (!context.params[jss::enabled].isBool())
+            return RPC::expected_field_error(jss::enabled, "bool");
+
+        profiler.setEnabled(context.params[jss::enabled].asBool());
+    }
+
+    if (context.params.isMember(jss::clear) &&
+        context.params[jss::clear].asBool())
+        profiler.clear();
+
+    return profiler.getJson();
+}
+
+}  // namespace ripple
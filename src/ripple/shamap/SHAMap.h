@@ -119,6 +119,10 @@ public:
     /** The depth of the hash map: data is only present in the leaves */
     static inline constexpr unsigned int leafDepth = 64;
 
+    /** The modified inner nodes two levels below the root needed for a
+        parallel flush to use more than one thread */
+    static inline constexpr std::size_t parallelFlushThreshold = 64;
+
     using DeltaItem = std::pair<
         boost::intrusive_ptr<SHAMapItem const>,
         boost::intrusive_ptr<SHAMapItem const>>;
@@ -217,6 +221,19 @@ public:
     boost::intrusive_ptr<SHAMapItem const> const&
     peekItem(uint256 const& id, SHAMapHash& hash) const;
 
+    /** Start loading the nodes on the path to an item in the background.
+
+        Any node on the path which is neither in the tree nor in the tree
+        node cache is requested from the node store asynchronously, so a
+        later lookup of `id` does not have to wait for disk I/O.
+
+        @param id the identifier of the item, which need not exist.
+        @param hold kept alive until all reads have completed, it must
+                    keep this map alive too.
+     */
+    void
+    prefetch(uint256 const& id, std::shared_ptr<void const> hold) const;
+
     // traverse functions
     /** Find the first item after the given item.
 
@@ -323,6 +340,41 @@ public:
         Slice const& rawNode,
         SHAMapSyncFilter* filter);
 
+    /** Add a node already made from its wire format.
+
+        Lets the caller make a group of nodes together, such as with
+        SHAMapTreeNode::makeFromWire, which hashes their inner nodes as a
+        batch.
+    */
+    SHAMapAddNode
+    addKnownNode(
+        SHAMapNodeID const& nodeID,
+        std::shared_ptr<SHAMapTreeNode> node,
+        SHAMapSyncFilter* filter);
+
+    /** Add non-root nodes received together, in order.
+
+        The nodes the map is missing are made together, so their inner
+        nodes are hashed as a batch. A missing node that can't be made from
+        its wire format is skipped, with the nodes below it, and counted as
+        invalid. The nodes after it are still added. Adding stops at the
+        first node the map rejects.
+    */
+    SHAMapAddNode
+    addKnownNodes(
+        std::vector<std::pair<SHAMapNodeID, Slice>> const& nodes,
+        SHAMapSyncFilter* filter);
+
+    /** The first node missing from memory on the path to a node.
+
+        addKnownNode can only hook a node where the node returned is the
+        node itself. Nothing is returned if the map has the node, or
+        doesn't need it. Only the nodes in memory are looked at, so a node
+        the node store has may still be returned.
+    */
+    std::optional<SHAMapNodeID>
+    firstMissingNode(SHAMapNodeID const& nodeID) const;
+
     // status functions
     void
     setImmutable();
@@ -344,9 +396,14 @@ public:
     int
     unshare();
 
-    /** Flush modified nodes to the nodestore and convert them to shared. */
+    /** Flush modified nodes to the nodestore and convert them to shared.
+
+        @param parallel Flush the subtrees two levels below the root on
+                        several threads, if enough of them were modified.
+                        The resulting hashes are the same either way.
+    */
     int
-    flushDirty(NodeObjectType t);
+    flushDirty(NodeObjectType t, bool parallel = false);
 
     void
     walkMap(std::vector<SHAMapMissingNode>& missingNodes, int maxMissing) const;
@@ -391,6 +448,14 @@ private:
     std::shared_ptr<SHAMapTreeNode>
     checkFilter(SHAMapHash const& hash, SHAMapSyncFilter* filter) const;
 
+    /** Hook a received node into the map, making it only if it's needed */
+    template <class MakeNode>
+    SHAMapAddNode
+    hookKnownNode(
+        SHAMapNodeID const& nodeID,
+        MakeNode&& makeNode,
+        SHAMapSyncFilter* filter);
+
     /** Update hashes up to the root */
     void
     dirtyUp(
@@ -503,7 +568,22 @@ private:
         Delta& differences,
         int& maxCount) const;
     int
-    walkSubTree(bool doWrite, NodeObjectType t);
+    walkSubTree(bool doWrite, NodeObjectType t, bool parallel = false);
+
+    // Flush the modified nodes below an inner node preFlushNode returned,
+    // then the node itself, which is replaced by the shared node.
+    int
+    flushSubTree(
+        std::shared_ptr<SHAMapInnerNode>& node,
+        bool doWrite,
+        NodeObjectType t);
+
+    // As flushSubTree, for the root, on several threads
+    int
+    flushParallel(
+        std::shared_ptr<SHAMapInnerNode>& node,
+        bool doWrite,
+        NodeObjectType t);
 
     // Structure to track information about call to
     // getMissingNodes while it's in progress
@@ -103,6 +103,10 @@ private:
     void
     iterNonEmptyChildIndexes(F&& f) const;
 
+    /** Copy the hashes of the children this node has in memory. */
+    void
+    copyChildHashes();
+
 public:
     explicit SHAMapInnerNode(
         std::uint32_t cowid,
@@ -175,6 +179,14 @@ public:
     void
     updateHashDeep();
 
+    /** Update the hashes of several nodes, hashing them together. */
+    static void
+    updateHashes(std::vector<SHAMapInnerNode*> const& nodes);
+
+    /** updateHashDeep for several nodes, hashing them together. */
+    static void
+    updateHashesDeep(std::vector<SHAMapInnerNode*> const& nodes);
+
     void
     serializeForWire(Serializer&) const override;
 
@@ -191,7 +203,7 @@ public:
     makeFullInner(Slice data, SHAMapHash const& hash, bool hashValid);
 
     static std::shared_ptr<SHAMapTreeNode>
-    makeCompressedInner(Slice data);
+    makeCompressedInner(Slice data, SHAMapHash const& hash, bool hashValid);
 };
 
 inline bool
@@ -32,6 +32,7 @@
 #include <memory>
 #include <mutex>
 #include <string>
+#include <vector>
 
 namespace ripple {
 
@@ -177,6 +178,12 @@ public:
     static std::shared_ptr<SHAMapTreeNode>
     makeFromWire(Slice rawNode);
 
+    /** Make nodes from their wire format, as makeFromWire would, hashing
+        the inner nodes together. A node that makeFromWire would reject is
+        returned as nullptr, and the others are made as usual. */
+    static std::vector<std::shared_ptr<SHAMapTreeNode>>
+    makeFromWire(std::vector<Slice> const& rawNodes);
+
 private:
     static std::shared_ptr<SHAMapTreeNode>
     makeTransaction(Slice data, SHAMapHash const& hash, bool hashValid);
@@ -18,12 +18,21 @@
 //==============================================================================
 
 #include <ripple/basics/contract.h>
+#include <ripple/core/impl/Workers.h>
 #include <ripple/shamap/SHAMap.h>
 #include <ripple/shamap/SHAMapAccountStateLeafNode.h>
 #include <ripple/shamap/SHAMapNodeID.h>
 #include <ripple/shamap/SHAMapSyncFilter.h>
 #include <ripple/shamap/SHAMapTxLeafNode.h>
 #include <ripple/shamap/SHAMapTxPlusMetaLeafNode.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
 
 namespace ripple {
 
@@ -469,6 +478,40 @@ SHAMap::descendAsync(
     return ptr.get();
 }
 
+void
+SHAMap::prefetch(uint256 const& id, std::shared_ptr<void const> hold) const
+{
+    SHAMapTreeNode* node = root_.get();
+    SHAMapNodeID nodeID;
+
+    while (node && node->isInner())
+    {
+        auto const inner = static_cast<SHAMapInnerNode*>(node);
+        auto const branch = selectBranch(nodeID, id);
+        if (inner->isEmptyBranch(branch))
+            return;
+
+        bool pending = false;
+        node = descendAsync(
+            inner,
+            branch,
+            nullptr,
+            pending,
+            [this, id, hold](
+                std::shared_ptr<SHAMapTreeNode> node, SHAMapHash const&) {
+                // The node is in the tree node cache now, so walking down
+                // from the root again reaches it without blocking.
+                if (node)
+                    prefetch(id, hold);
+            });
+
+        if (pending)
+            return;
+
+        nodeID = nodeID.getChildNodeID(branch);
+    }
+}
+
 template <class Node>
 std::shared_ptr<Node>
 SHAMap::unshareNode(std::shared_ptr<Node> node, SHAMapNodeID const& nodeID)
@@ -1033,14 +1076,14 @@ SHAMap::unshare()
 }
 
 int
-SHAMap::flushDirty(NodeObjectType t)
+SHAMap::flushDirty(NodeObjectType t, bool parallel)
 {
     // We only write back if this map is backed.
-    return walkSubTree(backed_, t);
+    return walkSubTree(backed_, t, parallel);
 }
 
 int
-SHAMap::walkSubTree(bool doWrite, NodeObjectType t)
+SHAMap::walkSubTree(bool doWrite, NodeObjectType t, bool parallel)
 {
     assert(!doWrite || backed_);
 
@@ -1069,99 +1112,361 @@ SHAMap::walkSubTree(bool doWrite, NodeObjectType t)
         return 1;
     }
 
-    // Stack of {parent,index,child} pointers representing
-    // inner nodes we are in the process of flushing
-    using StackEntry = std::pair<std::shared_ptr<SHAMapInnerNode>, int>;
-    std::stack<StackEntry, std::vector<StackEntry>> stack;
-
     node = preFlushNode(std::move(node));
 
-    int pos = 0;
+    if (parallel)
+        flushed = flushParallel(node, doWrite, t);
+    else
+        flushed = flushSubTree(node, doWrite, t);
 
-    // We can't flush an inner node until we flush its children
-    while (1)
+    // Last inner node is the new root_
+    root_ = std::move(node);
+
+    return flushed;
+}
+
+int
+SHAMap::flushSubTree(
+    std::shared_ptr<SHAMapInnerNode>& node,
+    bool doWrite,
+    NodeObjectType t)
+{
+    int flushed = 0;
+
+    // The modified inner nodes at each depth below node, with the parent
+    // and branch to hook each to once it's flushed
+    struct Entry
     {
-        while (pos < branchFactor)
+        SHAMapInnerNode* parent;
+        int branch;
+        std::shared_ptr<SHAMapInnerNode> node;
+    };
+    std::vector<std::vector<Entry>> levels;
+    levels.push_back({{nullptr, 0, std::move(node)}});
+
+    for (std::size_t depth = 0; depth < levels.size(); ++depth)
+    {
+        for (std::size_t i = 0; i < levels[depth].size(); ++i)
         {
-            if (node->isEmptyBranch(pos))
-            {
-                ++pos;
-            }
-            else
+            auto const parent = levels[depth][i].node;
+
+            for (int branch = 0; branch < branchFactor; ++branch)
             {
+                if (parent->isEmptyBranch(branch))
+                    continue;
+
                 // No need to do I/O. If the node isn't linked,
                 // it can't need to be flushed
-                int branch = pos;
-                auto child = node->getChild(pos++);
+                auto child = parent->getChild(branch);
+                if (!child || child->cowid() == 0)
+                    continue;
+
+                // This is a node that needs to be flushed
+                child = preFlushNode(std::move(child));
 
-                if (child && (child->cowid() != 0))
+                if (child->isInner())
                 {
-                    // This is a node that needs to be flushed
+                    if (levels.size() == depth + 1)
+                        levels.emplace_back();
+                    levels[depth + 1].push_back(
+                        {parent.get(),
+                         branch,
+                         std::static_pointer_cast<SHAMapInnerNode>(
+                             std::move(child))});
+                }
+                else
+                {
+                    // flush this leaf
+                    ++flushed;
 
-                    child = preFlushNode(std::move(child));
+                    assert(parent->cowid() == cowid_);
+                    child->updateHash();
+                    child->unshare();
 
-                    if (child->isInner())
-                    {
-                        // save our place and work on this node
-
-                        stack.emplace(std::move(node), branch);
-                        // The semantics of this changes when we move to c++-20
-                        // Right now no move will occur; With c++-20 child will
-                        // be moved from.
-                        node = std::static_pointer_cast<SHAMapInnerNode>(
-                            std::move(child));
-                        pos = 0;
-                    }
-                    else
-                    {
-                        // flush this leaf
-                        ++flushed;
+                    if (doWrite)
+                        child = writeNode(t, std::move(child));
 
-                        assert(node->cowid() == cowid_);
-                        child->updateHash();
-                        child->unshare();
+                    parent->shareChild(branch, child);
+                }
+            }
+        }
+    }
 
-                        if (doWrite)
-                            child = writeNode(t, std::move(child));
+    // We can't flush an inner node until we flush its children, so the
+    // deepest are hashed first, all those at a depth together
+    std::vector<SHAMapInnerNode*> nodes;
+    for (auto level = levels.rbegin(); level != levels.rend(); ++level)
+    {
+        nodes.clear();
+        for (auto const& entry : *level)
+            nodes.push_back(entry.node.get());
+        SHAMapInnerNode::updateHashesDeep(nodes);
 
-                        node->shareChild(branch, child);
-                    }
-                }
+        for (auto& entry : *level)
+        {
+            // This inner node can now be shared
+            entry.node->unshare();
+
+            if (doWrite)
+                entry.node = std::static_pointer_cast<SHAMapInnerNode>(
+                    writeNode(t, std::move(entry.node)));
+
+            ++flushed;
+
+            // Hook this inner node to its parent
+            if (entry.parent)
+            {
+                assert(entry.parent->cowid() == cowid_);
+                entry.parent->shareChild(entry.branch, entry.node);
             }
         }
+    }
+
+    node = std::move(levels.front().front().node);
+
+    return flushed;
+}
 
-        // update the hash of this inner node
-        node->updateHashDeep();
+namespace {
 
-        // This inner node can now be shared
-        node->unshare();
+// The threads which help flush maps in parallel, started on first use and
+// kept for the life of the process
+class FlushWorkers : public Workers::Callback
+{
+    std::mutex mutex_;
+    std::deque<std::function<void()>> tasks_;
+    Workers workers_;
+
+public:
+    static std::size_t
+    threads()
+    {
+        return std::clamp(std::thread::hardware_concurrency(), 1u, 16u);
+    }
+
+    static FlushWorkers&
+    instance()
+    {
+        static FlushWorkers workers;
+        return workers;
+    }
+
+    FlushWorkers() : workers_(*this, nullptr, "SHAMapFlush", threads() - 1)
+    {
+    }
+
+    void
+    add(std::function<void()> task)
+    {
+        {
+            std::lock_guard lock(mutex_);
+            tasks_.push_back(std::move(task));
+        }
+        workers_.addTask();
+    }
+
+    void
+    processTask(int) override
+    {
+        std::function<void()> task;
+        {
+            std::lock_guard lock(mutex_);
+            task = std::move(tasks_.front());
+            tasks_.pop_front();
+        }
+        task();
+    }
+};
+
+}  // namespace
+
+int
+SHAMap::flushParallel(
+    std::shared_ptr<SHAMapInnerNode>& node,
+    bool doWrite,
+    NodeObjectType t)
+{
+    auto dirtyChild = [](SHAMapInnerNode& parent, int branch) {
+        std::shared_ptr<SHAMapTreeNode> child;
+        if (!parent.isEmptyBranch(branch))
+        {
+            child = parent.getChild(branch);
+            if (child && child->cowid() == 0)
+                child.reset();
+        }
+        return child;
+    };
+
+    // Small changes are quicker to flush on this thread
+    std::size_t dirty = 0;
+    for (int i = 0; i < branchFactor; ++i)
+    {
+        auto const child = dirtyChild(*node, i);
+        if (!child || !child->isInner())
+            continue;
+        auto& inner = static_cast<SHAMapInnerNode&>(*child);
+        for (int j = 0; j < branchFactor; ++j)
+        {
+            if (auto const grandchild = dirtyChild(inner, j);
+                grandchild && grandchild->isInner())
+                ++dirty;
+        }
+    }
+    if (dirty < parallelFlushThreshold)
+        return flushSubTree(node, doWrite, t);
+
+    int flushed = 0;
+
+    // Flush a leaf, or an inner node already hashed, and hook it to its
+    // parent
+    auto share = [&](SHAMapInnerNode& parent,
+                     int branch,
+                     std::shared_ptr<SHAMapTreeNode> child) {
+        assert(parent.cowid() == cowid_);
+        if (child->isLeaf())
+            child->updateHash();
+        child->unshare();
 
         if (doWrite)
-            node = std::static_pointer_cast<SHAMapInnerNode>(
-                writeNode(t, std::move(node)));
+            child = writeNode(t, std::move(child));
 
+        parent.shareChild(branch, child);
         ++flushed;
+    };
 
-        if (stack.empty())
-            break;
+    // The modified inner nodes one level below the root, and the
+    // subtrees below them, which are flushed on the worker threads.
+    struct Task
+    {
+        std::shared_ptr<SHAMapInnerNode> parent;
+        int branch;
+        std::shared_ptr<SHAMapInnerNode> node;
+        int flushed = 0;
+    };
+    std::vector<std::pair<int, std::shared_ptr<SHAMapInnerNode>>> middle;
+    std::vector<Task> tasks;
+    tasks.reserve(dirty);
+
+    for (int i = 0; i < branchFactor; ++i)
+    {
+        auto child = dirtyChild(*node, i);
+        if (!child)
+            continue;
 
-        auto parent = std::move(stack.top().first);
-        pos = stack.top().second;
-        stack.pop();
+        child = preFlushNode(std::move(child));
+        if (child->isLeaf())
+        {
+            share(*node, i, std::move(child));
+            continue;
+        }
 
-        // Hook this inner node to its parent
-        assert(parent->cowid() == cowid_);
-        parent->shareChild(pos, node);
+        auto inner = std::static_pointer_cast<SHAMapInnerNode>(child);
+        for (int j = 0; j < branchFactor; ++j)
+        {
+            auto grandchild = dirtyChild(*inner, j);
+            if (!grandchild)
+                continue;
 
-        // Continue with parent's next child, if any
-        node = std::move(parent);
-        ++pos;
+            grandchild = preFlushNode(std::move(grandchild));
+            if (grandchild->isLeaf())
+                share(*inner, j, std::move(grandchild));
+            else
+                tasks.push_back(
+                    {inner,
+                     j,
+                     std::static_pointer_cast<SHAMapInnerNode>(
+                         std::move(grandchild))});
+        }
+        middle.emplace_back(i, std::move(inner));
     }
 
-    // Last inner node is the new root_
-    root_ = std::move(node);
+    // Each thread takes the next subtree until none are left. The subtrees
+    // share no modified nodes, and the tree node cache and the node store
+    // may be used concurrently.
+    std::atomic<std::size_t> next{0};
+    std::mutex m;
+    std::exception_ptr error;
+    auto work = [&]() {
+        try
+        {
+            for (auto i = next++; i < tasks.size(); i = next++)
+                tasks[i].flushed = flushSubTree(tasks[i].node, doWrite, t);
+        }
+        catch (...)
+        {
+            next = tasks.size();
+            std::lock_guard l(m);
+            if (!error)
+                error = std::current_exception();
+        }
+    };
 
-    return flushed;
+    // Once this thread has run out of subtrees it only waits for the
+    // helpers which already started: those the pool gets to later, as when
+    // it is busy with another flush, find the flush closed and return.
+    struct Helpers
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::size_t running = 0;
+        bool closed = false;
+    };
+    auto helpers = std::make_shared<Helpers>();
+
+    auto const threads =
+        std::min<std::size_t>(tasks.size(), FlushWorkers::threads());
+    JLOG(journal_.debug()) << "flushing " << tasks.size()
+                           << " subtrees on up to " << threads << " threads";
+
+    for (std::size_t i = 1; i < threads; ++i)
+    {
+        FlushWorkers::instance().add([helpers, &work]() {
+            {
+                std::lock_guard lock(helpers->mutex);
+                if (helpers->closed)
+                    return;
+                ++helpers->running;
+            }
+            work();
+            std::lock_guard lock(helpers->mutex);
+            if (--helpers->running == 0)
+                helpers->cv.notify_all();
+        });
+    }
+    work();
+    {
+        std::unique_lock lock(helpers->mutex);
+        helpers->closed = true;
+        helpers->cv.wait(lock, [&] { return helpers->running == 0; });
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+
+    // Hook the subtrees to their parents, then hash the top two levels
+    for (auto& task : tasks)
+    {
+        assert(task.parent->cowid() == cowid_);
+        task.parent->shareChild(task.branch, task.node);
+        flushed += task.flushed;
+    }
+
+    std::vector<SHAMapInnerNode*> nodes;
+    for (auto const& entry : middle)
+        nodes.push_back(entry.second.get());
+    SHAMapInnerNode::updateHashesDeep(nodes);
+
+    for (auto& [branch, inner] : middle)
+        share(*node, branch, std::move(inner));
+
+    node->updateHashDeep();
+    node->unshare();
+
+    if (doWrite)
+        node = std::static_pointer_cast<SHAMapInnerNode>(
+            writeNode(t, std::move(node)));
+
+    return flushed + 1;
 }
 
 void
@@ -29,7 +29,10 @@
 #include <ripple/shamap/SHAMapTreeNode.h>
 #include <ripple/shamap/impl/TaggedPointer.ipp>
 
+#include <boost/endian/conversion.hpp>
+
 #include <algorithm>
+#include <cstring>
 #include <iterator>
 #include <utility>
 
@@ -157,7 +160,10 @@ SHAMapInnerNode::makeFullInner(
 }
 
 std::shared_ptr<SHAMapTreeNode>
-SHAMapInnerNode::makeCompressedInner(Slice data)
+SHAMapInnerNode::makeCompressedInner(
+    Slice data,
+    SHAMapHash const& hash,
+    bool hashValid)
 {
     // A compressed inner node is serialized as a series of 33 byte chunks,
     // representing a one byte "position" and a 256-bit hash:
@@ -188,7 +194,12 @@ SHAMapInnerNode::makeCompressedInner(Slice data)
     }
 
     ret->resizeChildArrays(ret->getBranchCount());
-    ret->updateHash();
+
+    if (hashValid)
+        ret->hash_ = hash;
+    else
+        ret->updateHash();
+
     return ret;
 }
 
@@ -208,7 +219,7 @@ SHAMapInnerNode::updateHash()
 }
 
 void
-SHAMapInnerNode::updateHashDeep()
+SHAMapInnerNode::copyChildHashes()
 {
     SHAMapHash* hashes;
     std::shared_ptr<SHAMapTreeNode>* children;
@@ -219,9 +230,63 @@ SHAMapInnerNode::updateHashDeep()
         if (children[indexNum] != nullptr)
             hashes[indexNum] = children[indexNum]->getHash();
     });
+}
+
+void
+SHAMapInnerNode::updateHashDeep()
+{
+    copyChildHashes();
     updateHash();
 }
 
+void
+SHAMapInnerNode::updateHashes(std::vector<SHAMapInnerNode*> const& nodes)
+{
+    // What updateHash hashes: the prefix, then every branch's hash
+    constexpr std::size_t size = 4 + branchFactor * uint256::bytes;
+
+    std::vector<std::uint8_t> buffer(nodes.size() * size);
+    std::vector<Slice> messages;
+    std::vector<SHAMapInnerNode*> hashed;
+    messages.reserve(nodes.size());
+    hashed.reserve(nodes.size());
+
+    for (auto node : nodes)
+    {
+        if (node->isBranch_ == 0)
+        {
+            node->hash_ = SHAMapHash{};
+            continue;
+        }
+
+        auto p = buffer.data() + messages.size() * size;
+        messages.emplace_back(p, size);
+        hashed.push_back(node);
+
+        boost::endian::store_big_u32(
+            p, safe_cast<std::uint32_t>(HashPrefix::innerNode));
+        p += 4;
+        node->iterChildren([&](SHAMapHash const& hh) {
+            std::memcpy(p, hh.as_uint256().data(), uint256::bytes);
+            p += uint256::bytes;
+        });
+    }
+
+    std::vector<uint256> digests(hashed.size());
+    sha512HalfBatch(messages.data(), digests.data(), messages.size());
+
+    for (std::size_t i = 0; i < hashed.size(); ++i)
+        hashed[i]->hash_ = SHAMapHash{digests[i]};
+}
+
+void
+SHAMapInnerNode::updateHashesDeep(std::vector<SHAMapInnerNode*> const& nodes)
+{
+    for (auto node : nodes)
+        node->copyChildHashes();
+    updateHashes(nodes);
+}
+
 void
 SHAMapInnerNode::serializeForWire(Serializer& s) const
 {
@@ -20,6 +20,7 @@
 #include <ripple/basics/random.h>
 #include <ripple/shamap/SHAMap.h>
 #include <ripple/shamap/SHAMapSyncFilter.h>
+#include <set>
 
 namespace ripple {
 
@@ -571,6 +572,128 @@ SHAMap::addKnownNode(
     const SHAMapNodeID& node,
     Slice const& rawNode,
     SHAMapSyncFilter* filter)
+{
+    return hookKnownNode(
+        node,
+        [&rawNode] { return SHAMapTreeNode::makeFromWire(rawNode); },
+        filter);
+}
+
+SHAMapAddNode
+SHAMap::addKnownNode(
+    const SHAMapNodeID& node,
+    std::shared_ptr<SHAMapTreeNode> newNode,
+    SHAMapSyncFilter* filter)
+{
+    return hookKnownNode(
+        node,
+        [&newNode] { return std::move(newNode); },
+        filter);
+}
+
+SHAMapAddNode
+SHAMap::addKnownNodes(
+    std::vector<std::pair<SHAMapNodeID, Slice>> const& nodes,
+    SHAMapSyncFilter* filter)
+{
+    // A node is missing if the map stops short of it, or its parent is a
+    // missing node earlier in the list. addKnownNode makes the others only
+    // if it turns out to need them.
+    std::vector<Slice> rawNodes;
+    std::vector<int> batched(nodes.size(), -1);
+    std::set<SHAMapNodeID> missing;
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+    {
+        auto const& nodeID = nodes[i].first;
+        assert(!nodeID.isRoot());
+
+        auto const stop = firstMissingNode(nodeID);
+        if (!stop ||
+            (*stop != nodeID &&
+             !missing.count(SHAMapNodeID::createID(
+                 nodeID.getDepth() - 1, nodeID.getNodeID()))))
+            continue;
+
+        missing.insert(nodeID);
+        batched[i] = rawNodes.size();
+        rawNodes.push_back(nodes[i].second);
+    }
+    auto made = SHAMapTreeNode::makeFromWire(rawNodes);
+
+    // Nodes below a corrupt one can't be hooked, so they are skipped too
+    SHAMapAddNode ret;
+    int corrupt = 0;
+    std::set<SHAMapNodeID> skipped;
+    for (std::size_t i = 0; i < nodes.size(); ++i)
+    {
+        auto const& [nodeID, rawNode] = nodes[i];
+
+        if (batched[i] < 0)
+        {
+            ret += addKnownNode(nodeID, rawNode, filter);
+        }
+        else if (skipped.count(SHAMapNodeID::createID(
+                     nodeID.getDepth() - 1, nodeID.getNodeID())))
+        {
+            skipped.insert(nodeID);
+            continue;
+        }
+        else if (auto& node = made[batched[i]])
+        {
+            ret += addKnownNode(nodeID, std::move(node), filter);
+        }
+        else
+        {
+            JLOG(journal_.warn()) << "Corrupt node received " << nodeID;
+            ++corrupt;
+            skipped.insert(nodeID);
+            continue;
+        }
+
+        if (!ret.isGood())
+            break;
+    }
+
+    for (; corrupt != 0; --corrupt)
+        ret.incInvalid();
+    return ret;
+}
+
+std::optional<SHAMapNodeID>
+SHAMap::firstMissingNode(SHAMapNodeID const& node) const
+{
+    if (!isSynching())
+        return std::nullopt;
+
+    auto const generation = f_.getFullBelowCache(ledgerSeq_)->getGeneration();
+    SHAMapNodeID iNodeID;
+    auto iNode = root_.get();
+
+    // As hookKnownNode walks, without fetching
+    while (iNode->isInner() &&
+           !static_cast<SHAMapInnerNode*>(iNode)->isFullBelow(generation) &&
+           (iNodeID.getDepth() < node.getDepth()))
+    {
+        int branch = selectBranch(iNodeID, node.getNodeID());
+        auto inner = static_cast<SHAMapInnerNode*>(iNode);
+        if (inner->isEmptyBranch(branch))
+            return std::nullopt;
+
+        iNodeID = iNodeID.getChildNodeID(branch);
+        iNode = inner->getChildPointer(branch);
+        if (iNode == nullptr)
+            return iNodeID;
+    }
+
+    return std::nullopt;
+}
+
+template <class MakeNode>
+SHAMapAddNode
+SHAMap::hookKnownNode(
+    const SHAMapNodeID& node,
+    MakeNode&& makeNode,
+    SHAMapSyncFilter* filter)
 {
     assert(!node.isRoot());
 
@@ -609,7 +732,7 @@ SHAMap::addKnownNode(
 
         if (iNode == nullptr)
         {
-            auto newNode = SHAMapTreeNode::makeFromWire(rawNode);
+            auto newNode = makeNode();
 
             if (!newNode || childHash != newNode->getHash())
             {
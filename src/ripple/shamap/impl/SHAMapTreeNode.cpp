@@ -135,7 +135,7 @@ SHAMapTreeNode::makeFromWire(Slice rawNode)
         return SHAMapInnerNode::makeFullInner(rawNode, hash, hashValid);
 
     if (type == wireTypeCompressedInner)
-        return SHAMapInnerNode::makeCompressedInner(rawNode);
+        return SHAMapInnerNode::makeCompressedInner(rawNode, hash, hashValid);
 
     if (type == wireTypeTransactionWithMeta)
         return makeTransactionWithMeta(rawNode, hash, hashValid);
@@ -144,6 +144,46 @@ SHAMapTreeNode::makeFromWire(Slice rawNode)
         "wire: Unknown type (" + std::to_string(type) + ")");
 }
 
+std::vector<std::shared_ptr<SHAMapTreeNode>>
+SHAMapTreeNode::makeFromWire(std::vector<Slice> const& rawNodes)
+{
+    std::vector<std::shared_ptr<SHAMapTreeNode>> nodes;
+    nodes.reserve(rawNodes.size());
+    std::vector<SHAMapInnerNode*> inners;
+
+    for (auto rawNode : rawNodes)
+    {
+        // A node that can't be made doesn't stop the others being made
+        try
+        {
+            auto const type =
+                rawNode.empty() ? 0 : rawNode[rawNode.size() - 1];
+            if (type != wireTypeInner && type != wireTypeCompressedInner)
+            {
+                nodes.push_back(makeFromWire(rawNode));
+                continue;
+            }
+
+            rawNode.remove_suffix(1);
+
+            // Inner nodes are hashed below
+            auto node = type == wireTypeInner
+                ? SHAMapInnerNode::makeFullInner(rawNode, SHAMapHash{}, true)
+                : SHAMapInnerNode::makeCompressedInner(
+                      rawNode, SHAMapHash{}, true);
+            inners.push_back(static_cast<SHAMapInnerNode*>(node.get()));
+            nodes.push_back(std::move(node));
+        }
+        catch (std::exception const&)
+        {
+            nodes.push_back(nullptr);
+        }
+    }
+
+    SHAMapInnerNode::updateHashes(inners);
+    return nodes;
+}
+
 std::shared_ptr<SHAMapTreeNode>
 SHAMapTreeNode::makeFromPrefix(Slice rawNode, SHAMapHash const& hash)
 {
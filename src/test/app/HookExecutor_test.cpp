@@ -0,0 +1,143 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/applyHook.h>
+#include <ripple/beast/unit_test.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class HookExecutor_test : public beast::unit_test::suite
+{
+    using VM = hook::HookExecutor::WasmEdgeVM;
+
+    void
+    testSharedImportModule()
+    {
+        testcase("shared import module");
+
+        auto const importObj = hook::HookExecutor::importModule();
+        BEAST_EXPECT(importObj);
+        BEAST_EXPECT(importObj == hook::HookExecutor::importModule());
+
+        // the same module can be linked into several VMs at once and outlives
+        // each of them
+        {
+            VM vm1;
+            VM vm2;
+            BEAST_EXPECT(vm1.sane() && vm2.sane());
+            BEAST_EXPECT(WasmEdge_ResultOK(
+                WasmEdge_VMRegisterModuleFromImport(vm1.ctx, importObj)));
+            BEAST_EXPECT(WasmEdge_ResultOK(
+                WasmEdge_VMRegisterModuleFromImport(vm2.ctx, importObj)));
+        }
+
+        std::vector<std::thread> threads;
+        std::atomic<int> failures{0};
+        for (int t = 0; t < 4; ++t)
+            threads.emplace_back([&]() {
+                for (int i = 0; i < 100; ++i)
+                {
+                    VM vm;
+                    if (!vm.sane() ||
+                        !WasmEdge_ResultOK(WasmEdge_VMRegisterModuleFromImport(
+                            vm.ctx, importObj)))
+                        ++failures;
+                }
+            });
+        for (auto& t : threads)
+            t.join();
+        BEAST_EXPECT(failures == 0);
+
+        BEAST_EXPECT(hook::currentHookContext == nullptr);
+    }
+
+public:
+    void
+    run() override
+    {
+        testSharedImportModule();
+    }
+};
+
+/** Measures the fixed per-invocation cost of preparing a VM for a hook.
+
+    "per-execution" reproduces the original behaviour of building and linking
+    a fresh Hook API import module for every hook invocation, "shared" links
+    the process-wide module used by HookExecutor.
+*/
+class HookExecutorTiming_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+    using VM = hook::HookExecutor::WasmEdgeVM;
+
+    template <class F>
+    std::chrono::nanoseconds
+    measure(std::size_t iterations, F&& f)
+    {
+        auto const start = clock_type::now();
+        for (std::size_t i = 0; i < iterations; ++i)
+            f();
+        return (clock_type::now() - start) / iterations;
+    }
+
+public:
+    void
+    run() override
+    {
+        testcase("Setup");
+
+        std::size_t const iterations =
+            arg().empty() ? 10000 : std::stoul(arg());
+
+        auto const perExecution = measure(iterations, [&]() {
+            auto importObj = hook::HookExecutor::createImportModule();
+            {
+                VM vm;
+                BEAST_EXPECT(WasmEdge_ResultOK(
+                    WasmEdge_VMRegisterModuleFromImport(vm.ctx, importObj)));
+            }
+            WasmEdge_ModuleInstanceDelete(importObj);
+        });
+
+        auto const shared = measure(iterations, [&]() {
+            VM vm;
+            BEAST_EXPECT(
+                WasmEdge_ResultOK(WasmEdge_VMRegisterModuleFromImport(
+                    vm.ctx, hook::HookExecutor::importModule())));
+        });
+
+        log << iterations << " iterations" << std::endl;
+        log << "per-execution import module: " << perExecution.count()
+            << " ns/invocation" << std::endl;
+        log << "shared import module:        " << shared.count()
+            << " ns/invocation" << std::endl;
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(HookExecutor, app, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(HookExecutorTiming, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
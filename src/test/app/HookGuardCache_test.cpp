@@ -0,0 +1,112 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/HookGuardCache.h>
+#include <ripple/beast/unit_test.h>
+
+namespace ripple {
+namespace test {
+
+class HookGuardCache_test : public beast::unit_test::suite
+{
+    using Result = hook::HookGuardCache::Result;
+
+    void
+    testFetch()
+    {
+        testcase("fetch");
+
+        hook::HookGuardCache cache(4);
+        uint256 const valid{1};
+        uint256 const invalid{2};
+
+        BEAST_EXPECT(!cache.fetch(valid, 0));
+
+        cache.insert(valid, 0, Result{{10, 20}});
+        cache.insert(invalid, 0, Result{});
+        BEAST_EXPECT(cache.size() == 2);
+
+        auto const v = cache.fetch(valid, 0);
+        BEAST_EXPECT(v && *v && (*v)->first == 10 && (*v)->second == 20);
+
+        // failures are remembered too
+        auto const i = cache.fetch(invalid, 0);
+        BEAST_EXPECT(i && !*i);
+
+        // results from other guard rules don't apply
+        BEAST_EXPECT(!cache.fetch(valid, 1));
+        cache.insert(valid, 1, Result{});
+        BEAST_EXPECT(cache.size() == 2);
+        BEAST_EXPECT(!cache.fetch(valid, 0));
+        auto const r = cache.fetch(valid, 1);
+        BEAST_EXPECT(r && !*r);
+
+        auto const json = cache.getJson();
+        BEAST_EXPECT(json["entries"].asUInt() == 2);
+        BEAST_EXPECT(json["capacity"].asUInt() == 4);
+        BEAST_EXPECT(json["hits"].asString() == "3");
+        BEAST_EXPECT(json["misses"].asString() == "3");
+
+        cache.clear();
+        BEAST_EXPECT(cache.size() == 0);
+        BEAST_EXPECT(!cache.fetch(invalid, 0));
+    }
+
+    void
+    testEviction()
+    {
+        testcase("eviction");
+
+        hook::HookGuardCache cache(2);
+        cache.insert(uint256{1}, 0, Result{{1, 1}});
+        cache.insert(uint256{2}, 0, Result{{2, 2}});
+
+        // touching 1 makes 2 the least recently used
+        BEAST_EXPECT(cache.fetch(uint256{1}, 0));
+        cache.insert(uint256{3}, 0, Result{{3, 3}});
+        BEAST_EXPECT(cache.size() == 2);
+        BEAST_EXPECT(cache.fetch(uint256{1}, 0));
+        BEAST_EXPECT(!cache.fetch(uint256{2}, 0));
+        BEAST_EXPECT(cache.fetch(uint256{3}, 0));
+
+        cache.setCapacity(1);
+        BEAST_EXPECT(cache.size() == 1);
+        BEAST_EXPECT(cache.fetch(uint256{3}, 0));
+
+        // nothing is kept when disabled
+        cache.setCapacity(0);
+        BEAST_EXPECT(cache.size() == 0);
+        cache.insert(uint256{4}, 0, Result{{4, 4}});
+        BEAST_EXPECT(cache.size() == 0);
+        BEAST_EXPECT(!cache.fetch(uint256{4}, 0));
+    }
+
+public:
+    void
+    run() override
+    {
+        testFetch();
+        testEviction();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(HookGuardCache, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
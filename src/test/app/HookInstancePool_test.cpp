@@ -0,0 +1,293 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/HookInstancePool.h>
+#include <ripple/basics/scope.h>
+#include <ripple/beast/unit_test.h>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class HookInstancePool_test : public beast::unit_test::suite
+{
+    // (module (func (export "hook") (param i32) (result i64) i64.const 0))
+    std::vector<uint8_t> const stateless_ = {
+        0x00U, 0x61U, 0x73U, 0x6DU, 0x01U, 0x00U, 0x00U, 0x00U, 0x01U, 0x06U,
+        0x01U, 0x60U, 0x01U, 0x7FU, 0x01U, 0x7EU, 0x03U, 0x02U, 0x01U, 0x00U,
+        0x07U, 0x08U, 0x01U, 0x04U, 0x68U, 0x6FU, 0x6FU, 0x6BU, 0x00U, 0x00U,
+        0x0AU, 0x06U, 0x01U, 0x04U, 0x00U, 0x42U, 0x00U, 0x0BU};
+
+    // (module
+    //   (memory 1 1)
+    //   (global $g (mut i32) (i32.const 0))
+    //   (data (i32.const 0) "\05")
+    //   (func (export "hook") (param i32) (result i64)
+    //     ;; $g += 1, mem[0] += 1, return $g + mem[0]
+    //     ...))
+    //
+    // A fresh instance always returns 7.
+    std::vector<uint8_t> const stateful_ = {
+        0x00U, 0x61U, 0x73U, 0x6DU, 0x01U, 0x00U, 0x00U, 0x00U, 0x01U, 0x06U,
+        0x01U, 0x60U, 0x01U, 0x7FU, 0x01U, 0x7EU, 0x03U, 0x02U, 0x01U, 0x00U,
+        0x05U, 0x04U, 0x01U, 0x01U, 0x01U, 0x01U, 0x06U, 0x06U, 0x01U, 0x7FU,
+        0x01U, 0x41U, 0x00U, 0x0BU, 0x07U, 0x08U, 0x01U, 0x04U, 0x68U, 0x6FU,
+        0x6FU, 0x6BU, 0x00U, 0x00U, 0x0AU, 0x21U, 0x01U, 0x1FU, 0x00U, 0x23U,
+        0x00U, 0x41U, 0x01U, 0x6AU, 0x24U, 0x00U, 0x41U, 0x00U, 0x41U, 0x00U,
+        0x28U, 0x02U, 0x00U, 0x41U, 0x01U, 0x6AU, 0x36U, 0x02U, 0x00U, 0x23U,
+        0x00U, 0x41U, 0x00U, 0x28U, 0x02U, 0x00U, 0x6AU, 0xADU, 0x0BU, 0x0BU,
+        0x07U, 0x01U, 0x00U, 0x41U, 0x00U, 0x0BU, 0x01U, 0x05U};
+
+    static Slice
+    slice(std::vector<uint8_t> const& v)
+    {
+        return Slice(v.data(), v.size());
+    }
+
+    void
+    testRewrite()
+    {
+        testcase("rewrite");
+
+        using hook::ResettableModule;
+
+        // nothing to export, the module is unchanged
+        auto layout = ResettableModule::rewrite(slice(stateless_));
+        BEAST_EXPECT(layout);
+        BEAST_EXPECT(layout && layout->wasm == stateless_);
+        BEAST_EXPECT(layout && layout->globals.empty());
+        BEAST_EXPECT(layout && !layout->memory);
+
+        layout = ResettableModule::rewrite(slice(stateful_));
+        if (!BEAST_EXPECT(layout))
+            return;
+        BEAST_EXPECT(layout->wasm.size() > stateful_.size());
+        BEAST_EXPECT(
+            layout->globals ==
+            std::vector<std::string>{
+                std::string(ResettableModule::globalPrefix) + "0"});
+        BEAST_EXPECT(layout->memory == ResettableModule::memoryName);
+
+        // exports which already exist are used as they are
+        auto const again = ResettableModule::rewrite(
+            Slice(layout->wasm.data(), layout->wasm.size()));
+        BEAST_EXPECT(again);
+        BEAST_EXPECT(again && again->wasm == layout->wasm);
+        BEAST_EXPECT(again && again->globals == layout->globals);
+        BEAST_EXPECT(again && again->memory == layout->memory);
+
+        // tables can't be restored
+        std::vector<uint8_t> table(stateless_.begin(), stateless_.begin() + 8);
+        table.insert(table.end(), {0x04U, 0x04U, 0x01U, 0x70U, 0x00U, 0x01U});
+        BEAST_EXPECT(!ResettableModule::rewrite(slice(table)));
+
+        // and malformed modules are rejected
+        std::vector<uint8_t> bad = stateful_;
+        bad.resize(bad.size() - 3);
+        BEAST_EXPECT(!ResettableModule::rewrite(slice(bad)));
+        BEAST_EXPECT(!ResettableModule::rewrite(Slice{}));
+    }
+
+    void
+    testReuse()
+    {
+        testcase("reuse");
+
+        auto& pool = hook::HookInstancePool::instance();
+        auto const previousSize = pool.size();
+        pool.clear();
+
+        std::string error;
+        auto const module =
+            hook::HookModuleCache::compile(slice(stateful_), error);
+        if (!BEAST_EXPECT(module))
+            return;
+
+        uint256 const hookHash{1};
+        WasmEdge_String const name = WasmEdge_StringCreateByCString("hook");
+        scope_exit deleteName{[&name]() { WasmEdge_StringDelete(name); }};
+        WasmEdge_Value params[1] = {WasmEdge_ValueGenI32(0)};
+        WasmEdge_Value returns[1];
+
+        // disabled
+        pool.setSize(0);
+        BEAST_EXPECT(!pool.acquire(hookHash, module, slice(stateful_)));
+
+        pool.setSize(4);
+        std::uint64_t firstCount = 0;
+        for (int i = 0; i < 3; ++i)
+        {
+            auto instance = pool.acquire(hookHash, module, slice(stateful_));
+            if (!BEAST_EXPECT(instance))
+                break;
+
+            std::uint64_t instructions = 0;
+            auto const res =
+                instance->execute(name, params, 1, returns, 1, instructions);
+            BEAST_EXPECT(WasmEdge_ResultOK(res));
+
+            // every execution sees the state of a fresh instance
+            BEAST_EXPECT(WasmEdge_ValueGetI64(returns[0]) == 7);
+            if (i == 0)
+                firstCount = instructions;
+            BEAST_EXPECT(instructions == firstCount && instructions > 0);
+
+            pool.release(hookHash, std::move(instance));
+            BEAST_EXPECT(pool.pooled() == 1);
+        }
+
+        // modules which can't be reset aren't pooled
+        std::vector<uint8_t> table(stateless_.begin(), stateless_.begin() + 8);
+        table.insert(table.end(), {0x04U, 0x04U, 0x01U, 0x70U, 0x00U, 0x01U});
+        auto const tableModule =
+            hook::HookModuleCache::compile(slice(table), error);
+        BEAST_EXPECT(tableModule);
+        BEAST_EXPECT(!pool.acquire(uint256{2}, tableModule, slice(table)));
+
+        // the pool is bounded
+        pool.setSize(1);
+        pool.release(
+            uint256{3}, pool.acquire(uint256{3}, module, slice(stateful_)));
+        BEAST_EXPECT(pool.pooled() == 1);
+
+        pool.clear();
+        BEAST_EXPECT(pool.pooled() == 0);
+        pool.setSize(previousSize);
+    }
+
+    void
+    testParity()
+    {
+        testcase("parity");
+
+        auto& pool = hook::HookInstancePool::instance();
+        auto const previousSize = pool.size();
+        pool.clear();
+        pool.setSize(4);
+
+        WasmEdge_String const name = WasmEdge_StringCreateByCString("hook");
+        scope_exit deleteName{[&name]() { WasmEdge_StringDelete(name); }};
+        WasmEdge_Value params[1] = {WasmEdge_ValueGenI32(0)};
+
+        std::uint32_t n = 0;
+        for (auto const* wasm : {&stateless_, &stateful_})
+        {
+            std::string error;
+
+            // a fresh VM run of an independently compiled module
+            auto const reference =
+                hook::HookModuleCache::compile(slice(*wasm), error);
+            if (!BEAST_EXPECT(reference))
+                continue;
+
+            WasmEdge_ConfigureContext* conf = WasmEdge_ConfigureCreate();
+            WasmEdge_ConfigureStatisticsSetInstructionCounting(conf, true);
+            WasmEdge_VMContext* vm = WasmEdge_VMCreate(conf, NULL);
+            WasmEdge_Value expected[1];
+            BEAST_EXPECT(WasmEdge_ResultOK(WasmEdge_VMRunWasmFromASTModule(
+                vm, reference->ast(), name, params, 1, expected, 1)));
+            auto const expectedCount = WasmEdge_StatisticsGetInstrCount(
+                WasmEdge_VMGetStatisticsContext(vm));
+            WasmEdge_VMDelete(vm);
+            WasmEdge_ConfigureDelete(conf);
+
+            auto const module =
+                hook::HookModuleCache::compile(slice(*wasm), error);
+            if (!BEAST_EXPECT(module))
+                continue;
+
+            uint256 const hookHash{100 + n++};
+
+            // the first execution instantiates, the later ones are reused
+            for (int i = 0; i < 3; ++i)
+            {
+                auto instance = pool.acquire(hookHash, module, slice(*wasm));
+                if (!BEAST_EXPECT(instance))
+                    break;
+
+                WasmEdge_Value returns[1];
+                std::uint64_t instructions = 0;
+                BEAST_EXPECT(WasmEdge_ResultOK(instance->execute(
+                    name, params, 1, returns, 1, instructions)));
+                BEAST_EXPECT(
+                    WasmEdge_ValueGetI64(returns[0]) ==
+                    WasmEdge_ValueGetI64(expected[0]));
+                BEAST_EXPECT(instructions == expectedCount);
+
+                pool.release(hookHash, std::move(instance));
+            }
+        }
+
+        pool.clear();
+        pool.setSize(previousSize);
+    }
+
+    void
+    testBudget()
+    {
+        testcase("budget");
+
+        auto& pool = hook::HookInstancePool::instance();
+        auto& cache = hook::HookModuleCache::instance();
+        auto const previousSize = pool.size();
+        pool.clear();
+        pool.setSize(4);
+
+        std::string error;
+        uint256 const hookHash{200};
+        auto const compiled =
+            hook::HookModuleCache::compile(slice(stateful_), error);
+        if (!BEAST_EXPECT(compiled))
+            return;
+        auto const module = cache.insert(hookHash, compiled);
+
+        auto const moduleSize = module->size();
+        auto const bytes = cache.bytes();
+
+        // the resettable module is charged to the cache once it is built
+        auto instance = pool.acquire(hookHash, module, slice(stateful_));
+        BEAST_EXPECT(instance);
+        BEAST_EXPECT(module->size() > moduleSize);
+        BEAST_EXPECT(cache.bytes() == bytes + module->size() - moduleSize);
+
+        // and only once
+        pool.release(hookHash, std::move(instance));
+        pool.clear();
+        BEAST_EXPECT(pool.acquire(hookHash, module, slice(stateful_)));
+        BEAST_EXPECT(cache.bytes() == bytes + module->size() - moduleSize);
+
+        pool.clear();
+        pool.setSize(previousSize);
+    }
+
+public:
+    void
+    run() override
+    {
+        testRewrite();
+        testReuse();
+        testParity();
+        testBudget();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(HookInstancePool, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,197 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/HookModuleCache.h>
+#include <ripple/basics/scope.h>
+#include <ripple/beast/unit_test.h>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class HookModuleCache_test : public beast::unit_test::suite
+{
+    // (module (func (export "hook") (param i32) (result i64) i64.const 0))
+    std::vector<uint8_t> const wasm_ = {
+        0x00U, 0x61U, 0x73U, 0x6DU, 0x01U, 0x00U, 0x00U, 0x00U, 0x01U, 0x06U,
+        0x01U, 0x60U, 0x01U, 0x7FU, 0x01U, 0x7EU, 0x03U, 0x02U, 0x01U, 0x00U,
+        0x07U, 0x08U, 0x01U, 0x04U, 0x68U, 0x6FU, 0x6FU, 0x6BU, 0x00U, 0x00U,
+        0x0AU, 0x06U, 0x01U, 0x04U, 0x00U, 0x42U, 0x00U, 0x0BU};
+
+    Slice
+    code() const
+    {
+        return Slice(wasm_.data(), wasm_.size());
+    }
+
+    void
+    testCompile()
+    {
+        testcase("compile");
+
+        std::string error;
+        auto module = hook::HookModuleCache::compile(code(), error);
+        BEAST_EXPECT(module);
+        BEAST_EXPECT(module && module->ast());
+        BEAST_EXPECT(error.empty());
+
+        std::vector<uint8_t> bad = wasm_;
+        bad.resize(bad.size() - 3);
+        module = hook::HookModuleCache::compile(
+            Slice(bad.data(), bad.size()), error);
+        BEAST_EXPECT(!module);
+        BEAST_EXPECT(!error.empty());
+    }
+
+    void
+    testInstantiate()
+    {
+        testcase("instantiate");
+
+        WasmEdge_String const name = WasmEdge_StringCreateByCString("hook");
+        scope_exit deleteName{[&name]() { WasmEdge_StringDelete(name); }};
+        WasmEdge_Value params[1] = {WasmEdge_ValueGenI32(0)};
+
+        // reference run of the byte code by a VM
+        std::uint64_t expected = 0;
+        {
+            WasmEdge_ConfigureContext* conf = WasmEdge_ConfigureCreate();
+            scope_exit deleteConf{
+                [&conf]() { WasmEdge_ConfigureDelete(conf); }};
+            WasmEdge_ConfigureStatisticsSetInstructionCounting(conf, true);
+            WasmEdge_VMContext* vm = WasmEdge_VMCreate(conf, NULL);
+            scope_exit deleteVM{[&vm]() { WasmEdge_VMDelete(vm); }};
+            WasmEdge_Value returns[1];
+            BEAST_EXPECT(WasmEdge_ResultOK(WasmEdge_VMRunWasmFromBuffer(
+                vm, wasm_.data(), wasm_.size(), name, params, 1, returns, 1)));
+            BEAST_EXPECT(WasmEdge_ValueGetI64(returns[0]) == 0);
+            expected = WasmEdge_StatisticsGetInstrCount(
+                WasmEdge_VMGetStatisticsContext(vm));
+        }
+        BEAST_EXPECT(expected > 0);
+
+        std::string error;
+        auto const module = hook::HookModuleCache::compile(code(), error);
+        if (!BEAST_EXPECT(module))
+            return;
+
+        // the instance keeps a copy of its name
+        WasmEdge_String const env = WasmEdge_StringCreateByCString("env");
+        WasmEdge_ModuleInstanceContext* imports =
+            WasmEdge_ModuleInstanceCreate(env);
+        WasmEdge_StringDelete(env);
+        scope_exit deleteImports{
+            [&imports]() { WasmEdge_ModuleInstanceDelete(imports); }};
+
+        // every thread instantiates the one shared module
+        std::vector<std::thread> threads;
+        std::vector<int> ok(8, 0);
+        for (std::size_t t = 0; t < ok.size(); ++t)
+        {
+            threads.emplace_back([&, t]() {
+                for (int i = 0; i < 100; ++i)
+                {
+                    hook::HookModuleInstance instance;
+                    WasmEdge_Value returns[1];
+                    if (!instance.sane() ||
+                        !WasmEdge_ResultOK(
+                            instance.instantiate(module->ast(), imports)) ||
+                        !WasmEdge_ResultOK(
+                            instance.execute(name, params, 1, returns, 1)) ||
+                        WasmEdge_ValueGetI64(returns[0]) != 0 ||
+                        instance.instructionCount() != expected)
+                        return;
+                }
+                ok[t] = 1;
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        for (auto const o : ok)
+            BEAST_EXPECT(o);
+    }
+
+    void
+    testEviction()
+    {
+        testcase("eviction");
+
+        std::size_t const moduleSize =
+            wasm_.size() * hook::HookModuleCache::astOverheadFactor;
+
+        hook::HookModuleCache cache(moduleSize * 3);
+        std::string error;
+
+        for (int i = 1; i <= 3; ++i)
+            BEAST_EXPECT(cache.fetchOrCompile(uint256(i), code(), error));
+
+        BEAST_EXPECT(cache.size() == 3);
+        BEAST_EXPECT(cache.bytes() == moduleSize * 3);
+
+        // touch the oldest entry so the second becomes least recently used
+        auto const first = cache.fetch(uint256(1));
+        BEAST_EXPECT(first);
+
+        BEAST_EXPECT(cache.fetchOrCompile(uint256(4), code(), error));
+        BEAST_EXPECT(cache.size() == 3);
+        BEAST_EXPECT(cache.fetch(uint256(1)) == first);
+        BEAST_EXPECT(!cache.fetch(uint256(2)));
+        BEAST_EXPECT(cache.fetch(uint256(3)));
+        BEAST_EXPECT(cache.fetch(uint256(4)));
+
+        // shrinking the budget evicts immediately
+        cache.setBudget(moduleSize);
+        BEAST_EXPECT(cache.size() == 1);
+        BEAST_EXPECT(cache.fetch(uint256(4)));
+
+        // evicted modules remain usable by their holders
+        BEAST_EXPECT(first->ast());
+    }
+
+    void
+    testDisabled()
+    {
+        testcase("disabled");
+
+        hook::HookModuleCache cache(0);
+        std::string error;
+
+        BEAST_EXPECT(cache.fetchOrCompile(uint256(1), code(), error));
+        BEAST_EXPECT(cache.size() == 0);
+        BEAST_EXPECT(cache.bytes() == 0);
+        BEAST_EXPECT(!cache.fetch(uint256(1)));
+    }
+
+public:
+    void
+    run() override
+    {
+        testCompile();
+        testInstantiate();
+        testEviction();
+        testDisabled();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(HookModuleCache, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
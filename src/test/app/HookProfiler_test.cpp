@@ -0,0 +1,264 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/HookProfiler.h>
+#include <ripple/protocol/jss.h>
+#include <test/jtx.h>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+class HookProfiler_test : public beast::unit_test::suite
+{
+    using Profiler = hook::HookProfiler;
+
+    static std::size_t const testFunction;
+
+    static Profiler::FunctionStats
+    functionStats(Profiler::Snapshot const& snapshot)
+    {
+        return snapshot.functions.at(testFunction);
+    }
+
+    static void
+    call(std::uint64_t bytesIn, std::uint64_t bytesOut)
+    {
+        Profiler::Execution execution;
+        Profiler::Call profileCall(testFunction, execution, bytesIn);
+        execution.bytesWritten += bytesOut;
+    }
+
+    void
+    testCalls()
+    {
+        testcase("host calls");
+
+        auto& profiler = Profiler::instance();
+        profiler.clear();
+
+        // nothing is recorded while disabled
+        profiler.setEnabled(false);
+        call(10, 5);
+        BEAST_EXPECT(functionStats(profiler.snapshot()).calls == 0);
+
+        profiler.setEnabled(true);
+        {
+            Profiler::Execution execution;
+            {
+                Profiler::Call profileCall(testFunction, execution, 10);
+                execution.bytesWritten += 5;
+            }
+            {
+                Profiler::Call profileCall(testFunction, execution, 3);
+            }
+            BEAST_EXPECT(execution.hostCalls == 2);
+        }
+
+        auto const stats = functionStats(profiler.snapshot());
+        BEAST_EXPECT(stats.name == "profiler_test");
+        BEAST_EXPECT(stats.calls == 2);
+        BEAST_EXPECT(stats.bytesIn == 13);
+        BEAST_EXPECT(stats.bytesOut == 5);
+
+        profiler.clear();
+        BEAST_EXPECT(functionStats(profiler.snapshot()).calls == 0);
+        call(1, 1);
+        BEAST_EXPECT(functionStats(profiler.snapshot()).calls == 1);
+
+        profiler.setEnabled(false);
+    }
+
+    void
+    testReadLength()
+    {
+        testcase("read lengths");
+
+        BEAST_EXPECT(Profiler::isReadLength("read_len"));
+        BEAST_EXPECT(Profiler::isReadLength("kread_len"));
+        BEAST_EXPECT(!Profiler::isReadLength("read_ptr"));
+        BEAST_EXPECT(!Profiler::isReadLength("write_len"));
+    }
+
+    void
+    testHooks()
+    {
+        testcase("hooks");
+
+        using namespace std::chrono_literals;
+
+        auto& profiler = Profiler::instance();
+        profiler.clear();
+
+        uint256 const hookHash{1};
+        profiler.recordHook(hookHash, 2ms, 100, 3);
+        profiler.recordHook(hookHash, 1ms, 50, 1);
+        profiler.recordHook(uint256{2}, 1ms, 1, 0);
+
+        auto snapshot = profiler.snapshot();
+        BEAST_EXPECT(snapshot.hooks.size() == 2);
+
+        auto const& stats = snapshot.hooks[hookHash];
+        BEAST_EXPECT(stats.executions == 2);
+        BEAST_EXPECT(stats.nanoseconds == 3'000'000);
+        BEAST_EXPECT(stats.instructions == 150);
+        BEAST_EXPECT(stats.hostCalls == 4);
+
+        // hooks which have not run since clear() are not reported
+        profiler.clear();
+        profiler.recordHook(hookHash, 1ms, 1, 1);
+        snapshot = profiler.snapshot();
+        BEAST_EXPECT(snapshot.hooks.size() == 1);
+        BEAST_EXPECT(snapshot.hooks[hookHash].executions == 1);
+
+        auto const json = profiler.getJson();
+        BEAST_EXPECT(json["hooks"][to_string(hookHash)]["time_us"] == "1000");
+
+        profiler.clear();
+    }
+
+    void
+    testHookBound()
+    {
+        testcase("hook bound");
+
+        using namespace std::chrono_literals;
+
+        auto& profiler = Profiler::instance();
+        profiler.clear();
+
+        // hooks beyond the bound are counted, but not individually
+        std::size_t const extra = 10;
+        for (std::size_t i = 0; i < Profiler::maxHooks + extra; ++i)
+            profiler.recordHook(uint256{i + 1}, 1ms, 2, 1);
+
+        auto snapshot = profiler.snapshot();
+        BEAST_EXPECT(snapshot.hooks.size() == Profiler::maxHooks);
+        BEAST_EXPECT(snapshot.otherHooks.executions == extra);
+        BEAST_EXPECT(snapshot.otherHooks.instructions == 2 * extra);
+        BEAST_EXPECT(
+            profiler.getJson()["other_hooks"]["executions"] ==
+            std::to_string(extra));
+
+        // already tracked hooks are still counted individually
+        profiler.recordHook(uint256{1}, 1ms, 2, 1);
+        BEAST_EXPECT(profiler.snapshot().hooks[uint256{1}].executions == 2);
+
+        // and clearing frees room for new ones
+        uint256 const untracked{Profiler::maxHooks + extra};
+        BEAST_EXPECT(!snapshot.hooks.count(untracked));
+        profiler.clear();
+        profiler.recordHook(untracked, 1ms, 2, 1);
+        snapshot = profiler.snapshot();
+        BEAST_EXPECT(snapshot.hooks.size() == 1);
+        BEAST_EXPECT(snapshot.hooks[untracked].executions == 1);
+        BEAST_EXPECT(snapshot.otherHooks.executions == 0);
+
+        profiler.clear();
+    }
+
+    void
+    testThreads()
+    {
+        testcase("threads");
+
+        auto& profiler = Profiler::instance();
+        profiler.clear();
+        profiler.setEnabled(true);
+
+        int const threads = 4;
+        int const calls = 1000;
+
+        // counters of exited threads are retained
+        std::vector<std::thread> workers;
+        for (int i = 0; i < threads; ++i)
+            workers.emplace_back([&]() {
+                for (int j = 0; j < calls; ++j)
+                    call(1, 2);
+                Profiler::instance().recordHook(uint256{3}, {}, 1, calls);
+            });
+        for (auto& worker : workers)
+            worker.join();
+
+        // and added to the counters of live ones
+        call(1, 2);
+
+        auto snapshot = profiler.snapshot();
+        auto const stats = functionStats(snapshot);
+        BEAST_EXPECT(stats.calls == threads * calls + 1);
+        BEAST_EXPECT(stats.bytesIn == threads * calls + 1);
+        BEAST_EXPECT(stats.bytesOut == 2 * (threads * calls + 1));
+        BEAST_EXPECT(snapshot.hooks[uint256{3}].executions == threads);
+
+        profiler.setEnabled(false);
+        profiler.clear();
+    }
+
+    void
+    testRPC()
+    {
+        testcase("hook_profile");
+
+        using namespace jtx;
+        Env env{*this};
+
+        auto result = env.rpc("hook_profile", "on")[jss::result];
+        BEAST_EXPECT(result[jss::status] == "success");
+        BEAST_EXPECT(result["enabled"] == true);
+        BEAST_EXPECT(Profiler::instance().enabled());
+        BEAST_EXPECT(result["host_functions"].isObject());
+        BEAST_EXPECT(result["hooks"].isObject());
+
+        call(1, 1);
+        result = env.rpc("hook_profile")[jss::result];
+        BEAST_EXPECT(
+            result["host_functions"]["profiler_test"]["calls"] == "1");
+
+        result = env.rpc("hook_profile", "clear")[jss::result];
+        BEAST_EXPECT(!result["host_functions"].isMember("profiler_test"));
+
+        result = env.rpc("hook_profile", "off")[jss::result];
+        BEAST_EXPECT(result["enabled"] == false);
+        BEAST_EXPECT(!Profiler::instance().enabled());
+
+        result = env.rpc("hook_profile", "bogus")[jss::result];
+        BEAST_EXPECT(result[jss::error] == "invalidParams");
+    }
+
+public:
+    void
+    run() override
+    {
+        testCalls();
+        testReadLength();
+        testHooks();
+        testHookBound();
+        testThreads();
+        testRPC();
+    }
+};
+
+std::size_t const HookProfiler_test::testFunction =
+    hook::HookProfiler::registerFunction("profiler_test");
+
+BEAST_DEFINE_TESTSUITE(HookProfiler, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
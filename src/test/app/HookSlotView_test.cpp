@@ -0,0 +1,133 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/HookSlotView.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/STAmount.h>
+#include <ripple/protocol/STArray.h>
+#include <ripple/protocol/UintTypes.h>
+
+namespace ripple {
+namespace test {
+
+class HookSlotView_test : public beast::unit_test::suite
+{
+    static std::shared_ptr<STObject const>
+    makeObject()
+    {
+        auto obj = std::make_shared<STObject>(sfGeneric);
+        // set out of field code order, serialization sorts them
+        obj->setFieldVL(sfMemoData, Blob{1, 2, 3});
+        obj->setFieldU32(sfFlags, 0x80000000);
+        obj->setAccountID(sfAccount, AccountID{7});
+        obj->setFieldAmount(sfAmount, STAmount{XRPAmount{1000}});
+        obj->setFieldH256(sfInvoiceID, uint256{3});
+
+        STArray memos{sfMemos};
+        for (std::uint8_t i = 0; i < 3; ++i)
+        {
+            STObject memo{sfMemo};
+            memo.setFieldVL(sfMemoType, Blob{i});
+            memo.setFieldVL(sfMemoData, Blob(300, i));
+            memos.push_back(std::move(memo));
+        }
+        obj->setFieldArray(sfMemos, memos);
+
+        STObject inner{sfTemplateEntry};
+        inner.setFieldU16(sfTransactionType, 3);
+        obj->emplace_back(std::move(inner));
+
+        return obj;
+    }
+
+    // check every field within `field` serializes as add() does
+    void
+    expectSame(hook::SlotView& view, STBase const& field)
+    {
+        Serializer s;
+        field.add(s);
+
+        auto const bytes = view.serialized(&field);
+        BEAST_EXPECT(bytes && *bytes == s.slice());
+
+        if (auto const* obj = dynamic_cast<STObject const*>(&field))
+        {
+            for (STBase const& f : *obj)
+                if (f.getSType() != STI_NOTPRESENT)
+                    expectSame(view, f);
+        }
+        else if (auto const* arr = dynamic_cast<STArray const*>(&field))
+        {
+            for (STObject const& o : *arr)
+                expectSame(view, o);
+        }
+    }
+
+    void
+    testSerialized()
+    {
+        testcase("serialized");
+
+        auto const obj = makeObject();
+        hook::SlotView view{obj};
+        expectSame(view, *obj);
+
+        // the root is the whole object
+        Serializer s;
+        obj->add(s);
+        BEAST_EXPECT(view.serialized(obj.get())->size() == s.size());
+
+        // something outside of the object is serialized by itself
+        STAmount const other{XRPAmount{5}};
+        Serializer os;
+        other.add(os);
+        auto const otherBytes = view.serialized(&other);
+        BEAST_EXPECT(otherBytes && *otherBytes == os.slice());
+        expectSame(view, *obj);
+
+        BEAST_EXPECT(!view.serialized(nullptr));
+    }
+
+    void
+    testEmpty()
+    {
+        testcase("empty");
+
+        hook::SlotView view{nullptr};
+        BEAST_EXPECT(!view.serialized(nullptr));
+
+        auto const obj = std::make_shared<STObject const>(sfGeneric);
+        hook::SlotView emptyView{obj};
+        auto const bytes = emptyView.serialized(obj.get());
+        BEAST_EXPECT(bytes && bytes->empty());
+    }
+
+public:
+    void
+    run() override
+    {
+        testSerialized();
+        testEmpty();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(HookSlotView, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
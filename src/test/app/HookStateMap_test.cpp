@@ -0,0 +1,400 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/HookStateMap.h>
+#include <ripple/basics/Blob.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <chrono>
+#include <map>
+#include <tuple>
+
+namespace ripple {
+namespace test {
+
+namespace {
+
+// The nested map HookStateMap replaced, kept as a reference for ordering and
+// as the baseline for the timing suite.
+using LegacyStateMap = std::map<
+    AccountID,
+    std::tuple<
+        int64_t,
+        int64_t,
+        std::map<uint256, std::map<uint256, std::pair<bool, Blob>>>>>;
+
+struct Workload
+{
+    std::vector<AccountID> accounts;
+    std::vector<uint256> namespaces;
+    std::vector<uint256> keys;
+    Blob value;
+
+    // Hooks mostly use short keys, which make_state_key left pads with zeros
+    Workload(
+        std::size_t nKeys,
+        std::size_t valueSize,
+        std::uint64_t seed,
+        bool shortKeys = false)
+        : value(valueSize, 0xAB)
+    {
+        beast::xor_shift_engine rng(seed);
+        auto random256 = [&]() {
+            uint256 ret;
+            for (auto& b : ret)
+                b = static_cast<std::uint8_t>(rng());
+            return ret;
+        };
+
+        for (int i = 0; i < 3; ++i)
+        {
+            AccountID acc;
+            for (auto& b : acc)
+                b = static_cast<std::uint8_t>(rng());
+            accounts.push_back(acc);
+            namespaces.push_back(random256());
+        }
+
+        for (std::size_t i = 0; i < nKeys; ++i)
+        {
+            if (!shortKeys)
+            {
+                keys.push_back(random256());
+                continue;
+            }
+
+            uint256 key;
+            std::uint64_t const k = rng();
+            for (int b = 0; b < 8; ++b)
+                key.data()[31 - b] = static_cast<std::uint8_t>(k >> (8 * b));
+            keys.push_back(key);
+        }
+    }
+};
+
+}  // namespace
+
+class HookStateMap_test : public beast::unit_test::suite
+{
+    void
+    testValues()
+    {
+        testcase("values");
+
+        hook::HookStateMap map;
+        AccountID const acc{1};
+        uint256 const ns{2};
+        uint256 const key{3};
+
+        BEAST_EXPECT(!map.findAccount(acc));
+        BEAST_EXPECT(!map.hasNamespace(acc, ns));
+        BEAST_EXPECT(!map.find(acc, ns, key));
+
+        map.insertAccount(acc, 10, 1);
+        BEAST_EXPECT(map.findAccount(acc));
+        BEAST_EXPECT(map.findAccount(acc)->availableForReserves == 10);
+
+        Blob small(8, 0x11);
+        map.insert(acc, ns, key, makeSlice(small), false);
+        BEAST_EXPECT(map.hasNamespace(acc, ns));
+        BEAST_EXPECT(!map.hasNamespace(acc, uint256{4}));
+
+        auto* entry = map.find(acc, ns, key);
+        BEAST_EXPECT(entry && !entry->modified);
+        BEAST_EXPECT(entry && entry->value() == makeSlice(small));
+
+        // grow beyond the inline buffer, then shrink back into the
+        // (now external) storage
+        Blob large(hook::HookStateMap::inlineValueSize * 4, 0x22);
+        map.assign(*entry, makeSlice(large));
+        BEAST_EXPECT(map.find(acc, ns, key)->value() == makeSlice(large));
+
+        map.assign(*entry, makeSlice(small));
+        BEAST_EXPECT(map.find(acc, ns, key)->value() == makeSlice(small));
+
+        // deletions are cached as empty values
+        map.assign(*entry, Slice{});
+        BEAST_EXPECT(map.find(acc, ns, key)->value().empty());
+        BEAST_EXPECT(map.size() == 1);
+    }
+
+    void
+    testOrdering()
+    {
+        testcase("ordering");
+
+        Workload const w(2000, 40, 42);
+
+        hook::HookStateMap map;
+        LegacyStateMap legacy;
+
+        std::size_t i = 0;
+        for (auto const& key : w.keys)
+        {
+            auto const& acc = w.accounts[i % w.accounts.size()];
+            auto const& ns = w.namespaces[(i / 7) % w.namespaces.size()];
+            bool const modified = (i % 3) != 0;
+            ++i;
+
+            map.insert(acc, ns, key, makeSlice(w.value), modified);
+            std::get<2>(legacy[acc])[ns][key] = {modified, w.value};
+        }
+
+        auto const modified = map.modified();
+        auto it = modified.begin();
+        bool same = true;
+        for (auto const& [acc, accEntry] : legacy)
+            for (auto const& [ns, nsEntry] : std::get<2>(accEntry))
+                for (auto const& [key, value] : nsEntry)
+                {
+                    if (!value.first)
+                        continue;
+                    if (it == modified.end() || (*it)->account() != acc ||
+                        (*it)->ns() != ns || (*it)->key() != key)
+                        same = false;
+                    else
+                        ++it;
+                }
+
+        BEAST_EXPECT(same);
+        BEAST_EXPECT(it == modified.end());
+        BEAST_EXPECT(map.size() == w.keys.size());
+    }
+
+public:
+    void
+    run() override
+    {
+        testValues();
+        testOrdering();
+    }
+};
+
+/** Compares HookStateMap with the nested std::map it replaced.
+
+    Both maps are driven the way set_state_cache and lookup_state_cache use
+    them (minus the ledger reads) for a state-heavy hook: each key is read
+    (state), cached from the "ledger" on a miss and then written (state_set),
+    this is repeated for a number of rounds and finally the modified entries
+    are walked in commit order. Pass the number of keys as the suite
+    argument, the default is 256 (max_state_modifications).
+*/
+class HookStateMapTiming_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    static constexpr int rounds = 4;
+
+    template <class F>
+    std::chrono::microseconds
+    measure(int iterations, F&& f)
+    {
+        auto const start = clock_type::now();
+        for (int i = 0; i < iterations; ++i)
+            f();
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   clock_type::now() - start) /
+            iterations;
+    }
+
+    static std::pair<bool, Blob> const*
+    legacyLookup(
+        LegacyStateMap& stateMap,
+        AccountID const& acc,
+        uint256 const& ns,
+        uint256 const& key)
+    {
+        if (stateMap.find(acc) == stateMap.end())
+            return nullptr;
+
+        auto& stateMapAcc = std::get<2>(stateMap[acc]);
+        if (stateMapAcc.find(ns) == stateMapAcc.end())
+            return nullptr;
+
+        auto& stateMapNs = stateMapAcc[ns];
+        auto const& ret = stateMapNs.find(key);
+        if (ret == stateMapNs.end())
+            return nullptr;
+
+        return &ret->second;
+    }
+
+    static void
+    legacySet(
+        LegacyStateMap& stateMap,
+        AccountID const& acc,
+        uint256 const& ns,
+        uint256 const& key,
+        Blob& data,
+        bool modified)
+    {
+        if (stateMap.find(acc) == stateMap.end())
+        {
+            stateMap[acc] = {1000, 1, {{ns, {{key, {modified, data}}}}}};
+            return;
+        }
+
+        auto& availableForReserves = std::get<0>(stateMap[acc]);
+        auto& stateMapAcc = std::get<2>(stateMap[acc]);
+        if (stateMapAcc.find(ns) == stateMapAcc.end())
+        {
+            if (modified)
+                availableForReserves--;
+            stateMapAcc[ns] = {{key, {modified, data}}};
+            return;
+        }
+
+        auto& stateMapNs = stateMapAcc[ns];
+        if (stateMapNs.find(key) == stateMapNs.end())
+        {
+            if (modified)
+                availableForReserves--;
+            stateMapNs[key] = {modified, data};
+            return;
+        }
+
+        if (modified)
+            stateMapNs[key].first = true;
+        stateMapNs[key].second = data;
+    }
+
+    static std::size_t
+    runLegacy(Workload const& w)
+    {
+        LegacyStateMap map;
+        auto const& acc = w.accounts[0];
+        auto const& ns = w.namespaces[0];
+
+        std::size_t found = 0;
+        for (int r = 0; r < rounds; ++r)
+            for (auto const& key : w.keys)
+            {
+                if (auto const entry = legacyLookup(map, acc, ns, key))
+                    found += entry->second.size();
+                else
+                {
+                    Blob b = w.value;
+                    legacySet(map, acc, ns, key, b, false);
+                }
+
+                // state_set copies the value out of wasm memory
+                Blob data{w.value.begin(), w.value.end()};
+                legacySet(map, acc, ns, key, data, true);
+            }
+
+        for (auto const& accEntry : map)
+            for (auto const& nsEntry : std::get<2>(accEntry.second))
+                for (auto const& keyEntry : nsEntry.second)
+                    found += keyEntry.second.first;
+        return found;
+    }
+
+    static void
+    flatSet(
+        hook::HookStateMap& stateMap,
+        AccountID const& acc,
+        uint256 const& ns,
+        uint256 const& key,
+        Slice const& data,
+        bool modified)
+    {
+        auto* accountState = stateMap.findAccount(acc);
+        if (!accountState)
+        {
+            stateMap.insertAccount(acc, 1000, 1);
+            stateMap.insert(acc, ns, key, data, modified);
+            return;
+        }
+
+        if (!stateMap.hasNamespace(acc, ns))
+        {
+            if (modified)
+                accountState->availableForReserves--;
+            stateMap.insert(acc, ns, key, data, modified);
+            return;
+        }
+
+        auto* entry = stateMap.find(acc, ns, key);
+        if (!entry)
+        {
+            if (modified)
+                accountState->availableForReserves--;
+            stateMap.insert(acc, ns, key, data, modified);
+            return;
+        }
+
+        if (modified)
+            entry->modified = true;
+        stateMap.assign(*entry, data);
+    }
+
+    static std::size_t
+    runFlat(Workload const& w)
+    {
+        hook::HookStateMap map;
+        auto const& acc = w.accounts[0];
+        auto const& ns = w.namespaces[0];
+        auto const value = makeSlice(w.value);
+
+        std::size_t found = 0;
+        for (int r = 0; r < rounds; ++r)
+            for (auto const& key : w.keys)
+            {
+                if (auto const entry = map.find(acc, ns, key))
+                    found += entry->value().size();
+                else
+                    flatSet(map, acc, ns, key, value, false);
+
+                flatSet(map, acc, ns, key, value, true);
+            }
+
+        for (auto const* entry : map.modified())
+            found += entry->modified;
+        return found;
+    }
+
+public:
+    void
+    run() override
+    {
+        std::size_t const nKeys = arg().empty() ? 256 : std::stoul(arg());
+        int const iterations = 500;
+
+        for (std::size_t valueSize : {8, 32, 128, 256})
+        {
+            testcase("value size " + std::to_string(valueSize));
+
+            Workload const w(nKeys, valueSize, valueSize, true);
+            BEAST_EXPECT(runLegacy(w) == runFlat(w));
+
+            auto const legacy = measure(iterations, [&]() { runLegacy(w); });
+            auto const flat = measure(iterations, [&]() { runFlat(w); });
+
+            log << nKeys << " keys, " << valueSize << " byte values: "
+                << "std::map " << legacy.count() << "us, "
+                << "HookStateMap " << flat.count() << "us" << std::endl;
+        }
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(HookStateMap, app, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(HookStateMapTiming, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,116 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/HookStatePrefetch.h>
+#include <ripple/beast/unit_test.h>
+
+namespace ripple {
+namespace test {
+
+class HookStatePrefetch_test : public beast::unit_test::suite
+{
+    void
+    testRecord()
+    {
+        testcase("record");
+
+        hook::HookStatePrefetcher prefetcher;
+        AccountID const alice{1};
+        AccountID const bob{2};
+        uint256 const ns{3};
+
+        {
+            hook::HookStateMap map;
+            map.insert(alice, ns, uint256{10}, Slice{}, false);
+            map.insert(alice, ns, uint256{11}, Slice{}, true);
+            map.insert(bob, ns, uint256{12}, Slice{}, true);
+
+            // nothing is remembered while disabled
+            prefetcher.record(map);
+            BEAST_EXPECT(prefetcher.recent(alice, ns).empty());
+
+            prefetcher.setEnabled(true);
+            prefetcher.record(map);
+        }
+
+        // read and written keys are both remembered, per account
+        auto keys = prefetcher.recent(alice, ns);
+        BEAST_EXPECT(keys.size() == 2);
+        BEAST_EXPECT(keys == std::vector<uint256>({uint256{11}, uint256{10}}));
+        BEAST_EXPECT(prefetcher.recent(bob, ns).size() == 1);
+        BEAST_EXPECT(prefetcher.recent(alice, uint256{4}).empty());
+
+        // touching a key again moves it to the front
+        {
+            hook::HookStateMap map;
+            map.insert(alice, ns, uint256{10}, Slice{}, false);
+            prefetcher.record(map);
+        }
+        keys = prefetcher.recent(alice, ns);
+        BEAST_EXPECT(keys.size() == 2 && keys.front() == uint256{10});
+
+        // only the most recent keys are kept
+        {
+            hook::HookStateMap map;
+            for (int i = 0; i < 100; ++i)
+                map.insert(alice, ns, uint256(1000 + i), Slice{}, true);
+            prefetcher.record(map);
+        }
+        keys = prefetcher.recent(alice, ns);
+        BEAST_EXPECT(keys.size() == hook::HookStatePrefetcher::keysPerNamespace);
+
+        prefetcher.clear();
+        BEAST_EXPECT(prefetcher.recent(alice, ns).empty());
+    }
+
+    void
+    testEviction()
+    {
+        testcase("eviction");
+
+        hook::HookStatePrefetcher prefetcher;
+        prefetcher.setEnabled(true);
+
+        uint256 const ns{3};
+        for (std::size_t i = 0; i <= hook::HookStatePrefetcher::maxNamespaces;
+             ++i)
+        {
+            hook::HookStateMap map;
+            map.insert(AccountID(i + 1), ns, uint256{1}, Slice{}, true);
+            prefetcher.record(map);
+        }
+
+        // the least recently used namespace was dropped
+        BEAST_EXPECT(prefetcher.recent(AccountID(1), ns).empty());
+        BEAST_EXPECT(prefetcher.recent(AccountID(2), ns).size() == 1);
+    }
+
+public:
+    void
+    run() override
+    {
+        testRecord();
+        testEviction();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(HookStatePrefetch, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,374 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/BuildLedger.h>
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/misc/CanonicalTXSet.h>
+#include <ripple/protocol/jss.h>
+#include <test/app/SetHook_wasm.h>
+#include <test/jtx.h>
+#include <test/jtx/envconfig.h>
+#include <test/jtx/hook.h>
+
+#include <chrono>
+#include <functional>
+#include <random>
+#include <string_view>
+#include <thread>
+
+namespace ripple {
+namespace test {
+
+namespace {
+
+// The application's ParallelApply engine is made at start, so each
+// number of threads needs an Env of its own
+jtx::Env
+makeEnv(beast::unit_test::suite& suite, int threads)
+{
+    auto c = jtx::envconfig();
+    auto& sectionNode = c->section(ConfigSection::nodeDatabase());
+    sectionNode.set("type", "memory");
+    c->overwrite(SECTION_RELATIONAL_DB, "backend", "sqlite");
+    c->PARALLEL_APPLY_THREADS = threads;
+    return jtx::Env(suite, std::move(c));
+}
+
+// A hook SetHook_test compiled, found by a line of its source
+std::vector<uint8_t> const&
+testHook(std::string_view line)
+{
+    for (auto const& [source, code] : wasm)
+    {
+        if (source.find(line) != std::string::npos)
+            return code;
+    }
+    Throw<std::runtime_error>("no test hook " + std::string(line));
+}
+
+struct Built
+{
+    std::shared_ptr<Ledger> ledger;
+    std::set<TxID> left;
+    std::set<TxID> failed;
+};
+
+// Builds a ledger on the last closed one from a set of transactions
+Built
+build(jtx::Env& env, std::vector<std::shared_ptr<STTx const>> const& txs)
+{
+    auto const parent = env.app().getLedgerMaster().getClosedLedger();
+    auto const resolution = parent->info().closeTimeResolution;
+
+    CanonicalTXSet txns(parent->info().hash);
+    for (auto const& tx : txs)
+        txns.insert(tx);
+
+    Built b;
+    b.ledger = buildLedger(
+        parent,
+        parent->info().closeTime + resolution,
+        true,
+        resolution,
+        env.app(),
+        txns,
+        b.failed,
+        env.journal);
+
+    for (auto const& tx : txns)
+        b.left.insert(tx.first.getTXID());
+
+    return b;
+}
+
+}  // namespace
+
+class ParallelApply_test : public beast::unit_test::suite
+{
+    using Txs = std::vector<std::shared_ptr<STTx const>>;
+
+    // Builds a ledger from the transactions make returns, serially and on
+    // several threads, each in an Env set up the same way
+    void
+    checkSameLedger(
+        std::function<Txs(jtx::Env&)> const& make,
+        std::function<void(Built const&)> const& check)
+    {
+        auto serialEnv = makeEnv(*this, 0);
+        auto const serial = build(serialEnv, make(serialEnv));
+        check(serial);
+
+        for (int threads : {2, 4, 8})
+        {
+            auto env = makeEnv(*this, threads);
+            BEAST_EXPECT(env.app().getParallelApply());
+            auto const parallel = build(env, make(env));
+            BEAST_EXPECT(
+                parallel.ledger->info().parentHash ==
+                serial.ledger->info().parentHash);
+            BEAST_EXPECT(
+                parallel.ledger->info().hash == serial.ledger->info().hash);
+            BEAST_EXPECT(parallel.left == serial.left);
+            BEAST_EXPECT(parallel.failed == serial.failed);
+        }
+    }
+
+    void
+    testSameLedger()
+    {
+        testcase("Same ledger");
+
+        using namespace jtx;
+
+        TxID past;
+        TxID gap;
+        auto make = [&](Env& env) {
+            auto const gw = Account("gw");
+            auto const alice = Account("alice");
+            auto const bob = Account("bob");
+            auto const carol = Account("carol");
+            auto const dan = Account("dan");
+            auto const USD = gw["USD"];
+
+            std::vector<Account> payers;
+            for (int i = 0; i < 8; ++i)
+                payers.emplace_back("payer" + std::to_string(i));
+
+            env.fund(XRP(100000), gw, alice, bob, carol, dan);
+            for (auto const& payer : payers)
+                env.fund(XRP(100000), payer);
+            env.close();
+            env(trust(alice, USD(1000)));
+            env(trust(bob, USD(1000)));
+            env.close();
+            env(pay(gw, alice, USD(500)));
+            env.close();
+
+            Txs txs;
+            auto add = [&](JTx const& jt) { txs.push_back(jt.stx); };
+
+            // Independent payments, then payments to a shared destination
+            for (std::size_t i = 0; i < payers.size(); ++i)
+            {
+                auto const& payer = payers[i];
+                auto const s = env.seq(payer);
+                auto const to = Account("new" + std::to_string(i));
+                add(env.jt(pay(payer, to, XRP(1000)), seq(s), fee(10)));
+                add(env.jt(
+                    pay(payer, carol, XRP(10)), seq(s + 1), fee(10)));
+            }
+
+            // A chain of transactions from one account, ending in an offer
+            // which a second one crosses
+            auto const s = env.seq(alice);
+            for (int i = 0; i < 3; ++i)
+                add(env.jt(pay(alice, bob, XRP(5)), seq(s + i), fee(10)));
+            add(env.jt(
+                offer(alice, XRP(100), USD(100)), seq(s + 3), fee(10)));
+            add(env.jt(
+                offer(bob, USD(50), XRP(50)), seq(env.seq(bob)), fee(10)));
+
+            // Claims a fee without paying
+            add(env.jt(
+                pay(dan, bob, XRP(1000000)), seq(env.seq(dan)), fee(10)));
+
+            // Fails, with a sequence already used
+            auto const failing =
+                env.jt(pay(dan, bob, XRP(1)), seq(env.seq(dan) - 1), fee(10));
+            past = failing.stx->getTransactionID();
+            add(failing);
+
+            // Left over, with a sequence gap
+            auto const leftOver = env.jt(
+                pay(carol, bob, XRP(1)), seq(env.seq(carol) + 5), fee(10));
+            gap = leftOver.stx->getTransactionID();
+            add(leftOver);
+
+            return txs;
+        };
+
+        checkSameLedger(make, [&](Built const& serial) {
+            BEAST_EXPECT(serial.left == std::set<TxID>{gap});
+            BEAST_EXPECT(serial.failed == std::set<TxID>{past});
+        });
+    }
+
+    void
+    testHooks()
+    {
+        testcase("Hooks");
+
+        using namespace jtx;
+
+        auto const& emitHook =
+            testHook(R"(ASSERT(otxn_param(SBUF(bob), "bob", 3) == 20);)");
+        auto const& stateHook = testHook(
+            R"(ASSERT(state_set(SBUF("content2"), SBUF("key2")) == )"
+            R"(sizeof("content2"));)");
+
+        std::vector<TxID> invokes;
+        std::vector<TxID> payments;
+        auto make = [&](Env& env) {
+            auto const alice = Account("alice");
+            auto const bob = Account("bob");
+            auto const carol = Account("carol");
+
+            std::vector<Account> payers;
+            for (int i = 0; i < 8; ++i)
+                payers.emplace_back("payer" + std::to_string(i));
+
+            env.fund(XRP(100000), alice, bob, carol);
+            for (auto const& payer : payers)
+                env.fund(XRP(100000), payer);
+            env.close();
+
+            // alice emits a payment to bob when invoked, and carol sets
+            // hook state when paid
+            env(hook(alice, {{hso(emitHook)}}, 0), fee(XRP(100)));
+            env(hook(carol, {{hso(stateHook)}}, 0), fee(XRP(100)));
+            env.close();
+
+            Json::Value invoke;
+            invoke[jss::TransactionType] = "Invoke";
+            invoke[jss::Account] = alice.human();
+            Json::Value params{Json::arrayValue};
+            params[0U][jss::HookParameter][jss::HookParameterName] =
+                strHex(std::string("bob"));
+            params[0U][jss::HookParameter][jss::HookParameterValue] =
+                strHex(bob.id());
+            invoke[jss::HookParameters] = params;
+
+            Txs txs;
+            invokes.clear();
+            payments.clear();
+            auto const s = env.seq(alice);
+            for (int i = 0; i < 4; ++i)
+            {
+                auto const jt = env.jt(invoke, seq(s + i), fee(XRP(1)));
+                invokes.push_back(jt.stx->getTransactionID());
+                txs.push_back(jt.stx);
+            }
+            for (auto const& payer : payers)
+            {
+                auto const jt = env.jt(
+                    pay(payer, carol, XRP(10)),
+                    seq(env.seq(payer)),
+                    fee(XRP(1)));
+                payments.push_back(jt.stx->getTransactionID());
+                txs.push_back(jt.stx);
+                txs.push_back(
+                    env.jt(
+                           pay(payer, bob, XRP(10)),
+                           seq(env.seq(payer) + 1),
+                           fee(10))
+                        .stx);
+            }
+            return txs;
+        };
+
+        checkSameLedger(make, [&](Built const& serial) {
+            BEAST_EXPECT(serial.left.empty() && serial.failed.empty());
+
+            // The hooks ran, emitting and setting state
+            auto executed = [&](TxID const& id, SField const& field) {
+                auto const meta = serial.ledger->txRead(id).second;
+                return meta && meta->isFieldPresent(sfHookExecutions) &&
+                    meta->isFieldPresent(field);
+            };
+            for (auto const& id : invokes)
+                BEAST_EXPECT(executed(id, sfHookEmissions));
+            for (auto const& id : payments)
+                BEAST_EXPECT(executed(id, sfAffectedNodes));
+        });
+    }
+
+public:
+    void
+    run() override
+    {
+        testSameLedger();
+        testHooks();
+    }
+};
+
+class ParallelApply_bench_test : public beast::unit_test::suite
+{
+public:
+    void
+    run() override
+    {
+        using namespace jtx;
+        using namespace std::chrono;
+
+        auto const threads =
+            std::max<int>(std::thread::hardware_concurrency(), 4);
+        for (int t : {0, threads})
+        {
+            Env env = makeEnv(*this, t);
+
+            std::vector<Account> accounts;
+            std::vector<std::uint32_t> seqs;
+            for (int i = 0; i < 1000; ++i)
+            {
+                accounts.emplace_back("bench" + std::to_string(i));
+                env.fund(XRP(100000), accounts.back());
+                if (i % 100 == 99)
+                    env.close();
+            }
+            env.close();
+            for (auto const& account : accounts)
+                seqs.push_back(env.seq(account));
+
+            std::mt19937 rng(42);
+            std::vector<std::shared_ptr<STTx const>> txs;
+            for (std::size_t count : {1000, 5000, 10000})
+            {
+                while (txs.size() < count)
+                {
+                    auto const from = rng() % accounts.size();
+                    auto const to =
+                        (from + 1 + rng() % (accounts.size() - 1)) %
+                        accounts.size();
+                    auto const jt = env.jt(
+                        pay(accounts[from], accounts[to], XRP(1)),
+                        seq(seqs[from]++),
+                        fee(10));
+                    txs.push_back(jt.stx);
+                }
+
+                // Once to check the signatures, then timed
+                build(env, txs);
+                auto const start = steady_clock::now();
+                auto const built = build(env, txs);
+                auto const elapsed =
+                    duration_cast<milliseconds>(steady_clock::now() - start);
+                BEAST_EXPECT(built.left.empty() && built.failed.empty());
+                log << count << " payments, " << (t ? t : 1)
+                    << " threads: " << elapsed.count() << "ms" << std::endl;
+            }
+        }
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ParallelApply, app, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(ParallelApply_bench, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
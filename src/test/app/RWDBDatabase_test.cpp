@@ -0,0 +1,120 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/rdb/backend/SQLiteDatabase.h>
+#include <test/jtx.h>
+#include <atomic>
+#include <limits>
+#include <thread>
+#include <variant>
+
+namespace ripple {
+namespace test {
+
+class RWDBDatabase_test : public beast::unit_test::suite
+{
+    using AccountTx = RelationalDatabase::AccountTx;
+
+    // Read the transaction and account indexes while ledgers are saved. A
+    // transaction must never be found before the ledger holding it.
+    void
+    testConcurrentReads()
+    {
+        testcase("concurrent reads");
+
+        using namespace jtx;
+        Env env(*this);
+
+        auto* const db =
+            dynamic_cast<SQLiteDatabase*>(&env.app().getRelationalDatabase());
+        if (!BEAST_EXPECT(db))
+            return;
+
+        std::vector<Account> accounts;
+        for (int i = 0; i < 8; ++i)
+        {
+            accounts.emplace_back("account" + std::to_string(i));
+            env.fund(XRP(10000), accounts.back());
+        }
+        env.close();
+
+        std::atomic<bool> done{false};
+        std::atomic<int> bad{0};
+        std::atomic<int> seen{0};
+
+        // Each reader has an account of its own, and every transaction only
+        // affects the master account and one other, so no two readers share
+        // a transaction.
+        std::vector<std::thread> readers;
+        for (auto const& account : accounts)
+        {
+            readers.emplace_back([&, id = account.id()] {
+                while (!done.load())
+                {
+                    RelationalDatabase::AccountTxOptions const options{
+                        id,
+                        0,
+                        std::numeric_limits<std::uint32_t>::max(),
+                        0,
+                        20,
+                        false};
+                    for (auto const& [txn, meta] :
+                         db->getNewestAccountTxs(options))
+                    {
+                        ++seen;
+                        if (!db->getLedgerInfoByIndex(meta->getLgrSeq()))
+                            ++bad;
+
+                        error_code_i ec = rpcSUCCESS;
+                        auto const found =
+                            db->getTransaction(txn->getID(), std::nullopt, ec);
+                        if (!std::holds_alternative<AccountTx>(found))
+                            ++bad;
+                    }
+                }
+            });
+        }
+
+        for (int i = 0; i < 50; ++i)
+        {
+            for (auto const& account : accounts)
+                env(pay(env.master, account, XRP(1)));
+            env.close();
+        }
+
+        done = true;
+        for (auto& reader : readers)
+            reader.join();
+
+        BEAST_EXPECT(bad == 0);
+        BEAST_EXPECT(seen > 0);
+    }
+
+public:
+    void
+    run() override
+    {
+        testConcurrentReads();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(RWDBDatabase, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
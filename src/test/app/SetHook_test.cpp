@@ -17,6 +17,7 @@
 */
 //==============================================================================
 #include <ripple/app/hook/Enum.h>
+#include <ripple/app/hook/applyHook.h>
 #include <ripple/app/ledger/LedgerMaster.h>
 #include <ripple/app/tx/impl/SetHook.h>
 #include <ripple/json/json_reader.h>
@@ -26,6 +27,11 @@
 #include <test/app/SetHook_wasm.h>
 #include <test/jtx.h>
 #include <test/jtx/hook.h>
+#include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
 #include <unordered_map>
 
 namespace ripple {
@@ -12215,6 +12221,309 @@ private:
     HASH_WASM(accept2);
 };
 BEAST_DEFINE_TESTSUITE(SetHook, app, ripple);
+
+/**
+ * Manual benchmark of hook execution.
+ *
+ * Hooks are run directly through hook::apply against a ledger built by Env,
+ * the same way Transactor runs them, but the transaction is never applied so
+ * every invocation sees the same ledger. Each workload is run with the hook
+ * module cache warm, and again with the cache cleared before every
+ * invocation so that parsing and validating the module is included.
+ *
+ * Arguments are comma separated key=value pairs:
+ *
+ *   iterations=<n>   invocations per workload (default 200)
+ *   workload=<name>  only run the named workload
+ *   file=<path>      run the wasm in <path> instead of the built in hooks
+ *
+ * e.g. --unittest=SetHookBench --unittest-arg=workload=float,iterations=1000
+ */
+class SetHookBench_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    struct Workload
+    {
+        std::string name;
+        // substrings identifying the hook source in SetHook_wasm.h
+        std::vector<std::string> needles;
+        // the hook expects bob's account in the "bob" otxn parameter
+        bool bobParam = false;
+    };
+
+    struct Result
+    {
+        std::vector<clock_type::duration> durations;
+        std::uint64_t instructions = 0;
+        std::size_t accepted = 0;
+    };
+
+    static std::map<std::string, std::string>
+    parseArgs(std::string const& s)
+    {
+        std::map<std::string, std::string> ret;
+        std::vector<std::string> pairs;
+        boost::split(pairs, s, boost::algorithm::is_any_of(","));
+        for (auto const& pair : pairs)
+        {
+            auto const eq = pair.find('=');
+            if (eq == std::string::npos)
+                continue;
+            ret[boost::trim_copy(pair.substr(0, eq))] =
+                boost::trim_copy(pair.substr(eq + 1));
+        }
+        return ret;
+    }
+
+    // The shortest hook whose source contains all of the needles.
+    static std::optional<Blob>
+    findHook(std::vector<std::string> const& needles)
+    {
+        std::optional<Blob> ret;
+        std::size_t best = std::numeric_limits<std::size_t>::max();
+        for (auto const& [source, code] : wasm)
+        {
+            if (source.size() >= best)
+                continue;
+            if (std::all_of(
+                    needles.begin(), needles.end(), [&](auto const& needle) {
+                        return source.find(needle) != std::string::npos;
+                    }))
+            {
+                ret = Blob(code.begin(), code.end());
+                best = source.size();
+            }
+        }
+        return ret;
+    }
+
+    static std::optional<Blob>
+    readFile(std::string const& path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        if (!in)
+            return std::nullopt;
+        return Blob(
+            std::istreambuf_iterator<char>(in),
+            std::istreambuf_iterator<char>());
+    }
+
+    static double
+    percentile(std::vector<clock_type::duration> sorted, double p)
+    {
+        if (sorted.empty())
+            return 0;
+        auto const i = std::min(
+            sorted.size() - 1,
+            static_cast<std::size_t>(p * (sorted.size() - 1) + 0.5));
+        return std::chrono::duration<double, std::micro>(sorted[i]).count();
+    }
+
+    Result
+    measure(
+        jtx::Env& env,
+        jtx::Account const& account,
+        STTx const& tx,
+        Blob const& code,
+        std::size_t iterations,
+        bool cached)
+    {
+        auto const hookHash = sha512Half_s(Slice(code.data(), code.size()));
+
+        auto invoke = [&]() {
+            OpenView view(*env.current());
+            ApplyContext applyCtx(
+                env.app(),
+                view,
+                tx,
+                tesSUCCESS,
+                env.current()->fees().base,
+                tapNONE,
+                env.journal);
+            hook::HookStateMap stateMap;
+
+            auto const start = clock_type::now();
+            auto const result = hook::apply(
+                uint256{},
+                hookHash,
+                uint256{},
+                code,
+                {},
+                {},
+                stateMap,
+                applyCtx,
+                account.id(),
+                false,
+                false,
+                true,
+                0,
+                0,
+                nullptr);
+            return std::make_pair(clock_type::now() - start, result);
+        };
+
+        if (cached)
+            invoke();
+
+        Result ret;
+        ret.durations.reserve(iterations);
+        for (std::size_t i = 0; i < iterations; ++i)
+        {
+            if (!cached)
+            {
+                hook::HookModuleCache::instance().clear();
+                hook::HookInstancePool::instance().clear();
+            }
+
+            auto const [elapsed, result] = invoke();
+            ret.durations.push_back(elapsed);
+            ret.instructions += result.instructionCount;
+            if (result.exitType == hook_api::ExitType::ACCEPT)
+                ++ret.accepted;
+        }
+
+        std::sort(ret.durations.begin(), ret.durations.end());
+        return ret;
+    }
+
+    void
+    report(std::string const& label, Result const& r, std::size_t iterations)
+    {
+        log << std::left << std::setw(24) << label << std::right
+            << " p50 " << std::setw(9) << std::fixed << std::setprecision(1)
+            << percentile(r.durations, 0.50) << " us"
+            << "  p99 " << std::setw(9) << percentile(r.durations, 0.99)
+            << " us"
+            << "  instructions " << std::setw(9)
+            << (iterations ? r.instructions / iterations : 0)
+            << "  accepted " << r.accepted << "/" << iterations << std::endl;
+    }
+
+    void
+    reportProfile()
+    {
+        auto functions = hook::HookProfiler::instance().snapshot().functions;
+        std::sort(
+            functions.begin(),
+            functions.end(),
+            [](auto const& a, auto const& b) {
+                return a.nanoseconds > b.nanoseconds;
+            });
+        for (auto const& f : functions)
+        {
+            if (f.calls == 0)
+                continue;
+            log << "    " << std::left << std::setw(20) << f.name << std::right
+                << " calls " << std::setw(9) << f.calls << "  time "
+                << std::setw(9) << f.nanoseconds / 1000 << " us" << std::endl;
+        }
+    }
+
+public:
+    void
+    run() override
+    {
+        using namespace jtx;
+
+        auto const args = parseArgs(arg());
+        std::size_t const iterations = args.count("iterations")
+            ? std::stoul(args.at("iterations"))
+            : 200;
+
+        std::vector<std::pair<Workload, Blob>> workloads;
+        if (auto const it = args.find("file"); it != args.end())
+        {
+            auto code = readFile(it->second);
+            if (!code)
+            {
+                fail("cannot read " + it->second);
+                return;
+            }
+            workloads.emplace_back(Workload{it->second, {}, true}, *code);
+        }
+        else
+        {
+            std::vector<Workload> const builtin = {
+                {"accept", {"return accept(0,0,0);"}},
+                {"long", {"M_REPEAT_1000"}},
+                {"state_set", {"state_set(0, 257, 0, 32) == TOO_BIG"}},
+                {"emit", {"ASSERT(emit(SBUF(hash), SBUF(tx)) == 32);"}, true},
+                {"float", {"float_multiply("}},
+                {"sha512h", {"util_sha512h((uint32_t)hash"}},
+            };
+
+            auto const only = args.find("workload");
+            for (auto const& w : builtin)
+            {
+                if (only != args.end() && only->second != w.name)
+                    continue;
+                auto code = findHook(w.needles);
+                if (!code)
+                {
+                    fail("no hook found for workload " + w.name);
+                    continue;
+                }
+                workloads.emplace_back(w, std::move(*code));
+            }
+        }
+
+        Env env{*this, supported_amendments()};
+        auto const alice = Account{"alice"};
+        auto const bob = Account{"bob"};
+        env.fund(XRP(10000), alice, bob);
+        env.close();
+
+        auto& profiler = hook::HookProfiler::instance();
+        bool const wasProfiling = profiler.enabled();
+
+        log << iterations << " iterations per workload" << std::endl;
+        for (auto const& [workload, code] : workloads)
+        {
+            testcase(workload.name);
+
+            Json::Value invoke;
+            invoke[jss::TransactionType] = "Invoke";
+            invoke[jss::Account] = alice.human();
+            if (workload.bobParam)
+            {
+                Json::Value params{Json::arrayValue};
+                params[0U][jss::HookParameter][jss::HookParameterName] =
+                    strHex(std::string("bob"));
+                params[0U][jss::HookParameter][jss::HookParameterValue] =
+                    strHex(bob.id());
+                invoke[jss::HookParameters] = params;
+            }
+            auto const jt = env.jt(invoke, fee(XRP(1)));
+
+            // both timed passes run with the profiler off so that neither
+            // side of the comparison pays for it
+            profiler.setEnabled(false);
+            auto const cached =
+                measure(env, alice, *jt.stx, code, iterations, true);
+            auto const uncached =
+                measure(env, alice, *jt.stx, code, iterations, false);
+
+            report(workload.name + " (cached)", cached, iterations);
+            report(workload.name + " (uncached)", uncached, iterations);
+
+            // the per-function breakdown comes from a separate pass whose
+            // timings are not reported
+            profiler.clear();
+            profiler.setEnabled(true);
+            measure(env, alice, *jt.stx, code, iterations, true);
+            profiler.setEnabled(false);
+            reportProfile();
+
+            BEAST_EXPECT(cached.durations.size() == iterations);
+        }
+
+        profiler.clear();
+        profiler.setEnabled(wasProfiling);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(SetHookBench, app, ripple);
 }  // namespace test
 }  // namespace ripple
 #undef M
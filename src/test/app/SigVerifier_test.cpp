@@ -0,0 +1,140 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/ledger/LedgerMaster.h>
+#include <ripple/app/misc/HashRouter.h>
+#include <ripple/app/misc/SigVerifier.h>
+#include <ripple/app/tx/apply.h>
+#include <test/jtx.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+
+namespace ripple {
+namespace test {
+
+class SigVerifier_test : public beast::unit_test::suite
+{
+    // The transaction with a field changed after it was signed
+    static std::shared_ptr<STTx const>
+    tamper(STTx const& tx)
+    {
+        STObject obj(tx);
+        obj.setFieldU32(sfSourceTag, 1);
+        Serializer s;
+        obj.add(s);
+        SerialIter sit(s.slice());
+        return std::make_shared<STTx const>(sit);
+    }
+
+    void
+    testVerify()
+    {
+        testcase("Verify");
+
+        using namespace jtx;
+
+        Env env(*this);
+        Account const alice("alice", KeyType::secp256k1);
+        Account const bob("bob", KeyType::ed25519);
+        env.fund(XRP(10000), alice, bob);
+        env.close();
+
+        std::vector<std::shared_ptr<STTx const>> good;
+        std::vector<std::shared_ptr<STTx const>> bad;
+        for (auto const& account : {alice, bob})
+        {
+            auto const s = env.seq(account);
+            for (int i = 0; i < 100; ++i)
+            {
+                auto const jt = env.jt(noop(account), seq(s + i), fee(10));
+                good.push_back(jt.stx);
+                if (i % 10 == 0)
+                    bad.push_back(tamper(*jt.stx));
+            }
+        }
+
+        std::mutex mutex;
+        std::condition_variable cond;
+        std::size_t called = 0;
+
+        SigVerifier verifier(env.app(), 2, env.journal);
+        for (auto const& txs : {good, bad})
+        {
+            for (auto const& tx : txs)
+            {
+                BEAST_EXPECT(verifier.verify(tx, [&]() {
+                    std::lock_guard lock(mutex);
+                    ++called;
+                    cond.notify_all();
+                }));
+            }
+        }
+
+        {
+            using namespace std::chrono_literals;
+            std::unique_lock lock(mutex);
+            if (!BEAST_EXPECT(cond.wait_for(lock, 30s, [&] {
+                    return called == good.size() + bad.size();
+                })))
+                return;
+        }
+
+        // The verifier left its results where checkValidity finds them
+        auto const flags = [&](std::shared_ptr<STTx const> const& tx) {
+            return env.app().getHashRouter().getFlags(
+                tx->getTransactionID());
+        };
+        for (auto const& tx : good)
+            BEAST_EXPECT((flags(tx) & (SF_SIGGOOD | SF_SIGBAD)) == SF_SIGGOOD);
+        for (auto const& tx : bad)
+            BEAST_EXPECT((flags(tx) & (SF_SIGGOOD | SF_SIGBAD)) == SF_SIGBAD);
+
+        auto const validity = [&](std::shared_ptr<STTx const> const& tx) {
+            return checkValidity(
+                       env.app().getHashRouter(),
+                       *tx,
+                       env.app().getLedgerMaster().getValidatedRules(),
+                       env.app().config())
+                .first;
+        };
+
+        for (auto const& tx : good)
+            BEAST_EXPECT(validity(tx) == Validity::Valid);
+        for (auto const& tx : bad)
+            BEAST_EXPECT(validity(tx) == Validity::SigBad);
+
+        // Nothing is queued once stopped
+        verifier.stop();
+        BEAST_EXPECT(!verifier.verify(good.front(), [&]() { fail(); }));
+    }
+
+public:
+    void
+    run() override
+    {
+        testVerify();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SigVerifier, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,869 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/app/hook/XFL.h>
+#include <ripple/basics/Number.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <boost/multiprecision/cpp_int.hpp>
+#include <cfenv>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <vector>
+
+namespace ripple {
+namespace test {
+
+// The float kernels as they were before they were rewritten in XFL.h. Their
+// results are part of consensus, so the rewritten kernels must agree with
+// these on every input.
+namespace xfl_reference {
+
+using namespace hook_float;
+
+template <typename T>
+inline int64_t
+normalize_xfl(T& man, int32_t& exp, bool neg = false)
+{
+    if (man == 0)
+        return 0;
+
+    if (man == std::numeric_limits<int64_t>::min())
+        man++;
+
+    constexpr bool sman = std::is_same<T, int64_t>::value;
+    static_assert(sman || std::is_same<T, uint64_t>());
+
+    if constexpr (sman)
+    {
+        if (man < 0)
+        {
+            man *= -1LL;
+            neg = true;
+        }
+    }
+
+    // mantissa order
+    std::feclearexcept(FE_ALL_EXCEPT);
+    int32_t mo = log10(man);
+    // defensively ensure log10 produces a sane result; we'll borrow the
+    // overflow error code if it didn't
+    if (std::fetestexcept(FE_INVALID))
+        return XFL_OVERFLOW;
+
+    int32_t adjust = 15 - mo;
+
+    if (adjust > 0)
+    {
+        // defensive check
+        if (adjust > 18)
+            return 0;
+        man *= power_of_ten[adjust];
+        exp -= adjust;
+    }
+    else if (adjust < 0)
+    {
+        // defensive check
+        if (-adjust > 18)
+            return XFL_OVERFLOW;
+        man /= power_of_ten[-adjust];
+        exp -= adjust;
+    }
+
+    if (man == 0)
+    {
+        exp = 0;
+        return 0;
+    }
+
+    if (man < minMantissa)
+    {
+        if (man == minMantissa - 1LL)
+            man += 1LL;
+        else
+        {
+            man *= 10LL;
+            exp--;
+        }
+    }
+
+    if (man > maxMantissa)
+    {
+        if (man == maxMantissa + 1LL)
+            man -= 1LL;
+        else
+        {
+            man /= 10LL;
+            exp++;
+        }
+    }
+
+    if (exp < minExponent)
+    {
+        man = 0;
+        exp = 0;
+        return 0;
+    }
+
+    if (man == 0)
+    {
+        exp = 0;
+        return 0;
+    }
+
+    if (exp > maxExponent)
+        return XFL_OVERFLOW;
+
+    int64_t ret = make_float((uint64_t)man, exp, neg);
+    if constexpr (sman)
+    {
+        if (neg)
+            man *= -1LL;
+    }
+
+    return ret;
+}
+
+inline int64_t
+float_multiply_internal_parts(
+    uint64_t man1,
+    int32_t exp1,
+    bool neg1,
+    uint64_t man2,
+    int32_t exp2,
+    bool neg2)
+{
+    using namespace boost::multiprecision;
+    cpp_int mult = cpp_int(man1) * cpp_int(man2);
+    mult /= power_of_ten[15];
+    uint64_t man_out = static_cast<uint64_t>(mult);
+    if (mult > man_out)
+        return XFL_OVERFLOW;
+
+    int32_t exp_out = exp1 + exp2 + 15;
+    bool neg_out = (neg1 && !neg2) || (!neg1 && neg2);
+    int64_t ret = xfl_reference::normalize_xfl(man_out, exp_out, neg_out);
+
+    if (ret == EXPONENT_UNDERSIZED)
+        return 0;
+    if (ret == EXPONENT_OVERSIZED)
+        return XFL_OVERFLOW;
+    return ret;
+}
+
+inline int64_t
+float_multiply(int64_t float1, int64_t float2)
+{
+    if (is_invalid_float(float1) || is_invalid_float(float2))
+        return INVALID_FLOAT;
+
+    if (float1 == 0 || float2 == 0)
+        return 0;
+
+    return xfl_reference::float_multiply_internal_parts(
+        get_mantissa(float1),
+        get_exponent(float1),
+        is_negative(float1),
+        get_mantissa(float2),
+        get_exponent(float2),
+        is_negative(float2));
+}
+
+inline int64_t
+float_divide_internal(int64_t float1, int64_t float2, bool hasFix)
+{
+    if (is_invalid_float(float1) || is_invalid_float(float2))
+        return INVALID_FLOAT;
+    if (float2 == 0)
+        return DIVISION_BY_ZERO;
+    if (float1 == 0)
+        return 0;
+
+    if (float2 == float_one_internal)
+        return float1;
+
+    uint64_t man1 = get_mantissa(float1);
+    int32_t exp1 = get_exponent(float1);
+    bool neg1 = is_negative(float1);
+    uint64_t man2 = get_mantissa(float2);
+    int32_t exp2 = get_exponent(float2);
+    bool neg2 = is_negative(float2);
+
+    int64_t tmp1 = xfl_reference::normalize_xfl(man1, exp1);
+    int64_t tmp2 = xfl_reference::normalize_xfl(man2, exp2);
+
+    if (tmp1 < 0 || tmp2 < 0)
+        return INVALID_FLOAT;
+
+    if (tmp1 == 0)
+        return 0;
+
+    while (man2 > man1)
+    {
+        man2 /= 10;
+        exp2++;
+    }
+
+    if (man2 == 0)
+        return DIVISION_BY_ZERO;
+
+    while (man2 < man1)
+    {
+        if (man2 * 10 > man1)
+            break;
+        man2 *= 10;
+        exp2--;
+    }
+
+    uint64_t man3 = 0;
+    int32_t exp3 = exp1 - exp2;
+
+    while (man2 > 0)
+    {
+        int i = 0;
+        if (hasFix)
+        {
+            for (; man1 >= man2; man1 -= man2, ++i)
+                ;
+        }
+        else
+        {
+            for (; man1 > man2; man1 -= man2, ++i)
+                ;
+        }
+
+        man3 *= 10;
+        man3 += i;
+        man2 /= 10;
+        if (man2 == 0)
+            break;
+        exp3--;
+    }
+
+    bool neg3 = !((neg1 && neg2) || (!neg1 && !neg2));
+
+    return xfl_reference::normalize_xfl(man3, exp3, neg3);
+}
+
+inline int64_t
+float_sum(int64_t float1, int64_t float2)
+{
+    if (is_invalid_float(float1) || is_invalid_float(float2))
+        return INVALID_FLOAT;
+
+    if (float1 == 0)
+        return float2;
+    if (float2 == 0)
+        return float1;
+
+    int64_t man1 =
+        (int64_t)(get_mantissa(float1)) * (is_negative(float1) ? -1LL : 1LL);
+    int32_t exp1 = get_exponent(float1);
+    int64_t man2 =
+        (int64_t)(get_mantissa(float2)) * (is_negative(float2) ? -1LL : 1LL);
+    int32_t exp2 = get_exponent(float2);
+
+    try
+    {
+        ripple::IOUAmount amt1{man1, exp1};
+        ripple::IOUAmount amt2{man2, exp2};
+        amt1 += amt2;
+        int64_t result = make_float(amt1);
+        if (result == EXPONENT_UNDERSIZED)
+            return 0;
+        return result;
+    }
+    catch (std::overflow_error& e)
+    {
+        return XFL_OVERFLOW;
+    }
+}
+
+inline int64_t
+double_to_xfl(double x)
+{
+    if ((x) == 0)
+        return 0;
+    bool neg = x < 0;
+    double absresult = neg ? -x : x;
+
+    int32_t exp_out = (int32_t)log10(absresult);
+
+    absresult *= pow(10, -exp_out + 15);
+
+    int64_t result = (int64_t)absresult;
+    if (result < minMantissa)
+    {
+        if (result == minMantissa - 1LL)
+            result += 1LL;
+        else
+        {
+            result *= 10LL;
+            exp_out--;
+        }
+    }
+
+    if (result > maxMantissa)
+    {
+        if (result == maxMantissa + 1LL)
+            result -= 1LL;
+        else
+        {
+            result /= 10LL;
+            exp_out++;
+        }
+    }
+
+    exp_out -= 15;
+    int64_t ret = make_float(result, exp_out, neg);
+
+    if (ret == EXPONENT_UNDERSIZED)
+        return 0;
+
+    return ret;
+}
+
+inline int64_t
+float_log(int64_t float1)
+{
+    if (is_invalid_float(float1))
+        return INVALID_FLOAT;
+
+    if (float1 == 0)
+        return INVALID_ARGUMENT;
+
+    uint64_t man1 = get_mantissa(float1);
+    int32_t exp1 = get_exponent(float1);
+    if (is_negative(float1))
+        return COMPLEX_NOT_SUPPORTED;
+
+    double inp = (double)(man1);
+    double result = log10(inp) + exp1;
+
+    return xfl_reference::double_to_xfl(result);
+}
+
+inline int64_t
+float_root(int64_t float1, uint32_t n)
+{
+    if (is_invalid_float(float1))
+        return INVALID_FLOAT;
+    if (float1 == 0)
+        return 0;
+
+    if (n < 2)
+        return INVALID_ARGUMENT;
+
+    uint64_t man1 = get_mantissa(float1);
+    int32_t exp1 = get_exponent(float1);
+    if (is_negative(float1))
+        return COMPLEX_NOT_SUPPORTED;
+
+    double inp = (double)(man1)*pow(10, exp1);
+    double result = pow(inp, ((double)1.0f) / ((double)(n)));
+
+    return xfl_reference::double_to_xfl(result);
+}
+
+}  // namespace xfl_reference
+
+// The rewritten kernels, with the same signatures as above.
+namespace xfl_fast {
+
+using namespace hook_float;
+
+inline int64_t
+float_multiply(int64_t float1, int64_t float2)
+{
+    if (is_invalid_float(float1) || is_invalid_float(float2))
+        return INVALID_FLOAT;
+
+    if (float1 == 0 || float2 == 0)
+        return 0;
+
+    return float_multiply_internal_parts(
+        get_mantissa(float1),
+        get_exponent(float1),
+        is_negative(float1),
+        get_mantissa(float2),
+        get_exponent(float2),
+        is_negative(float2));
+}
+
+}  // namespace xfl_fast
+
+/**
+ * Differential tests of the float kernels in XFL.h.
+ *
+ * Normalization depends on its input only through (int32_t)log10(m), which
+ * only changes value at the mantissa_order() thresholds; mantissa_order()
+ * itself only changes value at those thresholds and at powers of two. So
+ * checking the order on both sides of every one of those points covers
+ * every uint64. The other kernels are checked over the edges of the format
+ * and a large number of random operands.
+ */
+class XFL_test : public beast::unit_test::suite
+{
+    using rng_t = beast::xor_shift_engine;
+
+    static int64_t
+    randomFloat(rng_t& rng, int32_t minExp = -96, int32_t maxExp = 80)
+    {
+        uint64_t const man = hook_float::minMantissa +
+            rng() % (hook_float::maxMantissa - hook_float::minMantissa + 1);
+        int32_t const exp = minExp + (int32_t)(rng() % (maxExp - minExp + 1));
+        return hook_float::make_float(man, exp, rng() & 1);
+    }
+
+    // floats at the edges of the format, including zero and some invalid
+    // encodings
+    static std::vector<int64_t>
+    edgeFloats()
+    {
+        using namespace hook_float;
+
+        std::vector<uint64_t> const mantissas = {
+            minMantissa,
+            minMantissa + 1,
+            minMantissa + 5,
+            1999999999999999ULL,
+            3162277660168379ULL,
+            3162277660168380ULL,
+            5000000000000000ULL,
+            maxMantissa - 1,
+            maxMantissa};
+
+        std::vector<int32_t> const exponents = {
+            minExponent,
+            minExponent + 1,
+            -81,
+            -50,
+            -16,
+            -15,
+            -14,
+            0,
+            1,
+            49,
+            maxExponent - 1,
+            maxExponent};
+
+        std::vector<int64_t> ret = {0, -1, (int64_t)(1ULL << 62U)};
+        for (auto const man : mantissas)
+            for (auto const exp : exponents)
+                for (bool const neg : {false, true})
+                    ret.push_back(make_float(man, exp, neg));
+        return ret;
+    }
+
+    void
+    testMantissaOrder()
+    {
+        testcase("mantissa order");
+
+        // as the thresholds are, this must be libm's log10 and not the
+        // compiler's
+        auto order = [](uint64_t m) {
+            return (int32_t)log10(hook_float::opaque((double)m));
+        };
+
+        std::vector<uint64_t> points;
+        for (int b = 0; b < 64; ++b)
+            points.push_back(1ULL << b);
+        for (auto const t : hook_float::mantissa_order_thresholds())
+            points.push_back(t);
+        for (int k = 0; k < 19; ++k)
+            points.push_back((uint64_t)hook_float::power_of_ten[k]);
+        points.push_back(10000000000000000000ULL);
+
+        bool ok = true;
+        for (auto const p : points)
+        {
+            for (uint64_t d = 0; d <= 4096; ++d)
+            {
+                for (uint64_t const m : {p - d, p + d})
+                {
+                    if (m == 0)
+                        continue;
+                    if (hook_float::mantissa_order(m) != order(m))
+                    {
+                        log << "order of " << m << " is " << order(m)
+                            << " not " << hook_float::mantissa_order(m)
+                            << std::endl;
+                        ok = false;
+                    }
+                }
+            }
+        }
+        BEAST_EXPECT(ok);
+        BEAST_EXPECT(
+            hook_float::mantissa_order(
+                std::numeric_limits<uint64_t>::max()) == 19);
+    }
+
+    template <typename T>
+    bool
+    checkNormalize(T man, int32_t exp, bool neg)
+    {
+        // keep the compiler from evaluating the reference's log10
+        man = hook_float::opaque(man);
+        T man1 = man, man2 = man;
+        int32_t exp1 = exp, exp2 = exp;
+        auto const r1 = xfl_reference::normalize_xfl(man1, exp1, neg);
+        auto const r2 = hook_float::normalize_xfl(man2, exp2, neg);
+        if (r1 == r2 && man1 == man2 && exp1 == exp2)
+            return true;
+
+        log << "normalize_xfl(" << man << ", " << exp << ", " << neg
+            << "): " << r1 << " " << man1 << " " << exp1 << " vs " << r2
+            << " " << man2 << " " << exp2 << std::endl;
+        return false;
+    }
+
+    void
+    testNormalize()
+    {
+        testcase("normalize");
+
+        std::vector<int32_t> const exponents = {
+            -130, -112, -97, -96, -95, -80, -15, 0, 15, 64, 79, 80, 81, 100};
+
+        bool ok = true;
+        auto check = [&](uint64_t m) {
+            for (auto const exp : exponents)
+            {
+                ok &= checkNormalize<uint64_t>(m, exp, false);
+                ok &= checkNormalize<uint64_t>(m, exp, true);
+                ok &= checkNormalize<int64_t>((int64_t)m, exp, false);
+                ok &= checkNormalize<int64_t>(-(int64_t)m, exp, false);
+            }
+        };
+
+        for (auto const t : hook_float::mantissa_order_thresholds())
+            for (uint64_t d = 0; d <= 64; ++d)
+                check(t - d), check(t + d);
+
+        for (int k = 0; k < 19; ++k)
+        {
+            uint64_t const p = hook_float::power_of_ten[k];
+            for (uint64_t d = 0; d <= 64; ++d)
+                check(p - d), check(p + d);
+        }
+
+        for (auto const m :
+             {(uint64_t)std::numeric_limits<int64_t>::max(),
+              (uint64_t)std::numeric_limits<int64_t>::min(),
+              std::numeric_limits<uint64_t>::max()})
+            check(m);
+
+        rng_t rng(1);
+        for (int i = 0; i < 200000; ++i)
+        {
+            // mantissas of every length
+            uint64_t const m = rng() >> (rng() % 64);
+            ok &= checkNormalize<uint64_t>(
+                m, -120 + (int32_t)(rng() % 220), rng() & 1);
+        }
+
+        BEAST_EXPECT(ok);
+    }
+
+    // run reference and fast over every pair of edge floats and `random`
+    // random pairs, counting disagreements
+    void
+    checkBinary(
+        char const* name,
+        std::function<int64_t(int64_t, int64_t)> const& reference,
+        std::function<int64_t(int64_t, int64_t)> const& fast,
+        int random,
+        int32_t spread = 176)
+    {
+        int failures = 0;
+        auto check = [&](int64_t a, int64_t b) {
+            auto const r1 = reference(a, b);
+            auto const r2 = fast(a, b);
+            if (r1 == r2)
+                return;
+            if (++failures <= 10)
+                log << name << "(" << a << ", " << b << "): " << r1 << " vs "
+                    << r2 << std::endl;
+        };
+
+        auto const edges = edgeFloats();
+        for (auto const a : edges)
+            for (auto const b : edges)
+                check(a, b);
+
+        rng_t rng(2);
+        for (int i = 0; i < random; ++i)
+        {
+            auto const a = randomFloat(rng);
+            int32_t const exp = hook_float::get_exponent(a);
+            int32_t const lo = std::max(-96, exp - spread / 2);
+            int32_t const hi = std::min(80, exp + spread / 2);
+            check(a, randomFloat(rng, lo, hi));
+        }
+
+        BEAST_EXPECTS(failures == 0, name);
+    }
+
+    void
+    testMultiply()
+    {
+        testcase("multiply");
+
+        checkBinary(
+            "float_multiply",
+            xfl_reference::float_multiply,
+            xfl_fast::float_multiply,
+            500000);
+    }
+
+    void
+    testDivide()
+    {
+        testcase("divide");
+
+        for (bool const hasFix : {false, true})
+        {
+            checkBinary(
+                hasFix ? "float_divide" : "float_divide (no fix)",
+                [&](int64_t a, int64_t b) {
+                    return xfl_reference::float_divide_internal(a, b, hasFix);
+                },
+                [&](int64_t a, int64_t b) {
+                    return hook_float::float_divide_internal(a, b, hasFix);
+                },
+                200000);
+        }
+    }
+
+    void
+    testSum()
+    {
+        testcase("sum");
+
+        // the fast path must not depend on which IOUAmount implementation
+        // is in use or on the rounding mode
+        for (bool const switchover : {false, true})
+        {
+            NumberSO stNumberSO{switchover};
+            for (auto const mode :
+                 {Number::to_nearest,
+                  Number::towards_zero,
+                  Number::downward,
+                  Number::upward})
+            {
+                saveNumberRoundMode const save{Number::setround(mode)};
+
+                // mostly close exponents so that operands often share one
+                checkBinary(
+                    "float_sum",
+                    xfl_reference::float_sum,
+                    hook_float::float_sum_internal,
+                    100000,
+                    4);
+            }
+        }
+    }
+
+    void
+    testLogRoot()
+    {
+        testcase("log and root");
+
+        int failures = 0;
+        auto check = [&](int64_t f, uint32_t n) {
+            auto const l1 = xfl_reference::float_log(f);
+            auto const l2 = hook_float::float_log_internal(f);
+            auto const r1 = xfl_reference::float_root(f, n);
+            auto const r2 = hook_float::float_root_internal(f, n);
+            if (l1 == l2 && r1 == r2)
+                return;
+            if (++failures <= 10)
+                log << "float_log(" << f << "): " << l1 << " vs " << l2
+                    << ", float_root(" << f << ", " << n << "): " << r1
+                    << " vs " << r2 << std::endl;
+        };
+
+        for (auto const f : edgeFloats())
+            for (uint32_t n = 0; n < 12; ++n)
+                check(f, n);
+
+        rng_t rng(3);
+        for (int i = 0; i < 200000; ++i)
+        {
+            auto const n = rng() % 4 ? 2 + (uint32_t)(rng() % 8)
+                                     : (uint32_t)(rng() >> 32);
+            check(randomFloat(rng), n);
+        }
+
+        // every exponent double_to_xfl scales by
+        for (int32_t e = -140; e <= 140; ++e)
+            for (double const x : {1.0, 1.5, 9.999999999999999})
+            {
+                double const v = hook_float::opaque(x * pow(10, e));
+                if (xfl_reference::double_to_xfl(v) !=
+                    hook_float::double_to_xfl(v))
+                    ++failures;
+            }
+
+        BEAST_EXPECT(failures == 0);
+    }
+
+public:
+    void
+    run() override
+    {
+        testMantissaOrder();
+        testNormalize();
+        testMultiply();
+        testDivide();
+        testSum();
+        testLogRoot();
+    }
+};
+
+/**
+ * Times each float kernel against the implementation it replaced.
+ *
+ * Run with --unittest=XFLBench, optionally passing the number of
+ * operations per kernel as --unittest-arg.
+ */
+class XFLBench_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    template <class F>
+    double
+    time(std::vector<int64_t> const& in, F&& f)
+    {
+        int64_t sink = 0;
+        auto const start = clock_type::now();
+        for (std::size_t i = 0; i + 1 < in.size(); ++i)
+            sink += f(in[i], in[i + 1]);
+        auto const elapsed = clock_type::now() - start;
+
+        // keep the results alive
+        volatile int64_t keep = sink;
+        (void)keep;
+
+        return std::chrono::duration<double, std::nano>(elapsed).count() /
+            (in.size() - 1);
+    }
+
+    template <class R, class F>
+    void
+    bench(char const* name, std::vector<int64_t> const& in, R&& r, F&& f)
+    {
+        auto const before = time(in, r);
+        auto const after = time(in, f);
+        log << std::left << std::setw(16) << name << std::right << std::fixed
+            << std::setprecision(1) << std::setw(10) << before << " ns"
+            << std::setw(10) << after << " ns" << std::setw(8)
+            << std::setprecision(2) << (before / after) << "x" << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        std::size_t count = 1000000;
+        if (!arg().empty())
+            count = std::stoul(arg());
+
+        beast::xor_shift_engine rng(4);
+        std::vector<int64_t> floats;
+        std::vector<int64_t> close;
+        std::vector<int64_t> mantissas;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            uint64_t const man = hook_float::minMantissa +
+                rng() % (hook_float::maxMantissa - hook_float::minMantissa);
+            floats.push_back(hook_float::make_float(
+                man, -30 + (int32_t)(rng() % 60), rng() & 1));
+            close.push_back(hook_float::make_float(man, -15, false));
+            mantissas.push_back((int64_t)(rng() >> (rng() % 64)));
+        }
+
+        log << count << " operations, reference then rewritten" << std::endl;
+
+        bench(
+            "normalize",
+            mantissas,
+            [](int64_t m, int64_t) {
+                int32_t exp = 0;
+                return xfl_reference::normalize_xfl(m, exp);
+            },
+            [](int64_t m, int64_t) {
+                int32_t exp = 0;
+                return hook_float::normalize_xfl(m, exp);
+            });
+        bench(
+            "float_multiply",
+            floats,
+            xfl_reference::float_multiply,
+            xfl_fast::float_multiply);
+        bench(
+            "float_divide",
+            floats,
+            [](int64_t a, int64_t b) {
+                return xfl_reference::float_divide_internal(a, b, true);
+            },
+            [](int64_t a, int64_t b) {
+                return hook_float::float_divide_internal(a, b, true);
+            });
+        bench(
+            "float_sum",
+            floats,
+            xfl_reference::float_sum,
+            hook_float::float_sum_internal);
+        bench(
+            "float_sum (exp)",
+            close,
+            xfl_reference::float_sum,
+            hook_float::float_sum_internal);
+        bench(
+            "float_log",
+            floats,
+            [](int64_t a, int64_t) { return xfl_reference::float_log(a); },
+            [](int64_t a, int64_t) {
+                return hook_float::float_log_internal(a);
+            });
+        bench(
+            "float_root",
+            floats,
+            [](int64_t a, int64_t) {
+                return xfl_reference::float_root(
+                    hook_float::set_sign(a, false), 3);
+            },
+            [](int64_t a, int64_t) {
+                return hook_float::float_root_internal(
+                    hook_float::set_sign(a, false), 3);
+            });
+
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(XFL, app, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(XFLBench, app, ripple);
+
+}  // namespace test
+}  // namespace ripple
@@ -0,0 +1,299 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/ShardedCache.h>
+#include <ripple/basics/TaggedCache.h>
+#include <ripple/basics/chrono.h>
+#include <ripple/beast/clock/manual_clock.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/protocol/Protocol.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <atomic>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace ripple {
+
+class ShardedCache_test : public beast::unit_test::suite
+{
+    using Key = LedgerIndex;
+    using Value = std::string;
+    using Cache = ShardedCache<Key, Value>;
+
+    // The scenarios of TaggedCache_test
+    void
+    testTagged(beast::Journal journal)
+    {
+        testcase("tagged");
+
+        using namespace std::chrono_literals;
+        TestStopwatch clock;
+        clock.set(0);
+
+        Cache c("test", 1, 1s, clock, journal);
+
+        // Insert an item, retrieve it, and age it so it gets purged.
+        {
+            BEAST_EXPECT(c.getCacheSize() == 0);
+            BEAST_EXPECT(c.getTrackSize() == 0);
+            BEAST_EXPECT(!c.insert(1, "one"));
+            BEAST_EXPECT(c.getCacheSize() == 1);
+            BEAST_EXPECT(c.getTrackSize() == 1);
+
+            {
+                std::string s;
+                BEAST_EXPECT(c.retrieve(1, s));
+                BEAST_EXPECT(s == "one");
+            }
+
+            ++clock;
+            c.sweep();
+            BEAST_EXPECT(c.getCacheSize() == 0);
+            BEAST_EXPECT(c.getTrackSize() == 0);
+        }
+
+        // Insert an item, maintain a strong pointer, age it, and
+        // verify that the entry still exists.
+        {
+            BEAST_EXPECT(!c.insert(2, "two"));
+
+            {
+                auto p = c.fetch(2);
+                BEAST_EXPECT(p != nullptr);
+                ++clock;
+                c.sweep();
+                BEAST_EXPECT(c.getCacheSize() == 0);
+                BEAST_EXPECT(c.getTrackSize() == 1);
+
+                // Fetching it caches it again
+                BEAST_EXPECT(c.fetch(2) == p);
+                BEAST_EXPECT(c.getCacheSize() == 1);
+                ++clock;
+                c.sweep();
+            }
+
+            // Make sure its gone now that our reference is gone
+            ++clock;
+            c.sweep();
+            BEAST_EXPECT(c.getCacheSize() == 0);
+            BEAST_EXPECT(c.getTrackSize() == 0);
+            BEAST_EXPECT(!c.fetch(2));
+        }
+
+        // Keep a strong pointer, age it out of the cache, then
+        // canonicalize a new object with the same key and make sure
+        // you get the original object.
+        {
+            BEAST_EXPECT(!c.insert(4, "four"));
+
+            {
+                auto const p1 = c.fetch(4);
+                ++clock;
+                c.sweep();
+                BEAST_EXPECT(c.getCacheSize() == 0);
+                BEAST_EXPECT(c.getTrackSize() == 1);
+
+                auto p2 = std::make_shared<std::string>("four");
+                BEAST_EXPECT(c.canonicalize_replace_client(4, p2));
+                BEAST_EXPECT(c.getCacheSize() == 1);
+                BEAST_EXPECT(p1.get() == p2.get());
+
+                auto p3 = std::make_shared<std::string>("four");
+                BEAST_EXPECT(c.canonicalize_replace_cache(4, p3));
+                BEAST_EXPECT(c.fetch(4) == p3);
+            }
+
+            BEAST_EXPECT(c.del(4, false));
+            BEAST_EXPECT(c.getCacheSize() == 0);
+            BEAST_EXPECT(c.getTrackSize() == 0);
+        }
+    }
+
+    void
+    testClock(beast::Journal journal)
+    {
+        testcase("clock");
+
+        using namespace std::chrono_literals;
+        TestStopwatch clock;
+        clock.set(0);
+
+        // Each shard's share of the target is at least the number of keys
+        // used again, so all of those stay cached
+        int const target = 64 * 256;
+        Cache c("test", target, 1h, clock, journal);
+
+        for (Key i = 0; i < 4 * target; ++i)
+            c.insert(i, std::to_string(i));
+        BEAST_EXPECT(c.getCacheSize() == 4 * target);
+
+        std::vector<std::shared_ptr<Value>> held;
+        for (Key i = 0; i < 32; ++i)
+            BEAST_EXPECT(c.fetch(i * 7));
+        held.push_back(c.fetch(5));
+
+        c.sweep();
+        BEAST_EXPECT(c.getCacheSize() <= target);
+        BEAST_EXPECT(c.getCacheSize() > target / 2);
+        for (Key i = 0; i < 32; ++i)
+            BEAST_EXPECT(c.touch_if_exists(i * 7));
+
+        // Those dropped from the cache but still held stay tracked
+        BEAST_EXPECT(c.fetch(5) == held.front());
+        BEAST_EXPECT(
+            c.getTrackSize() == c.getCacheSize() ||
+            c.getTrackSize() == c.getCacheSize() + 1);
+
+        // The target age still applies
+        clock.advance(2h);
+        c.sweep();
+        BEAST_EXPECT(c.getCacheSize() == 0);
+        BEAST_EXPECT(c.getTrackSize() == 1);
+
+        c.reset();
+        BEAST_EXPECT(c.getTrackSize() == 0);
+        BEAST_EXPECT(c.rate() == 0);
+    }
+
+    void
+    testThreads(beast::Journal journal)
+    {
+        testcase("threads");
+
+        using namespace std::chrono_literals;
+        TestStopwatch clock;
+        clock.set(0);
+        Cache c("test", 100, 1s, clock, journal);
+
+        std::atomic<bool> stop{false};
+        std::atomic<int> failures{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&, t] {
+                std::mt19937 rng(t);
+                for (int n = 0; n < 20000; ++n)
+                {
+                    Key const key = rng() % 1000;
+                    auto p = c.fetch(key);
+                    if (!p)
+                    {
+                        p = std::make_shared<Value>(std::to_string(key));
+                        c.canonicalize_replace_client(key, p);
+                    }
+                    if (*p != std::to_string(key))
+                        ++failures;
+                }
+            });
+        }
+
+        // More keys are used than the target size, so sweeps evict
+        std::thread sweeper([&] {
+            while (!stop)
+                c.sweep();
+        });
+
+        for (auto& t : threads)
+            t.join();
+        stop = true;
+        sweeper.join();
+
+        BEAST_EXPECT(failures == 0);
+        BEAST_EXPECT(c.getCacheSize() <= c.getTrackSize());
+    }
+
+public:
+    void
+    run() override
+    {
+        test::SuiteJournal journal("ShardedCache_test", *this);
+        testTagged(journal);
+        testClock(journal);
+        testThreads(journal);
+    }
+};
+
+/** Compares lookups from several threads in TaggedCache and ShardedCache. */
+class ShardedCache_bench_test : public beast::unit_test::suite
+{
+    template <class Cache>
+    void
+    bench(char const* name, unsigned threads)
+    {
+        using namespace std::chrono;
+        test::SuiteJournal journal("ShardedCache_bench_test", *this);
+
+        int const keys = 100000;
+        int const lookups = 1000000;
+        Cache c(name, keys, 1h, stopwatch(), journal);
+        for (int i = 0; i < keys; ++i)
+            c.insert(i, std::to_string(i));
+
+        auto const start = steady_clock::now();
+        std::vector<std::thread> workers;
+        for (unsigned t = 0; t < threads; ++t)
+        {
+            workers.emplace_back([&c, t] {
+                std::mt19937 rng(t);
+                for (int n = 0; n < lookups; ++n)
+                {
+                    // Mostly hits, with some nodes fetched and added
+                    auto const key = rng() % (keys + keys / 8);
+                    if (!c.fetch(key))
+                    {
+                        auto p = std::make_shared<std::string>("x");
+                        c.canonicalize_replace_client(key, p);
+                    }
+                }
+            });
+        }
+
+        // Sweep while the lookups go on
+        c.sweep();
+        for (auto& w : workers)
+            w.join();
+
+        auto const elapsed =
+            duration_cast<duration<double>>(steady_clock::now() - start);
+        log << name << ", " << threads << " threads: "
+            << static_cast<std::uint64_t>(
+                   threads * lookups / elapsed.count())
+            << " lookups/s" << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        auto const threads = std::max(std::thread::hardware_concurrency(), 4u);
+        for (unsigned t : {1u, threads})
+        {
+            bench<TaggedCache<LedgerIndex, std::string>>("TaggedCache", t);
+            bench<ShardedCache<LedgerIndex, std::string>>("ShardedCache", t);
+        }
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ShardedCache, common, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(ShardedCache_bench, common, ripple);
+
+}  // namespace ripple
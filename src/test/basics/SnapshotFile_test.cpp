@@ -0,0 +1,153 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/SnapshotFile.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/utility/temp_dir.h>
+#include <string>
+#include <vector>
+
+namespace ripple {
+
+class SnapshotFile_test : public beast::unit_test::suite
+{
+    static std::vector<std::string>
+    loadAll(SnapshotFile& file)
+    {
+        std::vector<std::string> records;
+        file.load([&](Slice s) {
+            records.emplace_back(
+                reinterpret_cast<char const*>(s.data()), s.size());
+        });
+        return records;
+    }
+
+    static Slice
+    slice(std::string const& s)
+    {
+        return Slice(s.data(), s.size());
+    }
+
+    void
+    testAppend()
+    {
+        testcase("append");
+
+        beast::temp_dir dir;
+        SnapshotFile file(dir.file("snapshot"), 1);
+
+        // nothing there yet
+        BEAST_EXPECT(loadAll(file).empty());
+
+        file.append(slice("first"));
+        file.append(slice(""));
+        file.sync();
+        file.append(slice(std::string(100000, 'x')));
+        file.close();
+
+        auto records = loadAll(file);
+        BEAST_EXPECT(records.size() == 3);
+        BEAST_EXPECT(records[0] == "first");
+        BEAST_EXPECT(records[1].empty());
+        BEAST_EXPECT(records[2] == std::string(100000, 'x'));
+
+        // appending carries on after a load
+        file.append(slice("last"));
+        file.close();
+        records = loadAll(file);
+        BEAST_EXPECT(records.size() == 4);
+        BEAST_EXPECT(records[3] == "last");
+
+        file.remove();
+        BEAST_EXPECT(!boost::filesystem::exists(file.path()));
+        BEAST_EXPECT(loadAll(file).empty());
+    }
+
+    void
+    testTorn()
+    {
+        testcase("torn");
+
+        beast::temp_dir dir;
+        SnapshotFile file(dir.file("snapshot"), 1);
+
+        file.append(slice("one"));
+        file.append(slice("two"));
+        file.close();
+        auto const size = boost::filesystem::file_size(file.path());
+
+        // lose the end of the last record, as a crash might
+        boost::filesystem::resize_file(file.path(), size - 1);
+        auto records = loadAll(file);
+        BEAST_EXPECT(records.size() == 1 && records[0] == "one");
+        BEAST_EXPECT(
+            boost::filesystem::file_size(file.path()) ==
+            size - SnapshotFile::recordHeaderBytes - 3);
+
+        file.append(slice("three"));
+        file.close();
+        records = loadAll(file);
+        BEAST_EXPECT(records.size() == 2 && records[1] == "three");
+
+        // and only part of the header
+        boost::filesystem::resize_file(file.path(), 5);
+        BEAST_EXPECT(loadAll(file).empty());
+        BEAST_EXPECT(boost::filesystem::file_size(file.path()) == 0);
+        file.append(slice("four"));
+        file.close();
+        records = loadAll(file);
+        BEAST_EXPECT(records.size() == 1 && records[0] == "four");
+    }
+
+    void
+    testForeign()
+    {
+        testcase("foreign");
+
+        beast::temp_dir dir;
+        SnapshotFile file(dir.file("snapshot"), 1);
+        file.append(slice("one"));
+        file.close();
+
+        SnapshotFile other(dir.file("snapshot"), 2);
+        try
+        {
+            loadAll(other);
+            fail("loaded another store's snapshot");
+        }
+        catch (std::runtime_error const&)
+        {
+            pass();
+        }
+        BEAST_EXPECT(loadAll(file).size() == 1);
+    }
+
+public:
+    void
+    run() override
+    {
+        testAppend();
+        testTorn();
+        testForeign();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(SnapshotFile, basics, ripple);
+
+}  // namespace ripple
@@ -20,10 +20,14 @@
 #include <ripple/beast/utility/temp_dir.h>
 #include <ripple/nodestore/DummyScheduler.h>
 #include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/DatabaseRotatingImp.h>
 #include <ripple/unity/rocksdb.h>
 #include <algorithm>
+#include <atomic>
+#include <mutex>
 #include <test/nodestore/TestBase.h>
 #include <test/unit_test/SuiteJournal.h>
+#include <thread>
 
 namespace ripple {
 
@@ -38,16 +42,20 @@ public:
     testBackend(
         std::string const& type,
         std::uint64_t const seedValue,
-        int numObjsToTest = 2000)
+        int numObjsToTest = 2000,
+        bool snapshot = false)
     {
         DummyScheduler scheduler;
 
-        testcase("Backend type=" + type);
+        testcase(
+            "Backend type=" + type + (snapshot ? " with snapshot" : ""));
 
         Section params;
         beast::temp_dir tempDir;
         params.set("type", type);
         params.set("path", tempDir.path());
+        if (snapshot)
+            params.set("snapshot", "1");
 
         beast::xor_shift_engine rng(seedValue);
 
@@ -82,8 +90,9 @@ public:
             }
         }
 
-        // rwdb backend does not keep table/data after close
-        if (type != "rwdb")
+        // rwdb and slab backends do not keep table/data after close, unless
+        // rwdb snapshots them
+        if ((type != "rwdb" && type != "slab") || snapshot)
         {
             // Re-open the backend
             std::unique_ptr<Backend> backend = Manager::instance().make_Backend(
@@ -100,6 +109,448 @@ public:
         }
     }
 
+    // Fetch from several threads while others store, as the node store does
+    void
+    testConcurrent(std::string const& type, std::uint64_t const seedValue)
+    {
+        DummyScheduler scheduler;
+
+        testcase("Concurrent type=" + type);
+
+        Section params;
+        beast::temp_dir tempDir;
+        params.set("type", type);
+        params.set("path", tempDir.path());
+
+        beast::xor_shift_engine rng(seedValue);
+        auto const batch = createPredictableBatch(20000, rng());
+
+        test::SuiteJournal journal("Backend_test", *this);
+        std::unique_ptr<Backend> backend = Manager::instance().make_Backend(
+            params, megabytes(4), scheduler, journal);
+        backend->open();
+
+        int const writers = 4;
+        std::atomic<int> stored{0};
+        std::atomic<int> writing{writers};
+        std::atomic<int> bad{0};
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < writers; ++t)
+        {
+            threads.emplace_back([&, t] {
+                for (int i = t; i < batch.size(); i += writers)
+                {
+                    backend->store(batch[i]);
+                    ++stored;
+                }
+                --writing;
+            });
+        }
+        for (int t = 0; t < 2; ++t)
+        {
+            threads.emplace_back([&, t] {
+                beast::xor_shift_engine r(t + 1);
+                while (writing.load() != 0)
+                {
+                    auto const& expected = batch[r() % batch.size()];
+                    std::shared_ptr<NodeObject> object;
+                    auto const status =
+                        backend->fetch(expected->getHash().data(), &object);
+                    if (status == ok ? !isSame(object, expected)
+                                     : status != notFound)
+                        ++bad;
+                }
+            });
+        }
+        for (auto& thread : threads)
+            thread.join();
+
+        BEAST_EXPECT(bad == 0);
+        BEAST_EXPECT(stored.load() == batch.size());
+
+        Batch copy;
+        fetchCopyOfBatch(*backend, &copy, batch);
+        BEAST_EXPECT(areBatchesEqual(batch, copy));
+
+        std::size_t visited = 0;
+        backend->for_each([&](std::shared_ptr<NodeObject>) { ++visited; });
+        BEAST_EXPECT(visited == batch.size());
+
+        if (auto const bytes = backend->memoryUsage())
+            BEAST_EXPECT(*bytes > 0);
+    }
+
+    // Rotate while other threads fetch, the old archive is closed under
+    // fetches that are still reading from it
+    void
+    testRotate(std::string const& type, std::uint64_t const seedValue)
+    {
+        DummyScheduler scheduler;
+
+        testcase("Rotate type=" + type);
+
+        beast::temp_dir tempDir;
+        test::SuiteJournal journal("Backend_test", *this);
+
+        int n = 0;
+        auto makeBackend = [&]() {
+            Section params;
+            params.set("type", type);
+            params.set("path", tempDir.file(std::to_string(n++)));
+            auto backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open();
+            return backend;
+        };
+
+        Section config;
+        config.set("type", type);
+        DatabaseRotatingImp rotating(
+            scheduler, 1, makeBackend(), makeBackend(), config, journal);
+        Database& db = rotating;
+
+        beast::xor_shift_engine rng(seedValue);
+        auto const batch = createPredictableBatch(20000, rng());
+
+        std::atomic<bool> done{false};
+        std::atomic<int> bad{0};
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t)
+        {
+            threads.emplace_back([&, t] {
+                beast::xor_shift_engine r(t + 1);
+                while (!done.load())
+                {
+                    auto const& expected = batch[r() % batch.size()];
+                    auto const object =
+                        db.fetchNodeObject(expected->getHash());
+                    if (object && !isSame(object, expected))
+                        ++bad;
+                }
+            });
+        }
+
+        int const rotations = 50;
+        std::size_t const step = batch.size() / rotations;
+        for (int i = 0; i < rotations; ++i)
+        {
+            storeBatch(
+                db,
+                Batch(
+                    batch.begin() + i * step, batch.begin() + (i + 1) * step));
+            rotating.rotateWithLock(
+                [&](std::string const&) { return makeBackend(); });
+        }
+
+        done = true;
+        for (auto& thread : threads)
+            thread.join();
+
+        BEAST_EXPECT(bad == 0);
+    }
+
+    // Runs each task on a thread of its own, as the JobQueue would
+    class ThreadScheduler : public DummyScheduler
+    {
+        std::mutex mutex_;
+        std::vector<std::thread> threads_;
+
+    public:
+        ~ThreadScheduler()
+        {
+            std::lock_guard lock(mutex_);
+            for (auto& thread : threads_)
+                thread.join();
+        }
+
+        void
+        scheduleTask(Task& task) override
+        {
+            std::lock_guard lock(mutex_);
+            threads_.emplace_back([&task] { task.performScheduledTask(); });
+        }
+    };
+
+    // Store from several threads with writes grouped into batches
+    void
+    testGroupCommit(std::string const& type, std::uint64_t const seedValue)
+    {
+        ThreadScheduler scheduler;
+
+        testcase("Group commit type=" + type);
+
+        Section params;
+        beast::temp_dir tempDir;
+        params.set("type", type);
+        params.set("path", tempDir.path());
+        params.set("group_commit_size", "256");
+        params.set("group_commit_latency_ms", "50");
+
+        beast::xor_shift_engine rng(seedValue);
+        auto const batch = createPredictableBatch(2000, rng());
+
+        test::SuiteJournal journal("Backend_test", *this);
+        {
+            std::unique_ptr<Backend> backend =
+                Manager::instance().make_Backend(
+                    params, megabytes(4), scheduler, journal);
+            backend->open();
+
+            // Objects waiting for their batch can be fetched
+            int const writers = 4;
+            std::atomic<int> bad{0};
+            std::vector<std::thread> threads;
+            for (int t = 0; t < writers; ++t)
+            {
+                threads.emplace_back([&, t] {
+                    for (int i = t; i < batch.size(); i += writers)
+                    {
+                        backend->store(batch[i]);
+                        std::shared_ptr<NodeObject> object;
+                        if (backend->fetch(
+                                batch[i]->getHash().data(), &object) != ok ||
+                            !isSame(object, batch[i]))
+                            ++bad;
+                    }
+                });
+            }
+            for (auto& thread : threads)
+                thread.join();
+            BEAST_EXPECT(bad == 0);
+
+            // Wait for the last batch to be written
+            auto const start = std::chrono::steady_clock::now();
+            auto counters = backend->writeBatchCounters();
+            while (counters && counters->objects < batch.size() &&
+                   std::chrono::steady_clock::now() - start <
+                       std::chrono::seconds(10))
+            {
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+                counters = backend->writeBatchCounters();
+            }
+            if (BEAST_EXPECT(counters))
+            {
+                BEAST_EXPECT(counters->objects == batch.size());
+                BEAST_EXPECT(counters->batches * 4 < counters->objects);
+            }
+        }
+
+        {
+            // Reopen and read it back in
+            std::unique_ptr<Backend> backend =
+                Manager::instance().make_Backend(
+                    params, megabytes(4), scheduler, journal);
+            backend->open();
+
+            Batch copy;
+            fetchCopyOfBatch(*backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+        }
+    }
+
+    // Without compression a fetch returns the stored object itself
+    void
+    testUncompressed(std::string const& type, std::uint64_t const seedValue)
+    {
+        DummyScheduler scheduler;
+
+        testcase("Uncompressed type=" + type);
+
+        Section params;
+        beast::temp_dir tempDir;
+        params.set("type", type);
+        params.set("path", tempDir.path());
+        params.set("compress", "0");
+        params.set("snapshot", "1");
+
+        beast::xor_shift_engine rng(seedValue);
+        auto const batch = createPredictableBatch(2000, rng());
+
+        test::SuiteJournal journal("Backend_test", *this);
+        {
+            std::unique_ptr<Backend> backend =
+                Manager::instance().make_Backend(
+                    params, megabytes(4), scheduler, journal);
+            backend->open();
+            storeBatch(*backend, batch);
+
+            bool shared = true;
+            for (auto const& object : batch)
+            {
+                std::shared_ptr<NodeObject> fetched;
+                if (backend->fetch(object->getHash().data(), &fetched) !=
+                        ok ||
+                    fetched != object)
+                    shared = false;
+            }
+            BEAST_EXPECT(shared);
+        }
+
+        {
+            // The snapshot is compressed, and decoded again when loaded
+            std::unique_ptr<Backend> backend =
+                Manager::instance().make_Backend(
+                    params, megabytes(4), scheduler, journal);
+            backend->open();
+
+            Batch copy;
+            fetchCopyOfBatch(*backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+
+            std::shared_ptr<NodeObject> first;
+            std::shared_ptr<NodeObject> second;
+            backend->fetch(batch.front()->getHash().data(), &first);
+            backend->fetch(batch.front()->getHash().data(), &second);
+            BEAST_EXPECT(first && first == second);
+        }
+    }
+
+    // Objects a failed snapshot write didn't save are saved by the next one
+    void
+    testSnapshotFailure(std::uint64_t const seedValue)
+    {
+        DummyScheduler scheduler;
+
+        testcase("Snapshot write failure");
+
+        Section params;
+        beast::temp_dir tempDir;
+        params.set("type", "rwdb");
+        params.set("path", tempDir.path());
+        params.set("snapshot", "1");
+
+        // every write to /dev/full fails as if the disk were full
+        auto const path = tempDir.file("rwdb.snapshot");
+        boost::filesystem::create_symlink("/dev/full", path);
+
+        beast::xor_shift_engine rng(seedValue);
+        auto batch = createPredictableBatch(2000, rng());
+
+        test::SuiteJournal journal("Backend_test", *this);
+        {
+            std::unique_ptr<Backend> backend =
+                Manager::instance().make_Backend(
+                    params, megabytes(4), scheduler, journal);
+            backend->open();
+            storeBatch(*backend, batch);
+
+            try
+            {
+                backend->close();
+                fail("saved a snapshot to a full disk");
+            }
+            catch (std::runtime_error const&)
+            {
+                pass();
+            }
+
+            // the objects are still there to be saved once there's room
+            boost::filesystem::remove(path);
+            backend->close();
+        }
+
+        {
+            std::unique_ptr<Backend> backend =
+                Manager::instance().make_Backend(
+                    params, megabytes(4), scheduler, journal);
+            backend->open();
+
+            Batch copy;
+            fetchCopyOfBatch(*backend, &copy, batch);
+            std::sort(batch.begin(), batch.end(), LessThan{});
+            std::sort(copy.begin(), copy.end(), LessThan{});
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+        }
+    }
+
+    // Recent ledgers' objects are held in memory, the rest only on disk
+    void
+    testTiered(std::uint64_t const seedValue, bool writeBehind)
+    {
+        DummyScheduler scheduler;
+
+        testcase(
+            std::string("Tiered") + (writeBehind ? " with write behind" : ""));
+
+        Section params;
+        beast::temp_dir tempDir;
+        params.set("type", "tiered");
+        params.set("path", tempDir.path());
+        params.set("hot_ledgers", "4");
+        if (writeBehind)
+            params.set("write_behind", "1");
+
+        beast::xor_shift_engine rng(seedValue);
+        auto const batch = createPredictableBatch(2000, rng());
+        int const perLedger = 100;
+
+        test::SuiteJournal journal("Backend_test", *this);
+        {
+            std::unique_ptr<Backend> backend =
+                Manager::instance().make_Backend(
+                    params, megabytes(4), scheduler, journal);
+            backend->open();
+
+            std::optional<std::uint64_t> fourLedgers;
+            for (int i = 0; i < batch.size(); ++i)
+            {
+                if (i == 4 * perLedger)
+                    fourLedgers = backend->memoryUsage();
+                backend->storeForLedger(batch[i], 1 + i / perLedger);
+            }
+            auto const recent = backend->memoryUsage();
+            if (!BEAST_EXPECT(fourLedgers && recent && *fourLedgers > 0))
+                return;
+            BEAST_EXPECT(*recent < 2 * *fourLedgers);
+
+            // Older objects come from disk, and are then held in memory
+            Batch copy;
+            fetchCopyOfBatch(*backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+            BEAST_EXPECT(*backend->memoryUsage() > 3 * *recent);
+
+            // Until their ledger leaves the window
+            auto const last = batch.size() / perLedger;
+            backend->storeForLedger(batch.back(), last + 4);
+            BEAST_EXPECT(*backend->memoryUsage() < *fourLedgers);
+
+            // An archive keeps nothing in memory, as its window never moves
+            backend->setArchived();
+            BEAST_EXPECT(*backend->memoryUsage() == 0);
+            fetchCopyOfBatch(*backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+            BEAST_EXPECT(*backend->memoryUsage() == 0);
+        }
+
+        {
+            // Reads are not held in memory past hot_max_mb
+            Section capped(params);
+            capped.set("hot_max_mb", "0");
+            std::unique_ptr<Backend> backend =
+                Manager::instance().make_Backend(
+                    capped, megabytes(4), scheduler, journal);
+            backend->open();
+
+            Batch copy;
+            fetchCopyOfBatch(*backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+            BEAST_EXPECT(*backend->memoryUsage() == 0);
+        }
+
+        {
+            // Everything is on disk
+            std::unique_ptr<Backend> backend =
+                Manager::instance().make_Backend(
+                    params, megabytes(4), scheduler, journal);
+            backend->open();
+
+            Batch copy;
+            fetchCopyOfBatch(*backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+        }
+    }
+
     //--------------------------------------------------------------------------
 
     void
@@ -109,10 +560,21 @@ public:
 
         testBackend("memory", seedValue);
         testBackend("rwdb", seedValue);
+        testBackend("rwdb", seedValue, 2000, true);
+        testUncompressed("rwdb", seedValue);
+        testSnapshotFailure(seedValue);
+        testBackend("slab", seedValue);
+        testConcurrent("slab", seedValue);
+        testRotate("slab", seedValue);
         testBackend("nudb", seedValue);
+        testGroupCommit("nudb", seedValue);
+        testBackend("tiered", seedValue);
+        testTiered(seedValue, false);
+        testTiered(seedValue, true);
 
 #if RIPPLE_ROCKSDB_AVAILABLE
         testBackend("rocksdb", seedValue);
+        testGroupCommit("rocksdb", seedValue);
 #endif
 
 #ifdef RIPPLE_ENABLE_SQLITE_BACKEND_TESTS
@@ -0,0 +1,684 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/BasicConfig.h>
+#include <ripple/basics/ByteUtilities.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/unit_test/thread.hpp>
+#include <ripple/beast/utility/rngfill.h>
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <ripple/json/json_value.h>
+#include <ripple/json/json_writer.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/protocol/HashPrefix.h>
+#include <ripple/unity/rocksdb.h>
+#include <boost/algorithm/string.hpp>
+#include <boost/predef.h>
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <map>
+#include <optional>
+#include <sstream>
+#include <test/csf/Histogram.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <vector>
+
+#if BOOST_OS_LINUX
+#include <unistd.h>
+#endif
+
+namespace ripple {
+namespace NodeStore {
+
+/** Benchmarks the node store backends with the node's workloads.
+
+    Each backend is run with each thread count through these workloads:
+
+        close       Stores in bursts, a ledger's objects at a time
+        fetch       Fetches of random stored objects
+        batch       Batch fetches of random stored objects
+        missing     Fetches of objects that were never stored
+        mixed       Fetches, missing fetches and stores together
+        rotate      Stores and fetches across a writable and an archive
+                    backend, replacing the archive every few ledgers as
+                    online delete does
+
+    Each backend, thread count and workload is reported as a line of JSON
+    giving the objects handled per second, the latency percentiles of each
+    kind of operation and the process's resident memory.
+
+    The argument is a list separated by ';' of:
+
+        type=...        A backend and its parameters, separated by ','.
+                        Defaults to each backend that runs locally.
+        threads=1:4     The thread counts to run with.
+        items=N         The objects stored, and operations per workload.
+        ledger=N        The objects stored per ledger.
+        rotate=N        The ledgers between rotations.
+        workloads=a:b   The workloads to run. close always runs, as the
+                        others fetch what it stores.
+        output=path     Also append the results to a file.
+
+    For example:
+
+        rippled --unittest=Benchmark \
+            --unittest-arg="type=nudb;type=rwdb,compress=0;threads=8"
+*/
+class Benchmark_test : public beast::unit_test::suite
+{
+    using clock_type = std::chrono::steady_clock;
+
+    // Latencies in nanoseconds, by operation
+    using Samples = std::map<std::string, std::vector<std::uint64_t>>;
+
+    struct Options
+    {
+        std::vector<std::string> backends;
+        std::vector<std::size_t> threads{1, 4, 16};
+#ifndef NDEBUG
+        std::size_t items = 20000;
+#else
+        std::size_t items = 200000;  // release
+#endif
+        std::size_t ledger = 2000;
+        std::size_t rotate = 4;
+        std::size_t batch = 64;
+        std::vector<std::string> workloads{
+            "close",
+            "fetch",
+            "batch",
+            "missing",
+            "mixed",
+            "rotate"};
+        std::string output;
+    };
+
+    struct Context
+    {
+        Section const& config;
+        Options const& options;
+        std::size_t threads;
+        Backend& backend;
+        Scheduler& scheduler;
+        beast::Journal journal;
+
+        // The objects stored by the close workload
+        std::size_t
+        stored() const
+        {
+            return ledgers() * options.ledger;
+        }
+
+        std::size_t
+        ledgers() const
+        {
+            return std::max<std::size_t>(1, options.items / options.ledger);
+        }
+    };
+
+    struct Result
+    {
+        explicit Result(std::size_t threads) : samples(threads)
+        {
+        }
+
+        std::vector<Samples> samples;  // per thread
+        clock_type::duration elapsed{};
+        std::atomic<std::size_t> objects{0};
+        std::atomic<std::size_t> errors{0};
+    };
+
+    using Workload = void (Benchmark_test::*)(Context&, Result&);
+
+    //--------------------------------------------------------------------------
+
+    // Objects are generated from a set and an index. Sets don't share
+    // keys, so one set's objects are missing from a backend with another's.
+    enum Set : std::uint64_t { stored = 1, missing = 2 };
+
+    static uint256
+    makeKey(Set set, std::size_t n)
+    {
+        beast::xor_shift_engine gen((std::uint64_t(set) << 48) + n + 1);
+        uint256 key;
+        beast::rngfill(key.data(), key.size(), gen);
+        return key;
+    }
+
+    // Half are inner nodes with some branches empty, the rest leaves of up
+    // to several hundred bytes.
+    static std::shared_ptr<NodeObject>
+    makeObject(Set set, std::size_t n)
+    {
+        beast::xor_shift_engine gen((std::uint64_t(set) << 48) + n + 1);
+        uint256 key;
+        beast::rngfill(key.data(), key.size(), gen);
+
+        Blob data;
+        if (gen() % 2)
+        {
+            data.resize(4 + 16 * uint256::size());
+            auto const prefix =
+                static_cast<std::uint32_t>(HashPrefix::innerNode);
+            for (int i = 0; i < 4; ++i)
+                data[i] = static_cast<std::uint8_t>(prefix >> (24 - 8 * i));
+            auto const branches = gen() | 1;
+            for (int i = 0; i < 16; ++i)
+            {
+                if (branches & (1 << i))
+                    beast::rngfill(
+                        &data[4 + i * uint256::size()], uint256::size(), gen);
+            }
+            return NodeObject::createObject(
+                hotACCOUNT_NODE, std::move(data), key);
+        }
+
+        data.resize(64 + gen() % 512);
+        beast::rngfill(data.data(), data.size(), gen);
+        return NodeObject::createObject(
+            gen() % 2 ? hotACCOUNT_NODE : hotTRANSACTION_NODE,
+            std::move(data),
+            key);
+    }
+
+    static std::uint64_t
+    nanoseconds(clock_type::duration d)
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(d).count();
+    }
+
+    template <class F>
+    static void
+    timed(Samples& samples, char const* op, F&& f)
+    {
+        auto const start = clock_type::now();
+        f();
+        samples[op].push_back(nanoseconds(clock_type::now() - start));
+    }
+
+    // Runs f(id, samples) on each thread, adding the time to the result
+    template <class F>
+    void
+    parallel(std::size_t threads, Result& result, F const& f)
+    {
+        auto const start = clock_type::now();
+        std::vector<beast::unit_test::thread> t;
+        t.reserve(threads);
+        for (std::size_t id = 0; id < threads; ++id)
+            t.emplace_back(
+                *this, [&f, &result, id] { f(id, result.samples[id]); });
+        for (auto& thread : t)
+            thread.join();
+        result.elapsed += clock_type::now() - start;
+    }
+
+    // Stores a ledger's objects, split between the threads
+    void
+    storeLedger(Context& c, Backend& backend, std::size_t ledger, Result& r)
+    {
+        auto const size = c.options.ledger;
+        Batch batch;
+        batch.reserve(size);
+        for (std::size_t i = 0; i < size; ++i)
+            batch.push_back(makeObject(stored, ledger * size + i));
+
+        auto const start = clock_type::now();
+        parallel(c.threads, r, [&](std::size_t id, Samples& samples) {
+            for (auto i = id; i < size; i += c.threads)
+                timed(samples, "store", [&] { backend.store(batch[i]); });
+        });
+        r.samples[0]["ledger"].push_back(
+            nanoseconds(clock_type::now() - start));
+        r.objects += size;
+    }
+
+    //--------------------------------------------------------------------------
+
+    void
+    doClose(Context& c, Result& r)
+    {
+        for (std::size_t ledger = 0; ledger < c.ledgers(); ++ledger)
+            storeLedger(c, c.backend, ledger, r);
+        c.backend.sync();
+    }
+
+    void
+    doFetch(Context& c, Result& r)
+    {
+        parallel(c.threads, r, [&](std::size_t id, Samples& samples) {
+            beast::xor_shift_engine gen(id + 1);
+            for (auto i = id; i < c.options.items; i += c.threads)
+            {
+                auto const key = makeKey(stored, gen() % c.stored());
+                std::shared_ptr<NodeObject> object;
+                timed(samples, "fetch", [&] {
+                    c.backend.fetch(key.data(), &object);
+                });
+                if (!object)
+                    ++r.errors;
+            }
+            r.objects += samples["fetch"].size();
+        });
+    }
+
+    void
+    doBatch(Context& c, Result& r)
+    {
+        auto const size = c.options.batch;
+        parallel(c.threads, r, [&](std::size_t id, Samples& samples) {
+            beast::xor_shift_engine gen(id + 1);
+            std::vector<uint256> keys(size);
+            std::vector<uint256 const*> pointers;
+            for (auto const& key : keys)
+                pointers.push_back(&key);
+
+            for (auto i = id * size; i < c.options.items;
+                 i += c.threads * size)
+            {
+                for (auto& key : keys)
+                    key = makeKey(stored, gen() % c.stored());
+                std::vector<std::shared_ptr<NodeObject>> objects;
+                timed(samples, "fetch_batch", [&] {
+                    objects = c.backend.fetchBatch(pointers).first;
+                });
+                r.errors += size -
+                    std::count_if(objects.begin(),
+                                  objects.end(),
+                                  [](auto const& object) { return !!object; });
+                r.objects += size;
+            }
+        });
+    }
+
+    void
+    doMissing(Context& c, Result& r)
+    {
+        parallel(c.threads, r, [&](std::size_t id, Samples& samples) {
+            for (auto i = id; i < c.options.items; i += c.threads)
+            {
+                auto const key = makeKey(missing, i);
+                std::shared_ptr<NodeObject> object;
+                timed(samples, "fetch_missing", [&] {
+                    c.backend.fetch(key.data(), &object);
+                });
+                if (object)
+                    ++r.errors;
+            }
+            r.objects += samples["fetch_missing"].size();
+        });
+    }
+
+    // Like a synced node: mostly fetches, some for objects not yet
+    // acquired, and stores of new objects
+    void
+    doMixed(Context& c, Result& r)
+    {
+        Batch batch;
+        batch.reserve(c.options.items / 5);
+        for (std::size_t i = 0; i < c.options.items / 5; ++i)
+            batch.push_back(makeObject(stored, c.stored() + i));
+        std::atomic<std::size_t> next{0};
+
+        parallel(c.threads, r, [&](std::size_t id, Samples& samples) {
+            beast::xor_shift_engine gen(id + 1);
+            for (auto i = id; i < c.options.items; i += c.threads)
+            {
+                auto const kind = gen() % 10;
+                if (kind >= 8)
+                {
+                    if (auto const n = next++; n < batch.size())
+                    {
+                        timed(samples, "store", [&] {
+                            c.backend.store(batch[n]);
+                        });
+                        continue;
+                    }
+                }
+
+                bool const present = kind != 7;
+                auto const key = present
+                    ? makeKey(stored, gen() % c.stored())
+                    : makeKey(missing, i);
+                std::shared_ptr<NodeObject> object;
+                timed(samples, present ? "fetch" : "fetch_missing", [&] {
+                    c.backend.fetch(key.data(), &object);
+                });
+                if (present != !!object)
+                    ++r.errors;
+            }
+        });
+        r.objects += c.options.items;
+    }
+
+    // Like DatabaseRotatingImp: fetches try the writable backend and then
+    // the archive, copying what they find there to the writable backend.
+    void
+    doRotate(Context& c, Result& r)
+    {
+        std::vector<std::unique_ptr<beast::temp_dir>> dirs;
+        auto make = [&] {
+            dirs.push_back(std::make_unique<beast::temp_dir>());
+            Section config = c.config;
+            config.set("path", dirs.back()->path());
+            auto backend = Manager::instance().make_Backend(
+                config, megabytes(4), c.scheduler, c.journal);
+            backend->open();
+            return backend;
+        };
+
+        auto writable = make();
+        auto archive = make();
+        std::size_t oldest = 0;  // The first ledger the backends hold
+        for (std::size_t ledger = 0; ledger < c.ledgers(); ++ledger)
+        {
+            if (ledger > 0 && ledger % c.options.rotate == 0)
+            {
+                auto const start = clock_type::now();
+                timed(r.samples[0], "rotate", [&] {
+                    auto next = make();
+                    archive->setDeletePath();
+                    archive = std::move(writable);
+                    writable = std::move(next);
+                });
+                r.elapsed += clock_type::now() - start;
+                oldest = ledger - c.options.rotate;
+            }
+
+            storeLedger(c, *writable, ledger, r);
+
+            auto const first = oldest * c.options.ledger;
+            auto const count = (ledger + 1) * c.options.ledger - first;
+            parallel(c.threads, r, [&](std::size_t id, Samples& samples) {
+                beast::xor_shift_engine gen(ledger * c.threads + id + 1);
+                for (auto i = id; i < c.options.ledger; i += c.threads)
+                {
+                    auto const key = makeKey(stored, first + gen() % count);
+                    std::shared_ptr<NodeObject> object;
+                    timed(samples, "fetch", [&] {
+                        writable->fetch(key.data(), &object);
+                        if (!object)
+                        {
+                            archive->fetch(key.data(), &object);
+                            if (object)
+                                writable->store(object);
+                        }
+                    });
+                    if (!object)
+                        ++r.errors;
+                }
+            });
+            r.objects += c.options.ledger;
+        }
+
+        writable->setDeletePath();
+        archive->setDeletePath();
+    }
+
+    //--------------------------------------------------------------------------
+
+    // The process's resident memory, where the platform reports it
+    static std::optional<std::uint64_t>
+    residentBytes()
+    {
+#if BOOST_OS_LINUX
+        std::ifstream statm("/proc/self/statm");
+        std::uint64_t size;
+        std::uint64_t resident;
+        if (statm >> size >> resident)
+            return resident * sysconf(_SC_PAGESIZE);
+#endif
+        return std::nullopt;
+    }
+
+    // Latencies are binned to within 1/32 of their value, keeping the
+    // histograms small
+    static std::uint64_t
+    bin(std::uint64_t ns)
+    {
+        int const shift = std::max(0, static_cast<int>(std::bit_width(ns)) - 5);
+        return (ns >> shift) << shift;
+    }
+
+    static std::string
+    to_string(Section const& config)
+    {
+        std::string s;
+        for (auto iter = config.begin(); iter != config.end(); ++iter)
+            s += (iter != config.begin() ? "," : "") + iter->first + "=" +
+                iter->second;
+        return s;
+    }
+
+    Json::Value
+    report(
+        Section const& config,
+        std::size_t threads,
+        std::string const& workload,
+        Backend const& backend,
+        Result const& r)
+    {
+        Json::Value jv(Json::objectValue);
+        jv["backend"] = get(config, "type", std::string());
+        jv["config"] = to_string(config);
+        jv["threads"] = static_cast<Json::UInt>(threads);
+        jv["workload"] = workload;
+
+        auto const seconds = std::chrono::duration<double>(r.elapsed).count();
+        jv["seconds"] = seconds;
+        jv["objects"] = static_cast<Json::UInt>(r.objects);
+        jv["objects_per_second"] = seconds > 0 ? r.objects / seconds : 0.0;
+        jv["errors"] = static_cast<Json::UInt>(r.errors);
+        if (auto const bytes = residentBytes())
+            jv["rss_mib"] = static_cast<Json::UInt>(*bytes >> 20);
+        if (auto const bytes = backend.memoryUsage())
+            jv["memory_mib"] = static_cast<Json::UInt>(*bytes >> 20);
+
+        std::map<std::string, test::csf::Histogram<std::uint64_t>> latencies;
+        for (auto const& samples : r.samples)
+        {
+            for (auto const& [op, times] : samples)
+            {
+                auto& histogram = latencies[op];
+                for (auto const ns : times)
+                    histogram.insert(bin(ns));
+            }
+        }
+
+        Json::Value& latency = (jv["latency_us"] = Json::objectValue);
+        for (auto const& [op, histogram] : latencies)
+        {
+            Json::Value& l = latency[op];
+            l["count"] = static_cast<Json::UInt>(histogram.size());
+            l["mean"] = histogram.avg() / 1000.0;
+            l["p50"] = histogram.percentile(0.50f) / 1000.0;
+            l["p99"] = histogram.percentile(0.99f) / 1000.0;
+            l["p999"] = histogram.percentile(0.999f) / 1000.0;
+            l["max"] = histogram.maxValue() / 1000.0;
+        }
+        return jv;
+    }
+
+    void
+    runBackend(
+        std::string const& backend,
+        std::size_t threads,
+        Options const& options,
+        std::ostream* output)
+    {
+        static std::map<std::string, Workload> const workloads = {
+            {"close", &Benchmark_test::doClose},
+            {"fetch", &Benchmark_test::doFetch},
+            {"batch", &Benchmark_test::doBatch},
+            {"missing", &Benchmark_test::doMissing},
+            {"mixed", &Benchmark_test::doMixed},
+            {"rotate", &Benchmark_test::doRotate}};
+
+        Section config;
+        {
+            std::vector<std::string> v;
+            boost::split(v, backend, boost::algorithm::is_any_of(","));
+            config.append(v);
+        }
+
+        beast::temp_dir tempDir;
+        Section params = config;
+        params.set("path", tempDir.path());
+
+        DummyScheduler scheduler;
+        test::SuiteJournal journal("Benchmark_test", *this);
+        auto store = Manager::instance().make_Backend(
+            params, megabytes(4), scheduler, journal);
+        store->open();
+
+        Context c{config, options, threads, *store, scheduler, journal};
+
+        std::vector<std::string> run{"close"};
+        for (auto const& workload : options.workloads)
+        {
+            if (!workloads.count(workload))
+                fail("Unknown workload " + workload);
+            else if (workload != "close")
+                run.push_back(workload);
+        }
+
+        for (auto const& workload : run)
+        {
+            Result r(threads);
+            (this->*workloads.at(workload))(c, r);
+            if (workload == "close" &&
+                std::find(
+                    options.workloads.begin(),
+                    options.workloads.end(),
+                    workload) == options.workloads.end())
+                continue;
+
+            BEAST_EXPECT(r.errors == 0);
+            auto const line =
+                compact(report(config, threads, workload, *store, r));
+            log << line << std::endl;
+            if (output)
+                *output << line << std::endl;
+        }
+
+        store->setDeletePath();
+        store->close();
+    }
+
+    static std::string
+    compact(Json::Value&& jv)
+    {
+        std::ostringstream ss;
+        ss << Json::Compact(std::move(jv));
+        return ss.str();
+    }
+
+    static std::vector<std::size_t>
+    parseCounts(std::string const& s)
+    {
+        std::vector<std::string> v;
+        boost::split(v, s, boost::algorithm::is_any_of(":"));
+        std::vector<std::size_t> counts;
+        for (auto const& n : v)
+            counts.push_back(std::stoul(n));
+        return counts;
+    }
+
+    static Options
+    parseOptions(std::string const& arg)
+    {
+        Options options;
+        std::vector<std::string> v;
+        boost::split(v, arg, boost::algorithm::is_any_of(";"));
+        for (auto const& s : v)
+        {
+            auto const eq = s.find('=');
+            if (eq == std::string::npos)
+                continue;
+            auto const key = s.substr(0, eq);
+            auto const value = s.substr(eq + 1);
+            if (key == "type")
+                options.backends.push_back(s);
+            else if (key == "threads")
+                options.threads = parseCounts(value);
+            else if (key == "items")
+                options.items = std::stoul(value);
+            else if (key == "ledger")
+                options.ledger = std::max<std::size_t>(1, std::stoul(value));
+            else if (key == "rotate")
+                options.rotate = std::max<std::size_t>(1, std::stoul(value));
+            else if (key == "workloads")
+                boost::split(
+                    options.workloads,
+                    value,
+                    boost::algorithm::is_any_of(":"));
+            else if (key == "output")
+                options.output = value;
+        }
+
+        if (options.backends.empty())
+            options.backends = {
+                "type=memory",
+                "type=rwdb",
+                "type=rwdb,compress=0",
+                "type=flatmap",
+                "type=flatmap,compress=0",
+                "type=slab",
+                "type=nudb",
+#if RIPPLE_ROCKSDB_AVAILABLE
+                "type=rocksdb,open_files=2000,filter_bits=12,cache_mb=256,"
+                "file_size_mb=8,file_size_mult=2",
+#endif
+            };
+        return options;
+    }
+
+public:
+    void
+    run() override
+    {
+        testcase("Benchmark", beast::unit_test::abort_on_fail);
+
+        auto const options = parseOptions(arg());
+
+        std::ofstream file;
+        if (!options.output.empty())
+        {
+            file.open(options.output, std::ios::app);
+            if (!BEAST_EXPECT(file))
+                return;
+        }
+
+        auto const output = file.is_open() ? &file : nullptr;
+        for (auto const& backend : options.backends)
+            for (auto const threads : options.threads)
+                runBackend(backend, threads, options, output);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE_MANUAL(Benchmark, NodeStore, ripple);
+
+}  // namespace NodeStore
+}  // namespace ripple
@@ -21,11 +21,15 @@
 #include <ripple/core/DatabaseCon.h>
 #include <ripple/nodestore/DummyScheduler.h>
 #include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/IoUring.h>
+#include <ripple/protocol/jss.h>
 #include <test/jtx.h>
 #include <test/jtx/CheckMessageLogs.h>
 #include <test/jtx/envconfig.h>
 #include <test/nodestore/TestBase.h>
 #include <test/unit_test/SuiteJournal.h>
+#include <condition_variable>
+#include <mutex>
 
 namespace ripple {
 
@@ -652,6 +656,91 @@ public:
 
     //--------------------------------------------------------------------------
 
+    void
+    testAsyncFetch(std::string const& type, std::int64_t const seedValue)
+    {
+        DummyScheduler scheduler;
+
+        testcase("asyncFetch from '" + type + "' with io_uring");
+
+        beast::temp_dir node_db;
+        Section nodeParams;
+        nodeParams.set("type", type);
+        nodeParams.set("path", node_db.path());
+        nodeParams.set("io_uring_depth", "64");
+
+        auto batch = createPredictableBatch(numObjectsToTest, seedValue);
+        {
+            std::unique_ptr<Database> db = Manager::instance().make_Database(
+                megabytes(4), scheduler, 2, nodeParams, journal_);
+            storeBatch(*db, batch);
+        }
+
+        // Reopened, everything is in the files, which is all the io_uring
+        // reader sees. Whichever way an object is read, each request
+        // completes once.
+        std::unique_ptr<Database> db = Manager::instance().make_Database(
+            megabytes(4), scheduler, 2, nodeParams, journal_);
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        Batch copy;
+        std::size_t completed = 0;
+        std::size_t missing = 0;
+        auto const callback = [&](std::shared_ptr<NodeObject> const& object) {
+            std::lock_guard lock(mutex);
+            if (object)
+                copy.push_back(object);
+            else
+                ++missing;
+            ++completed;
+            cv.notify_all();
+        };
+
+        for (auto const& object : batch)
+            db->asyncFetch(object->getHash(), 0, callback);
+
+        beast::xor_shift_engine rng(seedValue);
+        for (int i = 0; i < 10; ++i)
+        {
+            uint256 hash;
+            beast::rngfill(hash.begin(), hash.size(), rng);
+            db->asyncFetch(hash, 0, callback);
+        }
+
+        {
+            std::unique_lock lock(mutex);
+            BEAST_EXPECT(cv.wait_for(lock, std::chrono::seconds(30), [&] {
+                return completed == batch.size() + 10;
+            }));
+        }
+
+        // Everything stored is in the files, so the io_uring reader finds
+        // all of it, unless io_uring isn't available here at all
+        Json::Value counts(Json::objectValue);
+        db->getCountsJson(counts);
+        if (IoUring::make(1))
+        {
+            BEAST_EXPECT(
+                counts.isMember(jss::node_reads_async) &&
+                counts[jss::node_reads_async].asString() ==
+                    std::to_string(batch.size()));
+        }
+        else
+        {
+            log << "io_uring is unavailable, skipping the reader check"
+                << std::endl;
+        }
+        db.reset();
+        BEAST_EXPECT(missing == 10);
+
+        std::sort(batch.begin(), batch.end(), LessThan{});
+        std::sort(copy.begin(), copy.end(), LessThan{});
+        BEAST_EXPECT(areBatchesEqual(batch, copy));
+    }
+
+    //--------------------------------------------------------------------------
+
     void
     run() override
     {
@@ -667,6 +756,8 @@ public:
         {
             testNodeStore("nudb", true, seedValue);
 
+            testAsyncFetch("nudb", seedValue);
+
 #if RIPPLE_ROCKSDB_AVAILABLE
             testNodeStore("rocksdb", true, seedValue);
 #endif
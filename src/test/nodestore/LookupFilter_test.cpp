@@ -0,0 +1,208 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/DatabaseRotatingImp.h>
+#include <ripple/nodestore/impl/LookupFilter.h>
+#include <ripple/protocol/jss.h>
+#include <test/nodestore/TestBase.h>
+#include <test/unit_test/SuiteJournal.h>
+
+namespace ripple {
+namespace NodeStore {
+
+class LookupFilter_test : public TestBase
+{
+    void
+    testFilter(std::uint64_t const seedValue)
+    {
+        testcase("filter");
+
+        auto const stored = createPredictableBatch(10000, seedValue);
+        auto const missing = createPredictableBatch(10000, seedValue + 1);
+
+        LookupFilter filter(stored.size());
+        for (auto const& object : stored)
+            filter.insert(object->getHash());
+
+        bool all = true;
+        for (auto const& object : stored)
+            all = all && filter.mayContain(object->getHash());
+        BEAST_EXPECT(all);
+
+        std::size_t falsePositives = 0;
+        for (auto const& object : missing)
+        {
+            if (filter.mayContain(object->getHash()))
+                ++falsePositives;
+        }
+        // about 1% expected
+        BEAST_EXPECT(falsePositives < missing.size() / 40);
+
+        // too small still never misses a key
+        LookupFilter tiny(1);
+        for (auto const& object : stored)
+            tiny.insert(object->getHash());
+        all = true;
+        for (auto const& object : stored)
+            all = all && tiny.mayContain(object->getHash());
+        BEAST_EXPECT(all);
+    }
+
+    void
+    testSave(std::uint64_t const seedValue)
+    {
+        testcase("save");
+
+        beast::temp_dir dir;
+        auto const path = boost::filesystem::path(dir.file("filter"));
+        auto const stored = createPredictableBatch(1000, seedValue);
+        auto const missing = createPredictableBatch(1000, seedValue + 1);
+
+        BEAST_EXPECT(!LookupFilter::load(path, 1000));
+
+        LookupFilter filter(1000);
+        for (auto const& object : stored)
+            filter.insert(object->getHash());
+        filter.save(path);
+
+        auto const loaded = LookupFilter::load(path, 1000);
+        BEAST_EXPECT(loaded && loaded->bytes() == filter.bytes());
+        BEAST_EXPECT(!boost::filesystem::exists(path));
+        if (loaded)
+        {
+            bool same = true;
+            for (auto const& batch : {stored, missing})
+            {
+                for (auto const& object : batch)
+                    same = same &&
+                        loaded->mayContain(object->getHash()) ==
+                            filter.mayContain(object->getHash());
+            }
+            BEAST_EXPECT(same);
+        }
+
+        // sized differently
+        filter.save(path);
+        BEAST_EXPECT(!LookupFilter::load(path, 100000));
+        BEAST_EXPECT(!boost::filesystem::exists(path));
+    }
+
+    void
+    testRotating(std::uint64_t const seedValue)
+    {
+        testcase("rotating");
+
+        DummyScheduler scheduler;
+        test::SuiteJournal journal("LookupFilter_test", *this);
+
+        auto makeBackend = [&](std::string const& path) {
+            Section params;
+            params.set("type", "memory");
+            params.set("path", path);
+            auto backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open();
+            return backend;
+        };
+
+        Section config;
+        config.set("type", "memory");
+        config.set("lookup_filter", "10000");
+        DatabaseRotatingImp rotating(
+            scheduler,
+            1,
+            makeBackend("filter_test.0"),
+            makeBackend("filter_test.1"),
+            config,
+            journal);
+        Database& db = rotating;
+
+        auto filtered = [&] {
+            Json::Value counts(Json::objectValue);
+            db.getCountsJson(counts);
+            return std::stoull(counts[jss::node_reads_filtered].asString());
+        };
+
+        auto const first = createPredictableBatch(1000, seedValue);
+        auto const second = createPredictableBatch(1000, seedValue + 1);
+        auto const missing = createPredictableBatch(1000, seedValue + 2);
+
+        // Neither backend starts out with a filter
+        storeBatch(db, first);
+        for (auto const& object : missing)
+            BEAST_EXPECT(!db.fetchNodeObject(object->getHash()));
+        BEAST_EXPECT(filtered() == 0);
+
+        int n = 2;
+        auto rotate = [&] {
+            rotating.rotateWithLock([&](std::string const&) {
+                return makeBackend("filter_test." + std::to_string(n++));
+            });
+        };
+
+        // The writable backend is new, so it has a complete filter. The
+        // archive holding `first` still doesn't have one.
+        rotate();
+        storeBatch(db, second);
+        for (auto const& batch : {first, second})
+        {
+            for (auto const& object : batch)
+                BEAST_EXPECT(db.fetchNodeObject(object->getHash()));
+        }
+        for (auto const& object : missing)
+            BEAST_EXPECT(!db.fetchNodeObject(object->getHash()));
+        auto const skipped = filtered();
+        BEAST_EXPECT(skipped >= 1900 && skipped <= 2000);
+
+        // Now both are filtered, and `first` went with the old archive
+        rotate();
+        for (auto const& object : second)
+        {
+            BEAST_EXPECT(db.fetchNodeObject(
+                object->getHash(), 0, FetchType::synchronous, true));
+        }
+        for (auto const& object : first)
+            BEAST_EXPECT(!db.fetchNodeObject(object->getHash()));
+        BEAST_EXPECT(filtered() - skipped > 2 * 1000 + 900);
+
+        // What was copied forward passes the writable backend's filter
+        rotate();
+        for (auto const& object : second)
+            BEAST_EXPECT(db.fetchNodeObject(object->getHash()));
+    }
+
+public:
+    void
+    run() override
+    {
+        std::uint64_t const seedValue = 50;
+
+        testFilter(seedValue);
+        testSave(seedValue);
+        testRotating(seedValue);
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(LookupFilter, NodeStore, ripple);
+
+}  // namespace NodeStore
+}  // namespace ripple
@@ -0,0 +1,240 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/random.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/utility/rngfill.h>
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/nodestore/impl/NuDBReader.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <nudb/create.hpp>
+#include <nudb/detail/bucket.hpp>
+#include <nudb/detail/format.hpp>
+#include <nudb/nudb.hpp>
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace ripple {
+namespace NodeStore {
+
+class NuDBReader_test : public beast::unit_test::suite
+{
+    using Header = NuDBReader::Header;
+
+    static std::size_t constexpr blockSize = 4096;
+    static std::uint64_t constexpr salt = 0x0123456789abcdefULL;
+
+    static void
+    create(std::string const& dir, std::size_t keyBytes, nudb::error_code& ec)
+    {
+        nudb::create<nudb::xxhasher>(
+            dir + "/nudb.dat",
+            dir + "/nudb.key",
+            dir + "/nudb.log",
+            1,
+            nudb::make_uid(),
+            salt,
+            keyBytes,
+            blockSize,
+            0.50,
+            ec);
+    }
+
+    void
+    testHeader()
+    {
+        testcase("header");
+
+        test::SuiteJournal journal("NuDBReader_test", *this);
+
+        beast::temp_dir dir;
+        nudb::error_code ec;
+        create(dir.path(), uint256::size(), ec);
+        BEAST_EXPECT(!ec);
+
+        auto const header = Header::read(dir.path(), journal);
+        if (!BEAST_EXPECT(header))
+            return;
+        BEAST_EXPECT(header->salt == salt);
+        BEAST_EXPECT(header->blockSize == blockSize);
+        BEAST_EXPECT(
+            header->capacity == nudb::detail::bucket_capacity(blockSize));
+
+        // Keys that aren't hashes, and a directory without a database
+        beast::temp_dir small;
+        create(small.path(), 8, ec);
+        BEAST_EXPECT(!ec);
+        BEAST_EXPECT(!Header::read(small.path(), journal));
+
+        beast::temp_dir empty;
+        BEAST_EXPECT(!Header::read(empty.path(), journal));
+    }
+
+    void
+    testParse()
+    {
+        testcase("parse");
+
+        Header const header{
+            salt, blockSize, nudb::detail::bucket_capacity(blockSize)};
+
+        std::vector<std::uint8_t> buffer(blockSize);
+        nudb::detail::bucket b(blockSize, buffer.data(), nudb::detail::empty);
+        b.insert(100, 10, 7);
+        b.insert(200, 20, 9);
+        b.insert(300, 30, 7);
+        b.spill(0x123456);
+
+        NuDBReader::Records records;
+        BEAST_EXPECT(
+            header.parse(buffer.data(), buffer.size(), 7, records) ==
+            0x123456);
+        std::sort(records.begin(), records.end());
+        BEAST_EXPECT(records == NuDBReader::Records({{100, 10}, {300, 30}}));
+
+        // Matches are added to what is already there
+        BEAST_EXPECT(
+            header.parse(buffer.data(), buffer.size(), 9, records) ==
+            0x123456);
+        BEAST_EXPECT(records.size() == 3 && records[2].first == 200);
+
+        // Nothing matches, and the end of the chain
+        records.clear();
+        b.spill(0);
+        BEAST_EXPECT(
+            header.parse(buffer.data(), buffer.size(), 8, records) == 0);
+        BEAST_EXPECT(records.empty());
+
+        // Entries running past what was read and short headers are rejected
+        auto const used = nudb::detail::bucket_size(b.size());
+        BEAST_EXPECT(!header.parse(buffer.data(), used - 1, 7, records));
+        BEAST_EXPECT(!header.parse(buffer.data(), 7, 7, records));
+        BEAST_EXPECT(records.empty());
+    }
+
+    void
+    testLookup()
+    {
+        testcase("lookup");
+
+        test::SuiteJournal journal("NuDBReader_test", *this);
+
+        beast::temp_dir dir;
+        auto const dp = dir.file("nudb.dat");
+        auto const kp = dir.file("nudb.key");
+        nudb::error_code ec;
+        create(dir.path(), uint256::size(), ec);
+        if (!BEAST_EXPECT(!ec))
+            return;
+
+        // Enough keys to need more than one bucket
+        std::vector<uint256> keys(1000);
+        {
+            nudb::store db;
+            db.open(dp, kp, dir.file("nudb.log"), ec);
+            if (!BEAST_EXPECT(!ec))
+                return;
+            std::uint8_t const value[] = {1, 2, 3, 4};
+            for (auto& key : keys)
+            {
+                beast::rngfill(key.data(), key.size(), default_prng());
+                db.insert(key.data(), value, sizeof(value), ec);
+                if (!BEAST_EXPECT(!ec))
+                    return;
+            }
+            db.close(ec);
+            if (!BEAST_EXPECT(!ec))
+                return;
+        }
+
+        auto const header = Header::read(dir.path(), journal);
+        if (!BEAST_EXPECT(header))
+            return;
+
+        nudb::native_file kf;
+        nudb::native_file df;
+        kf.open(nudb::file_mode::read, kp, ec);
+        if (!BEAST_EXPECT(!ec))
+            return;
+        df.open(nudb::file_mode::read, dp, ec);
+        if (!BEAST_EXPECT(!ec))
+            return;
+        auto const buckets = (kf.size(ec) - blockSize) / blockSize;
+        BEAST_EXPECT(buckets > 1);
+
+        // Every key's bucket chain leads to its record
+        std::size_t found = 0;
+        std::vector<std::uint8_t> buffer(blockSize);
+        for (auto const& key : keys)
+        {
+            auto const hash = header->hash(key);
+            kf.read(
+                (Header::bucket(hash, buckets) + 1) * blockSize,
+                buffer.data(),
+                blockSize,
+                ec);
+            if (!BEAST_EXPECT(!ec))
+                return;
+
+            NuDBReader::Records records;
+            auto spill =
+                header->parse(buffer.data(), buffer.size(), hash, records);
+            while (spill && *spill != 0)
+            {
+                auto const size = nudb::detail::bucket_size(header->capacity);
+                df.read(*spill, buffer.data(), size, ec);
+                if (!BEAST_EXPECT(!ec))
+                    return;
+                spill = header->parse(buffer.data(), size, hash, records);
+            }
+            BEAST_EXPECT(spill);
+
+            for (auto const& [offset, size] : records)
+            {
+                // Value size (6), key
+                std::uint8_t record[6 + uint256::size()];
+                df.read(offset, record, sizeof(record), ec);
+                if (!BEAST_EXPECT(!ec))
+                    return;
+                if (size == 4 &&
+                    std::memcmp(record + 6, key.data(), key.size()) == 0)
+                {
+                    ++found;
+                    break;
+                }
+            }
+        }
+        BEAST_EXPECT(found == keys.size());
+    }
+
+public:
+    void
+    run() override
+    {
+        testHeader();
+        testParse();
+        testLookup();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(NuDBReader, NodeStore, ripple);
+
+}  // namespace NodeStore
+}  // namespace ripple
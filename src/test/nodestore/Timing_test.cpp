@@ -266,16 +266,8 @@ public:
 
     // Insert only
     void
-    do_insert(
-        Section const& config,
-        Params const& params,
-        beast::Journal journal)
+    do_insert(Backend& backend, Params const& params)
     {
-        DummyScheduler scheduler;
-        auto backend = make_Backend(config, scheduler, journal);
-        BEAST_EXPECT(backend != nullptr);
-        backend->open();
-
         class Body
         {
         private:
@@ -309,30 +301,21 @@ public:
                 params.items,
                 params.threads,
                 std::ref(*this),
-                std::ref(*backend));
+                std::ref(backend));
         }
         catch (std::exception const&)
         {
 #if NODESTORE_TIMING_DO_VERIFY
-            backend->verify();
+            backend.verify();
 #endif
             Rethrow();
         }
-        backend->close();
     }
 
     // Fetch existing keys
     void
-    do_fetch(
-        Section const& config,
-        Params const& params,
-        beast::Journal journal)
+    do_fetch(Backend& backend, Params const& params)
     {
-        DummyScheduler scheduler;
-        auto backend = make_Backend(config, scheduler, journal);
-        BEAST_EXPECT(backend != nullptr);
-        backend->open();
-
         class Body
         {
         private:
@@ -380,30 +363,21 @@ public:
                 params.threads,
                 std::ref(*this),
                 std::ref(params),
-                std::ref(*backend));
+                std::ref(backend));
         }
         catch (std::exception const&)
         {
 #if NODESTORE_TIMING_DO_VERIFY
-            backend->verify();
+            backend.verify();
 #endif
             Rethrow();
         }
-        backend->close();
     }
 
     // Perform lookups of non-existent keys
     void
-    do_missing(
-        Section const& config,
-        Params const& params,
-        beast::Journal journal)
+    do_missing(Backend& backend, Params const& params)
     {
-        DummyScheduler scheduler;
-        auto backend = make_Backend(config, scheduler, journal);
-        BEAST_EXPECT(backend != nullptr);
-        backend->open();
-
         class Body
         {
         private:
@@ -453,30 +427,21 @@ public:
                 params.threads,
                 std::ref(*this),
                 std::ref(params),
-                std::ref(*backend));
+                std::ref(backend));
         }
         catch (std::exception const&)
         {
 #if NODESTORE_TIMING_DO_VERIFY
-            backend->verify();
+            backend.verify();
 #endif
             Rethrow();
         }
-        backend->close();
     }
 
     // Fetch with present and missing keys
     void
-    do_mixed(
-        Section const& config,
-        Params const& params,
-        beast::Journal journal)
+    do_mixed(Backend& backend, Params const& params)
     {
-        DummyScheduler scheduler;
-        auto backend = make_Backend(config, scheduler, journal);
-        BEAST_EXPECT(backend != nullptr);
-        backend->open();
-
         class Body
         {
         private:
@@ -541,16 +506,15 @@ public:
                 params.threads,
                 std::ref(*this),
                 std::ref(params),
-                std::ref(*backend));
+                std::ref(backend));
         }
         catch (std::exception const&)
         {
 #if NODESTORE_TIMING_DO_VERIFY
-            backend->verify();
+            backend.verify();
 #endif
             Rethrow();
         }
-        backend->close();
     }
 
     // Simulate a rippled workload:
@@ -559,14 +523,8 @@ public:
     //      fetches an old key
     //      fetches recent, possibly non existent data
     void
-    do_work(Section const& config, Params const& params, beast::Journal journal)
+    do_work(Backend& backend, Params const& params)
     {
-        DummyScheduler scheduler;
-        auto backend = make_Backend(config, scheduler, journal);
-        BEAST_EXPECT(backend != nullptr);
-        backend->setDeletePath();
-        backend->open();
-
         class Body
         {
         private:
@@ -655,33 +613,27 @@ public:
                 params.threads,
                 std::ref(*this),
                 std::ref(params),
-                std::ref(*backend));
+                std::ref(backend));
         }
         catch (std::exception const&)
         {
 #if NODESTORE_TIMING_DO_VERIFY
-            backend->verify();
+            backend.verify();
 #endif
             Rethrow();
         }
-        backend->close();
     }
 
     //--------------------------------------------------------------------------
 
-    using test_func =
-        void (Timing_test::*)(Section const&, Params const&, beast::Journal);
+    using test_func = void (Timing_test::*)(Backend&, Params const&);
     using test_list = std::vector<std::pair<std::string, test_func>>;
 
     duration_type
-    do_test(
-        test_func f,
-        Section const& config,
-        Params const& params,
-        beast::Journal journal)
+    do_test(test_func f, Backend& backend, Params const& params)
     {
         auto const start = clock_type::now();
-        (this->*f)(config, params, journal);
+        (this->*f)(backend, params);
         return std::chrono::duration_cast<duration_type>(
             clock_type::now() - start);
     }
@@ -720,15 +672,27 @@ public:
                 beast::temp_dir tempDir;
                 Section config = parse(config_string);
                 config.set("path", tempDir.path());
+
+                // One backend for all the tests, as the memory only backends
+                // lose everything on close.
+                DummyScheduler scheduler;
+                auto backend = make_Backend(config, scheduler, journal);
+                BEAST_EXPECT(backend != nullptr);
+                backend->open();
+
                 std::stringstream ss;
                 ss << std::left << setw(10)
                    << get(config, "type", std::string()) << std::right;
                 for (auto const& test : tests)
                     ss << " " << setw(w)
-                       << to_string(
-                              do_test(test.second, config, params, journal));
+                       << to_string(do_test(test.second, *backend, params));
                 ss << "   " << to_string(config);
+                if (auto const bytes = backend->memoryUsage())
+                    ss << ",memory=" << (*bytes >> 20) << "MiB";
                 log << ss.str() << std::endl;
+
+                backend->setDeletePath();
+                backend->close();
             }
         }
     }
@@ -746,6 +710,8 @@ public:
         */
         std::string default_args =
             "type=nudb"
+            ";type=rwdb"
+            ";type=slab"
 #if RIPPLE_ROCKSDB_AVAILABLE
             ";type=rocksdb,open_files=2000,filter_bits=12,cache_mb=256,"
             "file_size_mb=8,file_size_mult=2"
@@ -0,0 +1,486 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/random.h>
+#include <ripple/beast/utility/temp_dir.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <ripple/nodestore/DummyScheduler.h>
+#include <ripple/nodestore/Manager.h>
+#include <ripple/nodestore/impl/EncodedBlob.h>
+#include <ripple/nodestore/impl/ZstdDictionary.h>
+#include <ripple/nodestore/impl/codec.h>
+#include <ripple/protocol/Indexes.h>
+#include <ripple/protocol/STLedgerEntry.h>
+#include <ripple/protocol/digest.h>
+#include <test/nodestore/TestBase.h>
+#include <test/unit_test/SuiteJournal.h>
+#include <boost/algorithm/string.hpp>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+namespace ripple {
+namespace NodeStore {
+
+// Account roots and trust lines between a few issuers, like the bulk of a
+// real ledger.
+static Batch
+createLedgerBatch(int numObjects, std::uint64_t seed)
+{
+    beast::xor_shift_engine rng(seed);
+
+    auto randomAccount = [&] {
+        AccountID id;
+        beast::rngfill(id.data(), id.size(), rng);
+        return id;
+    };
+    auto randomHash = [&] {
+        uint256 h;
+        beast::rngfill(h.data(), h.size(), rng);
+        return h;
+    };
+
+    std::vector<AccountID> issuers;
+    for (int i = 0; i < 8; ++i)
+        issuers.push_back(randomAccount());
+    std::array<Currency, 4> const currencies{
+        to_currency("USD"),
+        to_currency("EUR"),
+        to_currency("BTC"),
+        to_currency("JPY")};
+
+    Batch batch;
+    batch.reserve(numObjects);
+    for (int i = 0; i < numObjects; ++i)
+    {
+        auto const account = randomAccount();
+        std::shared_ptr<SLE> sle;
+        if (i % 2 == 0)
+        {
+            sle = std::make_shared<SLE>(keylet::account(account));
+            sle->setAccountID(sfAccount, account);
+            sle->setFieldAmount(
+                sfBalance,
+                STAmount(rand_int(rng, std::uint64_t{1000000000000})));
+            sle->setFieldU32(sfSequence, rand_int(rng, 100000000u));
+            sle->setFieldU32(sfOwnerCount, rand_int(rng, 20u));
+        }
+        else
+        {
+            auto const& issuer = issuers[rand_int(rng, issuers.size() - 1)];
+            auto const& currency =
+                currencies[rand_int(rng, currencies.size() - 1)];
+            auto const low = std::min(account, issuer);
+            auto const high = std::max(account, issuer);
+            sle = std::make_shared<SLE>(keylet::line(low, high, currency));
+            sle->setFieldAmount(
+                sfBalance,
+                STAmount(
+                    Issue{currency, noAccount()},
+                    rand_int(rng, std::uint64_t{1000000})));
+            sle->setFieldAmount(
+                sfLowLimit, STAmount(Issue{currency, low}, 1000000));
+            sle->setFieldAmount(sfHighLimit, STAmount(Issue{currency, high}));
+            sle->setFieldU32(sfFlags, lsfLowReserve);
+        }
+        sle->setFieldH256(sfPreviousTxnID, randomHash());
+        sle->setFieldU32(
+            sfPreviousTxnLgrSeq, rand_int(rng, 10000000u, 100000000u));
+
+        // As a SHAMap leaf stores it
+        Serializer s;
+        s.add32(HashPrefix::leafNode);
+        sle->add(s);
+        s.addBitString(sle->key());
+        batch.push_back(NodeObject::createObject(
+            hotACCOUNT_NODE, std::move(s.modData()), sha512Half(s.slice())));
+    }
+    return batch;
+}
+
+static std::vector<Blob>
+encodeBatch(Batch const& batch)
+{
+    std::vector<Blob> result;
+    result.reserve(batch.size());
+    for (auto const& object : batch)
+    {
+        EncodedBlob const e(object);
+        auto const p = reinterpret_cast<std::uint8_t const*>(e.getData());
+        result.emplace_back(p, p + e.getSize());
+    }
+    return result;
+}
+
+class ZstdDictionary_test : public TestBase
+{
+    std::unique_ptr<ZstdDictionary>
+    makeDictionary(std::uint64_t seed)
+    {
+        return std::make_unique<ZstdDictionary>(ZstdDictionary::train(
+            encodeBatch(createLedgerBatch(4000, seed)), 16 * 1024));
+    }
+
+    bool
+    roundTrip(Blob const& blob, ZstdDictionary const* dictionary)
+    {
+        nudb::detail::buffer bf1;
+        nudb::detail::buffer bf2;
+        auto const compressed =
+            nodeobject_compress(blob.data(), blob.size(), bf1, dictionary);
+        auto const result =
+            nodeobject_decompress(compressed.first, compressed.second, bf2);
+        return result.second == blob.size() &&
+            std::memcmp(result.first, blob.data(), blob.size()) == 0;
+    }
+
+    void
+    testCodec(std::uint64_t const seedValue)
+    {
+        testcase("codec");
+
+        auto const& dictionary = ZstdDictionary::add(makeDictionary(seedValue));
+        BEAST_EXPECT(ZstdDictionary::find(dictionary.id()) == &dictionary);
+
+        auto const blobs = encodeBatch(createLedgerBatch(1000, seedValue + 1));
+        std::size_t lz4 = 0;
+        std::size_t zstd = 0;
+        bool good = true;
+        nudb::detail::buffer bf;
+        for (auto const& blob : blobs)
+        {
+            good = good && roundTrip(blob, &dictionary) &&
+                roundTrip(blob, nullptr);
+
+            auto const z = nodeobject_compress(
+                blob.data(), blob.size(), bf, &dictionary);
+            good = good && static_cast<std::uint8_t const*>(z.first)[0] == 4;
+            zstd += z.second;
+            lz4 += nodeobject_compress(blob.data(), blob.size(), bf).second;
+        }
+        BEAST_EXPECT(good);
+        // Keys, hashes and accounts are random, so this is about all
+        // there is to gain on these objects.
+        BEAST_EXPECT(zstd * 10 < lz4 * 9);
+        log << "lz4 " << lz4 << " bytes, zstd " << zstd << " bytes"
+            << std::endl;
+
+        // Random data doesn't compress, but must still survive
+        good = true;
+        for (auto const& blob : encodeBatch(createPredictableBatch(
+                 numObjectsToTest, seedValue)))
+        {
+            good = good && roundTrip(blob, &dictionary);
+        }
+        BEAST_EXPECT(good);
+
+        // Inner nodes keep their own encoding
+        Blob inner(525);
+        inner[8] = hotUNKNOWN;
+        inner[9] = 'M';
+        inner[10] = 'I';
+        inner[11] = 'N';
+        inner[13] = 1;
+        BEAST_EXPECT(roundTrip(inner, &dictionary));
+        auto const r = nodeobject_compress(
+            inner.data(), inner.size(), bf, &dictionary);
+        BEAST_EXPECT(static_cast<std::uint8_t const*>(r.first)[0] == 2);
+    }
+
+    void
+    testUnknown(std::uint64_t const seedValue)
+    {
+        testcase("unknown dictionary");
+
+        auto const unregistered = makeDictionary(seedValue + 2);
+        BEAST_EXPECT(!ZstdDictionary::find(unregistered->id()));
+
+        auto const blob =
+            encodeBatch(createLedgerBatch(1, seedValue + 3)).front();
+        nudb::detail::buffer bf1;
+        nudb::detail::buffer bf2;
+        auto const compressed = nodeobject_compress(
+            blob.data(), blob.size(), bf1, unregistered.get());
+        try
+        {
+            nodeobject_decompress(compressed.first, compressed.second, bf2);
+            fail("decoded with an unknown dictionary");
+        }
+        catch (std::runtime_error const&)
+        {
+            pass();
+        }
+
+        // Nor do truncated frames
+        auto const& registered = ZstdDictionary::add(makeDictionary(seedValue));
+        auto const good =
+            nodeobject_compress(blob.data(), blob.size(), bf1, &registered);
+        try
+        {
+            nodeobject_decompress(good.first, good.second - 4, bf2);
+            fail("decoded a truncated frame");
+        }
+        catch (std::runtime_error const&)
+        {
+            pass();
+        }
+
+        try
+        {
+            ZstdDictionary(Blob(1024, 1));
+            fail("accepted a dictionary without an ID");
+        }
+        catch (std::runtime_error const&)
+        {
+            pass();
+        }
+    }
+
+    void
+    testDirectory(std::uint64_t const seedValue)
+    {
+        testcase("directory");
+
+        beast::temp_dir dir;
+        BEAST_EXPECT(!ZstdDictionary::loadDirectory(dir.path()));
+
+        auto const first = makeDictionary(seedValue + 4);
+        first->save(dir.path());
+        auto const second = makeDictionary(seedValue + 5);
+        second->save(dir.path());
+        BEAST_EXPECT(first->id() != second->id());
+
+        // Whichever was written last is used for compression
+        using namespace std::chrono;
+        auto const now = system_clock::to_time_t(system_clock::now());
+        auto const path = [&](ZstdDictionary const& d) {
+            return boost::filesystem::path(dir.path()) /
+                (std::to_string(d.id()) + ".dict");
+        };
+        boost::filesystem::last_write_time(path(*first), now - 60);
+        boost::filesystem::last_write_time(path(*second), now);
+
+        Section config;
+        BEAST_EXPECT(!ZstdDictionary::fromConfig(config));
+        config.set("zstd_dictionaries", dir.path());
+        auto const newest = ZstdDictionary::fromConfig(config);
+        BEAST_EXPECT(newest && newest->id() == second->id());
+        BEAST_EXPECT(newest && newest->content() == second->content());
+
+        auto const older = ZstdDictionary::find(first->id());
+        BEAST_EXPECT(older && older->content() == first->content());
+
+        // Loading again finds the same dictionaries
+        BEAST_EXPECT(ZstdDictionary::fromConfig(config) == newest);
+    }
+
+    void
+    testBackend(std::string const& type, std::uint64_t const seedValue)
+    {
+        testcase(type + " backend");
+
+        DummyScheduler scheduler;
+        test::SuiteJournal journal("ZstdDictionary_test", *this);
+        beast::temp_dir dir;
+        beast::temp_dir dictionaries;
+
+        Section params;
+        params.set("type", type);
+        params.set("path", dir.path());
+
+        auto const before = createLedgerBatch(500, seedValue + 6);
+        auto const after = createLedgerBatch(500, seedValue + 7);
+        auto const random = createPredictableBatch(500, seedValue);
+
+        {
+            // Written with lz4
+            auto backend = Manager::instance().make_Backend(
+                params, megabytes(4), scheduler, journal);
+            backend->open();
+            storeBatch(*backend, before);
+            backend->close();
+        }
+
+        makeDictionary(seedValue + 8)->save(dictionaries.path());
+        params.set("zstd_dictionaries", dictionaries.path());
+
+        auto backend = Manager::instance().make_Backend(
+            params, megabytes(4), scheduler, journal);
+        backend->open();
+        storeBatch(*backend, after);
+        storeBatch(*backend, random);
+
+        for (auto const& batch : {before, after, random})
+        {
+            Batch copy;
+            fetchCopyOfBatch(*backend, &copy, batch);
+            BEAST_EXPECT(areBatchesEqual(batch, copy));
+        }
+        backend->close();
+    }
+
+public:
+    void
+    run() override
+    {
+        std::uint64_t const seedValue = 50;
+
+        testCodec(seedValue);
+        testUnknown(seedValue);
+        testDirectory(seedValue);
+        testBackend("nudb", seedValue);
+    }
+};
+
+//------------------------------------------------------------------------------
+
+// Compares dictionary compression to lz4, by size and decoding speed.
+//
+// With no argument it uses generated ledger entries. To use real data, pass
+// a backend configuration, for example:
+//
+//  --unittest-arg=type=nudb,path=/var/lib/xahaud/db/nudb
+//
+// Objects from the start of the store are used to train the dictionary and
+// those that follow to measure it.
+class ZstdDictionaryBenchmark_test : public beast::unit_test::suite
+{
+    static constexpr std::size_t trainBytes =
+        100 * ZstdDictionary::defaultBytes;
+    static constexpr std::size_t measureBytes = 64 * 1024 * 1024;
+
+    std::pair<std::vector<Blob>, std::vector<Blob>>
+    loadSamples()
+    {
+        if (arg().empty())
+        {
+            auto const train = encodeBatch(createLedgerBatch(40000, 1));
+            auto const measure = encodeBatch(createLedgerBatch(100000, 2));
+            return {train, measure};
+        }
+
+        Section params;
+        std::vector<std::string> v;
+        boost::split(v, arg(), boost::algorithm::is_any_of(","));
+        params.append(v);
+
+        DummyScheduler scheduler;
+        beast::Journal const journal{beast::Journal::getNullSink()};
+        auto backend = Manager::instance().make_Backend(
+            params, megabytes(4), scheduler, journal);
+        backend->open(false);
+
+        struct Enough
+        {
+        };
+        std::vector<Blob> train;
+        std::vector<Blob> measure;
+        std::size_t total = 0;
+        try
+        {
+            backend->for_each([&](std::shared_ptr<NodeObject> object) {
+                auto const& data = object->getData();
+                if (data.size() >= 4 &&
+                    SerialIter(data.data(), 4).get32() ==
+                        safe_cast<std::uint32_t>(HashPrefix::innerNode))
+                    return;
+
+                auto blob = std::move(encodeBatch({object}).front());
+                total += blob.size();
+                if (total <= trainBytes)
+                    train.push_back(std::move(blob));
+                else if (total <= trainBytes + measureBytes)
+                    measure.push_back(std::move(blob));
+                else
+                    throw Enough{};
+            });
+        }
+        catch (Enough const&)
+        {
+        }
+        backend->close();
+        return {train, measure};
+    }
+
+    void
+    measure(
+        std::string const& name,
+        std::vector<Blob> const& samples,
+        ZstdDictionary const* dictionary)
+    {
+        using namespace std::chrono;
+
+        std::vector<Blob> compressed;
+        compressed.reserve(samples.size());
+        std::size_t in = 0;
+        std::size_t out = 0;
+        nudb::detail::buffer bf;
+        for (auto const& blob : samples)
+        {
+            auto const r =
+                nodeobject_compress(blob.data(), blob.size(), bf, dictionary);
+            auto const p = static_cast<std::uint8_t const*>(r.first);
+            compressed.emplace_back(p, p + r.second);
+            in += blob.size();
+            out += r.second;
+        }
+
+        auto const start = steady_clock::now();
+        for (auto const& blob : compressed)
+            nodeobject_decompress(blob.data(), blob.size(), bf);
+        auto const elapsed =
+            duration_cast<duration<double>>(steady_clock::now() - start);
+
+        std::stringstream ss;
+        ss << std::fixed << std::setprecision(2) << name << ": " << out
+           << " bytes, ratio " << double(in) / out << ", decode "
+           << in / elapsed.count() / (1024 * 1024) << " MiB/s";
+        log << ss.str() << std::endl;
+    }
+
+public:
+    void
+    run() override
+    {
+        testcase("compression");
+
+        auto const [train, samples] = loadSamples();
+        if (!BEAST_EXPECT(!train.empty() && !samples.empty()))
+            return;
+
+        std::size_t bytes = 0;
+        for (auto const& blob : samples)
+            bytes += blob.size();
+        log << samples.size() << " objects, " << bytes << " bytes"
+            << std::endl;
+
+        auto const& dictionary = ZstdDictionary::add(
+            std::make_unique<ZstdDictionary>(ZstdDictionary::train(train)));
+
+        measure("lz4", samples, nullptr);
+        measure("zstd", samples, &dictionary);
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(ZstdDictionary, NodeStore, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(ZstdDictionaryBenchmark, NodeStore, ripple);
+
+}  // namespace NodeStore
+}  // namespace ripple
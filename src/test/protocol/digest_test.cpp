@@ -0,0 +1,177 @@
+//------------------------------------------------------------------------------
+/*
+    This file is part of rippled: https://github.com/ripple/rippled
+    Copyright (c) 2023 XRPL Labs
+
+    Permission to use, copy, modify, and/or distribute this software for any
+    purpose  with  or without fee is hereby granted, provided that the above
+    copyright notice and this permission notice appear in all copies.
+
+    THE  SOFTWARE IS PROVIDED "AS IS" AND THE AUTHOR DISCLAIMS ALL WARRANTIES
+    WITH  REGARD  TO  THIS  SOFTWARE  INCLUDING  ALL  IMPLIED  WARRANTIES  OF
+    MERCHANTABILITY  AND  FITNESS. IN NO EVENT SHALL THE AUTHOR BE LIABLE FOR
+    ANY  SPECIAL ,  DIRECT, INDIRECT, OR CONSEQUENTIAL DAMAGES OR ANY DAMAGES
+    WHATSOEVER  RESULTING  FROM  LOSS  OF USE, DATA OR PROFITS, WHETHER IN AN
+    ACTION  OF  CONTRACT, NEGLIGENCE OR OTHER TORTIOUS ACTION, ARISING OUT OF
+    OR IN CONNECTION WITH THE USE OR PERFORMANCE OF THIS SOFTWARE.
+*/
+//==============================================================================
+
+#include <ripple/basics/Blob.h>
+#include <ripple/beast/unit_test.h>
+#include <ripple/beast/xor_shift_engine.h>
+#include <ripple/protocol/digest.h>
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+#include <vector>
+
+namespace ripple {
+
+class digest_test : public beast::unit_test::suite
+{
+    using Kernel = detail::Sha512Kernel;
+
+    static std::vector<Kernel>
+    kernels()
+    {
+        std::vector<Kernel> result;
+        for (auto k : {Kernel::scalar, Kernel::avx2, Kernel::avx512})
+        {
+            if (detail::sha512KernelSupported(k))
+                result.push_back(k);
+        }
+        return result;
+    }
+
+    static char const*
+    name(Kernel kernel)
+    {
+        switch (kernel)
+        {
+            case Kernel::avx2:
+                return "avx2";
+            case Kernel::avx512:
+                return "avx512";
+            default:
+                return "scalar";
+        }
+    }
+
+    // Hashes each message with sha512Half and with every kernel
+    void
+    check(std::vector<Blob> const& blobs)
+    {
+        std::vector<Slice> messages;
+        std::vector<uint256> expected;
+        for (auto const& b : blobs)
+        {
+            messages.emplace_back(b.data(), b.size());
+            expected.push_back(sha512Half(messages.back()));
+        }
+
+        for (auto kernel : kernels())
+        {
+            std::vector<uint256> digests(messages.size());
+            detail::sha512HalfBatch(
+                kernel, messages.data(), digests.data(), messages.size());
+            BEAST_EXPECTS(digests == expected, name(kernel));
+        }
+    }
+
+    static Blob
+    random(beast::xor_shift_engine& rng, std::size_t size)
+    {
+        Blob b(size);
+        for (auto& c : b)
+            c = static_cast<std::uint8_t>(rng());
+        return b;
+    }
+
+    void
+    testBatch()
+    {
+        testcase("sha512HalfBatch");
+
+        beast::xor_shift_engine rng(42);
+
+        // Sizes either side of the padding boundaries, and an inner node
+        for (std::size_t size : {0, 1, 111, 112, 127, 128, 239, 240, 516})
+        {
+            for (std::size_t count : {1, 3, 4, 5, 8, 9, 17})
+            {
+                std::vector<Blob> blobs;
+                for (std::size_t i = 0; i < count; ++i)
+                    blobs.push_back(random(rng, size));
+                check(blobs);
+            }
+        }
+
+        // Messages needing different numbers of blocks
+        std::vector<Blob> blobs;
+        for (std::size_t i = 0; i < 100; ++i)
+            blobs.push_back(random(rng, (i / 6) % 3 == 0 ? 516 : rng() % 700));
+        check(blobs);
+
+        check({});
+    }
+
+public:
+    void
+    run() override
+    {
+        testBatch();
+    }
+};
+
+/** Compares the rate at which each kernel hashes inner nodes. */
+class digest_bench_test : public beast::unit_test::suite
+{
+public:
+    void
+    run() override
+    {
+        using namespace std::chrono;
+        using Kernel = detail::Sha512Kernel;
+
+        std::size_t const count = 200000;
+        std::vector<Blob> blobs(count, Blob(516));
+        beast::xor_shift_engine rng(7);
+        for (auto& b : blobs)
+        {
+            for (auto& c : b)
+                c = static_cast<std::uint8_t>(rng());
+        }
+
+        std::vector<Slice> messages;
+        for (auto const& b : blobs)
+            messages.emplace_back(b.data(), b.size());
+        std::vector<uint256> digests(count);
+
+        for (auto [kernel, name] :
+             {std::pair{Kernel::scalar, "scalar"},
+              std::pair{Kernel::avx2, "avx2"},
+              std::pair{Kernel::avx512, "avx512"}})
+        {
+            if (!detail::sha512KernelSupported(kernel))
+                continue;
+
+            auto const start = steady_clock::now();
+            detail::sha512HalfBatch(
+                kernel, messages.data(), digests.data(), count);
+            auto const elapsed =
+                duration_cast<duration<double>>(steady_clock::now() - start);
+
+            std::stringstream ss;
+            ss << name << ": " << std::fixed << std::setprecision(0)
+               << count / elapsed.count() << " inner nodes/s";
+            log << ss.str() << std::endl;
+        }
+        pass();
+    }
+};
+
+BEAST_DEFINE_TESTSUITE(digest, protocol, ripple);
+BEAST_DEFINE_TESTSUITE_MANUAL(digest_bench, protocol, ripple);
+
+}  // namespace ripple
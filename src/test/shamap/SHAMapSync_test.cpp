@@ -85,7 +85,69 @@ public:
     }
 
     void
-    run() override
+    testCorruptNode()
+    {
+        testcase("corrupt node");
+
+        test::SuiteJournal journal("SHAMapSync_test", *this);
+
+        TestNodeFamily f(journal), f2(journal);
+        SHAMap source(SHAMapType::FREE, f);
+        SHAMap destination(SHAMapType::FREE, f2);
+
+        for (int i = 0; i < 1000; ++i)
+            source.addItem(SHAMapNodeType::tnACCOUNT_STATE, makeRandomAS());
+        source.setImmutable();
+
+        destination.setSynching();
+        {
+            std::vector<std::pair<SHAMapNodeID, Blob>> a;
+            BEAST_EXPECT(source.getNodeFat(SHAMapNodeID(), a, false, 0));
+            BEAST_EXPECT(
+                destination
+                    .addRootNode(
+                        source.getHash(), makeSlice(a[0].second), nullptr)
+                    .isGood());
+        }
+
+        // One packet with each missing node followed by its children
+        auto const nodesMissing = destination.getMissingNodes(16, nullptr);
+        BEAST_EXPECT(nodesMissing.size() >= 3);
+        if (nodesMissing.size() < 3)
+            return;
+
+        std::vector<std::pair<SHAMapNodeID, Blob>> b;
+        std::vector<std::size_t> starts;
+        for (auto const& it : nodesMissing)
+        {
+            starts.push_back(b.size());
+            BEAST_EXPECT(source.getNodeFat(it.first, b, false, 1));
+        }
+        starts.push_back(b.size());
+
+        // Corrupt the wire type of a node in the middle of the packet
+        b[starts[1]].second.back() = 0xff;
+
+        std::vector<std::pair<SHAMapNodeID, Slice>> packet;
+        for (auto const& [nodeID, data] : b)
+            packet.emplace_back(nodeID, makeSlice(data));
+
+        auto const san = destination.addKnownNodes(packet, nullptr);
+        BEAST_EXPECT(san.isInvalid());
+
+        // Every other node, before and after it, was added
+        BEAST_EXPECT(
+            san.getGood() ==
+            static_cast<int>(b.size() - (starts[2] - starts[1])));
+        BEAST_EXPECT(!destination.firstMissingNode(b[0].first));
+        BEAST_EXPECT(!destination.firstMissingNode(b.back().first));
+        BEAST_EXPECT(
+            destination.firstMissingNode(b[starts[1]].first) ==
+            b[starts[1]].first);
+    }
+
+    void
+    testSync()
     {
         using namespace beast::severities;
         test::SuiteJournal journal("SHAMapSync_test", *this);
@@ -147,6 +209,14 @@ public:
             if (nodesMissing.empty())
                 break;
 
+            // The map stops short of each node it asks for at the node
+            for (auto const& it : nodesMissing)
+            {
+                auto const stop = destination.firstMissingNode(it.first);
+                if (!stop || *stop != it.first)
+                    fail("", __FILE__, __LINE__);
+            }
+
             // get as many nodes as possible based on this information
             std::vector<std::pair<SHAMapNodeID, Blob>> b;
 
@@ -185,6 +255,13 @@ public:
 
         destination.invariants();
     }
+
+    void
+    run() override
+    {
+        testSync();
+        testCorruptNode();
+    }
 };
 
 BEAST_DEFINE_TESTSUITE(SHAMapSync, shamap, ripple);
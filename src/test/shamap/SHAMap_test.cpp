@@ -21,6 +21,7 @@
 #include <ripple/basics/Buffer.h>
 #include <ripple/beast/unit_test.h>
 #include <ripple/beast/utility/Journal.h>
+#include <ripple/protocol/digest.h>
 #include <ripple/shamap/SHAMap.h>
 #include <test/shamap/common.h>
 #include <test/unit_test/SuiteJournal.h>
@@ -325,6 +326,97 @@ public:
                 --h;
             }
         }
+
+        if (backed)
+            testcase("parallel flush backed");
+        else
+            testcase("parallel flush unbacked");
+        {
+            // Each map has its own family, so the parallel flush has to
+            // store every node itself
+            tests::TestNodeFamily sf{journal};
+            tests::TestNodeFamily pf{journal};
+            auto serial = std::make_shared<SHAMap>(SHAMapType::FREE, sf);
+            auto parallel = std::make_shared<SHAMap>(SHAMapType::FREE, pf);
+            if (!backed)
+            {
+                serial->setUnbacked();
+                parallel->setUnbacked();
+            }
+
+            auto update = [&](int begin, int end, int value) {
+                for (int i = begin; i < end; ++i)
+                {
+                    auto const key = sha512Half(i);
+                    for (auto& map : {serial, parallel})
+                    {
+                        map->delItem(key);
+                        BEAST_EXPECT(map->addItem(
+                            SHAMapNodeType::tnACCOUNT_STATE,
+                            make_shamapitem(key, IntToVUC(value))));
+                    }
+                }
+            };
+            auto flush = [&]() {
+                int const flushed = serial->flushDirty(hotACCOUNT_NODE);
+                BEAST_EXPECT(
+                    parallel->flushDirty(hotACCOUNT_NODE, true) == flushed);
+                BEAST_EXPECT(serial->getHash() == parallel->getHash());
+
+                if (backed)
+                {
+                    parallel->visitNodes([&](SHAMapTreeNode& node) {
+                        BEAST_EXPECT(node.cowid() == 0);
+                        BEAST_EXPECT(pf.db().fetchNodeObject(
+                            node.getHash().as_uint256()));
+                        return true;
+                    });
+                }
+
+                serial = serial->snapShot(true);
+                parallel = parallel->snapShot(true);
+            };
+
+            // Enough items to modify most nodes two levels down, which
+            // are flushed on several threads
+            update(0, 2000, 1);
+            flush();
+
+            // A change too small to flush on other threads
+            update(100, 110, 2);
+            flush();
+
+            // Modify most of the map a snapshot shares
+            update(0, 1500, 3);
+            for (int i = 1500; i < 1600; ++i)
+            {
+                BEAST_EXPECT(serial->delItem(sha512Half(i)));
+                BEAST_EXPECT(parallel->delItem(sha512Half(i)));
+            }
+            flush();
+
+            // Inner nodes made from the wire together are hashed as a batch
+            std::vector<Blob> wire;
+            std::vector<SHAMapHash> hashes;
+            parallel->visitNodes([&](SHAMapTreeNode& node) {
+                Serializer s;
+                node.serializeForWire(s);
+                wire.push_back(std::move(s.modData()));
+                hashes.push_back(node.getHash());
+                return true;
+            });
+            wire.emplace_back();
+            hashes.emplace_back();
+
+            std::vector<Slice> rawNodes;
+            for (auto const& w : wire)
+                rawNodes.push_back(makeSlice(w));
+            auto const nodes = SHAMapTreeNode::makeFromWire(rawNodes);
+            BEAST_EXPECT(nodes.size() == hashes.size());
+            BEAST_EXPECT(!nodes.back());
+            for (std::size_t i = 0; i + 1 < nodes.size(); ++i)
+                BEAST_EXPECT(nodes[i] && nodes[i]->getHash() == hashes[i]);
+        }
     }
 };
 